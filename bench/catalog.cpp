@@ -0,0 +1,51 @@
+/**
+ * @file	catalog.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/05
+ */
+
+/* -- Includes -- */
+
+#include <vector>
+
+#include "catalog.hpp"
+#include "corpus.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex::bench;
+
+/* -- Procedures -- */
+
+const vector<catalog_entry>& regex::bench::pattern_catalog()
+{
+  // names are used to track results between releases, so they must never be reused for a
+  // different expression
+  static const vector<catalog_entry> catalog {
+    { corpus_kind::log, "literal", "ERROR" },
+    { corpus_kind::log, "literal-rare", "mallory@corp" },
+    { corpus_kind::log, "alternation", "POST|PUT|DELETE" },
+    { corpus_kind::log, "timestamp", "\\d{4}-\\d{2}-\\d{2}T\\d{2}:\\d{2}" },
+    { corpus_kind::log, "ipv4", "\\d+\\.\\d+\\.\\d+\\.\\d+" },
+    { corpus_kind::log, "email", "[a-z]+@[a-z]+\\.(com|org|net)" },
+    { corpus_kind::log, "slow-request", "latency=\\d{5}ms" },
+    { corpus_kind::log, "server-error", " 5\\d\\d latency" },
+    { corpus_kind::log, "literal-lines", "ERROR", true },
+    { corpus_kind::log, "user-lines", "user=(alice|bob)@", true },
+    { corpus_kind::log, "status-lines", " \\d\\d\\d latency", true },
+    { corpus_kind::random, "literal", "zq" },
+    { corpus_kind::random, "digits", "\\d{4}" },
+    { corpus_kind::random, "word", "\\w{6}" },
+    { corpus_kind::random, "dfa-blowup", "[a-q]\\w{13}x" },
+    { corpus_kind::dna, "literal", "GATTACA" },
+    { corpus_kind::dna, "class-run", "[CG]{8}" },
+    { corpus_kind::dna, "motif", "AG[ACT]{2,6}TT" },
+    { corpus_kind::dna, "alternation", "ACGTAC|TTGACA|GGCCAT|ATATAT" },
+    { corpus_kind::pathological, "nested-alternation", "(a|aa)*c" },
+    { corpus_kind::pathological, "nested-plus", "(?:a+a+)+b" },
+    { corpus_kind::pathological, "stacked-star", "a*a*a*a*a*b" },
+    { corpus_kind::pathological, "line", "a{12,16}" },
+  };
+  return catalog;
+}
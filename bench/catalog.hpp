@@ -0,0 +1,62 @@
+/**
+ * @file	catalog.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/05
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+  namespace bench
+  {
+
+    /**
+     * Struct representing a benchmark pattern and the corpus it is searched in.
+     *
+     * Expressions only use syntax which `std::regex` interprets the same way, and avoid negated
+     * classes, which `std::regex` allows to match a newline, so that match counts are comparable
+     * between every engine.
+     */
+    struct catalog_entry
+    {
+      /** The corpus searched by this pattern. */
+      regex::bench::corpus_kind corpus;
+
+      /** A short, stable name identifying this pattern in reports. */
+      std::string name;
+
+      /** The expression to search for. */
+      std::string expression;
+
+      /**
+       * If `true`, each line of the corpus is searched as a separate input, as a line-oriented tool
+       * would, which measures the cost of starting each search rather than of scanning.
+       */
+      bool per_line = false;
+    };
+
+  }
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+  namespace bench
+  {
+
+    /** Returns the catalog of benchmark patterns, grouped by corpus. */
+    const std::vector<regex::bench::catalog_entry>& pattern_catalog();
+
+  }
+}
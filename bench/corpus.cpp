@@ -0,0 +1,178 @@
+/**
+ * @file	corpus.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/05
+ */
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex::bench;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  // the distributions in <random> are implementation defined, so values are drawn directly from
+  // the engine, whose output is fully specified, to generate the same corpus everywhere
+
+  /** Returns a value in `[0, limit)`. */
+  uint32_t next_below(mt19937& rng, uint32_t limit)
+  {
+    return static_cast<uint32_t>(rng() % limit);
+  }
+
+  /** Returns a random element of the specified list. */
+  const char* pick(mt19937& rng, const vector<const char*>& choices)
+  {
+    return choices[next_below(rng, static_cast<uint32_t>(choices.size()))];
+  }
+
+  /** Appends `value` to `line`, padded with zeros to `width` digits. */
+  void append_number(string& line, uint32_t value, size_t width = 0)
+  {
+    auto digits = to_string(value);
+    if (digits.size() < width)
+      line.append(width - digits.size(), '0');
+    line += digits;
+  }
+
+  /** Appends a log line to `corpus`. */
+  void append_log_line(mt19937& rng, string& corpus)
+  {
+    static const vector<const char*> levels { "INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR" };
+    static const vector<const char*> methods { "GET", "GET", "GET", "POST", "PUT", "DELETE" };
+    static const vector<const char*> resources { "users", "orders", "items", "sessions", "reports" };
+    static const vector<const char*> users { "alice", "bob", "carol", "dave", "erin", "mallory" };
+    static const vector<const char*> domains { "example.com", "mail.org", "corp.net" };
+    static const vector<uint32_t> statuses { 200, 200, 200, 201, 204, 301, 404, 500, 503 };
+
+    string line;
+    line += "2017-";
+    append_number(line, 1 + next_below(rng, 12), 2);
+    line += '-';
+    append_number(line, 1 + next_below(rng, 28), 2);
+    line += 'T';
+    append_number(line, next_below(rng, 24), 2);
+    line += ':';
+    append_number(line, next_below(rng, 60), 2);
+    line += ':';
+    append_number(line, next_below(rng, 60), 2);
+    line += '.';
+    append_number(line, next_below(rng, 1000), 3);
+    line += "Z ";
+    line += pick(rng, levels);
+    line += " [worker-";
+    append_number(line, next_below(rng, 32));
+    line += "] ";
+    line += pick(rng, methods);
+    line += " /api/v1/";
+    line += pick(rng, resources);
+    line += '/';
+    append_number(line, next_below(rng, 100000));
+    line += ' ';
+    append_number(line, statuses[next_below(rng, static_cast<uint32_t>(statuses.size()))]);
+    line += " latency=";
+    append_number(line, next_below(rng, 2) == 0 ? next_below(rng, 100) : next_below(rng, 20000));
+    line += "ms client=10.";
+    append_number(line, next_below(rng, 256));
+    line += '.';
+    append_number(line, next_below(rng, 256));
+    line += '.';
+    append_number(line, next_below(rng, 256));
+    line += " user=";
+    line += pick(rng, users);
+    line += '@';
+    line += pick(rng, domains);
+    line += '\n';
+
+    corpus += line;
+  }
+
+}
+
+/* -- Procedures -- */
+
+const vector<corpus_kind>& regex::bench::all_corpora()
+{
+  static const vector<corpus_kind> corpora {
+    corpus_kind::log,
+    corpus_kind::random,
+    corpus_kind::dna,
+    corpus_kind::pathological,
+  };
+  return corpora;
+}
+
+const string& regex::bench::corpus_name(corpus_kind kind)
+{
+  static const string LOG = "log";
+  static const string RANDOM = "random";
+  static const string DNA = "dna";
+  static const string PATHOLOGICAL = "pathological";
+
+  switch (kind)
+  {
+  case corpus_kind::log:
+    return LOG;
+  case corpus_kind::random:
+    return RANDOM;
+  case corpus_kind::dna:
+    return DNA;
+  case corpus_kind::pathological:
+    return PATHOLOGICAL;
+  }
+
+  throw invalid_argument("Unknown corpus kind.");
+}
+
+string regex::bench::generate_corpus(corpus_kind kind, size_t size, uint32_t seed)
+{
+  mt19937 rng(seed);
+  string corpus;
+  corpus.reserve(size + 256);
+
+  switch (kind)
+  {
+  case corpus_kind::log:
+    while (corpus.size() < size)
+      append_log_line(rng, corpus);
+    break;
+
+  case corpus_kind::random:
+    while (corpus.size() < size)
+      corpus += static_cast<char>(rng() & 0xff);
+    break;
+
+  case corpus_kind::dna:
+    while (corpus.size() < size)
+    {
+      for (int column = 0; column < 60; column++)
+        corpus += "ACGT"[next_below(rng, 4)];
+      corpus += '\n';
+    }
+    break;
+
+  case corpus_kind::pathological:
+    while (corpus.size() < size)
+    {
+      corpus.append(12 + next_below(rng, 5), 'a');
+      corpus += '\n';
+    }
+    break;
+  }
+
+  corpus.resize(size);
+  return corpus;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file	corpus.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/05
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+  namespace bench
+  {
+
+    /**
+     * Enumeration of the kinds of generated benchmark input.
+     */
+    enum class corpus_kind
+    {
+      /** Lines resembling a web server log, with timestamps, addresses, paths and user names. */
+      log,
+
+      /** Uniformly random bytes, including newlines and bytes above `0x7f`. */
+      random,
+
+      /** Lines over the four-letter alphabet `ACGT`. */
+      dna,
+
+      /** Short lines of a single repeated letter, which defeat backtracking engines. */
+      pathological,
+    };
+
+  }
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+  namespace bench
+  {
+
+    /** Returns every kind of corpus, in the order they are reported. */
+    const std::vector<regex::bench::corpus_kind>& all_corpora();
+
+    /** Returns the name of the specified kind of corpus. */
+    const std::string& corpus_name(regex::bench::corpus_kind kind);
+
+    /**
+     * Generates a corpus of exactly `size` bytes. The same kind, size and seed always generate the
+     * same corpus, on every platform.
+     */
+    std::string generate_corpus(regex::bench::corpus_kind kind, size_t size, uint32_t seed);
+
+  }
+}
@@ -0,0 +1,749 @@
+/**
+ * @file	main.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/05
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "automaton_image.hpp"
+#include "byte_search.hpp"
+#include "catalog.hpp"
+#include "corpus.hpp"
+#include "jit_dfa.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+using namespace regex::bench;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** The version of the report format, incremented whenever a field changes meaning. */
+  const int REPORT_VERSION = 1;
+
+  /** Exit status if the benchmarks ran. */
+  const int EXIT_OK = 0;
+
+  /** Exit status if `--check` found a regression. */
+  const int EXIT_REGRESSION = 1;
+
+  /** Exit status if the command line was invalid. */
+  const int EXIT_USAGE = 2;
+
+  /**
+   * With `--check`, the automatic engine must reach at least this fraction of the lazy DFA's
+   * throughput for every pattern, since the lazy DFA is what it falls back to.
+   */
+  const double CHECK_RATIO = 0.5;
+
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /**
+   * Enumeration of the report formats.
+   */
+  enum class report_format
+  {
+    text,
+    csv,
+    json,
+  };
+
+  /**
+   * Struct containing the command line options.
+   */
+  struct bench_options
+  {
+    size_t corpus_size = (4 << 20);
+    size_t reference_size = (64 << 10);
+    uint32_t seed = 1;
+    double min_time = 0.2;
+    report_format format = report_format::text;
+    vector<string> corpora;
+    vector<string> patterns;
+    vector<string> engines;
+    bool list = false;
+    bool check = false;
+  };
+
+  /**
+   * Abstract base class for an engine being measured, which finds leftmost-first matches.
+   */
+  class bench_engine
+  {
+  public:
+
+    virtual ~bench_engine() = default;
+
+    /** Finds the first match in the input range, with positions relative to `begin`. */
+    virtual bool find(const char* begin, const char* end, match& result) const = 0;
+
+  };
+
+  /** Engine searching with a `regex::pattern`. */
+  class pattern_engine : public bench_engine
+  {
+  public:
+
+    pattern_engine(const string& expression, const pattern_options& options)
+      : m_pattern(expression, options)
+    { }
+
+    bool find(const char* begin, const char* end, match& result) const override
+    {
+      return m_pattern.find(begin, end, result);
+    }
+
+  private:
+
+    pattern m_pattern;
+
+  };
+
+  /** Engine searching with a pattern loaded in place from a serialized automaton image. */
+  class image_engine : public bench_engine
+  {
+  public:
+
+    image_engine(const string& data)
+      : m_storage(aligned_copy(data)),
+        m_image(m_storage.data(), data.size()),
+        m_pattern(m_image.pattern(0))
+    { }
+
+    bool find(const char* begin, const char* end, match& result) const override
+    {
+      return m_pattern.find(begin, end, result);
+    }
+
+  private:
+
+    vector<uint64_t> m_storage;
+    automaton_image m_image;
+    image_pattern m_pattern;
+
+    /** Copies the image into storage aligned as an image must be. */
+    static vector<uint64_t> aligned_copy(const string& data)
+    {
+      vector<uint64_t> storage((data.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+      copy(data.begin(), data.end(), reinterpret_cast<char*>(storage.data()));
+      return storage;
+    }
+
+  };
+
+  /** Engine searching with `std::regex`, as a reference point. */
+  class std_regex_engine : public bench_engine
+  {
+  public:
+
+    std_regex_engine(const string& expression)
+      : m_regex(expression, std::regex::ECMAScript | std::regex::optimize)
+    { }
+
+    bool find(const char* begin, const char* end, match& result) const override
+    {
+      cmatch groups;
+      if (!regex_search(begin, end, groups, m_regex))
+        return false;
+
+      result.begin = static_cast<size_t>(groups[0].first - begin);
+      result.end = static_cast<size_t>(groups[0].second - begin);
+      return true;
+    }
+
+  private:
+
+    std::regex m_regex;
+
+  };
+
+  /**
+   * Struct describing an engine which may be measured.
+   *
+   * `prepare` converts an expression into the input from which `build` constructs the engine, and
+   * is not timed, so that the compile time of the `image` engine is that of loading an image which
+   * was written ahead of time.
+   */
+  struct engine_spec
+  {
+    string name;
+    function<string(const string&)> prepare;
+    function<unique_ptr<bench_engine>(const string&)> build;
+    bool reference;
+  };
+
+  /**
+   * Struct containing the result of measuring one engine for one pattern.
+   */
+  struct bench_result
+  {
+    string corpus;
+    string pattern;
+    string expression;
+    string engine;
+    string status;
+    double compile_us = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+    size_t matches = 0;
+
+    /** Returns the search throughput in megabytes (`2^20` bytes) per second. */
+    double mb_per_second() const
+    {
+      return (seconds > 0 ? bytes / seconds / (1 << 20) : 0);
+    }
+
+    /** Returns the number of matches found per second. */
+    double matches_per_second() const
+    {
+      return (seconds > 0 ? matches / seconds : 0);
+    }
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace
+{
+
+  /** Prints the usage message to standard error. */
+  void print_usage();
+
+  /** Parses the command line options. Returns `false` on error. */
+  bool parse_options(int argc, char** argv, bench_options& options);
+
+  /** Parses a size in bytes, with an optional `K` or `M` suffix. Returns `false` on error. */
+  bool parse_size(const string& text, size_t& size);
+
+  /** Returns the engines which may be measured. */
+  vector<engine_spec> make_engines();
+
+  /** Returns `true` if `name` is selected by the specified filter, where an empty filter selects all. */
+  bool selected(const vector<string>& filter, const string& name);
+
+  /**
+   * Calls `fn` repeatedly until at least `min_time` seconds and `min_runs` runs have elapsed,
+   * returning the shortest time taken by a single run, in seconds.
+   */
+  double best_time(double min_time, size_t min_runs, const function<void()>& fn);
+
+  /** Returns the number of non-overlapping matches in the input range, as an iterator would find. */
+  size_t count_matches(const bench_engine& engine, const char* begin, const char* end);
+
+  /** Returns the number of matches in the input range, searching each line separately. */
+  size_t count_line_matches(const bench_engine& engine, const char* begin, const char* end);
+
+  /**
+   * Reports every pattern for which the automatic engine is much slower than the lazy DFA. Returns
+   * `false` if there are any.
+   */
+  bool check_results(const vector<bench_result>& results);
+
+  /** Measures one engine for one pattern. */
+  bench_result measure(const engine_spec& spec,
+                       const catalog_entry& entry,
+                       const string& corpus,
+                       const bench_options& options);
+
+  /** Prints the results as an aligned table. */
+  void print_text(const vector<bench_result>& results);
+
+  /** Prints the results as comma-separated values, with a header row. */
+  void print_csv(const vector<bench_result>& results);
+
+  /** Prints the results as a single JSON object. */
+  void print_json(const vector<bench_result>& results, const bench_options& options);
+
+  /** Returns the specified string quoted and escaped for JSON. */
+  string json_string(const string& value);
+
+  /** Returns the specified string quoted for CSV. */
+  string csv_string(const string& value);
+
+}
+
+/* -- Procedures -- */
+
+int main(int argc, char** argv)
+{
+  bench_options options;
+  if (!parse_options(argc, argv, options))
+  {
+    print_usage();
+    return EXIT_USAGE;
+  }
+
+  auto engines = make_engines();
+  if (options.list)
+  {
+    cout << "corpora:";
+    for (auto kind : all_corpora())
+      cout << ' ' << corpus_name(kind);
+    cout << endl << "engines:";
+    for (const auto& spec : engines)
+      cout << ' ' << spec.name;
+    cout << endl << "patterns:" << endl;
+    for (const auto& entry : pattern_catalog())
+      cout << "  " << corpus_name(entry.corpus) << '/' << entry.name << "  " << entry.expression << endl;
+    return EXIT_OK;
+  }
+
+  vector<bench_result> results;
+  for (auto kind : all_corpora())
+  {
+    if (!selected(options.corpora, corpus_name(kind)))
+      continue;
+
+    auto corpus = generate_corpus(kind, options.corpus_size, options.seed);
+    for (const auto& entry : pattern_catalog())
+    {
+      if (entry.corpus != kind || !selected(options.patterns, entry.name))
+        continue;
+
+      for (const auto& spec : engines)
+      {
+        if (!selected(options.engines, spec.name))
+          continue;
+
+        if (options.format == report_format::text)
+          cerr << "  " << corpus_name(kind) << '/' << entry.name << " [" << spec.name << "]" << endl;
+        results.push_back(measure(spec, entry, corpus, options));
+      }
+    }
+  }
+
+  switch (options.format)
+  {
+  case report_format::text:
+    print_text(results);
+    break;
+  case report_format::csv:
+    print_csv(results);
+    break;
+  case report_format::json:
+    print_json(results, options);
+    break;
+  }
+
+  if (options.check && !check_results(results))
+    return EXIT_REGRESSION;
+  return EXIT_OK;
+}
+
+namespace
+{
+
+  void print_usage()
+  {
+    cerr << "usage: regex_bench [options]" << endl
+         << endl
+         << "  --size BYTES            size of each generated corpus (default 4M)" << endl
+         << "  --reference-size BYTES  bytes searched by std::regex (default 64K)" << endl
+         << "  --seed N                seed for generating the corpora (default 1)" << endl
+         << "  --min-time SECONDS      minimum time spent on each measurement (default 0.2)" << endl
+         << "  --corpus NAME           only run patterns for the named corpus (repeatable)" << endl
+         << "  --pattern NAME          only run the named pattern (repeatable)" << endl
+         << "  --engine NAME           only measure the named engine (repeatable)" << endl
+         << "  --format FORMAT         report as text, csv, or json (default text)" << endl
+         << "  --list                  list the corpora, engines and patterns" << endl
+         << "  --check                 fail if the automatic engine is much slower than the lazy DFA" << endl;
+  }
+
+  bool parse_options(int argc, char** argv, bench_options& options)
+  {
+    for (int index = 1; index < argc; index++)
+    {
+      string arg = argv[index];
+      if (arg == "--list")
+      {
+        options.list = true;
+        continue;
+      }
+      if (arg == "--check")
+      {
+        options.check = true;
+        continue;
+      }
+
+      if (index + 1 >= argc)
+      {
+        cerr << "regex_bench: unknown or incomplete option " << arg << endl;
+        return false;
+      }
+
+      string value = argv[++index];
+      bool ok = true;
+      if (arg == "--size")
+        ok = (parse_size(value, options.corpus_size) && options.corpus_size > 0);
+      else if (arg == "--reference-size")
+        ok = parse_size(value, options.reference_size);
+      else if (arg == "--seed")
+        options.seed = static_cast<uint32_t>(strtoul(value.c_str(), nullptr, 10));
+      else if (arg == "--min-time")
+        ok = ((options.min_time = strtod(value.c_str(), nullptr)) >= 0);
+      else if (arg == "--corpus")
+        options.corpora.push_back(value);
+      else if (arg == "--pattern")
+        options.patterns.push_back(value);
+      else if (arg == "--engine")
+        options.engines.push_back(value);
+      else if (arg == "--format" && value == "text")
+        options.format = report_format::text;
+      else if (arg == "--format" && value == "csv")
+        options.format = report_format::csv;
+      else if (arg == "--format" && value == "json")
+        options.format = report_format::json;
+      else
+        ok = false;
+
+      if (!ok)
+      {
+        cerr << "regex_bench: invalid option " << arg << ' ' << value << endl;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool parse_size(const string& text, size_t& size)
+  {
+    char* suffix = nullptr;
+    auto value = strtoull(text.c_str(), &suffix, 10);
+    if (suffix == text.c_str())
+      return false;
+
+    string unit(suffix);
+    if (unit == "K" || unit == "k")
+      value <<= 10;
+    else if (unit == "M" || unit == "m")
+      value <<= 20;
+    else if (!unit.empty())
+      return false;
+
+    size = static_cast<size_t>(value);
+    return true;
+  }
+
+  vector<engine_spec> make_engines()
+  {
+    // every engine is compiled so that wildcards never match a newline, as with std::regex
+    auto identity = [] (const string& expression) { return expression; };
+    auto pattern_spec = [=] (const string& name, engine_type engine, bool use_jit) {
+      pattern_options options;
+      options.engine = engine;
+      options.match_newline = false;
+      options.use_jit = use_jit;
+      return engine_spec {
+        name,
+        identity,
+        [=] (const string& expression) { return unique_ptr<bench_engine>(new pattern_engine(expression, options)); },
+        false,
+      };
+    };
+
+    vector<engine_spec> engines {
+      pattern_spec("automatic", engine_type::automatic, false),
+      pattern_spec("pike_vm", engine_type::pike_vm, false),
+      pattern_spec("lazy_dfa", engine_type::lazy_dfa, false),
+      pattern_spec("full_dfa", engine_type::full_dfa, false),
+      pattern_spec("shift_and", engine_type::shift_and, false),
+      pattern_spec("shuffle_dfa", engine_type::shuffle_dfa, false),
+    };
+
+    if (jit_dfa::is_supported())
+      engines.push_back(pattern_spec("jit_dfa", engine_type::full_dfa, true));
+
+    engines.push_back(engine_spec {
+      "image",
+      [] (const string& expression) {
+        pattern_options options;
+        options.match_newline = false;
+        image_writer writer;
+        writer.add_pattern(expression, options);
+        return writer.data();
+      },
+      [] (const string& data) { return unique_ptr<bench_engine>(new image_engine(data)); },
+      false,
+    });
+
+    engines.push_back(engine_spec {
+      "std_regex",
+      identity,
+      [] (const string& expression) { return unique_ptr<bench_engine>(new std_regex_engine(expression)); },
+      true,
+    });
+
+    return engines;
+  }
+
+  bool selected(const vector<string>& filter, const string& name)
+  {
+    return (filter.empty() || find(filter.begin(), filter.end(), name) != filter.end());
+  }
+
+  double best_time(double min_time, size_t min_runs, const function<void()>& fn)
+  {
+    using clock = chrono::steady_clock;
+
+    double best = 0;
+    double total = 0;
+    for (size_t runs = 0; runs < min_runs || total < min_time; runs++)
+    {
+      auto start = clock::now();
+      fn();
+      double elapsed = chrono::duration<double>(clock::now() - start).count();
+
+      best = (runs == 0 ? elapsed : min(best, elapsed));
+      total += elapsed;
+    }
+    return best;
+  }
+
+  size_t count_matches(const bench_engine& engine, const char* begin, const char* end)
+  {
+    size_t count = 0;
+    auto pos = begin;
+    while (true)
+    {
+      match result { 0, 0 };
+      if (!engine.find(pos, end, result))
+        break;
+      count++;
+
+      // an empty match is skipped over, so that the search always makes progress
+      auto next = result.end + (result.end == result.begin ? 1 : 0);
+      if (next > static_cast<size_t>(end - pos))
+        break;
+      pos += next;
+    }
+    return count;
+  }
+
+  size_t count_line_matches(const bench_engine& engine, const char* begin, const char* end)
+  {
+    size_t count = 0;
+    while (begin != end)
+    {
+      auto line_end = static_cast<const char*>(memchr(begin, '\n', static_cast<size_t>(end - begin)));
+      if (line_end == nullptr)
+        line_end = end;
+
+      count += count_matches(engine, begin, line_end);
+      begin = (line_end == end ? end : line_end + 1);
+    }
+    return count;
+  }
+
+  bench_result measure(const engine_spec& spec,
+                       const catalog_entry& entry,
+                       const string& corpus,
+                       const bench_options& options)
+  {
+    bench_result result;
+    result.corpus = corpus_name(entry.corpus);
+    result.pattern = entry.name;
+    result.expression = entry.expression;
+    result.engine = spec.name;
+
+    try
+    {
+      auto input = spec.prepare(entry.expression);
+      unique_ptr<bench_engine> engine;
+      auto compile_seconds = best_time(options.min_time / 4, 3, [&] { engine = spec.build(input); });
+      result.compile_us = compile_seconds * 1e6;
+
+      // the reference engine backtracks, and may take exponential time, so it only searches a prefix
+      result.bytes = (spec.reference ? min(corpus.size(), options.reference_size) : corpus.size());
+      auto begin = corpus.data();
+      auto end = begin + result.bytes;
+      result.seconds = best_time(options.min_time, 1, [&] {
+          result.matches = (entry.per_line ? count_line_matches(*engine, begin, end) : count_matches(*engine, begin, end));
+        });
+      result.status = "ok";
+    }
+    catch (const exception& ex)
+    {
+      result.status = string("unsupported: ") + ex.what();
+    }
+
+    return result;
+  }
+
+  bool check_results(const vector<bench_result>& results)
+  {
+    bool ok = true;
+    for (const auto& automatic : results)
+    {
+      if (automatic.engine != "automatic" || automatic.status != "ok")
+        continue;
+
+      for (const auto& lazy : results)
+      {
+        if (lazy.engine != "lazy_dfa" || lazy.status != "ok" ||
+            lazy.corpus != automatic.corpus || lazy.pattern != automatic.pattern)
+          continue;
+
+        if (automatic.mb_per_second() < CHECK_RATIO * lazy.mb_per_second())
+        {
+          cerr << "regex_bench: regression: " << automatic.corpus << '/' << automatic.pattern
+               << " automatic " << automatic.mb_per_second() << " MB/s, lazy_dfa "
+               << lazy.mb_per_second() << " MB/s" << endl;
+          ok = false;
+        }
+      }
+    }
+    return ok;
+  }
+
+  void print_text(const vector<bench_result>& results)
+  {
+    cout << left
+         << setw(14) << "corpus"
+         << setw(20) << "pattern"
+         << setw(13) << "engine"
+         << right
+         << setw(14) << "compile us"
+         << setw(12) << "MB/s"
+         << setw(11) << "matches"
+         << setw(14) << "matches/s"
+         << endl;
+
+    cout << fixed;
+    for (const auto& result : results)
+    {
+      cout << left
+           << setw(14) << result.corpus
+           << setw(20) << result.pattern
+           << setw(13) << result.engine
+           << right;
+      if (result.status != "ok")
+      {
+        cout << "  " << result.status << endl;
+        continue;
+      }
+
+      cout << setw(14) << setprecision(1) << result.compile_us
+           << setw(12) << setprecision(1) << result.mb_per_second()
+           << setw(11) << result.matches
+           << setw(14) << setprecision(0) << result.matches_per_second()
+           << endl;
+    }
+  }
+
+  void print_csv(const vector<bench_result>& results)
+  {
+    cout << "corpus,pattern,expression,engine,status,compile_us,bytes,seconds,mb_per_s,matches,matches_per_s" << endl;
+    cout << setprecision(9);
+    for (const auto& result : results)
+    {
+      cout << csv_string(result.corpus) << ','
+           << csv_string(result.pattern) << ','
+           << csv_string(result.expression) << ','
+           << csv_string(result.engine) << ','
+           << csv_string(result.status) << ','
+           << result.compile_us << ','
+           << result.bytes << ','
+           << result.seconds << ','
+           << result.mb_per_second() << ','
+           << result.matches << ','
+           << result.matches_per_second() << endl;
+    }
+  }
+
+  void print_json(const vector<bench_result>& results, const bench_options& options)
+  {
+    cout << setprecision(9);
+    cout << "{" << endl
+         << "  \"version\": " << REPORT_VERSION << "," << endl
+         << "  \"seed\": " << options.seed << "," << endl
+         << "  \"corpus_size\": " << options.corpus_size << "," << endl
+         << "  \"reference_size\": " << options.reference_size << "," << endl
+         << "  \"min_time\": " << options.min_time << "," << endl
+         << "  \"byte_search_isa\": " << json_string(byte_search_isa()) << "," << endl
+         << "  \"results\": [";
+
+    for (size_t idx = 0; idx < results.size(); idx++)
+    {
+      const auto& result = results[idx];
+      cout << (idx == 0 ? "" : ",") << endl
+           << "    { \"corpus\": " << json_string(result.corpus)
+           << ", \"pattern\": " << json_string(result.pattern)
+           << ", \"expression\": " << json_string(result.expression)
+           << ", \"engine\": " << json_string(result.engine)
+           << ", \"status\": " << json_string(result.status)
+           << ", \"compile_us\": " << result.compile_us
+           << ", \"bytes\": " << result.bytes
+           << ", \"seconds\": " << result.seconds
+           << ", \"mb_per_s\": " << result.mb_per_second()
+           << ", \"matches\": " << result.matches
+           << ", \"matches_per_s\": " << result.matches_per_second()
+           << " }";
+    }
+
+    cout << endl << "  ]" << endl << "}" << endl;
+  }
+
+  string json_string(const string& value)
+  {
+    ostringstream quoted;
+    quoted << '"';
+    for (auto ch : value)
+    {
+      if (ch == '"' || ch == '\\')
+        quoted << '\\' << ch;
+      else if (static_cast<unsigned char>(ch) < 0x20)
+      {
+        char escape[8];
+        snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned char>(ch));
+        quoted << escape;
+      }
+      else
+        quoted << ch;
+    }
+    quoted << '"';
+    return quoted.str();
+  }
+
+  string csv_string(const string& value)
+  {
+    string quoted = "\"";
+    for (auto ch : value)
+    {
+      if (ch == '"')
+        quoted += '"';
+      quoted += ch;
+    }
+    quoted += '"';
+    return quoted;
+  }
+
+}
@@ -0,0 +1,847 @@
+/**
+ * @file	automaton_image.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/04
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "automaton_image.hpp"
+#include "byte_search.hpp"
+#include "compiler.hpp"
+#include "dfa_state_builder.hpp"
+#include "full_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "prefix_analysis.hpp"
+#include "program.hpp"
+#include "simplifier.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /*
+   * An image consists of a header, followed by an array of entry records, followed by the data they
+   * refer to. Every offset is from the start of the image, and every record and array begins on an
+   * 8-byte boundary, so that the image can be used in place wherever it is loaded.
+   */
+
+  /** The magic number at the start of every image. */
+  const char IMAGE_MAGIC[8] = { 'R', 'G', 'X', 'I', 'M', 'A', 'G', 'E' };
+
+  /** Value stored in the header to detect an image written with a different byte order. */
+  const uint32_t IMAGE_BYTE_ORDER = 0x01020304;
+
+  /** The number of bytes in the byte class map of each table. */
+  const uint64_t CLASS_MAP_SIZE = 256;
+
+  /** Struct representing the header of an image. */
+  struct header_record
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t size;
+    uint64_t entry_count;
+    uint64_t entries;
+  };
+
+  /** Struct representing a DFA table within an image. */
+  struct table_record
+  {
+    uint32_t stride;
+    uint32_t start;
+    uint32_t last_match;
+    uint32_t state_count;
+    uint64_t classes;
+    uint64_t transitions;
+  };
+
+  /**
+   * Struct representing an entry within an image.
+   *
+   * `expressions` refers to an array of `(offset, length)` pairs, one per expression. A pattern has
+   * a single expression and uses `prefix` and both tables. A set uses only the forward table, and
+   * lists the expressions matched in each match state `i` at `match_ids[match_offsets[i]]` up to
+   * `match_ids[match_offsets[i + 1]]`.
+   */
+  struct entry_record
+  {
+    uint32_t kind;
+    uint32_t expression_count;
+    uint64_t expressions;
+    uint64_t prefix;
+    uint64_t prefix_length;
+    table_record forward;
+    table_record reverse;
+    uint64_t match_offsets;
+    uint64_t match_ids;
+  };
+
+  /** Struct representing an entry which has been compiled but not yet serialized. */
+  struct compiled_entry
+  {
+    image_entry_kind kind;
+    vector<string> expressions;
+    string prefix;
+    dfa_table forward;
+    dfa_table reverse;
+    vector<uint32_t> match_offsets;
+    vector<uint32_t> match_ids;
+  };
+
+  /** Rounds the specified size up to the image alignment. */
+  uint64_t align(uint64_t size)
+  {
+    return (size + automaton_image::ALIGNMENT - 1) / automaton_image::ALIGNMENT * automaton_image::ALIGNMENT;
+  }
+
+  /** Appends the specified bytes to `buffer`, padded to the image alignment, returning their offset. */
+  uint64_t append(string& buffer, const void* data, size_t size)
+  {
+    auto offset = static_cast<uint64_t>(buffer.size());
+    buffer.append(static_cast<const char*>(data), size);
+    buffer.resize(static_cast<size_t>(align(buffer.size())), '\0');
+    return offset;
+  }
+
+  /** Appends the specified table to `buffer`, returning its record. */
+  table_record append_table(string& buffer, const dfa_table& table)
+  {
+    table_record record;
+    record.stride = table.stride;
+    record.start = table.start;
+    record.last_match = table.last_match;
+    record.state_count = static_cast<uint32_t>(table.state_count());
+    record.classes = append(buffer, table.classes.data(), CLASS_MAP_SIZE);
+    record.transitions = append(buffer, table.transitions.data(), table.transitions.size() * sizeof(uint32_t));
+    return record;
+  }
+
+  /**
+   * Builds the DFA for a set program, storing the patterns matched in each match state in
+   * `match_offsets` and `match_ids`.
+   *
+   * The states are numbered like those of `regex::build_dfa_table`, but are not minimized, since
+   * states matching different patterns must never be merged.
+   */
+  dfa_table build_set_table(shared_ptr<const program> prog,
+                            size_t state_limit,
+                            vector<uint32_t>& match_offsets,
+                            vector<uint32_t>& match_ids)
+  {
+    dfa_state_builder builder(prog, match_kind::longest);
+    const auto& byte_classes = prog->byte_classes;
+    const auto class_bytes = byte_classes.representatives();
+    const size_t alphabet_size = byte_classes.count();
+
+    unordered_map<dfa_state_key, uint32_t, dfa_state_key_hash> ids;
+    vector<const dfa_state_key*> keys;
+    vector<uint32_t> transitions;
+
+    // interns a state, returning its index
+    auto intern = [&] (const dfa_state_key& key) -> uint32_t {
+      auto it = ids.find(key);
+      if (it != ids.end())
+        return it->second;
+
+      if (keys.size() >= state_limit)
+      {
+        ostringstream message;
+        message << "DFA exceeds limit of " << state_limit << " states.";
+        throw compile_error(message.str());
+      }
+
+      auto index = static_cast<uint32_t>(keys.size());
+      it = ids.emplace(key, index).first;
+      keys.push_back(&it->first);
+      return index;
+    };
+
+    // the dead state is always index 0
+    dfa_state_key key;
+    intern(key);
+    builder.start_state(prog->unanchored_start, key);
+    auto start = intern(key);
+
+    for (size_t index = 0; index < keys.size(); index++)
+    {
+      transitions.resize(transitions.size() + alphabet_size);
+      for (size_t cls = 0; cls < alphabet_size; cls++)
+      {
+        builder.next_state(*keys[index], class_bytes[cls], key);
+        transitions[index * alphabet_size + cls] = intern(key);
+      }
+    }
+
+    // number the dead state first, followed by the match states, followed by all others
+    vector<uint32_t> state_ids(keys.size(), UINT32_MAX);
+    vector<uint32_t> order;
+    state_ids[0] = 0;
+    order.push_back(0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+      for (size_t state = 1; state < keys.size(); state++)
+      {
+        if (builder.is_match_state(*keys[state]) == (pass == 0))
+        {
+          state_ids[state] = static_cast<uint32_t>(order.size());
+          order.push_back(static_cast<uint32_t>(state));
+        }
+      }
+      if (pass == 0)
+      {
+        // record the patterns matched in each match state, including the dead state as empty
+        match_offsets.assign(1, 0);
+        match_ids.clear();
+        for (auto state : order)
+        {
+          auto first = match_ids.size();
+          for (auto pc : *keys[state])
+          {
+            const auto& inst = prog->instructions[pc];
+            if (inst.op == opcode::match)
+              match_ids.push_back(inst.argument);
+          }
+          sort(match_ids.begin() + first, match_ids.end());
+          match_ids.erase(unique(match_ids.begin() + first, match_ids.end()), match_ids.end());
+          match_offsets.push_back(static_cast<uint32_t>(match_ids.size()));
+        }
+      }
+    }
+
+    dfa_table table;
+    table.stride = static_cast<uint32_t>(alphabet_size);
+    table.classes = byte_classes;
+    table.transitions.resize(keys.size() * alphabet_size);
+    for (size_t id = 0; id < order.size(); id++)
+      for (size_t symbol = 0; symbol < alphabet_size; symbol++)
+        table.transitions[id * alphabet_size + symbol] = state_ids[transitions[order[id] * alphabet_size + symbol]] * table.stride;
+
+    table.start = state_ids[start] * table.stride;
+    table.last_match = static_cast<uint32_t>(match_offsets.size() - 2) * table.stride;
+    return table;
+  }
+
+  /** Returns `true` if `count` elements of `element_size` bytes at `offset` lie within `size` bytes. */
+  bool in_bounds(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t size)
+  {
+    return (offset <= size && offset % automaton_image::ALIGNMENT == 0 && count <= (size - offset) / element_size);
+  }
+
+  /** Throws a `regex::image_error` with the specified message. */
+  [[noreturn]] void fail(const string& message)
+  {
+    throw image_error("Invalid automaton image: " + message);
+  }
+
+  /** Checks that the specified table record lies within an image of `size` bytes. */
+  void check_table(const table_record& table, uint64_t size)
+  {
+    if (table.stride == 0 || table.stride > CLASS_MAP_SIZE || table.state_count == 0)
+      fail("bad table dimensions.");
+
+    auto limit = static_cast<uint64_t>(table.state_count) * table.stride;
+    if (limit > UINT32_MAX)
+      fail("table too large.");
+    if (table.start >= limit || table.start % table.stride != 0 || table.last_match >= limit)
+      fail("bad table states.");
+    if (!in_bounds(table.classes, CLASS_MAP_SIZE, 1, size) ||
+        !in_bounds(table.transitions, limit, sizeof(uint32_t), size))
+      fail("table out of bounds.");
+  }
+
+  /** Returns a view of the specified table record within the image at `data`. */
+  image_table make_table(const char* data, const table_record& table)
+  {
+    return image_table {
+      table.stride,
+      table.start,
+      table.last_match,
+      reinterpret_cast<const uint8_t*>(data + table.classes),
+      reinterpret_cast<const uint32_t*>(data + table.transitions),
+    };
+  }
+
+  /** Checks every byte class and transition of the specified table record. */
+  void verify_table(const char* data, const table_record& table)
+  {
+    auto view = make_table(data, table);
+    auto limit = static_cast<uint64_t>(table.state_count) * table.stride;
+    for (size_t byte = 0; byte < CLASS_MAP_SIZE; byte++)
+      if (view.classes[byte] >= table.stride)
+        fail("byte class out of range.");
+    for (uint64_t idx = 0; idx < limit; idx++)
+      if (view.transitions[idx] >= limit || view.transitions[idx] % table.stride != 0)
+        fail("transition out of range.");
+  }
+
+}
+
+/* -- Types -- */
+
+struct image_writer::implementation
+{
+
+  /* -- Fields -- */
+
+  vector<compiled_entry> entries;
+
+};
+
+/* -- Procedures -- */
+
+image_writer::image_writer()
+  : impl(make_unique<implementation>())
+{
+}
+
+image_writer::~image_writer() = default;
+
+size_t image_writer::add_pattern(const string& expression, const pattern_options& options)
+{
+  lexical_analyzer lex(expression);
+  syntax_analyzer parse(lex.all_tokens());
+  auto tree = parse.parse_tree();
+
+  if (!options.match_newline)
+  {
+    bitset<256> allowed;
+    allowed.set();
+    allowed.reset('\n');
+    tree = restrict_classes(tree, allowed);
+  }
+
+  if (options.simplify)
+    tree = regex::simplify(tree);
+
+  compile_options reverse_options;
+  reverse_options.reverse = true;
+  full_dfa dfa(compile(tree), compile(tree, reverse_options), options.dfa_state_limit);
+
+  compiled_entry entry;
+  entry.kind = image_entry_kind::pattern;
+  entry.expressions.push_back(expression);
+  if (options.use_prefilter)
+    entry.prefix = analyze_prefix(tree).prefix;
+  entry.forward = dfa.forward_table();
+  entry.reverse = dfa.reverse_table();
+
+  impl->entries.push_back(move(entry));
+  return impl->entries.size() - 1;
+}
+
+size_t image_writer::add_set(const vector<string>& expressions, size_t state_limit)
+{
+  vector<syntax_tree> trees;
+  for (const auto& expression : expressions)
+  {
+    lexical_analyzer lex(expression);
+    syntax_analyzer parse(lex.all_tokens());
+    trees.push_back(simplify(parse.parse_tree()));
+  }
+
+  compiled_entry entry;
+  entry.kind = image_entry_kind::set;
+  entry.expressions = expressions;
+  entry.forward = build_set_table(compile_set(trees), state_limit, entry.match_offsets, entry.match_ids);
+
+  impl->entries.push_back(move(entry));
+  return impl->entries.size() - 1;
+}
+
+size_t image_writer::size() const
+{
+  return impl->entries.size();
+}
+
+string image_writer::data() const
+{
+  const auto& entries = impl->entries;
+
+  header_record header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+  header.version = automaton_image::VERSION;
+  header.byte_order = IMAGE_BYTE_ORDER;
+  header.entry_count = entries.size();
+  header.entries = align(sizeof(header_record));
+
+  // the header and entry records are filled in once the offsets of everything else are known
+  string buffer(static_cast<size_t>(header.entries + align(entries.size() * sizeof(entry_record))), '\0');
+  vector<entry_record> records(entries.size());
+  for (size_t idx = 0; idx < entries.size(); idx++)
+  {
+    const auto& entry = entries[idx];
+    auto& record = records[idx];
+    memset(&record, 0, sizeof(record));
+    record.kind = static_cast<uint32_t>(entry.kind);
+    record.expression_count = static_cast<uint32_t>(entry.expressions.size());
+
+    vector<uint64_t> expressions;
+    for (const auto& expression : entry.expressions)
+    {
+      expressions.push_back(append(buffer, expression.data(), expression.size()));
+      expressions.push_back(expression.size());
+    }
+    record.expressions = append(buffer, expressions.data(), expressions.size() * sizeof(uint64_t));
+
+    record.prefix = append(buffer, entry.prefix.data(), entry.prefix.size());
+    record.prefix_length = entry.prefix.size();
+    record.forward = append_table(buffer, entry.forward);
+    if (entry.kind == image_entry_kind::pattern)
+      record.reverse = append_table(buffer, entry.reverse);
+
+    record.match_offsets = append(buffer, entry.match_offsets.data(), entry.match_offsets.size() * sizeof(uint32_t));
+    record.match_ids = append(buffer, entry.match_ids.data(), entry.match_ids.size() * sizeof(uint32_t));
+  }
+
+  header.size = buffer.size();
+  memcpy(&buffer[0], &header, sizeof(header));
+  if (!records.empty())
+    memcpy(&buffer[static_cast<size_t>(header.entries)], records.data(), records.size() * sizeof(entry_record));
+  return buffer;
+}
+
+void image_writer::write(const string& path) const
+{
+  auto buffer = data();
+  ofstream file(path, ios::binary | ios::trunc);
+  file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+  file.close();
+  if (!file)
+    throw image_error("Failed to write automaton image to " + path + ".");
+}
+
+image_pattern::image_pattern(const image_table& forward,
+                             const image_table& reverse,
+                             const char* prefix,
+                             size_t prefix_length,
+                             const char* expression,
+                             size_t expression_length)
+  : m_forward(forward),
+    m_reverse(reverse),
+    m_prefix(prefix),
+    m_prefix_length(prefix_length),
+    m_expression(expression),
+    m_expression_length(expression_length)
+{
+}
+
+string image_pattern::expression() const
+{
+  return string(m_expression, m_expression_length);
+}
+
+bool image_pattern::is_match(const char* begin, const char* end) const
+{
+  size_t match_end;
+  return scan_forward(begin, end, true, match_end);
+}
+
+bool image_pattern::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool image_pattern::find(const char* begin, const char* end, match& result) const
+{
+  size_t match_end;
+  if (!scan_forward(begin, end, false, match_end))
+    return false;
+
+  result.begin = scan_reverse(begin, match_end);
+  result.end = match_end;
+  return true;
+}
+
+bool image_pattern::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+bool image_pattern::scan_forward(const char* begin, const char* end, bool stop_early, size_t& match_end) const
+{
+  const uint32_t* table = m_forward.transitions;
+  const uint8_t* classes = m_forward.classes;
+  const uint32_t start = m_forward.start;
+  const bool skip = (m_prefix_length != 0);
+  bool found = false;
+
+  // skips ahead to the next occurrence of the prefix which every match begins with
+  auto next_candidate = [this] (const char* from, const char* to) -> const char* {
+    if (m_prefix_length == 1)
+      return find_byte(from, to, static_cast<unsigned char>(m_prefix[0]));
+    return find_substring(from, to, m_prefix, m_prefix_length);
+  };
+
+  // as in `regex::full_dfa`, the start state immediately follows the match states
+  const uint32_t limit = (skip ? max(start, m_forward.last_match) : m_forward.last_match);
+
+  auto state = start;
+  if (state != 0 && state <= m_forward.last_match)
+  {
+    found = true;
+    match_end = 0;
+    if (stop_early)
+      return true;
+  }
+
+  auto ptr = begin;
+  if (skip && !found)
+    ptr = next_candidate(begin, end);
+
+  while (ptr != end)
+  {
+    state = table[state + classes[static_cast<unsigned char>(*ptr++)]];
+    if (state <= limit)
+    {
+      if (state == 0)
+        break;
+
+      if (state == start && !found)
+      {
+        ptr = next_candidate(ptr, end);
+        continue;
+      }
+
+      found = true;
+      match_end = static_cast<size_t>(ptr - begin);
+      if (stop_early)
+        return true;
+    }
+  }
+
+  return found;
+}
+
+size_t image_pattern::scan_reverse(const char* begin, size_t match_end) const
+{
+  const uint32_t* table = m_reverse.transitions;
+  const uint8_t* classes = m_reverse.classes;
+  const uint32_t last_match = m_reverse.last_match;
+  auto match_begin = match_end;
+
+  auto state = m_reverse.start;
+  for (auto ptr = begin + match_end; ptr != begin; )
+  {
+    ptr--;
+    state = table[state + classes[static_cast<unsigned char>(*ptr)]];
+    if (state <= last_match)
+    {
+      if (state == 0)
+        break;
+      match_begin = static_cast<size_t>(ptr - begin);
+    }
+  }
+
+  return match_begin;
+}
+
+image_set::image_set(const image_table& table,
+                     const uint32_t* match_offsets,
+                     const uint32_t* match_ids,
+                     const uint64_t* expressions,
+                     const char* base,
+                     size_t size)
+  : m_table(table),
+    m_match_offsets(match_offsets),
+    m_match_ids(match_ids),
+    m_expressions(expressions),
+    m_base(base),
+    m_size(size)
+{
+}
+
+size_t image_set::size() const
+{
+  return m_size;
+}
+
+string image_set::expression(size_t index) const
+{
+  if (index >= m_size)
+    throw out_of_range("Expression index out of range.");
+  return string(m_base + m_expressions[2 * index], static_cast<size_t>(m_expressions[2 * index + 1]));
+}
+
+bool image_set::is_match(const char* begin, const char* end) const
+{
+  const uint32_t* table = m_table.transitions;
+  const uint8_t* classes = m_table.classes;
+  const uint32_t last_match = m_table.last_match;
+
+  auto state = m_table.start;
+  for (auto ptr = begin; ; ptr++)
+  {
+    if (state <= last_match)
+    {
+      if (state != 0)
+        return true;
+      break;
+    }
+
+    if (ptr == end)
+      break;
+    state = table[state + classes[static_cast<unsigned char>(*ptr)]];
+  }
+
+  return false;
+}
+
+bool image_set::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool image_set::matches(const char* begin, const char* end, vector<size_t>& indices) const
+{
+  const uint32_t* table = m_table.transitions;
+  const uint8_t* classes = m_table.classes;
+  const uint32_t stride = m_table.stride;
+  const uint32_t last_match = m_table.last_match;
+  vector<bool> seen(m_size, false);
+  indices.clear();
+
+  auto state = m_table.start;
+  for (auto ptr = begin; ; ptr++)
+  {
+    if (state <= last_match)
+    {
+      if (state == 0)
+        break;
+
+      auto index = state / stride;
+      for (auto idx = m_match_offsets[index]; idx < m_match_offsets[index + 1]; idx++)
+      {
+        auto id = m_match_ids[idx];
+        if (!seen[id])
+        {
+          seen[id] = true;
+          indices.push_back(id);
+        }
+      }
+
+      // once every pattern has matched, there is nothing left to find
+      if (indices.size() == m_size)
+        break;
+    }
+
+    if (ptr == end)
+      break;
+    state = table[state + classes[static_cast<unsigned char>(*ptr)]];
+  }
+
+  sort(indices.begin(), indices.end());
+  return !indices.empty();
+}
+
+bool image_set::matches(const string& input, vector<size_t>& indices) const
+{
+  return matches(input.data(), input.data() + input.size(), indices);
+}
+
+automaton_image::automaton_image(const void* data, size_t size)
+  : m_data(static_cast<const char*>(data)),
+    m_size(size),
+    m_entry_count(0)
+{
+  if (reinterpret_cast<uintptr_t>(data) % ALIGNMENT != 0)
+    fail("misaligned.");
+  if (size < sizeof(header_record))
+    fail("truncated header.");
+
+  const auto& header = *reinterpret_cast<const header_record*>(m_data);
+  if (memcmp(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0)
+    fail("bad magic number.");
+  if (header.byte_order != IMAGE_BYTE_ORDER)
+    fail("written with a different byte order.");
+  if (header.version != VERSION)
+  {
+    ostringstream message;
+    message << "unsupported version " << header.version << ".";
+    fail(message.str());
+  }
+  if (header.size != size)
+    fail("size does not match header.");
+  if (!in_bounds(header.entries, header.entry_count, sizeof(entry_record), size))
+    fail("entries out of bounds.");
+
+  auto records = reinterpret_cast<const entry_record*>(m_data + header.entries);
+  for (uint64_t idx = 0; idx < header.entry_count; idx++)
+  {
+    const auto& record = records[idx];
+    auto kind = static_cast<image_entry_kind>(record.kind);
+    if (kind != image_entry_kind::pattern && kind != image_entry_kind::set)
+      fail("unknown entry kind.");
+    if (record.expression_count == 0 || (kind == image_entry_kind::pattern && record.expression_count != 1))
+      fail("bad expression count.");
+
+    if (!in_bounds(record.expressions, 2 * static_cast<uint64_t>(record.expression_count), sizeof(uint64_t), size))
+      fail("expressions out of bounds.");
+    auto expressions = reinterpret_cast<const uint64_t*>(m_data + record.expressions);
+    for (uint32_t expr = 0; expr < record.expression_count; expr++)
+      if (!in_bounds(expressions[2 * expr], expressions[2 * expr + 1], 1, size))
+        fail("expression out of bounds.");
+
+    check_table(record.forward, size);
+    if (kind == image_entry_kind::pattern)
+    {
+      check_table(record.reverse, size);
+      if (!in_bounds(record.prefix, record.prefix_length, 1, size))
+        fail("prefix out of bounds.");
+    }
+    else
+    {
+      // one offset per state up to the last match state, plus one past the end
+      auto offset_count = static_cast<uint64_t>(record.forward.last_match) / record.forward.stride + 2;
+      if (!in_bounds(record.match_offsets, offset_count, sizeof(uint32_t), size))
+        fail("match offsets out of bounds.");
+      auto offsets = reinterpret_cast<const uint32_t*>(m_data + record.match_offsets);
+      if (!in_bounds(record.match_ids, offsets[offset_count - 1], sizeof(uint32_t), size))
+        fail("match IDs out of bounds.");
+    }
+  }
+
+  m_entry_count = static_cast<size_t>(header.entry_count);
+}
+
+size_t automaton_image::size() const
+{
+  return m_entry_count;
+}
+
+image_entry_kind automaton_image::kind(size_t index) const
+{
+  if (index >= m_entry_count)
+    throw out_of_range("Entry index out of range.");
+
+  const auto& header = *reinterpret_cast<const header_record*>(m_data);
+  auto records = reinterpret_cast<const entry_record*>(m_data + header.entries);
+  return static_cast<image_entry_kind>(records[index].kind);
+}
+
+image_pattern automaton_image::pattern(size_t index) const
+{
+  if (kind(index) != image_entry_kind::pattern)
+    throw image_error("Automaton image entry is not a pattern.");
+
+  const auto& header = *reinterpret_cast<const header_record*>(m_data);
+  const auto& record = reinterpret_cast<const entry_record*>(m_data + header.entries)[index];
+  auto expressions = reinterpret_cast<const uint64_t*>(m_data + record.expressions);
+  return image_pattern(make_table(m_data, record.forward),
+                       make_table(m_data, record.reverse),
+                       m_data + record.prefix,
+                       static_cast<size_t>(record.prefix_length),
+                       m_data + expressions[0],
+                       static_cast<size_t>(expressions[1]));
+}
+
+image_set automaton_image::set(size_t index) const
+{
+  if (kind(index) != image_entry_kind::set)
+    throw image_error("Automaton image entry is not a set.");
+
+  const auto& header = *reinterpret_cast<const header_record*>(m_data);
+  const auto& record = reinterpret_cast<const entry_record*>(m_data + header.entries)[index];
+  return image_set(make_table(m_data, record.forward),
+                   reinterpret_cast<const uint32_t*>(m_data + record.match_offsets),
+                   reinterpret_cast<const uint32_t*>(m_data + record.match_ids),
+                   reinterpret_cast<const uint64_t*>(m_data + record.expressions),
+                   m_data,
+                   record.expression_count);
+}
+
+void automaton_image::verify() const
+{
+  const auto& header = *reinterpret_cast<const header_record*>(m_data);
+  auto records = reinterpret_cast<const entry_record*>(m_data + header.entries);
+  for (size_t idx = 0; idx < m_entry_count; idx++)
+  {
+    const auto& record = records[idx];
+    verify_table(m_data, record.forward);
+    if (static_cast<image_entry_kind>(record.kind) == image_entry_kind::pattern)
+    {
+      verify_table(m_data, record.reverse);
+      continue;
+    }
+
+    auto offset_count = record.forward.last_match / record.forward.stride + 2;
+    auto offsets = reinterpret_cast<const uint32_t*>(m_data + record.match_offsets);
+    auto ids = reinterpret_cast<const uint32_t*>(m_data + record.match_ids);
+    for (uint32_t state = 0; state + 1 < offset_count; state++)
+      if (offsets[state] > offsets[state + 1])
+        fail("match offsets out of order.");
+    for (uint32_t id = 0; id < offsets[offset_count - 1]; id++)
+      if (ids[id] >= record.expression_count)
+        fail("match ID out of range.");
+  }
+}
+
+mapped_image::mapped_image(const string& path)
+  : m_mapping(nullptr),
+    m_mapping_size(0)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw image_error("Failed to open automaton image " + path + ".");
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0)
+  {
+    close(fd);
+    throw image_error("Failed to read automaton image " + path + ".");
+  }
+
+  m_mapping_size = static_cast<size_t>(info.st_size);
+  m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m_mapping == MAP_FAILED)
+    throw image_error("Failed to map automaton image " + path + ".");
+
+  try
+  {
+    m_image = make_unique<automaton_image>(m_mapping, m_mapping_size);
+  }
+  catch (...)
+  {
+    munmap(m_mapping, m_mapping_size);
+    throw;
+  }
+}
+
+mapped_image::~mapped_image()
+{
+  munmap(m_mapping, m_mapping_size);
+}
+
+const automaton_image& mapped_image::image() const
+{
+  return *m_image;
+}
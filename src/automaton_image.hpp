@@ -0,0 +1,405 @@
+/**
+ * @file	automaton_image.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+#include "pattern.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class representing an exception thrown when an automaton image cannot be written or loaded.
+   */
+  class image_error : public std::runtime_error
+  {
+  public:
+
+    /** Constructs a new `regex::image_error` instance with the specified message. */
+    image_error(const std::string& message)
+      : std::runtime_error(message)
+    { }
+
+  };
+
+  /**
+   * Enumeration of the kinds of entry stored in an automaton image.
+   */
+  enum class image_entry_kind : uint32_t
+  {
+    pattern = 1,
+    set = 2,
+  };
+
+  /**
+   * Class which builds a serialized image of compiled patterns and pattern sets.
+   *
+   * Each pattern is stored as the forward and reverse tables of its minimized full DFA, along with
+   * its byte classes and the literal prefix used as a prefilter. Each set is stored as a single
+   * unminimized DFA for all of its expressions, with the list of expressions matched in each match
+   * state. Every reference within the image is an offset from its start, so that the image may be
+   * loaded at any address by a `regex::automaton_image` without being deserialized.
+   *
+   * The image is written in the byte order of the host, and may only be loaded by a host with the
+   * same byte order.
+   */
+  class image_writer
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new, empty `regex::image_writer`. */
+    image_writer();
+
+    /** Destructor. */
+    ~image_writer();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Compiles the specified expression into a new pattern entry. Only `dfa_state_limit`,
+     * `use_prefilter`, `simplify` and `match_newline` are used from `options`.
+     *
+     * @return The index of the new entry.
+     *
+     * @exception regex::lexical_error
+     * Thrown if the expression cannot be tokenized.
+     *
+     * @exception regex::syntax_error
+     * Thrown if the expression cannot be parsed.
+     *
+     * @exception regex::compile_error
+     * Thrown if the expression is too large to compile, or if its DFA would exceed
+     * `options.dfa_state_limit` states.
+     */
+    size_t add_pattern(const std::string& expression, const regex::pattern_options& options = regex::pattern_options());
+
+    /**
+     * Compiles the specified expressions into a new set entry.
+     *
+     * @return The index of the new entry.
+     *
+     * @exception regex::lexical_error
+     * Thrown if an expression cannot be tokenized.
+     *
+     * @exception regex::syntax_error
+     * Thrown if an expression cannot be parsed.
+     *
+     * @exception regex::compile_error
+     * Thrown if `expressions` is empty, if the expressions are too large to compile, or if their
+     * DFA would exceed `state_limit` states.
+     */
+    size_t add_set(const std::vector<std::string>& expressions, size_t state_limit = 10000);
+
+    /** Returns the number of entries added so far. */
+    size_t size() const;
+
+    /** Returns the serialized image. */
+    std::string data() const;
+
+    /**
+     * Writes the serialized image to the file at the specified path.
+     *
+     * @exception regex::image_error
+     * Thrown if the file cannot be written.
+     */
+    void write(const std::string& path) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+  /**
+   * Struct describing a DFA table stored in an automaton image. The layout is the same as that of a
+   * `regex::dfa_table`, with the classes and transitions referring directly into the image.
+   */
+  struct image_table
+  {
+    uint32_t stride;
+    uint32_t start;
+    uint32_t last_match;
+    const uint8_t* classes;
+    const uint32_t* transitions;
+  };
+
+  /**
+   * Class representing a pattern stored in an automaton image.
+   *
+   * This is a lightweight view into the image, which must outlive it. Searching performs no heap
+   * allocation, and a single instance may be used by multiple threads. Capture groups are not
+   * available from an image.
+   */
+  class image_pattern
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a view of a pattern from its tables and prefix within an image. */
+    image_pattern(const regex::image_table& forward,
+                  const regex::image_table& reverse,
+                  const char* prefix,
+                  size_t prefix_length,
+                  const char* expression,
+                  size_t expression_length);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the expression this pattern was compiled from. */
+    std::string expression() const;
+
+    /** Returns `true` if this pattern matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if this pattern matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    regex::image_table m_forward;
+    regex::image_table m_reverse;
+    const char* m_prefix;
+    size_t m_prefix_length;
+    const char* m_expression;
+    size_t m_expression_length;
+
+    /** Scans forwards for the end of the leftmost-first match, as `regex::full_dfa` does. */
+    bool scan_forward(const char* begin, const char* end, bool stop_early, size_t& match_end) const;
+
+    /** Scans backwards from `match_end` for the start of the longest match ending there. */
+    size_t scan_reverse(const char* begin, size_t match_end) const;
+
+  };
+
+  /**
+   * Class representing a pattern set stored in an automaton image.
+   *
+   * This is a lightweight view into the image, which must outlive it. A single instance may be used
+   * by multiple threads.
+   */
+  class image_set
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a view of a set from its table and expressions within an image. */
+    image_set(const regex::image_table& table,
+              const uint32_t* match_offsets,
+              const uint32_t* match_ids,
+              const uint64_t* expressions,
+              const char* base,
+              size_t size);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of expressions in this set. */
+    size_t size() const;
+
+    /** Returns the expression with the specified index. */
+    std::string expression(size_t index) const;
+
+    /** Returns `true` if any expression in this set matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if any expression in this set matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds every expression in this set which matches anywhere in the input range.
+     *
+     * @return `true` if any expression matched, in which case the indices of all matching
+     * expressions are stored in `indices` in ascending order.
+     */
+    bool matches(const char* begin, const char* end, std::vector<size_t>& indices) const;
+
+    /**
+     * Finds every expression in this set which matches anywhere in the input string.
+     *
+     * @return `true` if any expression matched, in which case the indices of all matching
+     * expressions are stored in `indices` in ascending order.
+     */
+    bool matches(const std::string& input, std::vector<size_t>& indices) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    regex::image_table m_table;
+    const uint32_t* m_match_offsets;
+    const uint32_t* m_match_ids;
+    const uint64_t* m_expressions;
+    const char* m_base;
+    size_t m_size;
+
+  };
+
+  /**
+   * Class which provides access to the entries of a serialized automaton image in place.
+   *
+   * The image is not copied, so it must outlive this object and every view obtained from it. Its
+   * layout is checked when it is loaded, so that every offset refers to memory within the image,
+   * but the contents of the transition tables are trusted unless `verify()` is called.
+   */
+  class automaton_image
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The version of the image format written and understood by this library. */
+    static const uint32_t VERSION = 1;
+
+    /** The alignment required of the image in memory. */
+    static const size_t ALIGNMENT = 8;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Loads the image stored in the specified memory.
+     *
+     * @exception regex::image_error
+     * Thrown if the memory is misaligned, or does not contain a well-formed image of this version
+     * written by a host with the same byte order.
+     */
+    automaton_image(const void* data, size_t size);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of entries in this image. */
+    size_t size() const;
+
+    /** Returns the kind of the entry with the specified index. */
+    regex::image_entry_kind kind(size_t index) const;
+
+    /**
+     * Returns the pattern stored in the entry with the specified index.
+     *
+     * @exception regex::image_error
+     * Thrown if the entry is not a pattern.
+     */
+    regex::image_pattern pattern(size_t index) const;
+
+    /**
+     * Returns the set stored in the entry with the specified index.
+     *
+     * @exception regex::image_error
+     * Thrown if the entry is not a set.
+     */
+    regex::image_set set(size_t index) const;
+
+    /**
+     * Checks every byte class and transition of every table in this image, which is only needed
+     * for images from untrusted sources.
+     *
+     * @exception regex::image_error
+     * Thrown if any table refers to a state or class which does not exist.
+     */
+    void verify() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    const char* m_data;
+    size_t m_size;
+    size_t m_entry_count;
+
+  };
+
+  /**
+   * Class which maps an automaton image file into memory.
+   *
+   * The file is mapped read-only and shared, so that every process loading the same image shares
+   * its pages. The file must not be modified while it is mapped.
+   */
+  class mapped_image
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Maps the image file at the specified path.
+     *
+     * @exception regex::image_error
+     * Thrown if the file cannot be mapped, or does not contain a well-formed image.
+     */
+    explicit mapped_image(const std::string& path);
+
+    /** Destructor. */
+    ~mapped_image();
+
+    mapped_image(const mapped_image&) = delete;
+    mapped_image& operator=(const mapped_image&) = delete;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the mapped image. */
+    const regex::automaton_image& image() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    void* m_mapping;
+    size_t m_mapping_size;
+    std::unique_ptr<regex::automaton_image> m_image;
+
+  };
+
+}
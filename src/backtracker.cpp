@@ -0,0 +1,215 @@
+/**
+ * @file	backtracker.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backtracker.hpp"
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct backtracker::implementation
+{
+
+  /* -- Types -- */
+
+  /** A pending unit of work: either a thread to explore, or a capture slot to restore. */
+  struct frame
+  {
+    bool restore;
+    uint32_t pc;
+    size_t value;
+  };
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> prog, size_t visited_limit, shared_ptr<const prefilter> pre)
+    : prog(move(prog)),
+      pre(move(pre)),
+      visited_limit(visited_limit),
+      slots(this->prog->slot_count, match::NO_POSITION)
+  { }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const program> prog;
+  const shared_ptr<const prefilter> pre;
+  const size_t visited_limit;
+  vector<uint64_t> visited;
+  vector<frame> stack;
+  vector<size_t> slots;
+
+  /* -- Methods -- */
+
+  /**
+   * Searches the input depth first. Returns `true` if a match was found, in which case its bounds
+   * are stored in `result`.
+   *
+   * Without a prefilter, the search begins at the unanchored start. With one, an anchored search is
+   * begun at each candidate position it reports. A pair which failed from one start fails from any
+   * other, so the visited bitmap is shared between them.
+   */
+  bool search(const char* begin, const char* end, match& result)
+  {
+    assert(can_search(prog->instructions.size(), static_cast<size_t>(end - begin), visited_limit));
+
+    // one row of positions per instruction, cleared only as far as this input needs
+    const size_t length = static_cast<size_t>(end - begin);
+    const size_t stride = length + 1;
+    visited.assign((prog->instructions.size() * stride + 63) / 64, 0);
+
+    if (pre == nullptr)
+      return search_from(begin, prog->unanchored_start, 0, length, stride, result);
+
+    for (auto candidate = pre->find(begin, end); candidate != end; candidate = pre->find(candidate + 1, end))
+      if (search_from(begin, prog->anchored_start, static_cast<size_t>(candidate - begin), length, stride, result))
+        return true;
+    return false;
+  }
+
+  /** Explores every thread reachable from instruction `start` at position `first`. */
+  bool search_from(const char* begin, uint32_t start, size_t first, size_t length, size_t stride, match& result)
+  {
+    fill(slots.begin(), slots.end(), match::NO_POSITION);
+
+    stack.clear();
+    stack.push_back(frame { false, start, first });
+    while (!stack.empty())
+    {
+      auto job = stack.back();
+      stack.pop_back();
+
+      if (job.restore)
+      {
+        slots[job.pc] = job.value;
+        continue;
+      }
+
+      auto pc = job.pc;
+      auto pos = job.value;
+      for (;;)
+      {
+        auto bit = pc * stride + pos;
+        if (visited[bit / 64] & (uint64_t(1) << (bit % 64)))
+          break;
+        visited[bit / 64] |= (uint64_t(1) << (bit % 64));
+
+        const auto& inst = prog->instructions[pc];
+        if (inst.op == opcode::byte || inst.op == opcode::byte_set || inst.op == opcode::any)
+        {
+          if (pos == length)
+            break;
+
+          auto ch = static_cast<unsigned char>(begin[pos]);
+          if ((inst.op == opcode::byte && ch != inst.argument) ||
+              (inst.op == opcode::byte_set && !prog->byte_sets[inst.argument].test(ch)))
+            break;
+
+          pc = inst.next;
+          pos++;
+          continue;
+        }
+
+        switch (inst.op)
+        {
+        case opcode::split:
+          // the alternate is only explored once everything reachable from `next` has failed
+          stack.push_back(frame { false, inst.alternate, pos });
+          pc = inst.next;
+          continue;
+
+        case opcode::jump:
+          pc = inst.next;
+          continue;
+
+        case opcode::save:
+          stack.push_back(frame { true, inst.argument, slots[inst.argument] });
+          slots[inst.argument] = pos;
+          pc = inst.next;
+          continue;
+
+        case opcode::match:
+          result.begin = slots[0];
+          result.end = pos;
+          return true;
+
+        default:
+          assert(false);
+          break;
+        }
+        break;
+      }
+    }
+
+    return false;
+  }
+
+};
+
+/* -- Procedures -- */
+
+backtracker::backtracker(shared_ptr<const program> prog, size_t visited_limit, shared_ptr<const prefilter> pre)
+  : impl(make_unique<implementation>(move(prog), visited_limit, move(pre)))
+{
+}
+
+backtracker::~backtracker() = default;
+
+bool backtracker::can_search(size_t length) const
+{
+  return can_search(impl->prog->instructions.size(), length, impl->visited_limit);
+}
+
+bool backtracker::is_match(const char* begin, const char* end)
+{
+  match result;
+  return impl->search(begin, end, result);
+}
+
+bool backtracker::is_match(const string& input)
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool backtracker::find(const char* begin, const char* end, match& result)
+{
+  return impl->search(begin, end, result);
+}
+
+bool backtracker::find(const string& input, match& result)
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+bool backtracker::captures(const char* begin, const char* end, vector<match>& groups)
+{
+  match result;
+  if (!impl->search(begin, end, result))
+    return false;
+
+  slots_to_groups(impl->slots.data(), impl->slots.size(), groups);
+  return true;
+}
+
+bool backtracker::captures(const string& input, vector<match>& groups)
+{
+  return captures(input.data(), input.data() + input.size(), groups);
+}
@@ -0,0 +1,129 @@
+/**
+ * @file	backtracker.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which executes a compiled program by backtracking, for short inputs.
+   *
+   * Alternatives are explored depth first in priority order, so the first match found is the
+   * leftmost-first match, and no thread lists need to be maintained. Each (instruction, position)
+   * pair is recorded in a bitmap when it is first explored, and is never explored again, so a search
+   * costs at most O(n * m) time for input length n and program size m, however ambiguous the
+   * expression. The bitmap has one bit per pair, so inputs are limited to those for which it fits in
+   * a fixed budget; `can_search()` should be checked before each search.
+   *
+   * Working storage is reused between searches, so a single instance must not be used by multiple
+   * threads at once.
+   */
+  class backtracker
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::backtracker` for the specified program.
+     *
+     * @param prog The program to execute.
+     * @param visited_limit The maximum number of bits in the visited bitmap.
+     * @param pre An optional prefilter, used to find the positions at which a match may start.
+     */
+    backtracker(std::shared_ptr<const regex::program> prog,
+                size_t visited_limit,
+                std::shared_ptr<const regex::prefilter> pre = nullptr);
+
+    /** Destructor. */
+    ~backtracker();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns `true` if a program with `instruction_count` instructions may search an input of
+     * `length` bytes within a budget of `visited_limit` bits.
+     */
+    static bool can_search(size_t instruction_count, size_t length, size_t visited_limit)
+    {
+      return (instruction_count != 0 && length < visited_limit / instruction_count);
+    }
+
+    /** Returns `true` if this backtracker may search an input of `length` bytes. */
+    bool can_search(size_t length) const;
+
+    /**
+     * Returns `true` if the program matches anywhere in the input range.
+     *
+     * @warning The input must satisfy `can_search()`.
+     */
+    bool is_match(const char* begin, const char* end);
+
+    /** Returns `true` if the program matches anywhere in the input string. */
+    bool is_match(const std::string& input);
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     *
+     * @warning The input must satisfy `can_search()`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result);
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result);
+
+    /**
+     * Finds the leftmost-first match in the input range, along with the bounds of each capture group
+     * within it.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to hold one entry per
+     * group, with the overall match first.
+     *
+     * @warning The input must satisfy `can_search()`.
+     */
+    bool captures(const char* begin, const char* end, std::vector<regex::match>& groups);
+
+    /**
+     * Finds the leftmost-first match in the input string, along with the bounds of each capture group
+     * within it.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to hold one entry per
+     * group, with the overall match first.
+     */
+    bool captures(const std::string& input, std::vector<regex::match>& groups);
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,279 @@
+/**
+ * @file	byte_search.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <cstring>
+
+#include "byte_search.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define REGEX_BYTE_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /* -- Scalar Implementations -- */
+
+  const char* find_byte2_scalar(const char* begin, const char* end, unsigned char byte1, unsigned char byte2)
+  {
+    for (auto ptr = begin; ptr != end; ptr++)
+    {
+      auto ch = static_cast<unsigned char>(*ptr);
+      if (ch == byte1 || ch == byte2)
+        return ptr;
+    }
+    return end;
+  }
+
+  const char* find_byte3_scalar(const char* begin,
+                                const char* end,
+                                unsigned char byte1,
+                                unsigned char byte2,
+                                unsigned char byte3)
+  {
+    for (auto ptr = begin; ptr != end; ptr++)
+    {
+      auto ch = static_cast<unsigned char>(*ptr);
+      if (ch == byte1 || ch == byte2 || ch == byte3)
+        return ptr;
+    }
+    return end;
+  }
+
+  const char* find_substring_scalar(const char* begin, const char* end, const char* needle, size_t length)
+  {
+    if (static_cast<size_t>(end - begin) < length)
+      return end;
+
+    auto last = end - length + 1;
+    for (auto ptr = begin; ptr != last; ptr++)
+    {
+      ptr = static_cast<const char*>(memchr(ptr, needle[0], static_cast<size_t>(last - ptr)));
+      if (ptr == nullptr)
+        return end;
+      if (memcmp(ptr + 1, needle + 1, length - 1) == 0)
+        return ptr;
+    }
+    return end;
+  }
+
+#if REGEX_BYTE_SEARCH_X86
+
+  /* -- SSE2 Implementations -- */
+
+  __attribute__((target("sse2")))
+  const char* find_byte2_sse2(const char* begin, const char* end, unsigned char byte1, unsigned char byte2)
+  {
+    const __m128i v1 = _mm_set1_epi8(static_cast<char>(byte1));
+    const __m128i v2 = _mm_set1_epi8(static_cast<char>(byte2));
+
+    auto ptr = begin;
+    for (; end - ptr >= 16; ptr += 16)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+      __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+      if (mask != 0)
+        return ptr + __builtin_ctz(mask);
+    }
+    return find_byte2_scalar(ptr, end, byte1, byte2);
+  }
+
+  __attribute__((target("sse2")))
+  const char* find_byte3_sse2(const char* begin,
+                              const char* end,
+                              unsigned char byte1,
+                              unsigned char byte2,
+                              unsigned char byte3)
+  {
+    const __m128i v1 = _mm_set1_epi8(static_cast<char>(byte1));
+    const __m128i v2 = _mm_set1_epi8(static_cast<char>(byte2));
+    const __m128i v3 = _mm_set1_epi8(static_cast<char>(byte3));
+
+    auto ptr = begin;
+    for (; end - ptr >= 16; ptr += 16)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+      __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, v1), _mm_cmpeq_epi8(chunk, v2)),
+                                _mm_cmpeq_epi8(chunk, v3));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+      if (mask != 0)
+        return ptr + __builtin_ctz(mask);
+    }
+    return find_byte3_scalar(ptr, end, byte1, byte2, byte3);
+  }
+
+  __attribute__((target("sse2")))
+  const char* find_substring_sse2(const char* begin, const char* end, const char* needle, size_t length)
+  {
+    // compare the first and last bytes of the needle at 16 offsets at once, and only verify the
+    // candidates where both agree
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[length - 1]);
+
+    auto ptr = begin;
+    for (; static_cast<size_t>(end - ptr) >= length - 1 + 16; ptr += 16)
+    {
+      __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+      __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + length - 1));
+      __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+      while (mask != 0)
+      {
+        auto offset = __builtin_ctz(mask);
+        if (memcmp(ptr + offset + 1, needle + 1, length - 2) == 0)
+          return ptr + offset;
+        mask &= mask - 1;
+      }
+    }
+    return find_substring_scalar(ptr, end, needle, length);
+  }
+
+  /* -- AVX2 Implementations -- */
+
+  __attribute__((target("avx2")))
+  const char* find_byte2_avx2(const char* begin, const char* end, unsigned char byte1, unsigned char byte2)
+  {
+    const __m256i v1 = _mm256_set1_epi8(static_cast<char>(byte1));
+    const __m256i v2 = _mm256_set1_epi8(static_cast<char>(byte2));
+
+    auto ptr = begin;
+    for (; end - ptr >= 32; ptr += 32)
+    {
+      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+      __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, v1), _mm256_cmpeq_epi8(chunk, v2));
+      auto mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+      if (mask != 0)
+        return ptr + __builtin_ctz(mask);
+    }
+    return find_byte2_sse2(ptr, end, byte1, byte2);
+  }
+
+  __attribute__((target("avx2")))
+  const char* find_byte3_avx2(const char* begin,
+                              const char* end,
+                              unsigned char byte1,
+                              unsigned char byte2,
+                              unsigned char byte3)
+  {
+    const __m256i v1 = _mm256_set1_epi8(static_cast<char>(byte1));
+    const __m256i v2 = _mm256_set1_epi8(static_cast<char>(byte2));
+    const __m256i v3 = _mm256_set1_epi8(static_cast<char>(byte3));
+
+    auto ptr = begin;
+    for (; end - ptr >= 32; ptr += 32)
+    {
+      __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+      __m256i eq = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, v1), _mm256_cmpeq_epi8(chunk, v2)),
+                                   _mm256_cmpeq_epi8(chunk, v3));
+      auto mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+      if (mask != 0)
+        return ptr + __builtin_ctz(mask);
+    }
+    return find_byte3_sse2(ptr, end, byte1, byte2, byte3);
+  }
+
+  __attribute__((target("avx2")))
+  const char* find_substring_avx2(const char* begin, const char* end, const char* needle, size_t length)
+  {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[length - 1]);
+
+    auto ptr = begin;
+    for (; static_cast<size_t>(end - ptr) >= length - 1 + 32; ptr += 32)
+    {
+      __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+      __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr + length - 1));
+      __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last));
+      auto mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+      while (mask != 0)
+      {
+        auto offset = __builtin_ctz(mask);
+        if (memcmp(ptr + offset + 1, needle + 1, length - 2) == 0)
+          return ptr + offset;
+        mask &= mask - 1;
+      }
+    }
+    return find_substring_sse2(ptr, end, needle, length);
+  }
+
+#endif
+
+  /* -- Dispatch -- */
+
+  /** Struct containing the implementations selected for the current CPU. */
+  struct implementations
+  {
+    const char* isa;
+    const char* (*find_byte2)(const char*, const char*, unsigned char, unsigned char);
+    const char* (*find_byte3)(const char*, const char*, unsigned char, unsigned char, unsigned char);
+    const char* (*find_substring)(const char*, const char*, const char*, size_t);
+  };
+
+  /** Returns the best implementations supported by the current CPU. */
+  const implementations& selected()
+  {
+    static const implementations IMPLEMENTATIONS = [] {
+#if REGEX_BYTE_SEARCH_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx2"))
+        return implementations { "avx2", find_byte2_avx2, find_byte3_avx2, find_substring_avx2 };
+      if (__builtin_cpu_supports("sse2"))
+        return implementations { "sse2", find_byte2_sse2, find_byte3_sse2, find_substring_sse2 };
+#endif
+      return implementations { "scalar", find_byte2_scalar, find_byte3_scalar, find_substring_scalar };
+    }();
+    return IMPLEMENTATIONS;
+  }
+
+}
+
+/* -- Procedures -- */
+
+const char* regex::find_byte(const char* begin, const char* end, unsigned char byte)
+{
+  // the C library's implementation is already vectorized
+  auto ptr = memchr(begin, byte, static_cast<size_t>(end - begin));
+  return (ptr == nullptr ? end : static_cast<const char*>(ptr));
+}
+
+const char* regex::find_byte2(const char* begin, const char* end, unsigned char byte1, unsigned char byte2)
+{
+  return selected().find_byte2(begin, end, byte1, byte2);
+}
+
+const char* regex::find_byte3(const char* begin,
+                              const char* end,
+                              unsigned char byte1,
+                              unsigned char byte2,
+                              unsigned char byte3)
+{
+  return selected().find_byte3(begin, end, byte1, byte2, byte3);
+}
+
+const char* regex::find_substring(const char* begin, const char* end, const char* needle, size_t length)
+{
+  if (length == 0)
+    return begin;
+  if (length == 1)
+    return find_byte(begin, end, static_cast<unsigned char>(needle[0]));
+  return selected().find_substring(begin, end, needle, length);
+}
+
+const char* regex::byte_search_isa()
+{
+  return selected().isa;
+}
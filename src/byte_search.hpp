@@ -0,0 +1,50 @@
+/**
+ * @file	byte_search.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Returns a pointer to the first occurrence of `byte` in `[begin, end)`, or `end` if there is none.
+   */
+  const char* find_byte(const char* begin, const char* end, unsigned char byte);
+
+  /**
+   * Returns a pointer to the first occurrence of either `byte1` or `byte2` in `[begin, end)`, or
+   * `end` if there is none.
+   */
+  const char* find_byte2(const char* begin, const char* end, unsigned char byte1, unsigned char byte2);
+
+  /**
+   * Returns a pointer to the first occurrence of any of `byte1`, `byte2`, or `byte3` in
+   * `[begin, end)`, or `end` if there is none.
+   */
+  const char* find_byte3(const char* begin,
+                         const char* end,
+                         unsigned char byte1,
+                         unsigned char byte2,
+                         unsigned char byte3);
+
+  /**
+   * Returns a pointer to the first occurrence of the `length`-byte string `needle` in `[begin, end)`,
+   * or `end` if there is none.
+   */
+  const char* find_substring(const char* begin, const char* end, const char* needle, size_t length);
+
+  /**
+   * Returns the name of the instruction set used by the byte search routines on this CPU.
+   */
+  const char* byte_search_isa();
+
+}
@@ -0,0 +1,448 @@
+/**
+ * @file	compiler.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compiler.hpp"
+#include "program.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /** Marker for an instruction field which has not yet been patched. */
+  const uint32_t UNPATCHED = 0xFFFFFFFF;
+
+  /**
+   * Struct representing a partially compiled subexpression.
+   *
+   * Each hole is an instruction field which must be patched to point at whatever follows the
+   * subexpression. Holes are encoded as `(pc << 1) | is_alternate`.
+   */
+  struct fragment
+  {
+    uint32_t start;
+    vector<uint32_t> holes;
+  };
+
+  /**
+   * Class implementing Thompson's construction over a syntax tree.
+   */
+  class program_builder
+  {
+  public:
+
+    program_builder(const compile_options& options)
+      : m_options(options),
+        m_prog(make_shared<program>()),
+        m_tree(nullptr),
+        m_slot_count(2),
+        m_repetitions(1)
+    { }
+
+    /**
+     * Compiles the specified trees into a complete program. Each tree is an alternative, in order of
+     * priority, ending in a match instruction numbered by its index.
+     */
+    shared_ptr<const program> build(const vector<const syntax_tree*>& roots)
+    {
+      // unanchored prefix: a non-greedy loop over any byte, then fall into the anchored start
+      auto prefix = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+      auto prefix_any = emit(opcode::any, 0, prefix, UNPATCHED);
+      m_prog->instructions[prefix].alternate = prefix_any;
+
+      // anchored body, bracketed by saves for the overall match bounds
+      auto save_begin = emit(opcode::save, 0, UNPATCHED, UNPATCHED);
+      m_prog->instructions[prefix].next = save_begin;
+
+      // each pattern but the last is reached through a split preferring it over those after it
+      fragment link { save_begin, { hole(save_begin, false) } };
+      for (size_t idx = 0; idx < roots.size(); idx++)
+      {
+        auto entry = UNPATCHED;
+        if (idx + 1 < roots.size())
+          entry = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+
+        m_tree = roots[idx];
+        auto body = compile_node(m_tree->root());
+        auto save_end = emit(opcode::save, 1, UNPATCHED, UNPATCHED);
+        auto match = emit(opcode::match, static_cast<uint32_t>(idx), UNPATCHED, UNPATCHED);
+        patch(body, save_end);
+        m_prog->instructions[save_end].next = match;
+
+        if (entry == UNPATCHED)
+          patch(link, body.start);
+        else
+        {
+          m_prog->instructions[entry].next = body.start;
+          patch(link, entry);
+          link = fragment { entry, { hole(entry, true) } };
+        }
+      }
+
+      m_prog->anchored_start = save_begin;
+      m_prog->unanchored_start = prefix;
+      m_prog->slot_count = m_slot_count;
+      m_prog->pattern_count = roots.size();
+      m_prog->reverse = m_options.reverse;
+      m_prog->byte_classes = make_byte_classes(*m_prog);
+      return m_prog;
+    }
+
+  private:
+
+    const compile_options& m_options;
+    shared_ptr<program> m_prog;
+    const syntax_tree* m_tree;
+    size_t m_slot_count;
+    size_t m_repetitions;
+    unordered_map<bitset<256>, uint32_t> m_byte_sets;
+
+    /** Compiles a node to a fragment. */
+    fragment compile_node(syntax_index index)
+    {
+      auto children = m_tree->children(index);
+      switch (m_tree->type(index))
+      {
+      case syntax_node_type::literal:
+      {
+        auto pc = emit(opcode::byte, static_cast<unsigned char>(m_tree->character(index)), UNPATCHED, UNPATCHED);
+        return fragment { pc, { hole(pc, false) } };
+      }
+
+      case syntax_node_type::wildcard:
+      {
+        auto pc = emit(opcode::any, 0, UNPATCHED, UNPATCHED);
+        return fragment { pc, { hole(pc, false) } };
+      }
+
+      case syntax_node_type::character_class:
+      {
+        auto pc = emit_byte_set(m_tree->bitmap(index));
+        return fragment { pc, { hole(pc, false) } };
+      }
+
+      case syntax_node_type::string:
+      {
+        // a reversed program matches the characters in the opposite order
+        const auto& text = m_tree->text(index);
+        fragment result { UNPATCHED, { } };
+        for (size_t idx = 0; idx < text.size(); idx++)
+        {
+          auto ch = text[m_options.reverse ? text.size() - 1 - idx : idx];
+          auto pc = emit(opcode::byte, static_cast<unsigned char>(ch), UNPATCHED, UNPATCHED);
+          if (result.start == UNPATCHED)
+            result.start = pc;
+          else
+            patch(result, pc);
+          result.holes.assign(1, hole(pc, false));
+        }
+        return result;
+      }
+
+      case syntax_node_type::concatenation:
+      {
+        // a reversed program matches the children in the opposite order
+        auto count = children.size();
+        auto result = compile_node(children[m_options.reverse ? count - 1 : 0]);
+        for (size_t idx = 1; idx < count; idx++)
+        {
+          auto next = compile_node(children[m_options.reverse ? count - 1 - idx : idx]);
+          patch(result, next.start);
+          result.holes = move(next.holes);
+        }
+        return result;
+      }
+
+      case syntax_node_type::alternation:
+      {
+        // each alternative but the last is reached through a split preferring it over those after it
+        fragment result { UNPATCHED, { } };
+        auto previous = UNPATCHED;
+        for (size_t idx = 0; idx < children.size(); idx++)
+        {
+          auto pc = UNPATCHED;
+          if (idx + 1 < children.size())
+            pc = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+
+          auto body = compile_node(children[idx]);
+          auto entry = (pc == UNPATCHED ? body.start : pc);
+          if (pc != UNPATCHED)
+            m_prog->instructions[pc].next = body.start;
+          if (previous == UNPATCHED)
+            result.start = entry;
+          else
+            m_prog->instructions[previous].alternate = entry;
+          previous = pc;
+
+          result.holes.insert(result.holes.end(), body.holes.cbegin(), body.holes.cend());
+        }
+        return result;
+      }
+
+      case syntax_node_type::optional:
+        return compile_optional(children[0]);
+
+      case syntax_node_type::kleene:
+        return compile_kleene(children[0]);
+
+      case syntax_node_type::repeat:
+        return compile_repeat(children[0]);
+
+      case syntax_node_type::quantifier:
+        return compile_quantifier(children[0], m_tree->min_count(index), m_tree->max_count(index));
+
+      case syntax_node_type::capture:
+      {
+        // a reversed program is only used to find the start of the overall match, so it needs no slots
+        if (m_options.reverse)
+          return compile_node(children[0]);
+
+        auto group = m_tree->group(index);
+        m_slot_count = max(m_slot_count, 2 * (static_cast<size_t>(group) + 1));
+        auto save_begin = emit(opcode::save, 2 * group, UNPATCHED, UNPATCHED);
+        auto body = compile_node(children[0]);
+        auto save_end = emit(opcode::save, 2 * group + 1, UNPATCHED, UNPATCHED);
+        m_prog->instructions[save_begin].next = body.start;
+        patch(body, save_end);
+        return fragment { save_begin, { hole(save_end, false) } };
+      }
+      }
+
+      assert(false);
+      throw compile_error("Unrecognized syntax node type.");
+    }
+
+    /** Compiles an optional closure over the specified node. */
+    fragment compile_optional(syntax_index index)
+    {
+      auto pc = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+      auto body = compile_node(index);
+      m_prog->instructions[pc].next = body.start;
+      body.holes.push_back(hole(pc, true));
+      return fragment { pc, move(body.holes) };
+    }
+
+    /** Compiles a Kleene closure over the specified node. */
+    fragment compile_kleene(syntax_index index)
+    {
+      auto pc = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+      auto body = compile_node(index);
+      m_prog->instructions[pc].next = body.start;
+      patch(body, pc);
+      return fragment { pc, { hole(pc, true) } };
+    }
+
+    /** Compiles a repeat closure over the specified node. */
+    fragment compile_repeat(syntax_index index)
+    {
+      auto body = compile_node(index);
+      auto pc = emit(opcode::split, 0, body.start, UNPATCHED);
+      patch(body, pc);
+      return fragment { body.start, { hole(pc, true) } };
+    }
+
+    /**
+     * Compiles between `min_count` and `max_count` repetitions of the specified node.
+     *
+     * The repetitions are unrolled: `x{2,4}` is compiled as `xx(x(x)?)?`, and `x{2,}` as `xx+`. The
+     * optional repetitions are nested rather than written as `x?x?`, so that the program grows
+     * linearly with the count and each optional repetition is only attempted once the previous one
+     * has matched. Since nested repetitions multiply, the number of copies of any node is bounded by
+     * `compile_options::max_repetitions`, which is checked before any of them are emitted.
+     */
+    fragment compile_quantifier(syntax_index index, uint32_t min_count, uint32_t max_count)
+    {
+      auto unbounded = (max_count == syntax_quantifier_node::UNBOUNDED);
+      size_t copies = max<size_t>(unbounded ? min_count : max_count, 1);
+      if (m_repetitions * copies > m_options.max_repetitions)
+      {
+        ostringstream message;
+        message << "Nested repetitions exceed limit of " << m_options.max_repetitions << " copies.";
+        throw compile_error(message.str());
+      }
+
+      auto outer_repetitions = m_repetitions;
+      m_repetitions *= copies;
+      auto result = unroll_quantifier(index, min_count, max_count);
+      m_repetitions = outer_repetitions;
+      return result;
+    }
+
+    /** Emits the unrolled repetitions for `compile_quantifier`. */
+    fragment unroll_quantifier(syntax_index index, uint32_t min_count, uint32_t max_count)
+    {
+      fragment result { UNPATCHED, { } };
+      auto append = [this, &result] (fragment next) {
+        if (result.start == UNPATCHED)
+          result = move(next);
+        else
+        {
+          patch(result, next.start);
+          result.holes = move(next.holes);
+        }
+      };
+
+      auto unbounded = (max_count == syntax_quantifier_node::UNBOUNDED);
+      for (uint32_t count = 0; count < min_count; count++)
+        append(unbounded && count + 1 == min_count ? compile_repeat(index) : compile_node(index));
+
+      if (unbounded)
+      {
+        if (min_count == 0)
+          append(compile_kleene(index));
+      }
+      else if (max_count > min_count)
+      {
+        // each optional repetition's split may skip all of the remaining repetitions
+        vector<uint32_t> skips;
+        fragment optional { UNPATCHED, { } };
+        for (uint32_t count = min_count; count < max_count; count++)
+        {
+          auto pc = emit(opcode::split, 0, UNPATCHED, UNPATCHED);
+          auto body = compile_node(index);
+          m_prog->instructions[pc].next = body.start;
+          skips.push_back(pc);
+          if (optional.start == UNPATCHED)
+            optional.start = pc;
+          else
+            patch(optional, pc);
+          optional.holes = move(body.holes);
+        }
+        for (auto pc : skips)
+          optional.holes.push_back(hole(pc, true));
+        append(move(optional));
+      }
+
+      // zero repetitions match the empty string
+      if (result.start == UNPATCHED)
+      {
+        auto pc = emit(opcode::jump, 0, UNPATCHED, UNPATCHED);
+        result = fragment { pc, { hole(pc, false) } };
+      }
+
+      return result;
+    }
+
+    /**
+     * Appends an instruction consuming any byte in the specified set, and returns its address.
+     * Identical sets share a single entry in the program's set list.
+     */
+    uint32_t emit_byte_set(const bitset<256>& bytes)
+    {
+      if (bytes.all())
+        return emit(opcode::any, 0, UNPATCHED, UNPATCHED);
+
+      if (bytes.count() == 1)
+      {
+        uint32_t byte = 0;
+        while (!bytes.test(byte))
+          byte++;
+        return emit(opcode::byte, byte, UNPATCHED, UNPATCHED);
+      }
+
+      auto result = m_byte_sets.emplace(bytes, static_cast<uint32_t>(m_prog->byte_sets.size()));
+      if (result.second)
+        m_prog->byte_sets.push_back(bytes);
+      return emit(opcode::byte_set, result.first->second, UNPATCHED, UNPATCHED);
+    }
+
+    /** Appends an instruction to the program and returns its address. */
+    uint32_t emit(opcode op, uint32_t argument, uint32_t next, uint32_t alternate)
+    {
+      if (m_prog->instructions.size() >= m_options.max_instructions)
+      {
+        ostringstream message;
+        message << "Compiled program exceeds limit of " << m_options.max_instructions << " instructions.";
+        throw compile_error(message.str());
+      }
+
+      m_prog->instructions.push_back(instruction { op, argument, next, alternate });
+      return static_cast<uint32_t>(m_prog->instructions.size() - 1);
+    }
+
+    /** Patches all holes in a fragment to point at the specified address. */
+    void patch(const fragment& frag, uint32_t target)
+    {
+      for (auto h : frag.holes)
+      {
+        auto& inst = m_prog->instructions[h >> 1];
+        if (h & 1)
+          inst.alternate = target;
+        else
+          inst.next = target;
+      }
+    }
+
+    /** Encodes a hole. */
+    static uint32_t hole(uint32_t pc, bool alternate)
+    {
+      return (pc << 1) | (alternate ? 1 : 0);
+    }
+
+  };
+
+}
+
+/* -- Procedures -- */
+
+shared_ptr<const program> regex::compile(const unique_ptr<const syntax_node>& root, const compile_options& options)
+{
+  assert(root != nullptr);
+  return compile(make_syntax_tree(root), options);
+}
+
+shared_ptr<const program> regex::compile(const syntax_tree& tree, const compile_options& options)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  program_builder builder(options);
+  return builder.build({ &tree });
+}
+
+shared_ptr<const program> regex::compile_set(const vector<unique_ptr<const syntax_node>>& roots,
+                                             const compile_options& options)
+{
+  vector<syntax_tree> trees;
+  for (const auto& root : roots)
+  {
+    assert(root != nullptr);
+    trees.push_back(make_syntax_tree(root));
+  }
+  return compile_set(trees, options);
+}
+
+shared_ptr<const program> regex::compile_set(const vector<syntax_tree>& trees, const compile_options& options)
+{
+  if (trees.empty())
+    throw compile_error("Cannot compile an empty set of patterns.");
+
+  vector<const syntax_tree*> roots;
+  for (const auto& tree : trees)
+  {
+    assert(tree.root() != syntax_tree::NO_NODE);
+    roots.push_back(&tree);
+  }
+
+  program_builder builder(options);
+  return builder.build(roots);
+}
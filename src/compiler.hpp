@@ -0,0 +1,102 @@
+/**
+ * @file	compiler.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "program.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class representing an exception thrown when a syntax tree cannot be compiled.
+   */
+  class compile_error : public std::runtime_error
+  {
+  public:
+
+    /** Constructs a new `regex::compile_error` instance with the specified message. */
+    compile_error(const std::string& message)
+      : std::runtime_error(message)
+    { }
+
+  };
+
+  /**
+   * Struct containing options for compiling a syntax tree into a program.
+   */
+  struct compile_options
+  {
+    /** If `true`, compile a program matching the reverse of the expression. */
+    bool reverse = false;
+
+    /** The maximum number of instructions the compiled program may contain. */
+    size_t max_instructions = (1 << 20);
+
+    /**
+     * The maximum number of copies a counted repetition may be unrolled into, counting the copies
+     * made by every counted repetition enclosing it: `(a{10}){20}` makes 200 copies of `a`.
+     */
+    size_t max_repetitions = 1000;
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Compiles the syntax tree rooted at the specified node into a program.
+   *
+   * @exception regex::compile_error
+   * Thrown if the program would exceed the limits set in `options`.
+   */
+  std::shared_ptr<const regex::program> compile(const std::unique_ptr<const regex::syntax_node>& root,
+                                                const regex::compile_options& options = regex::compile_options());
+
+  /**
+   * Compiles the specified arena syntax tree into a program.
+   *
+   * @exception regex::compile_error
+   * Thrown if the program would exceed the limits set in `options`.
+   */
+  std::shared_ptr<const regex::program> compile(const regex::syntax_tree& tree,
+                                                const regex::compile_options& options = regex::compile_options());
+
+  /**
+   * Compiles the syntax trees rooted at the specified nodes into a single program, in which the
+   * `match` instruction for each tree is numbered by its index.
+   *
+   * @exception regex::compile_error
+   * Thrown if `roots` is empty, or if the program would exceed the limits set in `options`.
+   */
+  std::shared_ptr<const regex::program> compile_set(const std::vector<std::unique_ptr<const regex::syntax_node>>& roots,
+                                                    const regex::compile_options& options = regex::compile_options());
+
+  /**
+   * Compiles the specified arena syntax trees into a single program, in which the `match`
+   * instruction for each tree is numbered by its index.
+   *
+   * @exception regex::compile_error
+   * Thrown if `trees` is empty, or if the program would exceed the limits set in `options`.
+   */
+  std::shared_ptr<const regex::program> compile_set(const std::vector<regex::syntax_tree>& trees,
+                                                    const regex::compile_options& options = regex::compile_options());
+
+}
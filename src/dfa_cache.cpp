@@ -0,0 +1,146 @@
+/**
+ * @file	dfa_cache.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "dfa_cache.hpp"
+#include "dfa_state_builder.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** Estimated bookkeeping overhead for each cached state, in addition to its key and transitions. */
+  const size_t STATE_OVERHEAD = 64;
+
+}
+
+/* -- Procedures -- */
+
+constexpr uint32_t dfa_cache::MATCH_FLAG;
+constexpr uint32_t dfa_cache::DEAD_FLAG;
+constexpr uint32_t dfa_cache::START_FLAG;
+constexpr uint32_t dfa_cache::INDEX_MASK;
+constexpr uint32_t dfa_cache::UNKNOWN;
+
+dfa_cache::dfa_cache(shared_ptr<const program> prog, uint32_t entry, match_kind kind, size_t capacity, bool tag_start)
+  : m_builder(move(prog), kind),
+    m_classes(m_builder.prog().byte_classes),
+    m_stride(m_classes.count()),
+    m_entry(entry),
+    m_tag_start(tag_start),
+    m_capacity(capacity),
+    m_built_usage(0),
+    m_clear_count(0)
+{
+  reset();
+}
+
+uint32_t dfa_cache::compute_transition(uint32_t from, unsigned char byte)
+{
+  m_builder.next_state(*m_keys[from & INDEX_MASK], byte, m_next_key);
+
+  auto to = find_state();
+  if (to == UNKNOWN)
+  {
+    if (m_memory_usage + state_size(m_next_key.size()) > m_capacity)
+    {
+      // the cache is full, so start over, keeping only the states on either side of this transition
+      m_saved_key = *m_keys[from & INDEX_MASK];
+      m_pending_key.swap(m_next_key);
+      m_clear_count++;
+      reset();
+
+      m_next_key.swap(m_saved_key);
+      from = find_state();
+      if (from == UNKNOWN)
+        from = add_state(false);
+
+      m_next_key.swap(m_pending_key);
+      to = find_state();
+    }
+    if (to == UNKNOWN)
+      to = add_state(false);
+  }
+
+  m_transitions[(from & INDEX_MASK) * m_stride + m_classes[byte]] = to;
+  return to;
+}
+
+void dfa_cache::reset()
+{
+  m_map.clear();
+  m_keys.clear();
+  m_match_ids.clear();
+  m_transitions.clear();
+  m_memory_usage = 0;
+
+  m_next_key.clear();
+  add_state(false);
+
+  m_builder.start_state(m_entry, m_next_key);
+  m_start = find_state();
+  if (m_start == UNKNOWN)
+    m_start = add_state(m_tag_start);
+}
+
+uint32_t dfa_cache::find_state() const
+{
+  auto it = m_map.find(m_next_key);
+  return (it == m_map.end() ? UNKNOWN : it->second);
+}
+
+uint32_t dfa_cache::add_state(bool start)
+{
+  auto id = static_cast<uint32_t>(m_keys.size());
+  if (start)
+    id |= START_FLAG;
+  if (m_next_key.empty())
+    id |= DEAD_FLAG;
+
+  m_match_ids.emplace_back();
+  for (auto pc : m_next_key)
+  {
+    const auto& inst = m_builder.prog().instructions[pc];
+    if (inst.op == opcode::match)
+      m_match_ids.back().push_back(inst.argument);
+  }
+  if (!m_match_ids.back().empty())
+  {
+    id |= MATCH_FLAG;
+    sort(m_match_ids.back().begin(), m_match_ids.back().end());
+  }
+
+  auto it = m_map.emplace(m_next_key, id).first;
+  m_keys.push_back(&it->first);
+  m_transitions.resize(m_transitions.size() + m_stride, UNKNOWN);
+  m_memory_usage += state_size(m_next_key.size());
+  m_built_usage += state_size(m_next_key.size());
+
+  // the dead state only ever transitions to itself
+  if (id & DEAD_FLAG)
+    fill(m_transitions.end() - m_stride, m_transitions.end(), id);
+
+  return id;
+}
+
+size_t dfa_cache::state_size(size_t key_length) const
+{
+  return (m_stride * sizeof(uint32_t)) + (2 * key_length * sizeof(uint32_t)) + STATE_OVERHEAD;
+}
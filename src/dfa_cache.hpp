@@ -0,0 +1,164 @@
+/**
+ * @file	dfa_cache.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "dfa_state_builder.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class caching the DFA states and transitions computed on the fly for one program.
+   *
+   * State IDs are indices tagged with `MATCH_FLAG`, `DEAD_FLAG`, and optionally `START_FLAG`, so
+   * that search loops can test for all of them with a single comparison. The cache is limited to a
+   * fixed memory budget; when it fills, it is cleared and rebuilt from the current state rather
+   * than being allowed to grow. Transitions are stored per byte equivalence class of the program
+   * rather than per byte, so each state's row is usually only a few entries wide.
+   */
+  class dfa_cache
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** Flag set on the IDs of states containing a match instruction. */
+    static constexpr uint32_t MATCH_FLAG = 0x80000000;
+
+    /** Flag set on the ID of the dead state, from which no match is possible. */
+    static constexpr uint32_t DEAD_FLAG = 0x40000000;
+
+    /** Flag set on the ID of the start state, if the cache was asked to tag it. */
+    static constexpr uint32_t START_FLAG = 0x20000000;
+
+    /** Mask extracting the index of a state from its ID. */
+    static constexpr uint32_t INDEX_MASK = 0x1FFFFFFF;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::dfa_cache`.
+     *
+     * @param prog The program to build states for.
+     * @param entry The instruction at which execution begins.
+     * @param kind How competing threads are resolved.
+     * @param capacity The maximum number of bytes to use for cached states and transitions.
+     * @param tag_start If `true`, the start state's ID is tagged with `START_FLAG`.
+     */
+    dfa_cache(std::shared_ptr<const regex::program> prog,
+              uint32_t entry,
+              regex::match_kind kind,
+              size_t capacity,
+              bool tag_start);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the ID of the start state. */
+    uint32_t start_state() const
+    {
+      return m_start;
+    }
+
+    /** Returns the ID of the state reached from `state` on `byte`, computing it if necessary. */
+    uint32_t next_state(uint32_t state, unsigned char byte)
+    {
+      auto next = m_transitions[(state & INDEX_MASK) * m_stride + m_classes[byte]];
+      if (next == UNKNOWN)
+        next = compute_transition(state, byte);
+      return next;
+    }
+
+    /**
+     * Returns the arguments of the match instructions in the specified state, in ascending order.
+     * Only valid until the next call to `next_state()`, which may clear the cache.
+     */
+    const std::vector<uint32_t>& match_ids(uint32_t state) const
+    {
+      return m_match_ids[state & INDEX_MASK];
+    }
+
+    /** Returns the number of times the cache has been cleared. */
+    size_t clear_count() const
+    {
+      return m_clear_count;
+    }
+
+    /**
+     * Returns the estimated number of bytes of states built since construction, including those
+     * since discarded by clearing the cache.
+     */
+    size_t built_usage() const
+    {
+      return m_built_usage;
+    }
+
+    /** Returns the estimated number of bytes used by the cache. */
+    size_t memory_usage() const
+    {
+      return m_memory_usage;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    /** Transition table entry for a transition which has not been computed yet. */
+    static constexpr uint32_t UNKNOWN = 0xFFFFFFFF;
+
+    regex::dfa_state_builder m_builder;
+    regex::byte_class_map m_classes;
+    size_t m_stride;
+    uint32_t m_entry;
+    bool m_tag_start;
+    size_t m_capacity;
+
+    std::unordered_map<regex::dfa_state_key, uint32_t, regex::dfa_state_key_hash> m_map;
+    std::vector<const regex::dfa_state_key*> m_keys;
+    std::vector<std::vector<uint32_t>> m_match_ids;
+    std::vector<uint32_t> m_transitions;
+    uint32_t m_start;
+    size_t m_memory_usage;
+    size_t m_built_usage;
+    size_t m_clear_count;
+
+    regex::dfa_state_key m_next_key;
+    regex::dfa_state_key m_saved_key;
+    regex::dfa_state_key m_pending_key;
+
+    /** Computes, caches, and returns the transition out of `from` on `byte`. */
+    uint32_t compute_transition(uint32_t from, unsigned char byte);
+
+    /** Discards all cached states, then adds the dead and start states. */
+    void reset();
+
+    /** Returns the ID of the state for the working key, or `UNKNOWN` if it is not cached. */
+    uint32_t find_state() const;
+
+    /** Adds a state for the working key to the cache, and returns its ID. */
+    uint32_t add_state(bool start);
+
+    /** Returns the estimated number of bytes used by a state with a key of the specified length. */
+    size_t state_size(size_t key_length) const;
+
+  };
+
+}
@@ -0,0 +1,125 @@
+/**
+ * @file	dfa_state_builder.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/18
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "dfa_state_builder.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Procedures -- */
+
+dfa_state_builder::dfa_state_builder(shared_ptr<const program> prog, match_kind kind)
+  : m_prog(move(prog)),
+    m_kind(kind),
+    m_set(m_prog->instructions.size()),
+    m_truncated(false)
+{
+  m_stack.reserve(m_prog->instructions.size() + 1);
+}
+
+void dfa_state_builder::start_state(uint32_t entry, dfa_state_key& key)
+{
+  begin_key(key);
+  add_closure(entry, key);
+  end_key(key);
+}
+
+void dfa_state_builder::next_state(const dfa_state_key& from, unsigned char byte, dfa_state_key& key)
+{
+  begin_key(key);
+  for (auto pc : from)
+  {
+    const auto& inst = m_prog->instructions[pc];
+    if (inst.op == opcode::byte && inst.argument == byte)
+      add_closure(inst.next, key);
+    else if (inst.op == opcode::byte_set && m_prog->byte_sets[inst.argument].test(byte))
+      add_closure(inst.next, key);
+    else if (inst.op == opcode::any)
+      add_closure(inst.next, key);
+
+    if (m_truncated)
+      break;
+  }
+  end_key(key);
+}
+
+bool dfa_state_builder::is_match_state(const dfa_state_key& key) const
+{
+  for (auto pc : key)
+    if (m_prog->instructions[pc].op == opcode::match)
+      return true;
+  return false;
+}
+
+void dfa_state_builder::begin_key(dfa_state_key& key)
+{
+  key.clear();
+  m_set.clear();
+  m_truncated = false;
+}
+
+void dfa_state_builder::end_key(dfa_state_key& key)
+{
+  if (m_kind == match_kind::longest)
+    sort(key.begin(), key.end());
+}
+
+void dfa_state_builder::add_closure(uint32_t pc, dfa_state_key& key)
+{
+  m_stack.push_back(pc);
+  while (!m_stack.empty())
+  {
+    pc = m_stack.back();
+    m_stack.pop_back();
+
+    bool done = false;
+    while (!done && !m_set.contains(pc))
+    {
+      m_set.insert(pc);
+      const auto& inst = m_prog->instructions[pc];
+      switch (inst.op)
+      {
+      case opcode::split:
+        m_stack.push_back(inst.alternate);
+        pc = inst.next;
+        break;
+
+      case opcode::jump:
+      case opcode::save:
+        pc = inst.next;
+        break;
+
+      case opcode::byte:
+      case opcode::byte_set:
+      case opcode::any:
+        key.push_back(pc);
+        done = true;
+        break;
+
+      case opcode::match:
+        key.push_back(pc);
+        if (m_kind == match_kind::leftmost_first)
+        {
+          // every remaining thread has lower priority than this match
+          m_truncated = true;
+          m_stack.clear();
+          return;
+        }
+        done = true;
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,109 @@
+/**
+ * @file	dfa_state_builder.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/18
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "program.hpp"
+#include "sparse_set.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Enumeration of the ways in which a DFA may resolve competing NFA threads.
+   */
+  enum class match_kind
+  {
+    /** Threads are kept in priority order, and those with lower priority than a match are dropped. */
+    leftmost_first,
+
+    /** All threads are kept, so that scanning continues until the longest match is found. */
+    longest,
+  };
+
+  /** Type of the key identifying a DFA state: the NFA instructions active in that state. */
+  using dfa_state_key = std::vector<uint32_t>;
+
+  /**
+   * Hash function for `regex::dfa_state_key` values.
+   */
+  struct dfa_state_key_hash
+  {
+    size_t operator()(const regex::dfa_state_key& key) const
+    {
+      size_t hash = 14695981039346656037ULL;
+      for (auto pc : key)
+        hash = (hash ^ pc) * 1099511628211ULL;
+      return hash;
+    }
+  };
+
+  /**
+   * Class which computes DFA states from a program using the subset construction.
+   *
+   * A DFA state is identified by the list of byte-consuming and match instructions which are active
+   * in it. For `regex::match_kind::leftmost_first`, the list is in priority order and truncated after
+   * the first match instruction. For `regex::match_kind::longest`, the list is sorted.
+   */
+  class dfa_state_builder
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new `regex::dfa_state_builder` for the specified program. */
+    dfa_state_builder(std::shared_ptr<const regex::program> prog, regex::match_kind kind);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the program this builder computes states for. */
+    const regex::program& prog() const
+    {
+      return *m_prog;
+    }
+
+    /** Stores the key of the state entered at instruction `entry` in `key`. */
+    void start_state(uint32_t entry, regex::dfa_state_key& key);
+
+    /** Stores the key of the state reached from `from` on `byte` in `key`. */
+    void next_state(const regex::dfa_state_key& from, unsigned char byte, regex::dfa_state_key& key);
+
+    /** Returns `true` if the state with the specified key contains a match instruction. */
+    bool is_match_state(const regex::dfa_state_key& key) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    std::shared_ptr<const regex::program> m_prog;
+    regex::match_kind m_kind;
+    regex::sparse_set m_set;
+    std::vector<uint32_t> m_stack;
+    bool m_truncated;
+
+    /** Prepares to compute a new key. */
+    void begin_key(regex::dfa_state_key& key);
+
+    /** Finishes computing a key. */
+    void end_key(regex::dfa_state_key& key);
+
+    /** Adds the threads reachable from `pc` through epsilon transitions to `key`. */
+    void add_closure(uint32_t pc, regex::dfa_state_key& key);
+
+  };
+
+}
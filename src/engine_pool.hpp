@@ -0,0 +1,153 @@
+/**
+ * @file	engine_pool.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Thread-safe pool of matching engines.
+   *
+   * Engines own mutable scratch space and caches, so each may only be used by one thread at a time.
+   * This pool hands out idle engines on request, creating new ones as needed, which allows a single
+   * immutable compiled expression to be shared between threads while each engine keeps its warm
+   * caches across searches.
+   *
+   * At most `idle_limit` engines are kept idle. An engine returned while the pool already holds that
+   * many is destroyed, so a burst of concurrent searches does not leave its working storage behind
+   * for the lifetime of the pool.
+   */
+  template <typename TEngine>
+  class engine_pool
+  {
+
+    /* -- Types -- */
+
+  public:
+
+    /** Function used to create new engines. */
+    using factory_type = std::function<std::unique_ptr<TEngine>()>;
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The default maximum number of idle engines kept by a pool. */
+    static const size_t DEFAULT_IDLE_LIMIT = 8;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::engine_pool` which creates engines with the specified factory, and
+     * keeps at most `idle_limit` of them idle.
+     */
+    engine_pool(factory_type factory, size_t idle_limit = DEFAULT_IDLE_LIMIT)
+      : m_factory(std::move(factory)),
+        m_idle_limit(idle_limit)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Invokes `fn` with exclusive access to an engine from the pool, and returns its result. */
+    template <typename TFunction>
+    auto with_engine(TFunction&& fn) const
+    {
+      lease engine(*this);
+      return fn(*engine.get());
+    }
+
+    /** Returns the number of engines currently idle in the pool. */
+    size_t idle_count() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_idle.size();
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    /** RAII object which returns an engine to the pool when destroyed. */
+    class lease
+    {
+    public:
+
+      lease(const engine_pool& pool)
+        : m_pool(pool),
+          m_engine(pool.acquire())
+      { }
+
+      ~lease()
+      {
+        m_pool.release(std::move(m_engine));
+      }
+
+      TEngine* get() const
+      {
+        return m_engine.get();
+      }
+
+    private:
+
+      const engine_pool& m_pool;
+      std::unique_ptr<TEngine> m_engine;
+
+    };
+
+    factory_type m_factory;
+    const size_t m_idle_limit;
+    mutable std::mutex m_mutex;
+    mutable std::vector<std::unique_ptr<TEngine>> m_idle;
+
+    /** Takes an idle engine from the pool, or creates a new one if none are available. */
+    std::unique_ptr<TEngine> acquire() const
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_idle.empty())
+        {
+          auto engine = std::move(m_idle.back());
+          m_idle.pop_back();
+          return engine;
+        }
+      }
+      return m_factory();
+    }
+
+    /** Returns an engine to the pool, or destroys it if the pool already has enough idle engines. */
+    void release(std::unique_ptr<TEngine> engine) const
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_idle.size() < m_idle_limit)
+        {
+          m_idle.push_back(std::move(engine));
+          return;
+        }
+      }
+
+      // the surplus engine is destroyed outside of the lock
+      engine.reset();
+    }
+
+  };
+
+}
@@ -0,0 +1,412 @@
+/**
+ * @file	full_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/18
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "compiler.hpp"
+#include "dfa_state_builder.hpp"
+#include "full_dfa.hpp"
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct full_dfa::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> forward_prog,
+                 shared_ptr<const program> reverse_prog,
+                 size_t state_limit,
+                 shared_ptr<const prefilter> pre)
+    : forward(build_dfa_table(forward_prog, forward_prog->unanchored_start, match_kind::leftmost_first, state_limit)),
+      reverse(build_dfa_table(reverse_prog, reverse_prog->anchored_start, match_kind::longest, state_limit)),
+      pre(move(pre))
+  { }
+
+  /* -- Fields -- */
+
+  const dfa_table forward;
+  const dfa_table reverse;
+  const shared_ptr<const prefilter> pre;
+
+  /* -- Methods -- */
+
+  /**
+   * Scans forwards for the end of the leftmost-first match. If `stop_early` is set, returns as
+   * soon as any match is seen.
+   */
+  bool scan_forward(const char* begin, const char* end, bool stop_early, size_t& match_end) const
+  {
+    const uint32_t* table = forward.transitions.data();
+    const uint8_t* classes = forward.classes.data();
+    const uint32_t start = forward.start;
+    bool found = false;
+
+    // the start state immediately follows the match states, so with a prefilter, returning to the
+    // start state is detected by the same comparison
+    const uint32_t limit = (pre != nullptr ? max(forward.start, forward.last_match) : forward.last_match);
+
+    auto state = forward.start;
+    if (forward.is_match(state))
+    {
+      found = true;
+      match_end = 0;
+      if (stop_early)
+        return true;
+    }
+
+    auto ptr = begin;
+    if (pre != nullptr && state == start && !found)
+      ptr = pre->find(begin, end);
+
+    while (ptr != end)
+    {
+      state = table[state + classes[static_cast<unsigned char>(*ptr++)]];
+      if (state <= limit)
+      {
+        if (state == 0)
+          break;
+
+        if (state == start && !found)
+        {
+          // there is no match in progress, so skip ahead to the next candidate
+          ptr = pre->find(ptr, end);
+          continue;
+        }
+
+        found = true;
+        match_end = static_cast<size_t>(ptr - begin);
+        if (stop_early)
+          return true;
+      }
+    }
+
+    return found;
+  }
+
+  /** Scans backwards from `match_end` for the start of the longest match ending there. */
+  size_t scan_reverse(const char* begin, size_t match_end) const
+  {
+    const uint32_t* table = reverse.transitions.data();
+    const uint8_t* classes = reverse.classes.data();
+    const uint32_t last_match = reverse.last_match;
+    auto match_begin = match_end;
+
+    auto state = reverse.start;
+    for (auto ptr = begin + match_end; ptr != begin; )
+    {
+      ptr--;
+      state = table[state + classes[static_cast<unsigned char>(*ptr)]];
+      if (state <= last_match)
+      {
+        if (state == 0)
+          break;
+        match_begin = static_cast<size_t>(ptr - begin);
+      }
+    }
+
+    return match_begin;
+  }
+
+};
+
+/* -- Procedures -- */
+
+full_dfa::full_dfa(shared_ptr<const program> forward,
+                   shared_ptr<const program> reverse,
+                   size_t state_limit,
+                   shared_ptr<const prefilter> pre)
+  : impl(make_unique<implementation>(move(forward), move(reverse), state_limit, move(pre)))
+{
+}
+
+full_dfa::~full_dfa() = default;
+
+bool full_dfa::is_match(const char* begin, const char* end) const
+{
+  size_t match_end;
+  return impl->scan_forward(begin, end, true, match_end);
+}
+
+bool full_dfa::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool full_dfa::find(const char* begin, const char* end, match& result) const
+{
+  size_t match_end;
+  if (!impl->scan_forward(begin, end, false, match_end))
+    return false;
+
+  result.begin = impl->scan_reverse(begin, match_end);
+  result.end = match_end;
+  return true;
+}
+
+bool full_dfa::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+size_t full_dfa::match_start(const char* begin, size_t match_end) const
+{
+  return impl->scan_reverse(begin, match_end);
+}
+
+const dfa_table& full_dfa::forward_table() const
+{
+  return impl->forward;
+}
+
+const dfa_table& full_dfa::reverse_table() const
+{
+  return impl->reverse;
+}
+
+dfa_table regex::build_dfa_table(shared_ptr<const program> prog, uint32_t entry, match_kind kind, size_t state_limit)
+{
+  dfa_state_builder builder(move(prog), kind);
+  const auto& byte_classes = builder.prog().byte_classes;
+  const auto class_bytes = byte_classes.representatives();
+  const size_t alphabet_size = byte_classes.count();
+
+  unordered_map<dfa_state_key, uint32_t, dfa_state_key_hash> ids;
+  vector<const dfa_state_key*> keys;
+  vector<uint32_t> transitions;
+  vector<bool> is_match;
+
+  // interns a state, returning its index
+  auto intern = [&] (const dfa_state_key& key) -> uint32_t {
+    auto it = ids.find(key);
+    if (it != ids.end())
+      return it->second;
+
+    if (keys.size() >= state_limit)
+    {
+      ostringstream message;
+      message << "DFA exceeds limit of " << state_limit << " states.";
+      throw compile_error(message.str());
+    }
+
+    auto index = static_cast<uint32_t>(keys.size());
+    it = ids.emplace(key, index).first;
+    keys.push_back(&it->first);
+    is_match.push_back(builder.is_match_state(key));
+    return index;
+  };
+
+  // the dead state is always index 0
+  dfa_state_key key;
+  intern(key);
+  builder.start_state(entry, key);
+  auto start = intern(key);
+
+  // determinize, visiting states in the order they are discovered; every byte in a class leads to
+  // the same state, so only one representative of each class is followed
+  for (size_t index = 0; index < keys.size(); index++)
+  {
+    transitions.resize(transitions.size() + alphabet_size);
+    for (size_t cls = 0; cls < alphabet_size; cls++)
+    {
+      builder.next_state(*keys[index], class_bytes[cls], key);
+      transitions[index * alphabet_size + cls] = intern(key);
+    }
+  }
+
+  // merge equivalent states, then number the classes so the dead state is first, followed by the match states,
+  // followed by the start state
+  auto classes = minimize_dfa(keys.size(), alphabet_size, transitions, is_match);
+  auto class_count = *max_element(classes.begin(), classes.end()) + 1;
+
+  vector<uint32_t> class_ids(class_count, UINT32_MAX);
+  vector<uint32_t> representatives(class_count);
+  uint32_t next_id = 0;
+  uint32_t last_match_id = 0;
+  class_ids[classes[0]] = next_id++;
+  representatives[classes[0]] = 0;
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (size_t state = 0; state < keys.size(); state++)
+    {
+      auto cls = classes[state];
+      if (class_ids[cls] == UINT32_MAX && is_match[state] == (pass == 0))
+      {
+        class_ids[cls] = next_id++;
+        representatives[cls] = static_cast<uint32_t>(state);
+      }
+    }
+    if (pass == 0)
+    {
+      last_match_id = next_id - 1;
+      if (class_ids[classes[start]] == UINT32_MAX)
+      {
+        class_ids[classes[start]] = next_id++;
+        representatives[classes[start]] = start;
+      }
+    }
+  }
+
+  dfa_table table;
+  table.stride = static_cast<uint32_t>(alphabet_size);
+  table.classes = byte_classes;
+  table.transitions.resize(class_count * alphabet_size);
+  for (uint32_t cls = 0; cls < class_count; cls++)
+  {
+    auto row = class_ids[cls] * alphabet_size;
+    auto rep_row = representatives[cls] * alphabet_size;
+    for (size_t symbol = 0; symbol < alphabet_size; symbol++)
+      table.transitions[row + symbol] = class_ids[classes[transitions[rep_row + symbol]]] * table.stride;
+  }
+
+  table.start = class_ids[classes[start]] * table.stride;
+  table.last_match = last_match_id * table.stride;
+  return table;
+}
+
+vector<uint32_t> regex::minimize_dfa(size_t state_count,
+                                     size_t alphabet_size,
+                                     const vector<uint32_t>& transitions,
+                                     const vector<bool>& is_match)
+{
+  // inverse transitions, grouped by (symbol, target)
+  vector<uint32_t> inverse_offsets(alphabet_size * state_count + 1, 0);
+  vector<uint32_t> inverse_sources(alphabet_size * state_count);
+  for (size_t state = 0; state < state_count; state++)
+    for (size_t symbol = 0; symbol < alphabet_size; symbol++)
+      inverse_offsets[symbol * state_count + transitions[state * alphabet_size + symbol] + 1]++;
+  for (size_t idx = 1; idx < inverse_offsets.size(); idx++)
+    inverse_offsets[idx] += inverse_offsets[idx - 1];
+  {
+    vector<uint32_t> fill_position(inverse_offsets.begin(), inverse_offsets.end() - 1);
+    for (size_t state = 0; state < state_count; state++)
+      for (size_t symbol = 0; symbol < alphabet_size; symbol++)
+        inverse_sources[fill_position[symbol * state_count + transitions[state * alphabet_size + symbol]]++] =
+          static_cast<uint32_t>(state);
+  }
+
+  // the partition is stored as a permutation of states in which each block is contiguous, with
+  // the marked members of a block moved to its front
+  vector<uint32_t> elements(state_count);
+  vector<uint32_t> location(state_count);
+  vector<uint32_t> block_of(state_count);
+  vector<uint32_t> block_first;
+  vector<uint32_t> block_end;
+  vector<uint32_t> block_marked;
+  vector<bool> in_worklist;
+  vector<uint32_t> worklist;
+
+  auto add_block = [&] (uint32_t first, uint32_t end) -> uint32_t {
+    auto block = static_cast<uint32_t>(block_first.size());
+    block_first.push_back(first);
+    block_end.push_back(end);
+    block_marked.push_back(0);
+    in_worklist.push_back(false);
+    for (auto idx = first; idx < end; idx++)
+      block_of[elements[idx]] = block;
+    return block;
+  };
+
+  auto push_worklist = [&] (uint32_t block) {
+    in_worklist[block] = true;
+    worklist.push_back(block);
+  };
+
+  // initial partition separates match states from all others
+  uint32_t count = 0;
+  for (size_t state = 0; state < state_count; state++)
+    if (is_match[state])
+      elements[count++] = static_cast<uint32_t>(state);
+  auto match_end = count;
+  for (size_t state = 0; state < state_count; state++)
+    if (!is_match[state])
+      elements[count++] = static_cast<uint32_t>(state);
+  for (uint32_t idx = 0; idx < state_count; idx++)
+    location[elements[idx]] = idx;
+
+  if (match_end > 0)
+    push_worklist(add_block(0, match_end));
+  if (match_end < state_count)
+    push_worklist(add_block(match_end, static_cast<uint32_t>(state_count)));
+
+  // refine until no block can be split
+  vector<uint32_t> splitter;
+  vector<uint32_t> touched;
+  while (!worklist.empty())
+  {
+    auto splitter_block = worklist.back();
+    worklist.pop_back();
+    in_worklist[splitter_block] = false;
+    splitter.assign(elements.begin() + block_first[splitter_block], elements.begin() + block_end[splitter_block]);
+
+    for (size_t symbol = 0; symbol < alphabet_size; symbol++)
+    {
+      // mark every state with a transition on this symbol into the splitter
+      touched.clear();
+      for (auto target : splitter)
+      {
+        auto inverse_begin = inverse_offsets[symbol * state_count + target];
+        auto inverse_end = inverse_offsets[symbol * state_count + target + 1];
+        for (auto idx = inverse_begin; idx < inverse_end; idx++)
+        {
+          auto source = inverse_sources[idx];
+          auto block = block_of[source];
+          auto marked_end = block_first[block] + block_marked[block];
+          if (location[source] < marked_end)
+            continue;
+
+          if (block_marked[block] == 0)
+            touched.push_back(block);
+
+          auto other = elements[marked_end];
+          swap(elements[location[source]], elements[marked_end]);
+          location[other] = location[source];
+          location[source] = marked_end;
+          block_marked[block]++;
+        }
+      }
+
+      // split each block which was only partially marked
+      for (auto block : touched)
+      {
+        auto marked = block_marked[block];
+        block_marked[block] = 0;
+        if (marked == block_end[block] - block_first[block])
+          continue;
+
+        auto first = block_first[block];
+        block_first[block] = first + marked;
+        auto new_block = add_block(first, first + marked);
+
+        if (in_worklist[block])
+          push_worklist(new_block);
+        else if (marked <= block_end[block] - block_first[block])
+          push_worklist(new_block);
+        else
+          push_worklist(block);
+      }
+    }
+  }
+
+  return block_of;
+}
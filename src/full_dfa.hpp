@@ -0,0 +1,192 @@
+/**
+ * @file	full_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/18
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dfa_state_builder.hpp"
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Struct representing a dense, minimized DFA transition table.
+   *
+   * Each row has one transition per byte equivalence class of the program, rather than one per
+   * byte. States are identified by the offset of their row in `transitions`, so that the next state
+   * is found by indexing with the class of the input byte. The dead state is always `0`, and the match states are those
+   * with IDs in the range `(0, last_match]`, so that the search loop can detect both with a single
+   * comparison. Unless it is itself a match state, the start state immediately follows the match
+   * states, so that returning to it can be detected by the same comparison.
+   */
+  struct dfa_table
+  {
+    /** The number of transitions out of each state. */
+    uint32_t stride = 256;
+
+    /** The equivalence class of each byte. */
+    regex::byte_class_map classes;
+
+    /** The transition table, indexed by `state + classes[byte]`. */
+    std::vector<uint32_t> transitions;
+
+    /** The ID of the start state. */
+    uint32_t start = 0;
+
+    /** The ID of the last match state. */
+    uint32_t last_match = 0;
+
+    /** Returns the number of states in this table. */
+    size_t state_count() const
+    {
+      return transitions.size() / stride;
+    }
+
+    /** Returns `true` if the specified state is the dead state. */
+    bool is_dead(uint32_t state) const
+    {
+      return (state == 0);
+    }
+
+    /** Returns `true` if the specified state is a match state. */
+    bool is_match(uint32_t state) const
+    {
+      return (state != 0 && state <= last_match);
+    }
+  };
+
+  /**
+   * Class which executes compiled programs as a DFA which is fully built ahead of time.
+   *
+   * The DFA is determinized with the subset construction and then minimized with Hopcroft's
+   * algorithm, producing a dense transition table. This makes construction considerably more
+   * expensive than for a `regex::lazy_dfa`, in exchange for the fastest possible scanning and a
+   * fixed memory footprint. Construction fails if the DFA would exceed a specified number of states.
+   *
+   * Since the table is immutable once built, a single instance may be used by multiple threads.
+   */
+  class full_dfa
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Builds a new `regex::full_dfa`.
+     *
+     * @param forward The program to run forwards.
+     * @param reverse The same expression compiled in reverse.
+     * @param state_limit The maximum number of states allowed in each direction before minimization.
+     * @param pre An optional prefilter, used to skip input whenever the forward scan is in its start
+     * state.
+     *
+     * @exception regex::compile_error
+     * Thrown if either DFA would exceed `state_limit` states.
+     */
+    full_dfa(std::shared_ptr<const regex::program> forward,
+             std::shared_ptr<const regex::program> reverse,
+             size_t state_limit,
+             std::shared_ptr<const regex::prefilter> pre = nullptr);
+
+    /** Destructor. */
+    ~full_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the program matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if the program matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /**
+     * Returns the start of the leftmost-first match in the input beginning at `begin`, given the
+     * offset at which it ends, as found by scanning the forward table.
+     */
+    size_t match_start(const char* begin, size_t match_end) const;
+
+    /** Returns the table used to scan forwards for the end of a match. */
+    const regex::dfa_table& forward_table() const;
+
+    /** Returns the table used to scan backwards for the start of a match. */
+    const regex::dfa_table& reverse_table() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Builds a minimized DFA table for the specified program.
+   *
+   * @param prog The program to determinize.
+   * @param entry The instruction at which execution begins.
+   * @param kind How competing threads are resolved.
+   * @param state_limit The maximum number of states allowed before minimization.
+   *
+   * @exception regex::compile_error
+   * Thrown if the DFA would exceed `state_limit` states.
+   */
+  regex::dfa_table build_dfa_table(std::shared_ptr<const regex::program> prog,
+                                   uint32_t entry,
+                                   regex::match_kind kind,
+                                   size_t state_limit);
+
+  /**
+   * Minimizes a DFA with Hopcroft's algorithm.
+   *
+   * @param state_count The number of states in the DFA.
+   * @param alphabet_size The number of transitions out of each state.
+   * @param transitions The transition table, indexed by `state * alphabet_size + symbol`.
+   * @param is_match Whether each state is a match state.
+   *
+   * @return The equivalence class of each state. States in the same class are indistinguishable.
+   */
+  std::vector<uint32_t> minimize_dfa(size_t state_count,
+                                     size_t alphabet_size,
+                                     const std::vector<uint32_t>& transitions,
+                                     const std::vector<bool>& is_match);
+
+}
@@ -0,0 +1,427 @@
+/**
+ * @file	jit_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compiler.hpp"
+#include "full_dfa.hpp"
+#include "jit_dfa.hpp"
+#include "match.hpp"
+
+#if !defined(REGEX_DISABLE_JIT) && defined(__x86_64__) && defined(__linux__)
+#define REGEX_JIT_X86_64 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+namespace
+{
+
+  /**
+   * Signature of the generated scan. Runs the DFA from the start state over `[ptr, end)`, storing
+   * the end of each match seen in `last_match`, and returns once the dead state or the end of the
+   * input is reached, or as soon as a match is seen if `stop_early` is nonzero.
+   */
+  typedef void (*scan_function)(const char* ptr, const char* end, const char** last_match, int stop_early);
+
+}
+
+#if REGEX_JIT_X86_64
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** The maximum number of runs of bytes branched on with comparisons rather than a jump table. */
+  const size_t MAX_COMPARE_RUNS = 8;
+
+  /** Value indicating that a label has not been bound. */
+  const size_t UNBOUND = SIZE_MAX;
+
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /**
+   * Class which assembles x86-64 machine code, with labels which may be referenced before they are
+   * bound.
+   */
+  class assembler
+  {
+  public:
+
+    /** Creates a new label, and returns its ID. */
+    uint32_t make_label()
+    {
+      m_labels.push_back(UNBOUND);
+      return static_cast<uint32_t>(m_labels.size() - 1);
+    }
+
+    /** Binds the specified label to the current position. */
+    void bind(uint32_t label)
+    {
+      m_labels[label] = m_code.size();
+    }
+
+    /** Returns the current position. */
+    size_t position() const
+    {
+      return m_code.size();
+    }
+
+    /** Appends raw bytes. */
+    void emit(initializer_list<uint8_t> bytes)
+    {
+      m_code.insert(m_code.end(), bytes.begin(), bytes.end());
+    }
+
+    /** Appends `int3` instructions until the position is a multiple of `alignment`. */
+    void align(size_t alignment)
+    {
+      while (m_code.size() % alignment != 0)
+        m_code.push_back(0xcc);
+    }
+
+    /**
+     * Appends an instruction ending in a 32-bit displacement to `label`, relative to the end of the
+     * instruction.
+     */
+    void emit_relative(initializer_list<uint8_t> opcode, uint32_t label)
+    {
+      emit(opcode);
+      emit_offset(label, m_code.size() + 4);
+    }
+
+    /** Appends a 32-bit offset to `label`, relative to position `base`. */
+    void emit_offset(uint32_t label, size_t base)
+    {
+      m_fixups.push_back(fixup { m_code.size(), label, base });
+      emit({ 0, 0, 0, 0 });
+    }
+
+    /** Resolves all references to labels, and returns the finished code. */
+    vector<uint8_t> finish()
+    {
+      for (const auto& fix : m_fixups)
+      {
+        auto offset = static_cast<int32_t>(static_cast<int64_t>(m_labels[fix.label]) - static_cast<int64_t>(fix.base));
+        memcpy(&m_code[fix.position], &offset, sizeof(offset));
+      }
+      return move(m_code);
+    }
+
+  private:
+
+    /** A reference to a label, to be filled in once all labels are bound. */
+    struct fixup
+    {
+      size_t position;
+      uint32_t label;
+      size_t base;
+    };
+
+    vector<uint8_t> m_code;
+    vector<size_t> m_labels;
+    vector<fixup> m_fixups;
+
+  };
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Struct describing a run of consecutive bytes which all lead to the same state. */
+  struct byte_run
+  {
+    uint32_t first;
+    uint32_t last;
+    uint32_t target;
+  };
+
+  /**
+   * Emits the transitions out of one state, for the byte in `eax`. Each run of bytes leading
+   * anywhere but the most common target is tested for, and the most common target is reached by
+   * falling through, so that a state which mostly loops back to itself takes a single branch per
+   * byte. States with many such runs use a jump table instead.
+   */
+  void emit_transitions(assembler& as,
+                        const vector<uint32_t>& labels,
+                        const vector<byte_run>& runs,
+                        uint32_t state,
+                        uint32_t body,
+                        bool is_match)
+  {
+    vector<size_t> weights(labels.size(), 0);
+    for (const auto& run : runs)
+      weights[run.target] += run.last - run.first + 1;
+    uint32_t common = state;
+    for (uint32_t target = 0; target < weights.size(); target++)
+      if (weights[target] > weights[common])
+        common = target;
+
+    size_t tested = 0;
+    for (const auto& run : runs)
+      if (run.target != common)
+        tested++;
+
+    if (tested > MAX_COMPARE_RUNS)
+    {
+      auto jump_table = as.make_label();
+      as.emit_relative({ 0x4c, 0x8d, 0x05 }, jump_table);                 // lea r8, [rip + table]
+      as.emit({ 0x49, 0x63, 0x04, 0x80 });                                // movsxd rax, dword [r8 + rax * 4]
+      as.emit({ 0x4c, 0x01, 0xc0 });                                      // add rax, r8
+      as.emit({ 0xff, 0xe0 });                                            // jmp rax
+
+      // entries are relative to the start of the table
+      as.align(4);
+      as.bind(jump_table);
+      auto base = as.position();
+      for (const auto& run : runs)
+        for (auto byte = run.first; byte <= run.last; byte++)
+          as.emit_offset(labels[run.target], base);
+      return;
+    }
+
+    for (const auto& run : runs)
+    {
+      if (run.target == common)
+        continue;
+
+      auto first = static_cast<uint8_t>(run.first);
+      auto last = static_cast<uint8_t>(run.last);
+      if (run.first == run.last)
+      {
+        as.emit({ 0x3c, first });                                         // cmp al, first
+        as.emit_relative({ 0x0f, 0x84 }, labels[run.target]);             // je target
+      }
+      else if (run.first == 0)
+      {
+        as.emit({ 0x3c, last });                                          // cmp al, last
+        as.emit_relative({ 0x0f, 0x86 }, labels[run.target]);             // jbe target
+      }
+      else if (run.last == 255)
+      {
+        as.emit({ 0x3c, first });                                         // cmp al, first
+        as.emit_relative({ 0x0f, 0x83 }, labels[run.target]);             // jae target
+      }
+      else
+      {
+        // only the low byte is compared, so the range check wraps modulo 256 like the displacement
+        as.emit({ 0x44, 0x8d, 0x40, static_cast<uint8_t>(-first) });     // lea r8d, [rax - first]
+        as.emit({ 0x41, 0x80, 0xf8, static_cast<uint8_t>(last - first) }); // cmp r8b, last - first
+        as.emit_relative({ 0x0f, 0x86 }, labels[run.target]);             // jbe target
+      }
+    }
+
+    // a non-matching state loops back to itself without repeating the check for the end of the
+    // input at its entry, while a match state must record each match
+    if (common == state && !is_match)
+    {
+      as.emit({ 0x48, 0x39, 0xf7 });                                      // cmp rdi, rsi
+      as.emit_relative({ 0x0f, 0x85 }, body);                             // jne body
+      as.emit({ 0xc3 });                                                  // ret
+    }
+    else
+      as.emit_relative({ 0xe9 }, labels[common]);                         // jmp common
+  }
+
+  /**
+   * Generates the scan for the DFA table `table`. On entry, `rdi` is the input pointer, `rsi` the
+   * end of the input, `rdx` the address at which to store the end of each match, and `ecx` the flag
+   * requesting an early return. Only caller-saved registers are used, and the stack is not.
+   */
+  vector<uint8_t> generate(const dfa_table& table)
+  {
+    assembler as;
+    auto state_count = table.state_count();
+    auto last_match = table.last_match / table.stride;
+
+    // the dead state's label returns, so that transitions to it are simply jumps to the exit
+    vector<uint32_t> labels(state_count);
+    for (auto& label : labels)
+      label = as.make_label();
+
+    as.emit_relative({ 0xe9 }, labels[table.start / table.stride]);      // jmp start
+    as.bind(labels[0]);
+    as.emit({ 0xc3 });                                                    // ret
+
+    vector<byte_run> runs;
+    for (uint32_t state = 1; state < state_count; state++)
+    {
+      runs.clear();
+      for (uint32_t byte = 0; byte < 256; byte++)
+      {
+        auto target = table.transitions[state * table.stride + table.classes[static_cast<unsigned char>(byte)]] / table.stride;
+        if (runs.empty() || runs.back().target != target)
+          runs.push_back(byte_run { byte, byte, target });
+        else
+          runs.back().last = byte;
+      }
+
+      as.align(16);
+      as.bind(labels[state]);
+
+      bool is_match = (state <= last_match);
+      if (is_match)
+      {
+        as.emit({ 0x48, 0x89, 0x3a });                                    // mov [rdx], rdi
+        as.emit({ 0x85, 0xc9 });                                          // test ecx, ecx
+        as.emit_relative({ 0x0f, 0x85 }, labels[0]);                      // jnz exit
+      }
+
+      as.emit({ 0x48, 0x39, 0xf7 });                                      // cmp rdi, rsi
+      as.emit_relative({ 0x0f, 0x84 }, labels[0]);                        // je exit
+
+      auto body = as.make_label();
+      as.bind(body);
+      as.emit({ 0x0f, 0xb6, 0x07 });                                      // movzx eax, byte [rdi]
+      as.emit({ 0x48, 0xff, 0xc7 });                                      // inc rdi
+      emit_transitions(as, labels, runs, state, body, is_match);
+    }
+
+    return as.finish();
+  }
+
+}
+
+#endif
+
+struct jit_dfa::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const full_dfa> dfa)
+    : dfa(move(dfa))
+  {
+#if REGEX_JIT_X86_64
+    auto code = generate(this->dfa->forward_table());
+
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    mapping_size = (code.size() + page_size - 1) / page_size * page_size;
+    void* memory = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+      throw compile_error("Failed to allocate memory for JIT compiled code.");
+
+    memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, mapping_size, PROT_READ | PROT_EXEC) != 0)
+    {
+      munmap(memory, mapping_size);
+      throw compile_error("Failed to make JIT compiled code executable.");
+    }
+
+    mapping = memory;
+    size = code.size();
+    scan = reinterpret_cast<scan_function>(memory);
+#else
+    throw compile_error("JIT compilation is not supported on this platform.");
+#endif
+  }
+
+  /* -- Destructor -- */
+
+  ~implementation()
+  {
+#if REGEX_JIT_X86_64
+    munmap(mapping, mapping_size);
+#endif
+  }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const full_dfa> dfa;
+  void* mapping = nullptr;
+  size_t mapping_size = 0;
+  size_t size = 0;
+  scan_function scan = nullptr;
+
+  /* -- Methods -- */
+
+  /** Runs the generated scan, returning the end of the last match seen, or `nullptr` if none was. */
+  const char* run(const char* begin, const char* end, bool stop_early) const
+  {
+    // an empty range may be null, which would be indistinguishable from no match
+    static const char EMPTY = 0;
+    if (begin == end)
+      begin = end = &EMPTY;
+
+    const char* last_match = nullptr;
+    scan(begin, end, &last_match, stop_early ? 1 : 0);
+    return last_match;
+  }
+
+};
+
+/* -- Procedures -- */
+
+jit_dfa::jit_dfa(shared_ptr<const full_dfa> dfa)
+  : impl(make_unique<implementation>(move(dfa)))
+{
+}
+
+jit_dfa::~jit_dfa() = default;
+
+bool jit_dfa::is_supported()
+{
+#if REGEX_JIT_X86_64
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t jit_dfa::code_size() const
+{
+  return impl->size;
+}
+
+bool jit_dfa::is_match(const char* begin, const char* end) const
+{
+  return (impl->run(begin, end, true) != nullptr);
+}
+
+bool jit_dfa::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool jit_dfa::find(const char* begin, const char* end, match& result) const
+{
+  auto last_match = impl->run(begin, end, false);
+  if (last_match == nullptr)
+    return false;
+
+  result.end = (begin == end ? 0 : static_cast<size_t>(last_match - begin));
+  result.begin = impl->dfa->match_start(begin, result.end);
+  return true;
+}
+
+bool jit_dfa::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file	jit_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "full_dfa.hpp"
+#include "match.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which compiles the forward table of a full DFA into native x86-64 code.
+   *
+   * Each state becomes a block of code which records a match if it is a match state, checks for
+   * the end of the input, loads the next byte, and jumps directly to the block for the next state.
+   * States whose transitions fall into a few runs of consecutive bytes branch with a short chain of
+   * comparisons, and all others with a jump table, so the scan performs no table lookups beyond
+   * the jump tables themselves, and no loads of state IDs at all. The code is written into an
+   * anonymous mapping which is made executable, and never writable, once it is complete. The start
+   * of each match is found with the reverse table of the full DFA.
+   *
+   * The JIT is only available on x86-64 Linux, and may be removed entirely by configuring with
+   * `REGEX_ENABLE_JIT` off, which defines `REGEX_DISABLE_JIT`. Results are identical to those of
+   * `regex::full_dfa`.
+   *
+   * Since the code is immutable once built, a single instance may be used by multiple threads.
+   */
+  class jit_dfa
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Compiles a new `regex::jit_dfa`.
+     *
+     * @param dfa The DFA to compile.
+     *
+     * @exception regex::compile_error
+     * Thrown if the JIT is not supported on this platform, or if executable memory could not be
+     * allocated, for instance because it is forbidden by the system's security policy.
+     */
+    jit_dfa(std::shared_ptr<const regex::full_dfa> dfa);
+
+    /** Destructor. */
+    ~jit_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the JIT is supported in this build and on this platform. */
+    static bool is_supported();
+
+    /** Returns the number of bytes of native code generated, including jump tables. */
+    size_t code_size() const;
+
+    /** Returns `true` if the DFA matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if the DFA matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
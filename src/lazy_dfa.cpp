@@ -0,0 +1,238 @@
+/**
+ * @file	lazy_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dfa_cache.hpp"
+#include "dfa_state_builder.hpp"
+#include "lazy_dfa.hpp"
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct lazy_dfa::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> forward,
+                 shared_ptr<const program> reverse,
+                 size_t cache_size,
+                 shared_ptr<const prefilter> pre)
+    : pre(move(pre)),
+      forward(forward, forward->unanchored_start, match_kind::leftmost_first, forward_size(cache_size), this->pre != nullptr),
+      reverse(reverse, reverse->anchored_start, match_kind::longest, cache_size / 2, false)
+  {
+    // with a prefilter, half of the forward budget goes to checking its candidates
+    if (this->pre != nullptr)
+      anchored = make_unique<dfa_cache>(forward, forward->anchored_start, match_kind::leftmost_first, forward_size(cache_size), false);
+  }
+
+  /* -- Fields -- */
+
+  shared_ptr<const prefilter> pre;
+  dfa_cache forward;
+  dfa_cache reverse;
+  unique_ptr<dfa_cache> anchored;
+
+  /* -- Methods -- */
+
+  /** Returns the budget of each of the forward caches. */
+  size_t forward_size(size_t cache_size) const
+  {
+    return (pre != nullptr ? cache_size / 4 : cache_size / 2);
+  }
+
+  /**
+   * Checks the candidates found by the prefilter from `ptr` onwards with an anchored scan, and
+   * leaves `ptr` at the first which cannot be ruled out within one byte past the longest literal,
+   * or at `end` if there is none. If the anchored scan finds a match first, its bounds are stored
+   * and `true` is returned; no match starts at an earlier candidate.
+   *
+   * Most false candidates die within that distance, and are skipped without resuming the
+   * unanchored scan, whose states would otherwise track every literal in progress and can thrash
+   * the cache when there are thousands of them.
+   */
+  bool scan_candidates(const char* begin, const char*& ptr, const char* end, bool stop_early,
+                       size_t& match_begin, size_t& match_end)
+  {
+    auto distance = pre->max_length() + 1;
+    for (ptr = pre->find(ptr, end); ptr != end; ptr = pre->find(ptr + 1, end))
+    {
+      bool found = false;
+      auto state = anchored->start_state();
+      for (auto scan = ptr; scan != end; )
+      {
+        if (!found && static_cast<size_t>(scan - ptr) == distance)
+          return false;
+
+        state = anchored->next_state(state, static_cast<unsigned char>(*scan++));
+        if (state & (dfa_cache::MATCH_FLAG | dfa_cache::DEAD_FLAG))
+        {
+          if (state & dfa_cache::DEAD_FLAG)
+            break;
+
+          found = true;
+          match_end = static_cast<size_t>(scan - begin);
+          if (stop_early)
+            break;
+        }
+      }
+
+      if (found)
+      {
+        match_begin = static_cast<size_t>(ptr - begin);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Scans forwards for the end of the leftmost-first match. If `stop_early` is set, returns as
+   * soon as any match is seen. If the scan also finds the start of the match, it is stored in
+   * `match_begin`, which is otherwise set to `match::NO_POSITION`.
+   */
+  bool scan_forward(const char* begin, const char* end, bool stop_early, size_t& match_begin, size_t& match_end)
+  {
+    bool found = false;
+    match_begin = match::NO_POSITION;
+    auto state = forward.start_state();
+    if (state & dfa_cache::MATCH_FLAG)
+    {
+      found = true;
+      match_end = 0;
+      if (stop_early)
+        return true;
+    }
+
+    // the start state is only tagged if there is a prefilter, and is then never a match state
+    auto ptr = begin;
+    if ((state & dfa_cache::START_FLAG) && scan_candidates(begin, ptr, end, stop_early, match_begin, match_end))
+      return true;
+
+    while (ptr != end)
+    {
+      state = forward.next_state(state, static_cast<unsigned char>(*ptr++));
+      if (state & (dfa_cache::MATCH_FLAG | dfa_cache::DEAD_FLAG | dfa_cache::START_FLAG))
+      {
+        if (state & dfa_cache::DEAD_FLAG)
+          break;
+
+        if (state & dfa_cache::START_FLAG)
+        {
+          // any match in progress is also tracked from the next candidate, so skip ahead to it, but
+          // such a match may have started earlier, so its start must be found by the reverse scan
+          if (scan_candidates(begin, ptr, end, stop_early, match_begin, match_end))
+          {
+            match_begin = match::NO_POSITION;
+            return true;
+          }
+          continue;
+        }
+
+        found = true;
+        match_end = static_cast<size_t>(ptr - begin);
+        if (stop_early)
+          return true;
+      }
+    }
+
+    return found;
+  }
+
+  /** Scans backwards from `match_end` for the start of the longest match ending there. */
+  size_t scan_reverse(const char* begin, size_t match_end)
+  {
+    auto match_begin = match_end;
+    auto state = reverse.start_state();
+    assert(!(state & dfa_cache::DEAD_FLAG));
+
+    for (auto ptr = begin + match_end; ptr != begin; )
+    {
+      ptr--;
+      state = reverse.next_state(state, static_cast<unsigned char>(*ptr));
+      if (state & (dfa_cache::MATCH_FLAG | dfa_cache::DEAD_FLAG))
+      {
+        if (state & dfa_cache::DEAD_FLAG)
+          break;
+        match_begin = static_cast<size_t>(ptr - begin);
+      }
+    }
+
+    return match_begin;
+  }
+
+};
+
+/* -- Procedures -- */
+
+lazy_dfa::lazy_dfa(shared_ptr<const program> forward,
+                   shared_ptr<const program> reverse,
+                   size_t cache_size,
+                   shared_ptr<const prefilter> pre)
+  : impl(make_unique<implementation>(move(forward), move(reverse), cache_size, move(pre)))
+{
+}
+
+lazy_dfa::~lazy_dfa() = default;
+
+bool lazy_dfa::is_match(const char* begin, const char* end)
+{
+  size_t match_begin, match_end;
+  return impl->scan_forward(begin, end, true, match_begin, match_end);
+}
+
+bool lazy_dfa::is_match(const string& input)
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool lazy_dfa::find(const char* begin, const char* end, match& result)
+{
+  size_t match_begin, match_end;
+  if (!impl->scan_forward(begin, end, false, match_begin, match_end))
+    return false;
+
+  result.begin = (match_begin != match::NO_POSITION ? match_begin : impl->scan_reverse(begin, match_end));
+  result.end = match_end;
+  return true;
+}
+
+bool lazy_dfa::find(const string& input, match& result)
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+size_t lazy_dfa::cache_clear_count() const
+{
+  auto count = impl->forward.clear_count() + impl->reverse.clear_count();
+  if (impl->anchored != nullptr)
+    count += impl->anchored->clear_count();
+  return count;
+}
+
+size_t lazy_dfa::cache_memory_usage() const
+{
+  auto usage = impl->forward.memory_usage() + impl->reverse.memory_usage();
+  if (impl->anchored != nullptr)
+    usage += impl->anchored->memory_usage();
+  return usage;
+}
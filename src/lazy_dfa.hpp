@@ -0,0 +1,101 @@
+/**
+ * @file	lazy_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which executes compiled programs as a DFA built on the fly.
+   *
+   * DFA states and transitions are only computed for the states and bytes actually encountered in
+   * the input, and are cached so that steady-state matching costs one table lookup per byte. The
+   * cache is limited to a fixed memory budget; when it fills, it is cleared and rebuilt from the
+   * current state rather than being allowed to grow.
+   *
+   * Matches are located with a forward scan over the forward program, which finds the end of the
+   * leftmost-first match, followed by a backward scan over the reverse program from that end,
+   * which finds its start.
+   *
+   * The cache is mutable state, so a single instance must not be used by multiple threads at once.
+   */
+  class lazy_dfa
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::lazy_dfa`.
+     *
+     * @param forward The program to run forwards.
+     * @param reverse The same expression compiled in reverse.
+     * @param cache_size The maximum number of bytes to use for cached states and transitions.
+     * @param pre An optional prefilter, used to skip input whenever the forward scan is in its start
+     * state. Each candidate it finds is checked with an anchored scan before the forward scan
+     * resumes there.
+     */
+    lazy_dfa(std::shared_ptr<const regex::program> forward,
+             std::shared_ptr<const regex::program> reverse,
+             size_t cache_size,
+             std::shared_ptr<const regex::prefilter> pre = nullptr);
+
+    /** Destructor. */
+    ~lazy_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the program matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end);
+
+    /** Returns `true` if the program matches anywhere in the input string. */
+    bool is_match(const std::string& input);
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result);
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result);
+
+    /** Returns the number of times the state cache has been cleared because it was full. */
+    size_t cache_clear_count() const;
+
+    /** Returns the number of bytes currently used by the state cache. */
+    size_t cache_memory_usage() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
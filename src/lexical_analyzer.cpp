@@ -6,6 +6,8 @@
 
 /* -- Includes -- */
 
+#include <bitset>
+#include <cassert>
 #include <iterator>
 #include <memory>
 #include <sstream>
@@ -36,9 +38,228 @@ struct lexical_analyzer::implementation
 
   const std::string& input;
   std::string::const_iterator position;
+  vector<token> pending;
+  size_t pending_index = 0;
 
   /* -- Methods -- */
 
+  /** Returns `true` if the specified character may follow a backslash to stand for itself. */
+  static bool is_escapable(char ch)
+  {
+    switch (ch)
+    {
+    case '.':
+    case '(':
+    case ')':
+    case '|':
+    case '?':
+    case '*':
+    case '+':
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case '^':
+    case '-':
+    case '\\':
+      return true;
+
+    default:
+      return false;
+    }
+  }
+
+  /**
+   * If the specified character follows a backslash to name a shorthand class (`\d`, `\w`, `\s`, or
+   * their negations `\D`, `\W`, `\S`), stores the class's characters in `bitmap` and returns `true`.
+   */
+  static bool shorthand_class(char ch, bitset<256>& bitmap)
+  {
+    bitmap.reset();
+    switch (ch)
+    {
+    case 'd':
+    case 'D':
+      for (int byte = '0'; byte <= '9'; byte++)
+        bitmap.set(byte);
+      break;
+
+    case 'w':
+    case 'W':
+      for (int byte = '0'; byte <= '9'; byte++)
+        bitmap.set(byte);
+      for (int byte = 'A'; byte <= 'Z'; byte++)
+        bitmap.set(byte);
+      for (int byte = 'a'; byte <= 'z'; byte++)
+        bitmap.set(byte);
+      bitmap.set('_');
+      break;
+
+    case 's':
+    case 'S':
+      for (int byte = '\t'; byte <= '\r'; byte++)
+        bitmap.set(byte);
+      bitmap.set(' ');
+      break;
+
+    default:
+      return false;
+    }
+
+    if (ch >= 'A' && ch <= 'Z')
+      bitmap.flip();
+    return true;
+  }
+
+  /** Appends a `class_range` token to the pending tokens for each run of characters in `bitmap`. */
+  void add_class_ranges(const bitset<256>& bitmap, size_t token_position)
+  {
+    for (size_t first = 0; first < bitmap.size(); first++)
+    {
+      if (!bitmap.test(first))
+        continue;
+      auto last = first;
+      while (last + 1 < bitmap.size() && bitmap.test(last + 1))
+        last++;
+      pending.push_back(token::class_range(static_cast<unsigned char>(first), static_cast<unsigned char>(last), token_position));
+      first = last;
+    }
+  }
+
+  /**
+   * Reads a bracketed character class starting at the current position, appending an
+   * `open_class_bracket` token, a `class_range` token for each member, and a `close_class_bracket`
+   * token to the pending tokens.
+   *
+   * A `]` immediately after the opening bracket (or `^`) is a member rather than the end of the
+   * class, and a `-` which cannot form a range is a member.
+   */
+  void read_class()
+  {
+    auto start = offset(position);
+    auto end = input.cend();
+    assert(position != end && *position == '[');
+    position++;
+
+    bool negated = (position != end && *position == '^');
+    if (negated)
+      position++;
+    pending.push_back(token::open_class_bracket(negated, start));
+
+    // reads a single class member, returning `false` if it was a shorthand class, which was added
+    auto read_member = [this, end] (unsigned char& ch) -> bool {
+      if (*position != '\\')
+      {
+        ch = static_cast<unsigned char>(*position++);
+        return true;
+      }
+
+      auto escape = offset(position);
+      if (++position == end)
+        throw_syntax_error(escape, "Escape character at end of string.");
+
+      bitset<256> bitmap;
+      if (shorthand_class(*position, bitmap))
+      {
+        position++;
+        add_class_ranges(bitmap, escape);
+        return false;
+      }
+      if (!is_escapable(*position))
+        throw_syntax_error(escape, "Unrecognized escape sequence.");
+      ch = static_cast<unsigned char>(*position++);
+      return true;
+    };
+
+    for (bool first = true; ; first = false)
+    {
+      if (position == end)
+        throw_syntax_error(start, "Unterminated character class.");
+
+      if (*position == ']' && !first)
+      {
+        pending.push_back(token(token_type::close_class_bracket, offset(position)));
+        position++;
+        return;
+      }
+
+      // a dash followed by the closing bracket is a literal dash
+      auto member = offset(position);
+      unsigned char low = 0;
+      bool literal = read_member(low);
+      bool range = (position != end && *position == '-' && position + 1 != end && *(position + 1) != ']');
+      if (range && !literal)
+        throw_syntax_error(member, "Shorthand class cannot bound a range.");
+      if (!literal)
+        continue;
+
+      if (range)
+      {
+        position++;
+        unsigned char high = 0;
+        if (!read_member(high))
+          throw_syntax_error(member, "Shorthand class cannot bound a range.");
+        if (high < low)
+          throw_syntax_error(member, "Character class range is out of order.");
+        pending.push_back(token::class_range(low, high, member));
+      }
+      else
+        pending.push_back(token::class_range(low, low, member));
+    }
+  }
+
+  /** Returns the offset of the specified position in the input. */
+  size_t offset(string::const_iterator ptr) const
+  {
+    return static_cast<size_t>(distance(input.cbegin(), ptr));
+  }
+
+  /**
+   * Reads a quantifier of the form `{n}`, `{m,}` or `{m,n}` starting at the current position. If one
+   * is present, its bounds are stored in `min_count` and `max_count` and the position just past it is
+   * returned; otherwise, the current position is returned.
+   */
+  string::const_iterator read_quantifier(size_t& min_count, size_t& max_count) const
+  {
+    auto ptr = position;
+    auto end = input.cend();
+
+    // reads a decimal count, returning `false` if there are no digits
+    auto read_count = [&ptr, end, this] (size_t& count) -> bool {
+      auto begin = ptr;
+      count = 0;
+      for (; ptr != end && *ptr >= '0' && *ptr <= '9'; ptr++)
+      {
+        count = count * 10 + static_cast<size_t>(*ptr - '0');
+        if (count > lexical_analyzer::MAX_REPETITION)
+          throw_syntax_error(distance(input.cbegin(), begin),
+                             "Repetition count exceeds " + to_string(lexical_analyzer::MAX_REPETITION) + ".");
+      }
+      return (ptr != begin);
+    };
+
+    assert(ptr != end && *ptr == '{');
+    ptr++;
+    if (!read_count(min_count))
+      return position;
+
+    if (ptr != end && *ptr == ',')
+    {
+      ptr++;
+      if (!read_count(max_count))
+        max_count = token::UNBOUNDED;
+    }
+    else
+      max_count = min_count;
+
+    if (ptr == end || *ptr != '}')
+      return position;
+
+    if (max_count < min_count)
+      throw_syntax_error(distance(input.cbegin(), position), "Repetition range is out of order.");
+    return ++ptr;
+  }
+
   /** Throws a syntax error. */
   [[noreturn]] static void throw_syntax_error(size_t position, const string& error_message)
   {
@@ -51,6 +272,9 @@ struct lexical_analyzer::implementation
 
 /* -- Procedures -- */
 
+const size_t token::UNBOUNDED;
+const size_t lexical_analyzer::MAX_REPETITION;
+
 lexical_analyzer::lexical_analyzer(const std::string& input)
   : impl(make_unique<implementation>(input))
 {
@@ -58,20 +282,24 @@ lexical_analyzer::lexical_analyzer(const std::string& input)
 
 lexical_analyzer::~lexical_analyzer() = default;
 
-vector<unique_ptr<const token>> lexical_analyzer::all_tokens()
+vector<token> lexical_analyzer::all_tokens()
 {
-  vector<unique_ptr<const token>> tokens;
-  while (true)
+  vector<token> tokens;
+  all_tokens(tokens);
+  return tokens;
+}
+
+void lexical_analyzer::all_tokens(vector<token>& tokens)
+{
+  tokens.clear();
+  do
   {
-    auto tok = next_token();
-    tokens.push_back(move(tok));
-    if (tokens.back()->type() == token_type::eof)
-      break;
+    tokens.push_back(next_token());
   }
-  return tokens;
+  while (tokens.back().type() != token_type::eof);
 }
 
-unique_ptr<const token> lexical_analyzer::next_token()
+token lexical_analyzer::next_token()
 {
   // skip a character
   auto skip = [this] () -> void {
@@ -88,9 +316,15 @@ unique_ptr<const token> lexical_analyzer::next_token()
     return distance(this->impl->input.cbegin(), this->impl->position);
   };
 
+  // return tokens already read as part of a character class
+  if (impl->pending_index != impl->pending.size())
+    return impl->pending[impl->pending_index++];
+  impl->pending.clear();
+  impl->pending_index = 0;
+
   // return EOF if we're out of input
   if (impl->position == impl->input.cend())
-    return make_unique<eof_token>(get_position());
+    return token(token_type::eof, get_position());
 
   switch (*impl->position)
   {
@@ -99,49 +333,80 @@ unique_ptr<const token> lexical_analyzer::next_token()
   {
     auto position = get_position();
     skip();
-    return make_unique<wildcard_token>(position);
+    return token(token_type::wildcard, position);
   }
 
   case '(':
   {
+    // a group beginning with "?:" only groups its contents, without capturing them
     auto position = get_position();
     skip();
-    return make_unique<open_bracket_token>(position);
+    auto rest = impl->input.cend() - impl->position;
+    bool capturing = !(rest >= 2 && *impl->position == '?' && *(impl->position + 1) == ':');
+    if (!capturing)
+    {
+      skip();
+      skip();
+    }
+    return token::open_bracket(capturing, position);
   }
 
   case ')':
   {
     auto position = get_position();
     skip();
-    return make_unique<close_bracket_token>(position);
+    return token(token_type::close_bracket, position);
   }
 
   case '|':
   {
     auto position = get_position();
     skip();
-    return make_unique<alternation_operator_token>(position);
+    return token(token_type::alternation_operator, position);
   }
 
   case '?':
   {
     auto position = get_position();
     skip();
-    return make_unique<optional_operator_token>(position);
+    return token(token_type::optional_operator, position);
   }
 
   case '*':
   {
     auto position = get_position();
     skip();
-    return make_unique<kleene_operator_token>(position);
+    return token(token_type::kleene_operator, position);
   }
 
   case '+':
   {
     auto position = get_position();
     skip();
-    return make_unique<repeat_operator_token>(position);
+    return token(token_type::repeat_operator, position);
+  }
+
+  case '{':
+  {
+    // a brace which does not begin a valid quantifier is an ordinary literal
+    size_t min_count = 0;
+    size_t max_count = 0;
+    auto position = get_position();
+    auto end = impl->read_quantifier(min_count, max_count);
+    if (end == impl->position)
+    {
+      skip();
+      return token::literal('{', position);
+    }
+
+    impl->position = end;
+    return token::quantifier(min_count, max_count, position);
+  }
+
+  case '[':
+  {
+    impl->read_class();
+    return impl->pending[impl->pending_index++];
   }
 
   case '\\':
@@ -150,27 +415,27 @@ unique_ptr<const token> lexical_analyzer::next_token()
     if (next == impl->input.cend())
       implementation::throw_syntax_error(get_position(), "Escape character at end of string.");
 
-    switch (*next)
-    {
-    case '.':
-    case '(':
-    case ')':
-    case '|':
-    case '?':
-    case '*':
-    case '+':
-    case '\\':
+    // a shorthand class is equivalent to the bracketed class of the same characters
+    bitset<256> bitmap;
+    if (implementation::shorthand_class(*next, bitmap))
     {
-      skip();
-      auto character = get_character();
       auto position = get_position();
       skip();
-      return make_unique<literal_token>(character, position);
+      skip();
+      impl->pending.push_back(token::open_class_bracket(false, position));
+      impl->add_class_ranges(bitmap, position);
+      impl->pending.push_back(token(token_type::close_class_bracket, position));
+      return impl->pending[impl->pending_index++];
     }
 
-    default:
+    if (!implementation::is_escapable(*next))
       implementation::throw_syntax_error(get_position(), "Unrecognized escape sequence.");
-    }
+
+    skip();
+    auto character = get_character();
+    auto position = get_position();
+    skip();
+    return token::literal(character, position);
   }
 
   default:
@@ -178,7 +443,7 @@ unique_ptr<const token> lexical_analyzer::next_token()
     auto character = get_character();
     auto position = get_position();
     skip();
-    return make_unique<literal_token>(character, position);
+    return token::literal(character, position);
   }
 
   }
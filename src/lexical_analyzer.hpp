@@ -40,6 +40,13 @@ namespace regex
   class lexical_analyzer
   {
 
+    /* -- Constants -- */
+
+  public:
+
+    /** The largest repetition count which may appear in a quantifier. */
+    static const size_t MAX_REPETITION = 1000;
+
     /* -- Lifecycle -- */
 
   public:
@@ -60,7 +67,16 @@ namespace regex
      * @exception regex::lexical_error
      * Thrown if a token cannot be read from the current position.
      */
-    std::vector<std::unique_ptr<const regex::token>> all_tokens();
+    std::vector<regex::token> all_tokens();
+
+    /**
+     * Extracts all tokens from the input string into the specified buffer, replacing its contents.
+     * No memory is allocated if the buffer already has sufficient capacity.
+     *
+     * @exception regex::lexical_error
+     * Thrown if a token cannot be read from the current position.
+     */
+    void all_tokens(std::vector<regex::token>& tokens);
 
     /**
      * Extracts the next token from the input string.
@@ -68,7 +84,7 @@ namespace regex
      * @exception regex::lexical_error
      * Thrown if a token cannot be read from the current position.
      */
-    std::unique_ptr<const regex::token> next_token();
+    regex::token next_token();
 
     /* -- Implementation -- */
 
@@ -6,40 +6,472 @@
 
 /* -- Includes -- */
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <exception>
 #include <iostream>
 #include <string>
+#include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compiler.hpp"
 #include "lexical_analyzer.hpp"
-#include "syntax.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "program.hpp"
 #include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
 
 /* -- Namespaces -- */
 
 using namespace std;
 using namespace regex;
 
+/* -- Constants -- */
+
+namespace
+{
+
+  /** The number of bytes requested by each read, for inputs which cannot be mapped. */
+  const size_t READ_SIZE = (4 << 20);
+
+  /** The size of the buffer used for standard output. */
+  const size_t OUTPUT_BUFFER_SIZE = (64 << 10);
+
+  /** Exit status if any line was selected. */
+  const int EXIT_MATCH = 0;
+
+  /** Exit status if no line was selected. */
+  const int EXIT_NO_MATCH = 1;
+
+  /** Exit status if an error occurred. */
+  const int EXIT_ERROR = 2;
+
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /**
+   * Struct containing the command line options.
+   */
+  struct grep_options
+  {
+    bool count = false;
+    bool files_with_matches = false;
+    bool line_numbers = false;
+    bool only_matching = false;
+    bool quiet = false;
+    bool invert = false;
+    bool dump = false;
+    int with_filename = -1;
+  };
+
+  /**
+   * Class which searches inputs for lines matching a pattern, and prints them.
+   *
+   * Rather than matching line by line, each block of input is searched as a whole, and line
+   * boundaries are only located around the matches found. Since the pattern is compiled so that no
+   * wildcard or class matches a newline, a match can only span lines if the expression contains a
+   * newline itself. Blocks always consist of whole lines.
+   */
+  class searcher
+  {
+  public:
+
+    searcher(const pattern& pat, const grep_options& options)
+      : m_pattern(pat),
+        m_options(options),
+        m_selected(false)
+    { }
+
+    /** Returns `true` if any line has been selected in any input. */
+    bool selected() const
+    {
+      return m_selected;
+    }
+
+    /** Prepares to search a new input with the specified display name. */
+    void begin_input(const string& name)
+    {
+      m_name = name;
+      m_line_number = 1;
+      m_selected_lines = 0;
+      m_done = false;
+    }
+
+    /** Finishes the current input, printing its count if requested. */
+    void end_input()
+    {
+      if (m_options.quiet || m_options.files_with_matches)
+        return;
+      if (m_options.count)
+      {
+        if (m_options.with_filename)
+          cout << m_name << ':';
+        cout << m_selected_lines << '\n';
+      }
+    }
+
+    /** Returns `true` if nothing more needs to be read from the current input. */
+    bool done() const
+    {
+      return m_done;
+    }
+
+    /** Searches a block of whole lines from the current input. */
+    void search(const char* begin, const char* end)
+    {
+      m_counted = begin;
+      const char* pos = begin;
+      while (pos < end && !m_done)
+      {
+        match result { 0, 0 };
+        if (!m_pattern.find(pos, end, result))
+          break;
+
+        const char* match_begin = pos + result.begin;
+        const char* match_end = pos + result.end;
+
+        // an empty match after the final newline is not on any line
+        if (match_begin == end && end[-1] == '\n')
+          break;
+
+        auto line_begin = static_cast<const char*>(memrchr(pos, '\n', static_cast<size_t>(match_begin - pos)));
+        line_begin = (line_begin == nullptr ? pos : line_begin + 1);
+        auto line_end = find_line_end(match_end > match_begin ? match_end - 1 : match_begin, end);
+
+        if (m_options.invert)
+          select_lines(pos, line_begin);
+        else if (m_options.only_matching)
+        {
+          // print this match, then look for the next one, on this line or a later one
+          if (match_end != match_begin)
+            select(line_begin, match_begin, match_end);
+          pos = (match_end == match_begin ? match_end + 1 : match_end);
+          continue;
+        }
+        else
+          select(line_begin, line_begin, line_end);
+
+        pos = (line_end == end ? end : line_end + 1);
+      }
+
+      if (m_options.invert && pos < end && !m_done)
+        select_lines(pos, end);
+
+      // keep the line count current for the next block
+      if (m_options.line_numbers)
+        line_number(end);
+    }
+
+  private:
+
+    const pattern& m_pattern;
+    const grep_options& m_options;
+    bool m_selected;
+    string m_name;
+    size_t m_line_number;
+    size_t m_selected_lines;
+    const char* m_counted;
+    bool m_done;
+
+    /** Returns the newline ending the line containing `pos`, or `end` if it is unterminated. */
+    static const char* find_line_end(const char* pos, const char* end)
+    {
+      auto newline = static_cast<const char*>(memchr(pos, '\n', static_cast<size_t>(end - pos)));
+      return (newline == nullptr ? end : newline);
+    }
+
+    /** Returns the number of the line starting at `pos`, counting forwards from the last call. */
+    size_t line_number(const char* pos)
+    {
+      m_line_number += static_cast<size_t>(count(m_counted, pos, '\n'));
+      m_counted = pos;
+      return m_line_number;
+    }
+
+    /** Selects every line in the range `[begin, end)`, which begins at the start of a line. */
+    void select_lines(const char* begin, const char* end)
+    {
+      while (begin < end && !m_done)
+      {
+        auto line_end = find_line_end(begin, end);
+        select(begin, begin, line_end);
+        begin = line_end + 1;
+      }
+    }
+
+    /**
+     * Selects the line, or lines, starting at `line_begin`, printing the text `[begin, end)` unless
+     * only counts or file names are to be printed.
+     */
+    void select(const char* line_begin, const char* begin, const char* end)
+    {
+      m_selected = true;
+      m_selected_lines += 1 + static_cast<size_t>(count(begin, end, '\n'));
+
+      if (m_options.quiet || m_options.files_with_matches)
+      {
+        if (!m_options.quiet)
+          cout << m_name << '\n';
+        m_done = true;
+        return;
+      }
+      if (m_options.count)
+        return;
+
+      if (m_options.with_filename)
+        cout << m_name << ':';
+      if (m_options.line_numbers)
+        cout << line_number(line_begin) << ':';
+      cout.write(begin, end - begin);
+      cout << '\n';
+    }
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace
+{
+
+  /** Prints the usage message to standard error. */
+  void print_usage();
+
+  /** Parses the command line options, returning the index of the first operand, or `-1` on error. */
+  int parse_options(int argc, char** argv, grep_options& options);
+
+  /** Prints the syntax tree and program compiled from the specified expression. */
+  void dump_expression(const string& expression);
+
+  /** Searches the named file, or standard input for `-`. Returns `false` if it could not be read. */
+  bool search_file(const string& name, searcher& search);
+
+  /** Searches the open file by mapping it into memory. Returns `false` if it cannot be mapped. */
+  bool search_mapped(int fd, searcher& search);
+
+  /** Searches the open file by reading it in large blocks. Returns `false` if a read fails. */
+  bool search_buffered(int fd, searcher& search);
+
+}
+
 /* -- Procedures -- */
 
 int main(int argc, char** argv)
 {
+  grep_options options;
+  int first = parse_options(argc, argv, options);
+  if (first < 0 || first >= argc)
+  {
+    print_usage();
+    return EXIT_ERROR;
+  }
+
+  string expression = argv[first++];
+  vector<string> files(argv + first, argv + argc);
+  if (files.empty())
+    files.push_back("-");
+  if (options.with_filename < 0)
+    options.with_filename = (files.size() > 1);
+
   try
   {
-    static const string INPUT = "\\?\\\\\\*\\++a?\\?";
+    if (options.dump)
+    {
+      dump_expression(expression);
+      return EXIT_MATCH;
+    }
 
-    cout << "Regex: " << INPUT << endl;
+    pattern_options compile_options;
+    compile_options.match_newline = false;
+    pattern pat(expression, compile_options);
 
-    lexical_analyzer lex(INPUT);
-    syntax_analyzer parse(lex.all_tokens());
+    static char output_buffer[OUTPUT_BUFFER_SIZE];
+    ios::sync_with_stdio(false);
+    cout.rdbuf()->pubsetbuf(output_buffer, sizeof(output_buffer));
 
-    auto regex = parse.parse_regex();
-    print_syntax_tree(regex);
+    searcher search(pat, options);
+    bool error = false;
+    for (const auto& name : files)
+    {
+      if (!search_file(name, search))
+        error = true;
+      if (options.quiet && search.selected())
+        break;
+    }
+    cout.flush();
 
-    return 0;
+    if (error && !(options.quiet && search.selected()))
+      return EXIT_ERROR;
+    return (search.selected() ? EXIT_MATCH : EXIT_NO_MATCH);
   }
   catch (const exception& ex)
   {
-    cerr << ex.what() << endl;
-    return 1;
+    cerr << "regex: " << ex.what() << endl;
+    return EXIT_ERROR;
+  }
+}
+
+namespace
+{
+
+  void print_usage()
+  {
+    cerr << "usage: regex [-cHhlnoqv] [--dump] pattern [file ...]" << endl
+         << endl
+         << "  -c      print only the number of selected lines in each file" << endl
+         << "  -H      print the file name with each line" << endl
+         << "  -h      never print file names" << endl
+         << "  -l      print only the names of files with selected lines" << endl
+         << "  -n      print the line number with each line" << endl
+         << "  -o      print only the matched part of each line" << endl
+         << "  -q      print nothing, and stop at the first selected line" << endl
+         << "  -v      select lines which do not match" << endl
+         << "  --dump  print the syntax tree and program for the pattern" << endl;
+  }
+
+  int parse_options(int argc, char** argv, grep_options& options)
+  {
+    int index = 1;
+    for (; index < argc; index++)
+    {
+      string arg = argv[index];
+      if (arg == "--")
+        return index + 1;
+      if (arg == "--dump")
+      {
+        options.dump = true;
+        continue;
+      }
+      if (arg.size() < 2 || arg[0] != '-' || arg[1] == '-')
+        break;
+
+      for (size_t idx = 1; idx < arg.size(); idx++)
+      {
+        switch (arg[idx])
+        {
+        case 'c': options.count = true; break;
+        case 'H': options.with_filename = 1; break;
+        case 'h': options.with_filename = 0; break;
+        case 'l': options.files_with_matches = true; break;
+        case 'n': options.line_numbers = true; break;
+        case 'o': options.only_matching = true; break;
+        case 'q': options.quiet = true; break;
+        case 'v': options.invert = true; break;
+        default:
+          cerr << "regex: unknown option -" << arg[idx] << endl;
+          return -1;
+        }
+      }
+    }
+    return index;
   }
+
+  void dump_expression(const string& expression)
+  {
+    cout << "Regex: " << expression << endl;
+
+    lexical_analyzer lex(expression);
+    syntax_analyzer parse(lex.all_tokens());
+
+    auto tree = parse.parse_tree();
+    print_syntax_tree(tree);
+
+    auto prog = compile(tree);
+    print_program(*prog);
+  }
+
+  bool search_file(const string& name, searcher& search)
+  {
+    bool is_stdin = (name == "-");
+    int fd = (is_stdin ? STDIN_FILENO : open(name.c_str(), O_RDONLY));
+    if (fd < 0)
+    {
+      cerr << "regex: " << name << ": " << strerror(errno) << endl;
+      return false;
+    }
+
+    search.begin_input(is_stdin ? "(standard input)" : name);
+    bool ok = (search_mapped(fd, search) || search_buffered(fd, search));
+    search.end_input();
+
+    if (!ok)
+      cerr << "regex: " << name << ": " << strerror(errno) << endl;
+    if (!is_stdin)
+      close(fd);
+    return ok;
+  }
+
+  bool search_mapped(int fd, searcher& search)
+  {
+    // only regular files can be mapped; pipes and terminals must be read
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+      return false;
+
+    // files such as those in /proc report a size of zero but still have contents, so they are read
+    if (info.st_size == 0)
+      return false;
+
+    auto size = static_cast<size_t>(info.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+      return false;
+    madvise(data, size, MADV_SEQUENTIAL);
+
+    auto begin = static_cast<const char*>(data);
+    search.search(begin, begin + size);
+    munmap(data, size);
+    return true;
+  }
+
+  bool search_buffered(int fd, searcher& search)
+  {
+    // each block is searched up to its last newline, and the partial line after it is carried over
+    vector<char> buffer(READ_SIZE);
+    size_t filled = 0;
+    for (;;)
+    {
+      if (buffer.size() - filled < READ_SIZE)
+        buffer.resize(filled + READ_SIZE);
+
+      auto count = read(fd, buffer.data() + filled, READ_SIZE);
+      if (count < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        return false;
+      }
+      if (count == 0)
+        break;
+      filled += static_cast<size_t>(count);
+
+      auto newline = static_cast<const char*>(memrchr(buffer.data(), '\n', filled));
+      if (newline == nullptr)
+        continue;
+
+      size_t length = static_cast<size_t>(newline - buffer.data()) + 1;
+      search.search(buffer.data(), buffer.data() + length);
+      if (search.done())
+        return true;
+
+      copy(buffer.begin() + length, buffer.begin() + filled, buffer.begin());
+      filled -= length;
+    }
+
+    if (filled != 0)
+      search.search(buffer.data(), buffer.data() + filled);
+    return true;
+  }
+
 }
@@ -0,0 +1,52 @@
+/**
+ * @file	match.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Struct representing the location of a match within the searched input.
+   *
+   * Positions are byte offsets from the beginning of the input, with `end` being exclusive. A capture
+   * group which did not participate in a match has both positions set to `NO_POSITION`.
+   */
+  struct match
+  {
+    /** Position value indicating that a group did not participate in a match. */
+    static const size_t NO_POSITION = SIZE_MAX;
+
+    size_t begin;
+    size_t end;
+  };
+
+  /**
+   * Converts the capture slots recorded by an engine into one match per group, where group 0 is the
+   * overall match. Groups whose slots were not both recorded are reported as not participating.
+   */
+  inline void slots_to_groups(const size_t* slots, size_t slot_count, std::vector<regex::match>& groups)
+  {
+    groups.resize(slot_count / 2);
+    for (size_t idx = 0; idx < groups.size(); idx++)
+    {
+      auto begin = slots[2 * idx];
+      auto end = slots[2 * idx + 1];
+      if (begin == regex::match::NO_POSITION || end == regex::match::NO_POSITION)
+        begin = end = regex::match::NO_POSITION;
+      groups[idx] = regex::match { begin, end };
+    }
+  }
+
+}
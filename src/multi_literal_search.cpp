@@ -0,0 +1,328 @@
+/**
+ * @file	multi_literal_search.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "multi_literal_search.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define REGEX_MULTI_LITERAL_X86 1
+#include <immintrin.h>
+#endif
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** Transition table entry for a trie edge which does not exist. */
+  const uint32_t NO_STATE = 0xFFFFFFFF;
+
+}
+
+/* -- Procedures -- */
+
+aho_corasick::aho_corasick(const vector<string>& literals)
+  : m_classes(256, 0),
+    m_stride(1)
+{
+  // every byte appearing in a literal gets its own column, and all other bytes share column 0
+  for (const auto& literal : literals)
+  {
+    assert(!literal.empty());
+    for (auto ch : literal)
+    {
+      auto byte = static_cast<unsigned char>(ch);
+      if (m_classes[byte] == 0)
+        m_classes[byte] = m_stride++;
+    }
+  }
+
+  // build the trie
+  m_transitions.assign(m_stride, NO_STATE);
+  m_depth.push_back(0);
+  m_output_length.push_back(0);
+  m_literal.push_back(NO_STATE);
+  for (size_t idx = 0; idx < literals.size(); idx++)
+  {
+    const auto& literal = literals[idx];
+    uint32_t state = 0;
+    for (auto ch : literal)
+    {
+      auto& next = m_transitions[state * m_stride + m_classes[static_cast<unsigned char>(ch)]];
+      if (next == NO_STATE)
+      {
+        next = static_cast<uint32_t>(m_depth.size());
+        m_depth.push_back(m_depth[state] + 1);
+        m_output_length.push_back(0);
+        m_literal.push_back(NO_STATE);
+        m_transitions.resize(m_transitions.size() + m_stride, NO_STATE);
+      }
+      state = m_transitions[state * m_stride + m_classes[static_cast<unsigned char>(ch)]];
+    }
+    m_output_length[state] = m_depth[state];
+    if (m_literal[state] == NO_STATE)
+      m_literal[state] = static_cast<uint32_t>(idx);
+  }
+
+  // compute failure links breadth first, replacing missing edges with the failure state's edges so
+  // that the result is a complete DFA
+  vector<uint32_t> failure(m_depth.size(), 0);
+  queue<uint32_t> pending;
+  for (uint32_t cls = 0; cls < m_stride; cls++)
+  {
+    auto& next = m_transitions[cls];
+    if (next == NO_STATE)
+      next = 0;
+    else
+      pending.push(next);
+  }
+
+  while (!pending.empty())
+  {
+    auto state = pending.front();
+    pending.pop();
+
+    // a literal ending at the failure state also ends here, but the state's own literal is longer
+    if (m_output_length[state] == 0)
+      m_output_length[state] = m_output_length[failure[state]];
+
+    for (uint32_t cls = 0; cls < m_stride; cls++)
+    {
+      auto& next = m_transitions[state * m_stride + cls];
+      auto fallback = m_transitions[failure[state] * m_stride + cls];
+      if (next == NO_STATE)
+        next = fallback;
+      else
+      {
+        failure[next] = fallback;
+        pending.push(next);
+      }
+    }
+  }
+}
+
+const char* aho_corasick::find(const char* begin, const char* end) const
+{
+  const uint32_t* transitions = m_transitions.data();
+  const uint32_t* classes = m_classes.data();
+  const char* best = end;
+
+  uint32_t state = 0;
+  for (auto ptr = begin; ptr != end; )
+  {
+    state = transitions[state * m_stride + classes[static_cast<unsigned char>(*ptr++)]];
+    if (m_output_length[state] != 0)
+      best = min(best, ptr - m_output_length[state]);
+
+    // the depth of the current state bounds how far back any literal still in progress can start,
+    // so once that is past the best match, no earlier match is possible
+    if (best != end && ptr - m_depth[state] >= best)
+      break;
+  }
+
+  return best;
+}
+
+bool aho_corasick::is_match(const char* begin, const char* end) const
+{
+  return (find(begin, end) != end);
+}
+
+bool aho_corasick::find(const char* begin, const char* end, match& result) const
+{
+  auto start = find(begin, end);
+  if (start == end)
+    return false;
+
+  // every literal occurring at the start is a path through the trie from the root, and each trie
+  // edge leads one level deeper, unlike the edges added for failures
+  uint32_t state = 0;
+  uint32_t best = NO_STATE;
+  for (auto ptr = start; ptr != end; )
+  {
+    auto next = m_transitions[state * m_stride + m_classes[static_cast<unsigned char>(*ptr++)]];
+    if (m_depth[next] != m_depth[state] + 1)
+      break;
+
+    state = next;
+    if (m_literal[state] < best)
+    {
+      best = m_literal[state];
+      result.end = static_cast<size_t>(ptr - begin);
+    }
+  }
+
+  result.begin = static_cast<size_t>(start - begin);
+  return true;
+}
+
+size_t aho_corasick::memory_usage() const
+{
+  auto words = m_classes.capacity() + m_transitions.capacity() + m_depth.capacity() + m_output_length.capacity() +
+    m_literal.capacity();
+  return words * sizeof(uint32_t);
+}
+
+packed_searcher::packed_searcher(const vector<string>& literals)
+  : m_literals(literals)
+{
+  assert(!literals.empty() && literals.size() <= MAX_LITERALS);
+
+  // sort the literals so that similar ones share buckets, which keeps the fingerprints selective
+  sort(m_literals.begin(), m_literals.end());
+
+  m_fingerprint = MAX_FINGERPRINT;
+  for (const auto& literal : m_literals)
+  {
+    assert(!literal.empty());
+    m_fingerprint = min(m_fingerprint, literal.size());
+  }
+
+  memset(m_low_masks, 0, sizeof(m_low_masks));
+  memset(m_high_masks, 0, sizeof(m_high_masks));
+  for (size_t idx = 0; idx < m_literals.size(); idx++)
+  {
+    auto bucket = idx * BUCKET_COUNT / m_literals.size();
+    m_buckets[bucket].push_back(static_cast<uint32_t>(idx));
+    for (size_t offset = 0; offset < m_fingerprint; offset++)
+    {
+      auto byte = static_cast<unsigned char>(m_literals[idx][offset]);
+      m_low_masks[offset][byte & 0x0F] |= static_cast<uint8_t>(1 << bucket);
+      m_high_masks[offset][byte >> 4] |= static_cast<uint8_t>(1 << bucket);
+    }
+  }
+}
+
+size_t packed_searcher::memory_usage() const
+{
+  size_t usage = m_literals.capacity() * sizeof(string);
+  for (const auto& literal : m_literals)
+    usage += literal.capacity();
+  for (const auto& bucket : m_buckets)
+    usage += bucket.capacity() * sizeof(uint32_t);
+  return usage;
+}
+
+bool packed_searcher::is_supported()
+{
+#if REGEX_MULTI_LITERAL_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("ssse3");
+#else
+  return false;
+#endif
+}
+
+const char* packed_searcher::find(const char* begin, const char* end) const
+{
+  auto ptr = begin;
+  auto found = find_packed(begin, end, ptr);
+  if (found != nullptr)
+    return found;
+
+  for (; static_cast<size_t>(end - ptr) >= m_fingerprint; ptr++)
+  {
+    auto buckets = candidate_buckets(ptr);
+    if (buckets != 0 && verify(ptr, end, buckets))
+      return ptr;
+  }
+  return end;
+}
+
+uint8_t packed_searcher::candidate_buckets(const char* ptr) const
+{
+  uint8_t buckets = 0xFF;
+  for (size_t offset = 0; offset < m_fingerprint; offset++)
+  {
+    auto byte = static_cast<unsigned char>(ptr[offset]);
+    buckets &= (m_low_masks[offset][byte & 0x0F] & m_high_masks[offset][byte >> 4]);
+  }
+  return buckets;
+}
+
+bool packed_searcher::verify(const char* ptr, const char* end, uint8_t buckets) const
+{
+  auto available = static_cast<size_t>(end - ptr);
+  for (; buckets != 0; buckets &= static_cast<uint8_t>(buckets - 1))
+  {
+    for (auto idx : m_buckets[__builtin_ctz(buckets)])
+    {
+      const auto& literal = m_literals[idx];
+      if (literal.size() <= available && memcmp(ptr, literal.data(), literal.size()) == 0)
+        return true;
+    }
+  }
+  return false;
+}
+
+#if REGEX_MULTI_LITERAL_X86
+
+__attribute__((target("ssse3")))
+const char* packed_searcher::find_packed(const char* begin, const char* end, const char*& resume) const
+{
+  const __m128i nibble_mask = _mm_set1_epi8(0x0F);
+  __m128i low_masks[MAX_FINGERPRINT];
+  __m128i high_masks[MAX_FINGERPRINT];
+  for (size_t offset = 0; offset < m_fingerprint; offset++)
+  {
+    low_masks[offset] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_low_masks[offset]));
+    high_masks[offset] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_high_masks[offset]));
+  }
+
+  alignas(16) uint8_t buckets[16];
+  auto ptr = begin;
+  for (; static_cast<size_t>(end - ptr) >= 16 + m_fingerprint - 1; ptr += 16)
+  {
+    // each byte of the result holds the buckets which may have a literal starting at that position
+    __m128i candidates = _mm_set1_epi8(static_cast<char>(0xFF));
+    for (size_t offset = 0; offset < m_fingerprint; offset++)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr + offset));
+      __m128i low = _mm_shuffle_epi8(low_masks[offset], _mm_and_si128(chunk, nibble_mask));
+      __m128i high = _mm_shuffle_epi8(high_masks[offset], _mm_and_si128(_mm_srli_epi16(chunk, 4), nibble_mask));
+      candidates = _mm_and_si128(candidates, _mm_and_si128(low, high));
+    }
+
+    auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(candidates, _mm_setzero_si128()))) ^ 0xFFFF;
+    if (mask == 0)
+      continue;
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(buckets), candidates);
+    for (; mask != 0; mask &= mask - 1)
+    {
+      auto offset = __builtin_ctz(mask);
+      if (verify(ptr + offset, end, buckets[offset]))
+        return ptr + offset;
+    }
+  }
+
+  resume = ptr;
+  return nullptr;
+}
+
+#else
+
+const char* packed_searcher::find_packed(const char* begin, const char* end, const char*& resume) const
+{
+  resume = begin;
+  return nullptr;
+}
+
+#endif
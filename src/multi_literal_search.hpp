@@ -0,0 +1,158 @@
+/**
+ * @file	multi_literal_search.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which finds the first occurrence of any of a set of literal strings using the Aho-Corasick
+   * automaton.
+   *
+   * The automaton is stored as a dense transition table over the bytes which actually appear in the
+   * literals, with all other bytes sharing a single column, so scanning costs one table lookup per
+   * byte regardless of the number of literals.
+   *
+   * It can also serve as the matching engine for an expression which is just an alternation of
+   * literals, reporting the same leftmost-first matches as the expression.
+   */
+  class aho_corasick
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Builds a new `regex::aho_corasick` for the specified non-empty literals. */
+    explicit aho_corasick(const std::vector<std::string>& literals);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns a pointer to the start of the leftmost occurrence of any literal in `[begin, end)`, or
+     * `end` if there is none.
+     */
+    const char* find(const char* begin, const char* end) const;
+
+    /** Returns `true` if any literal occurs in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /**
+     * Finds the leftmost occurrence of any literal in the input range. If several literals occur
+     * there, the one given first to the constructor is chosen, as for an alternation of them.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /** Returns the number of states in the automaton. */
+    size_t state_count() const
+    {
+      return m_depth.size();
+    }
+
+    /** Returns the estimated number of bytes used by the automaton's tables. */
+    size_t memory_usage() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    std::vector<uint32_t> m_classes;
+    uint32_t m_stride;
+    std::vector<uint32_t> m_transitions;
+    std::vector<uint32_t> m_depth;
+    std::vector<uint32_t> m_output_length;
+    std::vector<uint32_t> m_literal;
+
+  };
+
+  /**
+   * Class which finds the first occurrence of any of a small set of literal strings by testing 16
+   * positions at once with packed SIMD shuffles.
+   *
+   * Literals are divided among 8 buckets. The low and high nibbles of each of the first few bytes
+   * of the input at each position are used to look up which buckets have a literal with that
+   * nibble at that offset, and only positions at which some bucket survives every lookup are
+   * verified against that bucket's literals. This requires SSSE3; `is_supported()` should be
+   * checked before construction.
+   */
+  class packed_searcher
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The maximum number of literals supported. */
+    static const size_t MAX_LITERALS = 32;
+
+    /** The maximum number of leading bytes used to select candidate positions. */
+    static const size_t MAX_FINGERPRINT = 3;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Builds a new `regex::packed_searcher` for the specified non-empty literals. */
+    explicit packed_searcher(const std::vector<std::string>& literals);
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the current CPU supports the packed searcher. */
+    static bool is_supported();
+
+    /**
+     * Returns a pointer to the start of the leftmost occurrence of any literal in `[begin, end)`, or
+     * `end` if there is none.
+     */
+    const char* find(const char* begin, const char* end) const;
+
+    /** Returns the estimated number of bytes used by the literals and their buckets. */
+    size_t memory_usage() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    static const size_t BUCKET_COUNT = 8;
+
+    std::vector<std::string> m_literals;
+    std::vector<uint32_t> m_buckets[BUCKET_COUNT];
+    size_t m_fingerprint;
+    uint8_t m_low_masks[MAX_FINGERPRINT][16];
+    uint8_t m_high_masks[MAX_FINGERPRINT][16];
+
+    /** Returns the buckets which may have a literal starting at `ptr`, using scalar lookups. */
+    uint8_t candidate_buckets(const char* ptr) const;
+
+    /** Returns `true` if a literal in one of the specified buckets starts at `ptr`. */
+    bool verify(const char* ptr, const char* end, uint8_t buckets) const;
+
+    /**
+     * Scans 16 positions at a time with SSSE3 shuffles. Returns the leftmost match, or `nullptr` if
+     * there is none before `resume`, the position at which scalar scanning must continue.
+     */
+    const char* find_packed(const char* begin, const char* end, const char*& resume) const;
+
+  };
+
+}
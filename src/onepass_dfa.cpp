@@ -0,0 +1,249 @@
+/**
+ * @file	onepass_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compiler.hpp"
+#include "match.hpp"
+#include "onepass_dfa.hpp"
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** State ID indicating that there is no transition. */
+  const uint32_t NO_STATE = UINT32_MAX;
+
+}
+
+/* -- Types -- */
+
+struct onepass_dfa::implementation
+{
+
+  /* -- Types -- */
+
+  /** A transition, along with the slots to record at the current position when taking it. */
+  struct transition
+  {
+    uint32_t next;
+    uint32_t actions;
+  };
+
+  /** An instruction reached while building a state, with the slot actions taken on the way to it. */
+  struct frame
+  {
+    uint32_t pc;
+    uint32_t actions;
+  };
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> prog)
+    : prog(move(prog)),
+      classes(this->prog->byte_classes),
+      stride(classes.count())
+  {
+    if (this->prog->slot_count > MAX_SLOTS)
+    {
+      ostringstream message;
+      message << "Program exceeds limit of " << MAX_SLOTS << " capture slots.";
+      throw compile_error(message.str());
+    }
+    build();
+  }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const program> prog;
+  const byte_class_map classes;
+  const uint32_t stride;
+
+  /** The transitions out of each state, indexed by `state * stride + classes[byte]`. */
+  vector<transition> table;
+
+  /** The slots to record on accepting in each state, or `NO_STATE` if the state does not accept. */
+  vector<uint32_t> match_actions;
+
+  /* -- Methods -- */
+
+  /**
+   * Builds the transition table. Each state is an instruction at which the anchored program may
+   * resume after consuming a byte, and its transitions follow the epsilon closure from there.
+   */
+  void build()
+  {
+    const auto& instructions = prog->instructions;
+    auto representatives = classes.representatives();
+
+    vector<uint32_t> state_of(instructions.size(), NO_STATE);
+    vector<uint32_t> entries;
+    auto state_for = [&] (uint32_t pc) {
+      if (state_of[pc] == NO_STATE)
+      {
+        state_of[pc] = static_cast<uint32_t>(entries.size());
+        entries.push_back(pc);
+        table.resize(table.size() + stride, transition { NO_STATE, 0 });
+        match_actions.push_back(NO_STATE);
+      }
+      return state_of[pc];
+    };
+
+    // the closure of each state is marked with the state's ID, so no clearing is needed between them
+    vector<uint32_t> visited(instructions.size(), NO_STATE);
+    vector<frame> stack;
+
+    state_for(prog->anchored_start);
+    for (uint32_t state = 0; state < entries.size(); state++)
+    {
+      stack.push_back(frame { entries[state], 0 });
+      while (!stack.empty())
+      {
+        auto current = stack.back();
+        stack.pop_back();
+
+        // reaching an instruction twice means that two paths lead through it
+        if (visited[current.pc] == state)
+          throw compile_error("Program is not one-pass.");
+        visited[current.pc] = state;
+
+        const auto& inst = instructions[current.pc];
+        switch (inst.op)
+        {
+        case opcode::split:
+          stack.push_back(frame { inst.alternate, current.actions });
+          stack.push_back(frame { inst.next, current.actions });
+          break;
+
+        case opcode::jump:
+          stack.push_back(frame { inst.next, current.actions });
+          break;
+
+        case opcode::save:
+          stack.push_back(frame { inst.next, current.actions | (uint32_t(1) << inst.argument) });
+          break;
+
+        case opcode::match:
+          if (match_actions[state] != NO_STATE)
+            throw compile_error("Program is not one-pass.");
+          match_actions[state] = current.actions;
+          break;
+
+        case opcode::byte:
+        case opcode::byte_set:
+        case opcode::any:
+        {
+          // `state_for` may grow the table, so the row is only located afterwards
+          auto next = state_for(inst.next);
+          auto row = table.begin() + state * stride;
+          for (uint32_t cls = 0; cls < stride; cls++)
+          {
+            auto ch = representatives[cls];
+            if ((inst.op == opcode::byte && ch != inst.argument) ||
+                (inst.op == opcode::byte_set && !prog->byte_sets[inst.argument].test(ch)))
+              continue;
+            if (row[cls].next != NO_STATE)
+              throw compile_error("Program is not one-pass.");
+            row[cls] = transition { next, current.actions };
+          }
+          break;
+        }
+        }
+      }
+    }
+  }
+
+  /** Records the current position in each slot in `actions`. */
+  static void apply(uint32_t actions, size_t pos, size_t* slots)
+  {
+    for (size_t slot = 0; actions != 0; slot++, actions >>= 1)
+      if (actions & 1)
+        slots[slot] = pos;
+  }
+
+  /** Matches the entire input range, storing the capture slots in `slots`. */
+  bool run(const char* begin, const char* end, size_t* slots) const
+  {
+    const transition* rows = table.data();
+    const uint8_t* byte_classes = classes.data();
+
+    uint32_t state = 0;
+    size_t length = static_cast<size_t>(end - begin);
+    for (size_t pos = 0; pos < length; pos++)
+    {
+      const auto& next = rows[state * stride + byte_classes[static_cast<unsigned char>(begin[pos])]];
+      if (next.next == NO_STATE)
+        return false;
+      if (next.actions != 0)
+        apply(next.actions, pos, slots);
+      state = next.next;
+    }
+
+    if (match_actions[state] == NO_STATE)
+      return false;
+    apply(match_actions[state], length, slots);
+    return true;
+  }
+
+};
+
+/* -- Procedures -- */
+
+onepass_dfa::onepass_dfa(shared_ptr<const program> prog)
+  : impl(make_unique<implementation>(move(prog)))
+{
+}
+
+onepass_dfa::~onepass_dfa() = default;
+
+size_t onepass_dfa::state_count() const
+{
+  return impl->match_actions.size();
+}
+
+size_t onepass_dfa::memory_usage() const
+{
+  return sizeof(implementation)
+    + impl->table.capacity() * sizeof(implementation::transition)
+    + impl->match_actions.capacity() * sizeof(uint32_t);
+}
+
+bool onepass_dfa::captures(const char* begin, const char* end, vector<match>& groups) const
+{
+  size_t slots[MAX_SLOTS];
+  size_t slot_count = impl->prog->slot_count;
+  fill(slots, slots + slot_count, match::NO_POSITION);
+
+  if (!impl->run(begin, end, slots))
+    return false;
+
+  slots_to_groups(slots, slot_count, groups);
+  return true;
+}
+
+bool onepass_dfa::captures(const string& input, vector<match>& groups) const
+{
+  return captures(input.data(), input.data() + input.size(), groups);
+}
+
+/* -- Constants -- */
+
+const size_t onepass_dfa::MAX_SLOTS;
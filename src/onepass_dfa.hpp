@@ -0,0 +1,106 @@
+/**
+ * @file	onepass_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which extracts capture groups with a DFA, for programs which are one-pass.
+   *
+   * A program is one-pass if, from any point in an anchored match, the next input byte determines
+   * a single way to continue: no two paths through the epsilon closure reach the same instruction,
+   * no two consuming instructions reachable at once accept the same byte, and at most one path
+   * reaches a match. Every input then has at most one path through the program, so the capture
+   * slots can be attached to the transitions as a mask of `save` instructions to perform, and
+   * extraction is a single table lookup per byte, with no threads or backtracking. Expressions such
+   * as `(\w+)@(\w+)` or `(a|b)*c` are one-pass, while `(a*)a` is not.
+   *
+   * Only the anchored program is determinized, so `captures()` expects the exact bounds of the
+   * overall match, as found by another engine.
+   *
+   * Since the table is immutable once built, a single instance may be used by multiple threads.
+   */
+  class onepass_dfa
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The maximum number of capture slots a program may have. */
+    static const size_t MAX_SLOTS = 32;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Builds a new `regex::onepass_dfa`.
+     *
+     * @param prog The program to execute.
+     *
+     * @exception regex::compile_error
+     * Thrown if the program is not one-pass, or has more than `MAX_SLOTS` capture slots.
+     */
+    onepass_dfa(std::shared_ptr<const regex::program> prog);
+
+    /** Destructor. */
+    ~onepass_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of states in the DFA. */
+    size_t state_count() const;
+
+    /**
+     * Returns the estimated number of bytes used by the transition table. This does not include the
+     * program, which is shared with the caller.
+     */
+    size_t memory_usage() const;
+
+    /**
+     * Matches the program against the entire input range, and extracts the bounds of each capture
+     * group.
+     *
+     * @return `true` if the whole range matched, in which case `groups` is resized to hold one
+     * entry per group, with the overall match first.
+     */
+    bool captures(const char* begin, const char* end, std::vector<regex::match>& groups) const;
+
+    /**
+     * Matches the program against the entire input string, and extracts the bounds of each capture
+     * group.
+     *
+     * @return `true` if the whole string matched, in which case `groups` is resized to hold one
+     * entry per group, with the overall match first.
+     */
+    bool captures(const std::string& input, std::vector<regex::match>& groups) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
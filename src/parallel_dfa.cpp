@@ -0,0 +1,479 @@
+/**
+ * @file	parallel_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "full_dfa.hpp"
+#include "match.hpp"
+#include "parallel_dfa.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** The number of bytes after which a chunk's paths are expected to have mostly merged. */
+  const size_t WARMUP_LENGTH = 4096;
+
+  /** The maximum number of unmerged paths allowed after the warmup. */
+  const size_t MAX_PATHS = 16;
+
+  /** The number of bytes a chunk scans between checks for a match seen by an earlier chunk. */
+  const size_t STOP_CHECK_INTERVAL = (1 << 16);
+
+  /** Value indicating that a state has no path assigned. */
+  const uint32_t NO_PATH = UINT32_MAX;
+
+}
+
+/* -- Types -- */
+
+namespace
+{
+
+  /**
+   * Struct summarizing the scan of one chunk from each of a contiguous range of states.
+   *
+   * Each starting state has a path. When two unfinished paths reach the same state, one is merged
+   * into the other, and only the surviving path is scanned further.
+   */
+  struct chunk_summary
+  {
+    /** The first state scanned from. */
+    uint32_t first_state = 0;
+
+    /** The path each path was merged into, or itself if it was never merged. */
+    vector<uint32_t> parent;
+
+    /** For each unmerged path, `true` if it reached a match or dead state. */
+    vector<uint8_t> seen;
+
+    /** For each unmerged path which did not see a match, the state it ended in. */
+    vector<uint32_t> final_state;
+
+    /** `false` if the paths did not merge quickly enough for the summary to be worth computing. */
+    bool complete = false;
+  };
+
+  /**
+   * Pool of worker threads shared by the searches of every `regex::parallel_dfa`.
+   *
+   * Threads are started as searches need them, up to one less than the number of hardware threads,
+   * and then wait for work until the process exits. Each search queues a batch of tasks, and the
+   * searching thread claims tasks from its own batch alongside the workers, so a search finishes
+   * even when every worker is busy with other searches.
+   */
+  class worker_pool
+  {
+
+  public:
+
+    /** Returns the pool shared by all searches. */
+    static worker_pool& shared()
+    {
+      static worker_pool pool;
+      return pool;
+    }
+
+    /** Destructor. */
+    ~worker_pool()
+    {
+      {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+      }
+      task_ready.notify_all();
+      for (auto& worker : workers)
+        worker.join();
+    }
+
+    /**
+     * Runs `task(idx)` for each `idx` in `[0, count)`, on the calling thread and up to
+     * `thread_count - 1` workers, returning once all of them have finished.
+     */
+    void run(size_t count, size_t thread_count, const function<void(size_t)>& task)
+    {
+      batch tasks { &task, count, 0, count };
+      unique_lock<mutex> guard(lock);
+      auto wanted = min(min(thread_count, count) - 1, max_workers);
+      while (workers.size() < wanted)
+        workers.emplace_back([this] { work(); });
+      if (count > 1)
+        batches.push_back(&tasks);
+      guard.unlock();
+      task_ready.notify_all();
+
+      guard.lock();
+      while (tasks.next < tasks.count)
+        run_one(tasks, guard);
+      task_done.wait(guard, [&tasks] { return tasks.remaining == 0; });
+    }
+
+  private:
+
+    /** A search's tasks, which live on the searching thread's stack until all have finished. */
+    struct batch
+    {
+      const function<void(size_t)>* task;
+      size_t count;
+      size_t next;
+      size_t remaining;
+    };
+
+    worker_pool()
+      : max_workers(max<size_t>(thread::hardware_concurrency(), 2) - 1),
+        stopping(false)
+    { }
+
+    /** Claims and runs the next task of `tasks`, which must have one left. Called with `lock` held. */
+    void run_one(batch& tasks, unique_lock<mutex>& guard)
+    {
+      auto idx = tasks.next++;
+      if (tasks.next == tasks.count)
+        batches.erase(find(batches.begin(), batches.end(), &tasks));
+
+      guard.unlock();
+      (*tasks.task)(idx);
+      guard.lock();
+
+      if (--tasks.remaining == 0)
+        task_done.notify_all();
+    }
+
+    /** Runs queued tasks until the pool is destroyed. */
+    void work()
+    {
+      unique_lock<mutex> guard(lock);
+      while (true)
+      {
+        task_ready.wait(guard, [this] { return stopping || !batches.empty(); });
+        if (stopping)
+          return;
+        run_one(*batches.front(), guard);
+      }
+    }
+
+    const size_t max_workers;
+    vector<thread> workers;
+    mutex lock;
+    condition_variable task_ready;
+    condition_variable task_done;
+    deque<batch*> batches;
+    bool stopping;
+
+  };
+
+}
+
+struct parallel_dfa::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const full_dfa> dfa, size_t thread_count, size_t min_chunk_size)
+    : dfa(move(dfa)),
+      table(this->dfa->forward_table()),
+      thread_count(max<size_t>(thread_count, 1)),
+      min_chunk_size(max<size_t>(min_chunk_size, 1))
+  { }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const full_dfa> dfa;
+  const dfa_table& table;
+  const size_t thread_count;
+  const size_t min_chunk_size;
+
+  /* -- Methods -- */
+
+  /**
+   * Runs `task(idx)` for each `idx` in `[0, count)` on the calling thread and the shared worker
+   * threads, returning once all of them have finished.
+   */
+  void run_tasks(size_t count, const function<void(size_t)>& task) const
+  {
+    worker_pool::shared().run(count, thread_count, task);
+  }
+
+  /** Returns the number of threads to use for an input of `length` bytes. */
+  size_t threads_for(size_t length) const
+  {
+    return max<size_t>(min(thread_count, length / min_chunk_size), 1);
+  }
+
+  /**
+   * Scans the input in parallel. Returns `true` if a match was seen, in which case `chunk_begin`
+   * and `state` are set to the start of the chunk in which it was first seen and the state the scan
+   * entered that chunk in. If the scan cannot be run in parallel, `chunk_begin` is set to `nullptr`.
+   */
+  bool scan_chunks(const char* begin, const char* end, const char*& chunk_begin, uint32_t& state) const
+  {
+    chunk_begin = nullptr;
+    auto chunk_count = threads_for(static_cast<size_t>(end - begin));
+    if (chunk_count < 2 || table.is_match(table.start))
+      return false;
+
+    vector<const char*> bounds(chunk_count + 1);
+    auto length = static_cast<size_t>(end - begin);
+    for (size_t idx = 0; idx <= chunk_count; idx++)
+      bounds[idx] = begin + length / chunk_count * idx;
+    bounds[chunk_count] = end;
+
+    // the first chunk is only ever entered in the start state; any other chunk may be entered in
+    // any state which is neither dead nor a match state, since the first match ends the stitching
+    vector<chunk_summary> summaries(chunk_count);
+    auto other_first = table.last_match + table.stride;
+    auto other_count = static_cast<uint32_t>(table.state_count() - other_first / table.stride);
+
+    // a chunk in which every path sees a match ends the stitching whatever state it is entered in,
+    // so the chunks after it stop scanning
+    atomic<size_t> matched_chunk(chunk_count);
+    run_tasks(chunk_count, [&] (size_t idx) {
+        if (idx == 0)
+          summarize(bounds[0], bounds[1], table.start, 1, 0, matched_chunk, summaries[0]);
+        else
+          summarize(bounds[idx], bounds[idx + 1], other_first, other_count, idx, matched_chunk, summaries[idx]);
+      });
+
+    state = table.start;
+    for (size_t idx = 0; idx < chunk_count; idx++)
+    {
+      const auto& summary = summaries[idx];
+      if (!summary.complete)
+      {
+        chunk_begin = nullptr;
+        return false;
+      }
+
+      auto path = (state - summary.first_state) / table.stride;
+      assert(path < summary.parent.size());
+      while (summary.parent[path] != path)
+        path = summary.parent[path];
+
+      chunk_begin = bounds[idx];
+      if (summary.seen[path])
+        return true;
+      state = summary.final_state[path];
+    }
+
+    return false;
+  }
+
+  /**
+   * Scans chunk `chunk` of the input, `[begin, end)`, from each of `count` states beginning at
+   * `first_state`. If every path sees a match, `matched_chunk` is lowered to `chunk`; if it is
+   * lowered below `chunk` by another thread, the scan is abandoned, leaving the summary incomplete.
+   */
+  void summarize(const char* begin, const char* end, uint32_t first_state, uint32_t count,
+                 size_t chunk, atomic<size_t>& matched_chunk, chunk_summary& summary) const
+  {
+    const uint32_t* transitions = table.transitions.data();
+    const uint8_t* classes = table.classes.data();
+    const uint32_t last_match = table.last_match;
+    const uint32_t stride = table.stride;
+
+    summary.first_state = first_state;
+    summary.parent.resize(count);
+    iota(summary.parent.begin(), summary.parent.end(), 0);
+    summary.seen.assign(count, 0);
+    summary.final_state.assign(count, 0);
+
+    vector<uint32_t> states(count);
+    vector<uint32_t> active(count);
+    for (uint32_t path = 0; path < count; path++)
+    {
+      states[path] = first_state + path * stride;
+      active[path] = path;
+    }
+    vector<uint32_t> owner(table.state_count(), NO_PATH);
+
+    auto ptr = begin;
+    while (ptr != end && !active.empty())
+    {
+      // once a single path remains, it is scanned exactly as a sequential scan would be
+      if (active.size() == 1)
+      {
+        auto path = active[0];
+        auto state = states[path];
+        while (ptr != end && !active.empty())
+        {
+          if (matched_chunk.load(memory_order_relaxed) < chunk)
+            return;
+
+          auto block_end = ptr + min<size_t>(static_cast<size_t>(end - ptr), STOP_CHECK_INTERVAL);
+          while (ptr != block_end)
+          {
+            state = transitions[state + classes[static_cast<unsigned char>(*ptr++)]];
+            if (state <= last_match)
+            {
+              summary.seen[path] = 1;
+              active.clear();
+              break;
+            }
+          }
+        }
+        states[path] = state;
+        break;
+      }
+
+      auto cls = classes[static_cast<unsigned char>(*ptr++)];
+      size_t kept = 0;
+      for (auto path : active)
+      {
+        auto state = transitions[states[path] + cls];
+        if (state <= last_match)
+          summary.seen[path] = 1;
+        else
+        {
+          states[path] = state;
+          active[kept++] = path;
+        }
+      }
+      active.resize(kept);
+
+      // merge paths which have reached the same state, since their futures are now identical
+      auto offset = static_cast<size_t>(ptr - begin);
+      if (active.size() > 8 || (offset % 64) == 0)
+      {
+        kept = 0;
+        for (auto path : active)
+        {
+          auto& first = owner[states[path] / stride];
+          if (first == NO_PATH)
+          {
+            first = path;
+            active[kept++] = path;
+          }
+          else
+            summary.parent[path] = first;
+        }
+        active.resize(kept);
+        for (auto path : active)
+          owner[states[path] / stride] = NO_PATH;
+      }
+
+      if (offset == WARMUP_LENGTH && active.size() > MAX_PATHS)
+        return;
+      if (offset % STOP_CHECK_INTERVAL == 0 && matched_chunk.load(memory_order_relaxed) < chunk)
+        return;
+    }
+
+    // with no unfinished paths left, every path saw a match
+    if (active.empty())
+    {
+      auto lowest = matched_chunk.load(memory_order_relaxed);
+      while (chunk < lowest && !matched_chunk.compare_exchange_weak(lowest, chunk, memory_order_relaxed))
+        ;
+    }
+
+    for (auto path : active)
+      summary.final_state[path] = states[path];
+    summary.complete = true;
+  }
+
+  /**
+   * Finishes the scan for the end of the leftmost-first match, from `ptr` in state `state`, exactly
+   * as the sequential scan would.
+   */
+  size_t finish_scan(const char* begin, const char* ptr, const char* end, uint32_t state) const
+  {
+    const uint32_t* transitions = table.transitions.data();
+    const uint8_t* classes = table.classes.data();
+    const uint32_t last_match = table.last_match;
+
+    size_t match_end = 0;
+    bool found = false;
+    while (ptr != end)
+    {
+      state = transitions[state + classes[static_cast<unsigned char>(*ptr++)]];
+      if (state <= last_match)
+      {
+        if (state == 0)
+          break;
+        found = true;
+        match_end = static_cast<size_t>(ptr - begin);
+      }
+    }
+
+    assert(found);
+    (void)found;
+    return match_end;
+  }
+
+};
+
+/* -- Procedures -- */
+
+parallel_dfa::parallel_dfa(shared_ptr<const full_dfa> dfa, size_t thread_count, size_t min_chunk_size)
+  : impl(make_unique<implementation>(move(dfa), thread_count, min_chunk_size))
+{
+}
+
+parallel_dfa::~parallel_dfa() = default;
+
+size_t parallel_dfa::threads_for(size_t length) const
+{
+  return impl->threads_for(length);
+}
+
+bool parallel_dfa::is_match(const char* begin, const char* end) const
+{
+  const char* chunk_begin;
+  uint32_t state;
+  bool found = impl->scan_chunks(begin, end, chunk_begin, state);
+  if (chunk_begin == nullptr)
+    return impl->dfa->is_match(begin, end);
+  return found;
+}
+
+bool parallel_dfa::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool parallel_dfa::find(const char* begin, const char* end, match& result) const
+{
+  const char* chunk_begin;
+  uint32_t state;
+  bool found = impl->scan_chunks(begin, end, chunk_begin, state);
+  if (chunk_begin == nullptr)
+    return impl->dfa->find(begin, end, result);
+  if (!found)
+    return false;
+
+  result.end = impl->finish_scan(begin, chunk_begin, end, state);
+  result.begin = impl->dfa->match_start(begin, result.end);
+  return true;
+}
+
+bool parallel_dfa::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+/* -- Constants -- */
+
+const size_t parallel_dfa::DEFAULT_MIN_CHUNK_SIZE;
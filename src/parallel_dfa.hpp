@@ -0,0 +1,108 @@
+/**
+ * @file	parallel_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "full_dfa.hpp"
+#include "match.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which searches a single large input with a full DFA on several threads at once.
+   *
+   * The input is split into one chunk per thread. The first chunk is scanned from the start state,
+   * and every other chunk is scanned from every state the scan could be in when it arrives there,
+   * with the paths merged as soon as they reach the same state. For most expressions they all merge
+   * within a few bytes, after which the enumeration costs no more than an ordinary scan. Each chunk
+   * records, for each state it might begin in, either the state it ends in, or that a match was
+   * seen. The summaries are then chained together from the start state to find the first chunk in
+   * which the real scan sees a match, and the scan is finished sequentially from there, exactly as
+   * `regex::full_dfa` would, so results are identical to a sequential search. The real scan is
+   * certain to see a match by the end of any chunk in which every path sees one, so once such a
+   * chunk is found, the threads scanning the chunks after it stop early.
+   *
+   * Inputs too small to give each thread `min_chunk_size` bytes, and chunks whose paths do not
+   * merge quickly, are searched sequentially instead.
+   *
+   * The chunks are scanned by the calling thread and a pool of worker threads shared by every
+   * instance, which is started by the first search which is split and grows to at most one less
+   * than the number of hardware threads. Since the DFA is immutable and all working storage is local to each search, a
+   * single instance may be used by multiple threads.
+   */
+  class parallel_dfa
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The default minimum number of bytes in each chunk. */
+    static const size_t DEFAULT_MIN_CHUNK_SIZE = (1 << 20);
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::parallel_dfa`.
+     *
+     * @param dfa The DFA to search with.
+     * @param thread_count The maximum number of threads to use for each search.
+     * @param min_chunk_size The minimum number of bytes for each thread to scan.
+     */
+    parallel_dfa(std::shared_ptr<const regex::full_dfa> dfa,
+                 size_t thread_count,
+                 size_t min_chunk_size = DEFAULT_MIN_CHUNK_SIZE);
+
+    /** Destructor. */
+    ~parallel_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of threads which would be used to search an input of `length` bytes. */
+    size_t threads_for(size_t length) const;
+
+    /** Returns `true` if the DFA matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if the DFA matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
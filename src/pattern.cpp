@@ -0,0 +1,364 @@
+/**
+ * @file	pattern.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <bitset>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "backtracker.hpp"
+#include "compiler.hpp"
+#include "engine_pool.hpp"
+#include "full_dfa.hpp"
+#include "jit_dfa.hpp"
+#include "lazy_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "multi_literal_search.hpp"
+#include "onepass_dfa.hpp"
+#include "parallel_dfa.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "prefilter.hpp"
+#include "prefix_analysis.hpp"
+#include "program.hpp"
+#include "shift_and.hpp"
+#include "shuffle_dfa.hpp"
+#include "simplifier.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct pattern::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const string& expression, const pattern_options& options)
+    : expression(expression),
+      options(options),
+      backtrackers([this] { return make_unique<backtracker>(forward, this->options.backtrack_limit, pre); }),
+      pike_vms([this] { return make_unique<pike_vm>(forward, pre); }),
+      lazy_dfas([this] { return make_unique<lazy_dfa>(forward, reverse, this->options.dfa_cache_size, pre); })
+  {
+    lexical_analyzer lex(expression);
+    syntax_analyzer parse(lex.all_tokens());
+    auto tree = parse.parse_tree();
+
+    // groups are counted before simplification, which may remove those which can never match
+    group_count = 0;
+    for (syntax_index index = 0; index < tree.size(); index++)
+      if (tree.type(index) == syntax_node_type::capture)
+        group_count = max(group_count, static_cast<size_t>(tree.group(index)));
+
+    if (!options.match_newline)
+    {
+      bitset<256> allowed;
+      allowed.set();
+      allowed.reset('\n');
+      tree = restrict_classes(tree, allowed);
+    }
+
+    if (options.simplify)
+      tree = regex::simplify(tree);
+
+    compile_options forward_options;
+    forward = compile(tree, forward_options);
+
+    compile_options reverse_options;
+    reverse_options.reverse = true;
+    reverse = compile(tree, reverse_options);
+
+    auto info = analyze_prefix(tree);
+    if (options.use_prefilter)
+      pre = make_prefilter(info);
+
+    // an alternation of more literals than the packed searcher takes is matched directly by an
+    // Aho-Corasick automaton, since its DFA would have a state for nearly every prefix of them,
+    // unless they share a prefix which can be skipped to far faster
+    if (options.engine == engine_type::automatic && info.literals_exact && !info.nullable &&
+        info.literals.size() > packed_searcher::MAX_LITERALS && info.prefix.size() <= 1)
+      literals = make_unique<aho_corasick>(info.literals);
+
+    // small expressions are matched bit-parallel if their matches have a bounded length, and all
+    // others by the lazy DFA, which recovers the start of an unbounded match far more cheaply
+    engine = options.engine;
+    bool small = false;
+    if (engine == engine_type::automatic)
+    {
+      small = (shift_and::count_positions(tree) <= shift_and::MAX_POSITIONS);
+      engine = engine_type::lazy_dfa;
+    }
+
+    // small expressions without a prefilter may be executed even faster if their DFA is tiny
+    if (small && pre == nullptr)
+    {
+      try
+      {
+        full = make_shared<full_dfa>(forward, reverse, min<size_t>(options.dfa_state_limit, 4 * shuffle_dfa::MAX_STATES));
+        if (shuffle_dfa::fits(*full))
+          engine = engine_type::shuffle_dfa;
+        else
+          full = nullptr;
+      }
+      catch (const compile_error&)
+      {
+        // the expression is matched by another engine instead
+      }
+    }
+
+    if (small && engine == engine_type::lazy_dfa)
+    {
+      shift = make_unique<shift_and>(tree, forward, reverse, pre, options.dfa_cache_size);
+      if (shift->is_bounded())
+        engine = engine_type::shift_and;
+      else
+        shift = nullptr;
+    }
+
+    if (engine == engine_type::full_dfa || (engine == engine_type::shuffle_dfa && full == nullptr))
+      full = make_shared<full_dfa>(forward, reverse, options.dfa_state_limit, pre);
+
+    if (engine == engine_type::shift_and && shift == nullptr)
+      shift = make_unique<shift_and>(tree, forward, reverse, pre, options.dfa_cache_size);
+    else if (engine == engine_type::shuffle_dfa)
+      shuffled = make_unique<shuffle_dfa>(full);
+
+    // large inputs are split between threads, which needs the whole DFA up front; a prefilter skips
+    // through the input faster than the threads could scan it, so it is kept sequential instead
+    if (options.thread_count > 1 && pre == nullptr && literals == nullptr &&
+        (options.engine == engine_type::automatic || engine == engine_type::full_dfa || engine == engine_type::shuffle_dfa))
+    {
+      try
+      {
+        if (full == nullptr)
+          full = make_shared<full_dfa>(forward, reverse, options.dfa_state_limit, pre);
+        parallel = make_unique<parallel_dfa>(full, options.thread_count);
+      }
+      catch (const compile_error&)
+      {
+        // the expression is only searched sequentially
+      }
+    }
+
+    if (options.use_jit && jit_dfa::is_supported() && literals == nullptr &&
+        (options.engine == engine_type::automatic || engine == engine_type::full_dfa))
+    {
+      try
+      {
+        if (full == nullptr)
+          full = make_shared<full_dfa>(forward, reverse, options.dfa_state_limit, pre);
+        jitted = make_unique<jit_dfa>(full);
+      }
+      catch (const compile_error&)
+      {
+        // the DFA is too large, or executable memory is not allowed, so it is interpreted
+      }
+    }
+
+    if (group_count != 0)
+    {
+      try
+      {
+        onepass = make_unique<onepass_dfa>(forward);
+      }
+      catch (const compile_error&)
+      {
+        // groups are extracted by a general engine instead
+      }
+    }
+  }
+
+  /* -- Fields -- */
+
+  const string expression;
+  const pattern_options options;
+  shared_ptr<const program> forward;
+  shared_ptr<const program> reverse;
+  shared_ptr<const prefilter> pre;
+  engine_type engine;
+  engine_pool<backtracker> backtrackers;
+  engine_pool<pike_vm> pike_vms;
+  engine_pool<lazy_dfa> lazy_dfas;
+  shared_ptr<const full_dfa> full;
+  unique_ptr<const shift_and> shift;
+  unique_ptr<const shuffle_dfa> shuffled;
+  unique_ptr<const onepass_dfa> onepass;
+  unique_ptr<const parallel_dfa> parallel;
+  unique_ptr<const jit_dfa> jitted;
+  unique_ptr<const aho_corasick> literals;
+  size_t group_count;
+
+  /* -- Methods -- */
+
+  /**
+   * Extracts the capture groups of a match which is known to span exactly the input range, with
+   * positions relative to `begin`.
+   */
+  bool extract_groups(const char* begin, const char* end, vector<match>& groups) const
+  {
+    if (onepass != nullptr)
+      return onepass->captures(begin, end, groups);
+
+    if (backtracker::can_search(forward->instructions.size(), static_cast<size_t>(end - begin), options.backtrack_limit))
+      return backtrackers.with_engine([=, &groups] (backtracker& engine) { return engine.captures(begin, end, groups); });
+
+    return pike_vms.with_engine([=, &groups] (pike_vm& engine) { return engine.captures(begin, end, groups); });
+  }
+
+  /**
+   * Invokes `fn` with exclusive access to an instance of the engine best suited to an input of the
+   * specified length.
+   */
+  template <typename TFunction>
+  bool with_engine(size_t length, TFunction&& fn) const
+  {
+    if (literals != nullptr)
+      return fn(*literals);
+
+    // setting up any other engine costs more than backtracking over a short enough input, unless a
+    // prefilter can rule most of it out first
+    if (options.engine == engine_type::automatic && pre == nullptr && length <= options.backtrack_input_limit &&
+        backtracker::can_search(forward->instructions.size(), length, options.backtrack_limit))
+      return backtrackers.with_engine(fn);
+
+    if (parallel != nullptr && parallel->threads_for(length) > 1)
+      return fn(*parallel);
+
+    if (jitted != nullptr)
+      return fn(*jitted);
+
+    switch (engine)
+    {
+    case engine_type::pike_vm:
+      return pike_vms.with_engine(fn);
+
+    case engine_type::full_dfa:
+      return fn(*full);
+
+    case engine_type::shift_and:
+      return fn(*shift);
+
+    case engine_type::shuffle_dfa:
+      return fn(*shuffled);
+
+    case engine_type::automatic:
+    case engine_type::lazy_dfa:
+    default:
+      return lazy_dfas.with_engine(fn);
+    }
+  }
+
+};
+
+/* -- Procedures -- */
+
+pattern::pattern(const string& expression, const pattern_options& options)
+  : impl(make_unique<implementation>(expression, options))
+{
+}
+
+pattern::~pattern() = default;
+
+const string& pattern::expression() const
+{
+  return impl->expression;
+}
+
+const pattern_options& pattern::options() const
+{
+  return impl->options;
+}
+
+size_t pattern::memory_usage() const
+{
+  size_t usage = sizeof(implementation) + impl->expression.capacity();
+  usage += impl->forward->instructions.capacity() * sizeof(instruction);
+  usage += impl->reverse->instructions.capacity() * sizeof(instruction);
+  if (impl->full != nullptr)
+  {
+    usage += impl->full->forward_table().transitions.capacity() * sizeof(uint32_t);
+    usage += impl->full->reverse_table().transitions.capacity() * sizeof(uint32_t);
+  }
+  if (impl->pre != nullptr)
+    usage += impl->pre->memory_usage();
+  if (impl->shift != nullptr)
+    usage += impl->shift->memory_usage();
+  if (impl->shuffled != nullptr)
+    usage += impl->shuffled->memory_usage();
+  if (impl->onepass != nullptr)
+    usage += impl->onepass->memory_usage();
+  if (impl->jitted != nullptr)
+    usage += impl->jitted->code_size();
+  if (impl->literals != nullptr)
+    usage += impl->literals->memory_usage();
+  return usage;
+}
+
+size_t pattern::group_count() const
+{
+  return impl->group_count;
+}
+
+bool pattern::is_match(const char* begin, const char* end) const
+{
+  return impl->with_engine(static_cast<size_t>(end - begin), [=] (auto& engine) {
+      return engine.is_match(begin, end);
+    });
+}
+
+bool pattern::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool pattern::find(const char* begin, const char* end, match& result) const
+{
+  return impl->with_engine(static_cast<size_t>(end - begin), [=, &result] (auto& engine) {
+      return engine.find(begin, end, result);
+    });
+}
+
+bool pattern::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+bool pattern::captures(const char* begin, const char* end, vector<match>& groups) const
+{
+  match overall;
+  if (!find(begin, end, overall))
+    return false;
+
+  // searching just the matched range finds the same match, so the groups need not be searched for
+  if (!impl->extract_groups(begin + overall.begin, begin + overall.end, groups))
+    return false;
+
+  // groups removed by simplification never participate
+  groups.resize(impl->group_count + 1, match { match::NO_POSITION, match::NO_POSITION });
+  for (auto& group : groups)
+  {
+    if (group.begin == match::NO_POSITION)
+      continue;
+    group.begin += overall.begin;
+    group.end += overall.begin;
+  }
+  return true;
+}
+
+bool pattern::captures(const string& input, vector<match>& groups) const
+{
+  return captures(input.data(), input.data() + input.size(), groups);
+}
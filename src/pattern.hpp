@@ -0,0 +1,199 @@
+/**
+ * @file	pattern.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Enumeration of the matching engines which may execute a pattern.
+   */
+  enum class engine_type
+  {
+    automatic,
+    pike_vm,
+    lazy_dfa,
+    full_dfa,
+    shift_and,
+    shuffle_dfa,
+  };
+
+  /**
+   * Struct containing options for compiling a pattern.
+   */
+  struct pattern_options
+  {
+    /** The engine used to execute the pattern. */
+    regex::engine_type engine = regex::engine_type::automatic;
+
+    /** The maximum number of bytes each lazy DFA may use for its state cache. */
+    size_t dfa_cache_size = (2 << 20);
+
+    /** The maximum number of states in each direction of a full DFA. */
+    size_t dfa_state_limit = 10000;
+
+    /**
+     * The maximum number of (instruction, position) pairs the backtracker may visit, whether
+     * searching a short input or extracting capture groups. Zero disables backtracking.
+     */
+    size_t backtrack_limit = (256 << 10);
+
+    /**
+     * With the automatic engine, inputs of at most this many bytes are searched by backtracking
+     * instead, if the pattern has no prefilter and the search fits within `backtrack_limit`. Longer
+     * inputs repay the cost of setting up a DFA.
+     */
+    size_t backtrack_input_limit = 256;
+
+    /** If `true`, a literal prefilter is used to skip input which cannot start a match. */
+    bool use_prefilter = true;
+
+    /** If `true`, the syntax tree is simplified before it is compiled. */
+    bool simplify = true;
+
+    /**
+     * If `false`, wildcards and character classes never match a newline, so that no match spans a
+     * line break unless the expression contains one literally.
+     */
+    bool match_newline = true;
+
+    /**
+     * The maximum number of threads used to search a single large input. With more than one, the
+     * automatic and full DFA engines search inputs of at least a few megabytes in parallel, if a
+     * full DFA can be built within `dfa_state_limit` states and the expression has no prefilter.
+     * The calling thread scans one part of the input, and the rest are handed to a pool of worker
+     * threads shared by all patterns, which is started by the first parallel search, grows to at
+     * most one less than the number of hardware threads, and waits idle between searches until the
+     * process exits.
+     */
+    size_t thread_count = 1;
+
+    /**
+     * If `true`, the automatic and full DFA engines compile the DFA into native code, where a full
+     * DFA can be built within `dfa_state_limit` states and `regex::jit_dfa::is_supported()`. If the
+     * system refuses to allocate executable memory, the DFA is interpreted as usual.
+     */
+    bool use_jit = false;
+  };
+
+  /**
+   * Class representing a compiled regular expression.
+   *
+   * A `regex::pattern` is immutable once constructed, and may safely be searched by multiple threads
+   * at the same time.
+   */
+  class pattern
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Compiles a new `regex::pattern` from the specified expression.
+     *
+     * @exception regex::lexical_error
+     * Thrown if the expression cannot be tokenized.
+     *
+     * @exception regex::syntax_error
+     * Thrown if the expression cannot be parsed.
+     *
+     * @exception regex::compile_error
+     * Thrown if the expression is too large to compile, if a full DFA was requested and would
+     * exceed `options.dfa_state_limit` states, if the Shift-And engine was requested and the
+     * expression has more than `regex::shift_and::MAX_POSITIONS` positions, or if the shuffle DFA
+     * was requested and the DFA has more than `regex::shuffle_dfa::MAX_STATES` states.
+     */
+    pattern(const std::string& expression, const regex::pattern_options& options = regex::pattern_options());
+
+    /** Destructor. */
+    ~pattern();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the expression this pattern was compiled from. */
+    const std::string& expression() const;
+
+    /** Returns the options this pattern was compiled with. */
+    const regex::pattern_options& options() const;
+
+    /**
+     * Returns the estimated number of bytes used by this pattern's compiled programs and tables.
+     * This does not include the working storage of engines created while searching, which is
+     * bounded separately: at most `regex::engine_pool::DEFAULT_IDLE_LIMIT` engines of each kind are
+     * kept between searches, and each lazy DFA caches at most `options.dfa_cache_size` bytes.
+     */
+    size_t memory_usage() const;
+
+    /** Returns the number of capture groups in this pattern, not counting the overall match. */
+    size_t group_count() const;
+
+    /** Returns `true` if this pattern matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if this pattern matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input range, along with the bounds of
+     * each capture group within it.
+     *
+     * The overall match is found by the usual engine, after which the groups are extracted from
+     * just the matched range, by a one-pass DFA if the pattern allows it, or by a backtracker or
+     * Pike VM otherwise.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to `group_count() + 1`
+     * entries, with the overall match first. Groups which did not participate in the match are set
+     * to `regex::match::NO_POSITION`.
+     */
+    bool captures(const char* begin, const char* end, std::vector<regex::match>& groups) const;
+
+    /**
+     * Finds the leftmost-first match of this pattern in the input string, along with the bounds of
+     * each capture group within it.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to `group_count() + 1`
+     * entries, with the overall match first.
+     */
+    bool captures(const std::string& input, std::vector<regex::match>& groups) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
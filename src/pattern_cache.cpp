@@ -0,0 +1,207 @@
+/**
+ * @file	pattern_cache.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+/* -- Includes -- */
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pattern.hpp"
+#include "pattern_cache.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the cache key for the specified expression and options. */
+  string cache_key(const string& expression, const pattern_options& options)
+  {
+    string key;
+    key += to_string(static_cast<int>(options.engine)) + ",";
+    key += to_string(options.dfa_cache_size) + ",";
+    key += to_string(options.dfa_state_limit) + ",";
+    key += to_string(options.backtrack_limit) + ",";
+    key += to_string(options.backtrack_input_limit) + ",";
+    key += (options.use_prefilter ? "1," : "0,");
+    key += (options.simplify ? "1," : "0,");
+    key += (options.match_newline ? "1," : "0,");
+    key += to_string(options.thread_count) + ",";
+    key += (options.use_jit ? "1:" : "0:");
+    key += expression;
+    return key;
+  }
+
+}
+
+/* -- Types -- */
+
+struct pattern_cache::implementation
+{
+
+  /* -- Types -- */
+
+  /** A cached pattern. */
+  struct entry
+  {
+    string key;
+    shared_ptr<const pattern> value;
+    size_t size;
+  };
+
+  /** An independently locked portion of the cache, with its entries in most recently used order. */
+  struct shard
+  {
+    mutable mutex lock;
+    list<entry> entries;
+    unordered_map<string, list<entry>::iterator> index;
+    size_t memory_usage = 0;
+  };
+
+  /* -- Constructor -- */
+
+  implementation(const pattern_cache_options& options)
+    : shards(options.shard_count == 0 ? 1 : options.shard_count),
+      shard_limit(options.memory_limit / shards.size()),
+      hits(0),
+      misses(0),
+      evictions(0)
+  { }
+
+  /* -- Fields -- */
+
+  vector<shard> shards;
+  const size_t shard_limit;
+  atomic<size_t> hits;
+  atomic<size_t> misses;
+  atomic<size_t> evictions;
+
+  /* -- Methods -- */
+
+  /** Returns the shard responsible for the specified key. */
+  shard& shard_for(const string& key)
+  {
+    return shards[hash<string>()(key) % shards.size()];
+  }
+
+  /** Returns the cached pattern with the specified key, or `nullptr`, marking it as recently used. */
+  shared_ptr<const pattern> lookup(shard& s, const string& key)
+  {
+    lock_guard<mutex> guard(s.lock);
+    auto it = s.index.find(key);
+    if (it == s.index.end())
+      return nullptr;
+
+    s.entries.splice(s.entries.begin(), s.entries, it->second);
+    return it->second->value;
+  }
+
+  /**
+   * Adds a pattern to the specified shard, evicting others as needed, and returns the pattern which
+   * is now cached for its key. If another thread cached the same key first, its pattern is kept.
+   */
+  shared_ptr<const pattern> insert(shard& s, const string& key, shared_ptr<const pattern> value)
+  {
+    // the entry and the index each store a copy of the key, allocated to fit
+    auto size = value->memory_usage() + 2 * key.size();
+
+    lock_guard<mutex> guard(s.lock);
+    auto it = s.index.find(key);
+    if (it != s.index.end())
+    {
+      s.entries.splice(s.entries.begin(), s.entries, it->second);
+      return it->second->value;
+    }
+
+    // a pattern which could never fit is returned without being cached
+    if (size > shard_limit)
+      return value;
+
+    while (!s.entries.empty() && s.memory_usage + size > shard_limit)
+    {
+      auto& victim = s.entries.back();
+      s.memory_usage -= victim.size;
+      s.index.erase(victim.key);
+      s.entries.pop_back();
+      evictions++;
+    }
+
+    s.entries.push_front(entry { key, value, size });
+    s.index.emplace(key, s.entries.begin());
+    s.memory_usage += size;
+    return value;
+  }
+
+};
+
+/* -- Procedures -- */
+
+pattern_cache::pattern_cache(const pattern_cache_options& options)
+  : impl(make_unique<implementation>(options))
+{
+}
+
+pattern_cache::~pattern_cache() = default;
+
+pattern_cache& pattern_cache::global()
+{
+  static pattern_cache cache;
+  return cache;
+}
+
+shared_ptr<const pattern> pattern_cache::get(const string& expression, const pattern_options& options)
+{
+  auto key = cache_key(expression, options);
+  auto& s = impl->shard_for(key);
+
+  auto value = impl->lookup(s, key);
+  if (value != nullptr)
+  {
+    impl->hits++;
+    return value;
+  }
+
+  impl->misses++;
+  return impl->insert(s, key, make_shared<const pattern>(expression, options));
+}
+
+void pattern_cache::clear()
+{
+  for (auto& s : impl->shards)
+  {
+    lock_guard<mutex> guard(s.lock);
+    s.entries.clear();
+    s.index.clear();
+    s.memory_usage = 0;
+  }
+}
+
+pattern_cache_stats pattern_cache::stats() const
+{
+  pattern_cache_stats stats;
+  stats.hits = impl->hits;
+  stats.misses = impl->misses;
+  stats.evictions = impl->evictions;
+  for (const auto& s : impl->shards)
+  {
+    lock_guard<mutex> guard(s.lock);
+    stats.entries += s.entries.size();
+    stats.memory_usage += s.memory_usage;
+  }
+  return stats;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file	pattern_cache.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "pattern.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Struct containing options for a `regex::pattern_cache`.
+   */
+  struct pattern_cache_options
+  {
+    /** The number of independently locked shards. */
+    size_t shard_count = 16;
+
+    /**
+     * The maximum estimated number of bytes used by all cached patterns and their keys. Only each
+     * pattern's compiled programs and tables are counted, as reported by `memory_usage()`. The
+     * working storage of the engines searching a pattern grows and shrinks after it is cached, and
+     * is bounded per pattern instead.
+     */
+    size_t memory_limit = (64 << 20);
+  };
+
+  /**
+   * Struct containing statistics for a `regex::pattern_cache`.
+   */
+  struct pattern_cache_stats
+  {
+    /** The number of lookups which found a cached pattern. */
+    size_t hits = 0;
+
+    /** The number of lookups which had to compile a pattern. */
+    size_t misses = 0;
+
+    /** The number of patterns evicted to stay within the memory limit. */
+    size_t evictions = 0;
+
+    /** The number of patterns currently cached. */
+    size_t entries = 0;
+
+    /** The estimated number of bytes used by the patterns currently cached and their keys. */
+    size_t memory_usage = 0;
+  };
+
+  /**
+   * Class caching compiled patterns by expression and options.
+   *
+   * Patterns are divided among shards by the hash of their key, and each shard has its own lock and
+   * evicts its least recently used patterns once it exceeds its share of the memory limit, so that
+   * lookups from many threads rarely contend. Patterns are compiled outside of any lock. Since
+   * patterns are immutable, a pattern returned by the cache remains valid and may be shared between
+   * threads even after it is evicted.
+   */
+  class pattern_cache
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new, empty `regex::pattern_cache`. */
+    explicit pattern_cache(const regex::pattern_cache_options& options = regex::pattern_cache_options());
+
+    /** Destructor. */
+    ~pattern_cache();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the process-wide shared cache. */
+    static regex::pattern_cache& global();
+
+    /**
+     * Returns the pattern compiled from the specified expression and options, compiling and
+     * caching it if it is not already cached.
+     *
+     * @exception regex::lexical_error
+     * Thrown if the expression cannot be tokenized.
+     *
+     * @exception regex::syntax_error
+     * Thrown if the expression cannot be parsed.
+     *
+     * @exception regex::compile_error
+     * Thrown if the expression cannot be compiled with the specified options.
+     */
+    std::shared_ptr<const regex::pattern> get(const std::string& expression,
+                                              const regex::pattern_options& options = regex::pattern_options());
+
+    /** Removes all patterns from the cache. Statistics are not reset. */
+    void clear();
+
+    /** Returns the current statistics for this cache. */
+    regex::pattern_cache_stats stats() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,193 @@
+/**
+ * @file	pike_vm.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "match.hpp"
+#include "pike_vm.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+#include "thread_list.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct pike_vm::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> prog, shared_ptr<const prefilter> pre)
+    : prog(move(prog)),
+      pre(move(pre)),
+      slot_count(this->prog->slot_count),
+      clist(this->prog->instructions.size(), slot_count),
+      nlist(this->prog->instructions.size(), slot_count),
+      threads(*this->prog, slot_count),
+      matched_slots(slot_count)
+  { }
+
+  /* -- Fields -- */
+
+  shared_ptr<const program> prog;
+  shared_ptr<const prefilter> pre;
+  size_t slot_count;
+  thread_list clist;
+  thread_list nlist;
+  thread_builder threads;
+  vector<size_t> matched_slots;
+
+  /* -- Methods -- */
+
+  /**
+   * Runs the program over the input, storing the slots of the leftmost-first match in
+   * `matched_slots`. If `stop_early` is set, returns as soon as any match is found.
+   */
+  bool search(const char* begin, const char* end, bool stop_early)
+  {
+    bool matched = false;
+    clist.set.clear();
+
+    for (size_t pos = 0; ; pos++)
+    {
+      // start a new thread at each position, with lower priority than any existing thread, until a
+      // match is found
+      if (!matched)
+      {
+        if (clist.set.empty() && pre != nullptr)
+        {
+          // nothing is in progress, so skip directly to the next position where a match could start
+          auto candidate = pre->find(begin + pos, end);
+          if (candidate == end)
+            break;
+          pos = static_cast<size_t>(candidate - begin);
+        }
+
+        threads.start_thread(clist, prog->anchored_start, pos);
+      }
+
+      if (clist.set.empty())
+        break;
+
+      bool at_end = (begin + pos == end);
+      uint32_t ch = (at_end ? 0 : static_cast<unsigned char>(begin[pos]));
+      nlist.set.clear();
+
+      for (size_t idx = 0; idx < clist.set.size(); idx++)
+      {
+        auto pc = clist.set[idx];
+        const auto& inst = prog->instructions[pc];
+        const size_t* thread_slots = &clist.slots[pc * slot_count];
+
+        bool cut = false;
+        switch (inst.op)
+        {
+        case opcode::match:
+          matched = true;
+          copy(thread_slots, thread_slots + slot_count, matched_slots.begin());
+          if (stop_early)
+            return true;
+          // all remaining threads have lower priority than this one
+          cut = true;
+          break;
+
+        case opcode::byte:
+          if (!at_end && ch == inst.argument)
+            threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+          break;
+
+        case opcode::byte_set:
+          if (!at_end && prog->byte_sets[inst.argument].test(ch))
+            threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+          break;
+
+        case opcode::any:
+          if (!at_end)
+            threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+          break;
+
+        default:
+          // epsilon instructions are only in the list to mark them as visited
+          break;
+        }
+
+        if (cut)
+          break;
+      }
+
+      if (at_end)
+        break;
+      swap(clist, nlist);
+    }
+
+    return matched;
+  }
+
+};
+
+/* -- Procedures -- */
+
+pike_vm::pike_vm(shared_ptr<const program> prog, shared_ptr<const prefilter> pre)
+  : impl(make_unique<implementation>(move(prog), move(pre)))
+{
+}
+
+pike_vm::~pike_vm() = default;
+
+bool pike_vm::is_match(const char* begin, const char* end)
+{
+  return impl->search(begin, end, true);
+}
+
+bool pike_vm::is_match(const string& input)
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool pike_vm::find(const char* begin, const char* end, match& result)
+{
+  if (!impl->search(begin, end, false))
+    return false;
+
+  result.begin = impl->matched_slots[0];
+  result.end = impl->matched_slots[1];
+  return true;
+}
+
+bool pike_vm::find(const string& input, match& result)
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+bool pike_vm::captures(const char* begin, const char* end, vector<match>& groups)
+{
+  if (!impl->search(begin, end, false))
+    return false;
+
+  slots_to_groups(impl->matched_slots.data(), impl->slot_count, groups);
+  return true;
+}
+
+bool pike_vm::captures(const string& input, vector<match>& groups)
+{
+  return captures(input.data(), input.data() + input.size(), groups);
+}
+
+/* -- Constants -- */
+
+const size_t match::NO_POSITION;
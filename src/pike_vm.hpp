@@ -0,0 +1,104 @@
+/**
+ * @file	pike_vm.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which executes a compiled program by simulating all NFA threads in lockstep.
+   *
+   * Matching always completes in O(n * m) time for input length n and program size m. Matches are
+   * reported with leftmost-first semantics: the leftmost match is returned and, among matches
+   * starting at the same position, the one preferred by the expression's greedy operators and the
+   * order of its alternatives.
+   *
+   * All working storage is allocated when the VM is constructed, so searches do not allocate. For
+   * the same reason, a single instance must not be used by multiple threads at once.
+   */
+  class pike_vm
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::pike_vm` for the specified program.
+     *
+     * @param prog The program to execute.
+     * @param pre An optional prefilter, used to skip input whenever no threads are active.
+     */
+    pike_vm(std::shared_ptr<const regex::program> prog, std::shared_ptr<const regex::prefilter> pre = nullptr);
+
+    /** Destructor. */
+    ~pike_vm();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the program matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end);
+
+    /** Returns `true` if the program matches anywhere in the input string. */
+    bool is_match(const std::string& input);
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result);
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result);
+
+    /**
+     * Finds the leftmost-first match in the input range, along with the bounds of each capture group
+     * within it.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to hold one entry per
+     * group, with the overall match first.
+     */
+    bool captures(const char* begin, const char* end, std::vector<regex::match>& groups);
+
+    /**
+     * Finds the leftmost-first match in the input string, along with the bounds of each capture group
+     * within it.
+     *
+     * @return `true` if a match was found, in which case `groups` is resized to hold one entry per
+     * group, with the overall match first.
+     */
+    bool captures(const std::string& input, std::vector<regex::match>& groups);
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
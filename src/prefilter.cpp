@@ -0,0 +1,300 @@
+/**
+ * @file	prefilter.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "byte_search.hpp"
+#include "multi_literal_search.hpp"
+#include "prefilter.hpp"
+#include "prefix_analysis.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /**
+   * The maximum number of first bytes for which an expression in a set without a literal prefix
+   * still contributes each byte as a literal, rather than disabling the set's prefilter.
+   */
+  const size_t SET_FIRST_BYTE_LIMIT = 16;
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the length of the longest of the specified literals. */
+  size_t longest_length(const vector<string>& literals)
+  {
+    size_t length = 0;
+    for (const auto& literal : literals)
+      length = max(length, literal.size());
+    return length;
+  }
+
+}
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /** Prefilter which finds a required literal prefix. */
+  class substring_prefilter : public prefilter
+  {
+  public:
+
+    substring_prefilter(const string& needle)
+      : m_needle(needle)
+    { }
+
+    virtual const char* find(const char* begin, const char* end) const override
+    {
+      return find_substring(begin, end, m_needle.data(), m_needle.size());
+    }
+
+    virtual string description() const override
+    {
+      return "substring \"" + m_needle + "\"";
+    }
+
+    virtual size_t max_length() const override
+    {
+      return m_needle.size();
+    }
+
+    virtual size_t memory_usage() const override
+    {
+      return sizeof(*this) + m_needle.capacity();
+    }
+
+  private:
+
+    const string m_needle;
+
+  };
+
+  /** Prefilter which finds any one of up to three possible first bytes. */
+  class first_byte_prefilter : public prefilter
+  {
+  public:
+
+    first_byte_prefilter(const vector<unsigned char>& bytes)
+      : m_bytes(bytes)
+    { }
+
+    virtual const char* find(const char* begin, const char* end) const override
+    {
+      switch (m_bytes.size())
+      {
+      case 1:
+        return find_byte(begin, end, m_bytes[0]);
+      case 2:
+        return find_byte2(begin, end, m_bytes[0], m_bytes[1]);
+      default:
+        return find_byte3(begin, end, m_bytes[0], m_bytes[1], m_bytes[2]);
+      }
+    }
+
+    virtual string description() const override
+    {
+      ostringstream description;
+      description << "first bytes {";
+      for (size_t idx = 0; idx < m_bytes.size(); idx++)
+        description << (idx == 0 ? "" : ", ") << static_cast<int>(m_bytes[idx]);
+      description << "}";
+      return description.str();
+    }
+
+    virtual size_t max_length() const override
+    {
+      return 1;
+    }
+
+    virtual size_t memory_usage() const override
+    {
+      return sizeof(*this) + m_bytes.capacity();
+    }
+
+  private:
+
+    const vector<unsigned char> m_bytes;
+
+  };
+
+  /** Prefilter which finds any one of a small set of literals with packed SIMD comparisons. */
+  class packed_prefilter : public prefilter
+  {
+  public:
+
+    packed_prefilter(const vector<string>& literals)
+      : m_searcher(literals),
+        m_count(literals.size()),
+        m_max_length(longest_length(literals))
+    { }
+
+    virtual const char* find(const char* begin, const char* end) const override
+    {
+      return m_searcher.find(begin, end);
+    }
+
+    virtual string description() const override
+    {
+      return "packed " + to_string(m_count) + " literals";
+    }
+
+    virtual size_t max_length() const override
+    {
+      return m_max_length;
+    }
+
+    virtual size_t memory_usage() const override
+    {
+      return sizeof(*this) + m_searcher.memory_usage();
+    }
+
+  private:
+
+    const packed_searcher m_searcher;
+    const size_t m_count;
+    const size_t m_max_length;
+
+  };
+
+  /** Prefilter which finds any one of a set of literals with an Aho-Corasick automaton. */
+  class aho_corasick_prefilter : public prefilter
+  {
+  public:
+
+    aho_corasick_prefilter(const vector<string>& literals)
+      : m_automaton(literals),
+        m_count(literals.size()),
+        m_max_length(longest_length(literals))
+    { }
+
+    virtual const char* find(const char* begin, const char* end) const override
+    {
+      return m_automaton.find(begin, end);
+    }
+
+    virtual string description() const override
+    {
+      return "aho-corasick " + to_string(m_count) + " literals";
+    }
+
+    virtual size_t max_length() const override
+    {
+      return m_max_length;
+    }
+
+    virtual size_t memory_usage() const override
+    {
+      return sizeof(*this) + m_automaton.memory_usage();
+    }
+
+  private:
+
+    const aho_corasick m_automaton;
+    const size_t m_count;
+    const size_t m_max_length;
+
+  };
+
+}
+
+/* -- Procedures -- */
+
+shared_ptr<const prefilter> regex::make_prefilter(const prefix_info& info)
+{
+  // if the empty string matches, a match can start anywhere
+  if (info.nullable)
+    return nullptr;
+
+  if (info.prefix.size() > 1)
+    return make_shared<substring_prefilter>(info.prefix);
+
+  // a handful of single bytes are found faster by the byte search procedures
+  auto literals = info.literals;
+  sort(literals.begin(), literals.end());
+  literals.erase(unique(literals.begin(), literals.end()), literals.end());
+  auto single_bytes = all_of(literals.begin(), literals.end(), [] (const string& literal) { return literal.size() == 1; });
+  if (literals.size() > 1 && !(single_bytes && literals.size() <= 3))
+  {
+    if (literals.size() <= packed_searcher::MAX_LITERALS && packed_searcher::is_supported())
+      return make_shared<packed_prefilter>(literals);
+    return make_shared<aho_corasick_prefilter>(literals);
+  }
+
+  auto count = info.first_bytes.count();
+  if (count == 0 || count > 3)
+    return nullptr;
+
+  vector<unsigned char> bytes;
+  for (size_t byte = 0; byte < info.first_bytes.size(); byte++)
+    if (info.first_bytes.test(byte))
+      bytes.push_back(static_cast<unsigned char>(byte));
+  return make_shared<first_byte_prefilter>(bytes);
+}
+
+shared_ptr<const prefilter> regex::make_prefilter(const unique_ptr<const syntax_node>& root)
+{
+  return make_prefilter(analyze_prefix(root));
+}
+
+shared_ptr<const prefilter> regex::make_prefilter(const syntax_tree& tree)
+{
+  return make_prefilter(analyze_prefix(tree));
+}
+
+shared_ptr<const prefilter> regex::make_set_prefilter(const vector<syntax_tree>& trees)
+{
+  // a match of the set must begin with one of the literals of some expression, so the set is
+  // described by the union of its expressions' literals, each of which must have a usable set
+  prefix_info combined;
+  for (const auto& tree : trees)
+  {
+    auto info = analyze_prefix(tree);
+    if (info.nullable)
+      return nullptr;
+
+    combined.first_bytes |= info.first_bytes;
+    if (!info.literals.empty())
+      combined.literals.insert(combined.literals.end(), info.literals.begin(), info.literals.end());
+    else if (!info.prefix.empty())
+      combined.literals.push_back(info.prefix);
+    else
+    {
+      // with no literal, the expression's first bytes serve as literals of one byte each
+      if (info.first_bytes.count() > SET_FIRST_BYTE_LIMIT)
+        return nullptr;
+      for (size_t byte = 0; byte < info.first_bytes.size(); byte++)
+        if (info.first_bytes.test(byte))
+          combined.literals.push_back(string(1, static_cast<char>(byte)));
+    }
+  }
+
+  sort(combined.literals.begin(), combined.literals.end());
+  combined.literals.erase(unique(combined.literals.begin(), combined.literals.end()), combined.literals.end());
+  if (combined.literals.size() == 1)
+    combined.prefix = combined.literals.front();
+  return make_prefilter(combined);
+}
@@ -0,0 +1,98 @@
+/**
+ * @file	prefilter.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "prefix_analysis.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Abstract base class for types which quickly skip over input which cannot start a match.
+   *
+   * A prefilter never misses a position at which a match could start, but may report positions at
+   * which no match actually starts. Engines use it to jump directly to candidate positions whenever
+   * they have no partial matches in progress, and verify each candidate with the full automaton.
+   */
+  class prefilter
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Destructor. */
+    virtual ~prefilter() = default;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns a pointer to the first position in `[begin, end)` at which a match might start, or
+     * `end` if there is none.
+     */
+    virtual const char* find(const char* begin, const char* end) const = 0;
+
+    /** Returns a short description of this prefilter. */
+    virtual std::string description() const = 0;
+
+    /** Returns the length of the longest literal this prefilter searches for. */
+    virtual size_t max_length() const = 0;
+
+    /** Returns the estimated number of bytes used by this prefilter's tables. */
+    virtual size_t memory_usage() const = 0;
+
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Creates the most effective prefilter for an expression with the specified prefix information.
+   *
+   * @return The prefilter, or `nullptr` if no prefilter would be useful for this expression.
+   */
+  std::shared_ptr<const regex::prefilter> make_prefilter(const regex::prefix_info& info);
+
+  /**
+   * Creates the most effective prefilter for the syntax tree rooted at the specified node.
+   *
+   * @return The prefilter, or `nullptr` if no prefilter would be useful for this expression.
+   */
+  std::shared_ptr<const regex::prefilter> make_prefilter(const std::unique_ptr<const regex::syntax_node>& root);
+
+  /**
+   * Creates the most effective prefilter for the specified arena syntax tree.
+   *
+   * @return The prefilter, or `nullptr` if no prefilter would be useful for this expression.
+   */
+  std::shared_ptr<const regex::prefilter> make_prefilter(const regex::syntax_tree& tree);
+
+  /**
+   * Creates the most effective prefilter for a set of expressions, which finds every position at
+   * which any one of them could match.
+   *
+   * @return The prefilter, or `nullptr` if no prefilter would be useful for every expression.
+   */
+  std::shared_ptr<const regex::prefilter> make_set_prefilter(const std::vector<regex::syntax_tree>& trees);
+
+}
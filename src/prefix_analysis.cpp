@@ -0,0 +1,273 @@
+/**
+ * @file	prefix_analysis.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "prefix_analysis.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /**
+   * The maximum number of literals tracked for an expression, unless the expression has more syntax
+   * nodes than this. A large alternation of words may need a literal for each of its nodes, but a
+   * short expression should not expand into a huge set.
+   */
+  const size_t MAX_LITERALS = 4096;
+
+  /** The maximum length of each tracked literal. Longer literals are truncated. */
+  const size_t MAX_LITERAL_LENGTH = 64;
+
+  /** The maximum number of characters in a class for which each is tracked as a literal. */
+  const size_t MAX_CLASS_LITERALS = 16;
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Returns the longest common prefix of two strings. */
+  string common_prefix(const string& lhs, const string& rhs)
+  {
+    auto mismatch_pos = mismatch(lhs.begin(), lhs.begin() + min(lhs.size(), rhs.size()), rhs.begin());
+    return string(lhs.begin(), mismatch_pos.first);
+  }
+
+  /** Discards the literals of `info` if they are inexact and one is empty, and so rules nothing out. */
+  void discard_empty_literal(prefix_info& info)
+  {
+    if (!info.literals_exact && any_of(info.literals.begin(), info.literals.end(), [] (const string& literal) { return literal.empty(); }))
+      info.literals.clear();
+  }
+
+  /** Updates `lhs` to describe the concatenation of `lhs` followed by `rhs`. */
+  void concatenate_prefix(prefix_info& lhs, prefix_info rhs, size_t limit)
+  {
+    if (lhs.exact)
+      lhs.prefix += rhs.prefix;
+    lhs.exact = (lhs.exact && rhs.exact);
+    if (lhs.nullable)
+      lhs.first_bytes |= rhs.first_bytes;
+    lhs.nullable = (lhs.nullable && rhs.nullable);
+
+    // a nullable right-hand side only has literals if they are exact and include the empty string,
+    // so every match of the right-hand side begins with one of its literals
+    if (lhs.literals_exact && !rhs.literals.empty() && lhs.literals.size() * rhs.literals.size() <= limit)
+    {
+      vector<string> literals;
+      literals.reserve(lhs.literals.size() * rhs.literals.size());
+      lhs.literals_exact = rhs.literals_exact;
+      for (const auto& head : lhs.literals)
+      {
+        for (const auto& tail : rhs.literals)
+        {
+          literals.push_back(head + tail);
+          if (literals.back().size() > MAX_LITERAL_LENGTH)
+          {
+            literals.back().resize(MAX_LITERAL_LENGTH);
+            lhs.literals_exact = false;
+          }
+        }
+      }
+      lhs.literals = move(literals);
+    }
+    else
+      lhs.literals_exact = false;
+    discard_empty_literal(lhs);
+  }
+
+  /** Updates `lhs` to describe the alternation of `lhs` and `rhs`. */
+  void alternate_prefix(prefix_info& lhs, prefix_info rhs, size_t limit)
+  {
+    lhs.exact = (lhs.exact && rhs.exact && lhs.prefix == rhs.prefix);
+    lhs.prefix = common_prefix(lhs.prefix, rhs.prefix);
+    lhs.first_bytes |= rhs.first_bytes;
+    lhs.nullable = (lhs.nullable || rhs.nullable);
+
+    if (!lhs.literals.empty() && !rhs.literals.empty() && lhs.literals.size() + rhs.literals.size() <= limit)
+    {
+      lhs.literals.insert(lhs.literals.end(),
+                          make_move_iterator(rhs.literals.begin()),
+                          make_move_iterator(rhs.literals.end()));
+      lhs.literals_exact = (lhs.literals_exact && rhs.literals_exact);
+      discard_empty_literal(lhs);
+    }
+    else
+    {
+      lhs.literals.clear();
+      lhs.literals_exact = false;
+    }
+  }
+
+  /** Recursively analyzes a syntax tree. */
+  prefix_info recursive_analyze_prefix(const syntax_tree& tree, syntax_index index, size_t limit)
+  {
+    prefix_info info;
+    auto children = tree.children(index);
+    switch (tree.type(index))
+    {
+    case syntax_node_type::literal:
+    {
+      auto character = tree.character(index);
+      info.prefix = string(1, character);
+      info.exact = true;
+      info.first_bytes.set(static_cast<unsigned char>(character));
+      info.literals.push_back(info.prefix);
+      info.literals_exact = true;
+      break;
+    }
+
+    case syntax_node_type::wildcard:
+      info.first_bytes.set();
+      break;
+
+    case syntax_node_type::character_class:
+    {
+      // a small class behaves as an alternation of its characters
+      const auto& bitmap = tree.bitmap(index);
+      info.first_bytes = bitmap;
+      if (bitmap.none() || bitmap.count() > MAX_CLASS_LITERALS)
+        break;
+
+      for (size_t byte = 0; byte < bitmap.size(); byte++)
+        if (bitmap.test(byte))
+          info.literals.push_back(string(1, static_cast<char>(byte)));
+      info.literals_exact = true;
+
+      if (info.literals.size() == 1)
+      {
+        info.prefix = info.literals.front();
+        info.exact = true;
+      }
+      break;
+    }
+
+    case syntax_node_type::string:
+    {
+      const auto& text = tree.text(index);
+      info.prefix = text;
+      info.exact = true;
+      info.first_bytes.set(static_cast<unsigned char>(text[0]));
+      info.literals.push_back(text.substr(0, MAX_LITERAL_LENGTH));
+      info.literals_exact = (text.size() <= MAX_LITERAL_LENGTH);
+      break;
+    }
+
+    case syntax_node_type::concatenation:
+      info = recursive_analyze_prefix(tree, children[0], limit);
+      for (size_t idx = 1; idx < children.size(); idx++)
+        concatenate_prefix(info, recursive_analyze_prefix(tree, children[idx], limit), limit);
+      break;
+
+    case syntax_node_type::alternation:
+      info = recursive_analyze_prefix(tree, children[0], limit);
+      for (size_t idx = 1; idx < children.size(); idx++)
+        alternate_prefix(info, recursive_analyze_prefix(tree, children[idx], limit), limit);
+      break;
+
+    case syntax_node_type::optional:
+    {
+      // an optional set of literals is the same set with the empty string, which is least preferred
+      auto body = recursive_analyze_prefix(tree, children[0], limit);
+      info.first_bytes = body.first_bytes;
+      info.nullable = true;
+      if (body.literals_exact)
+      {
+        info.literals = move(body.literals);
+        info.literals.push_back(string());
+        info.literals_exact = true;
+      }
+      break;
+    }
+
+    case syntax_node_type::kleene:
+    {
+      auto body = recursive_analyze_prefix(tree, children[0], limit);
+      info.first_bytes = body.first_bytes;
+      info.nullable = true;
+      break;
+    }
+
+    case syntax_node_type::quantifier:
+    {
+      // the mandatory repetitions behave as a concatenation, and any optional ones as an optional
+      // closure, which contributes nothing but its first bytes
+      auto body = recursive_analyze_prefix(tree, children[0], limit);
+      auto min_count = tree.min_count(index);
+      if (min_count == 0)
+      {
+        info.first_bytes = body.first_bytes;
+        info.nullable = true;
+        break;
+      }
+
+      info = body;
+      for (uint32_t count = 1; count < min_count && (info.exact || info.literals_exact); count++)
+        concatenate_prefix(info, body, limit);
+
+      if (min_count < tree.max_count(index))
+      {
+        prefix_info rest;
+        rest.first_bytes = body.first_bytes;
+        rest.nullable = true;
+        concatenate_prefix(info, rest, limit);
+      }
+      break;
+    }
+
+    case syntax_node_type::capture:
+      info = recursive_analyze_prefix(tree, children[0], limit);
+      break;
+
+    case syntax_node_type::repeat:
+    {
+      auto body = recursive_analyze_prefix(tree, children[0], limit);
+      info.prefix = body.prefix;
+      info.first_bytes = body.first_bytes;
+      info.nullable = body.nullable;
+      info.literals = move(body.literals);
+      discard_empty_literal(info);
+      break;
+    }
+    }
+
+    return info;
+  }
+
+}
+
+/* -- Procedures -- */
+
+prefix_info regex::analyze_prefix(const unique_ptr<const syntax_node>& root)
+{
+  assert(root != nullptr);
+  return analyze_prefix(make_syntax_tree(root));
+}
+
+prefix_info regex::analyze_prefix(const syntax_tree& tree)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  return recursive_analyze_prefix(tree, tree.root(), max(MAX_LITERALS, tree.size()));
+}
@@ -0,0 +1,70 @@
+/**
+ * @file	prefix_analysis.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <bitset>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Struct describing what every match of an expression must begin with.
+   */
+  struct prefix_info
+  {
+    /** A literal string which every match must begin with. */
+    std::string prefix;
+
+    /** `true` if the expression matches exactly `prefix` and nothing else. */
+    bool exact = false;
+
+    /** The set of bytes which a non-empty match may begin with. */
+    std::bitset<256> first_bytes;
+
+    /** `true` if the expression can match the empty string. */
+    bool nullable = false;
+
+    /**
+     * A set of non-empty literal strings, one of which every match must begin with, or an empty set
+     * if no such set of reasonable size is known. May contain duplicates. If `literals_exact` is
+     * set, the literals are in order of preference, and a nullable expression's set also contains
+     * the empty string.
+     */
+    std::vector<std::string> literals;
+
+    /** `true` if the expression matches exactly the strings in `literals` and nothing else. */
+    bool literals_exact = false;
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Analyzes the syntax tree rooted at the specified node to determine how its matches must begin.
+   */
+  regex::prefix_info analyze_prefix(const std::unique_ptr<const regex::syntax_node>& root);
+
+  /**
+   * Analyzes the specified arena syntax tree to determine how its matches must begin.
+   */
+  regex::prefix_info analyze_prefix(const regex::syntax_tree& tree);
+
+}
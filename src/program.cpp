@@ -0,0 +1,150 @@
+/**
+ * @file	program.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+/* -- Includes -- */
+
+#include <array>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "program.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Procedures -- */
+
+vector<unsigned char> byte_class_map::representatives() const
+{
+  vector<unsigned char> result(m_count);
+  for (size_t byte = m_classes.size(); byte-- > 0; )
+    result[m_classes[byte]] = static_cast<unsigned char>(byte);
+  return result;
+}
+
+void byte_class_map::split(const bitset<256>& bytes)
+{
+  // renumber by (old class, membership), in order of first appearance so classes stay sorted
+  static const int NO_CLASS = -1;
+  array<int, 512> renumbered;
+  renumbered.fill(NO_CLASS);
+
+  m_count = 0;
+  for (size_t byte = 0; byte < m_classes.size(); byte++)
+  {
+    auto& cls = renumbered[m_classes[byte] * 2 + (bytes.test(byte) ? 1 : 0)];
+    if (cls == NO_CLASS)
+      cls = static_cast<int>(m_count++);
+    m_classes[byte] = static_cast<uint8_t>(cls);
+  }
+}
+
+byte_class_map regex::make_byte_classes(const program& prog)
+{
+  // start with a single class, then split it by each distinct set of bytes an instruction consumes
+  byte_class_map classes;
+  classes.merge_all();
+
+  vector<bool> split_bytes(256, false);
+  vector<bool> split_sets(prog.byte_sets.size(), false);
+  for (const auto& inst : prog.instructions)
+  {
+    if (inst.op == opcode::byte && !split_bytes[inst.argument])
+    {
+      split_bytes[inst.argument] = true;
+      bitset<256> bytes;
+      classes.split(bytes.set(inst.argument));
+    }
+    else if (inst.op == opcode::byte_set && !split_sets[inst.argument])
+    {
+      split_sets[inst.argument] = true;
+      classes.split(prog.byte_sets[inst.argument]);
+    }
+  }
+
+  return classes;
+}
+
+void regex::print_program(const program& prog)
+{
+  cout << "Byte classes: " << prog.byte_classes.count() << endl;
+
+  for (size_t pc = 0; pc < prog.instructions.size(); pc++)
+  {
+    const auto& inst = prog.instructions[pc];
+
+    cout << pc;
+    if (pc == prog.anchored_start)
+      cout << " (anchored)";
+    if (pc == prog.unanchored_start)
+      cout << " (unanchored)";
+    cout << ": " << opcode_string(inst.op);
+
+    switch (inst.op)
+    {
+    case opcode::byte:
+      if (isprint(static_cast<int>(inst.argument)))
+        cout << " '" << static_cast<char>(inst.argument) << "'";
+      else
+        cout << " 0x" << hex << inst.argument << dec;
+      cout << " -> " << inst.next;
+      break;
+
+    case opcode::byte_set:
+      cout << " " << inst.argument << " (" << prog.byte_sets[inst.argument].count() << " bytes) -> " << inst.next;
+      break;
+
+    case opcode::any:
+    case opcode::jump:
+      cout << " -> " << inst.next;
+      break;
+
+    case opcode::split:
+      cout << " -> " << inst.next << ", " << inst.alternate;
+      break;
+
+    case opcode::save:
+      cout << " " << inst.argument << " -> " << inst.next;
+      break;
+
+    case opcode::match:
+      cout << " " << inst.argument;
+      break;
+    }
+
+    cout << endl;
+  }
+}
+
+const string& regex::opcode_string(opcode op)
+{
+  static const string STRING_BYTE		= "Byte";
+  static const string STRING_BYTE_SET		= "ByteSet";
+  static const string STRING_ANY		= "Any";
+  static const string STRING_SPLIT		= "Split";
+  static const string STRING_JUMP		= "Jump";
+  static const string STRING_SAVE		= "Save";
+  static const string STRING_MATCH		= "Match";
+  static const string STRING_DEFAULT		= "Unknown";
+
+  switch (op)
+  {
+  case opcode::byte:		return STRING_BYTE;
+  case opcode::byte_set:	return STRING_BYTE_SET;
+  case opcode::any:		return STRING_ANY;
+  case opcode::split:		return STRING_SPLIT;
+  case opcode::jump:		return STRING_JUMP;
+  case opcode::save:		return STRING_SAVE;
+  case opcode::match:		return STRING_MATCH;
+  default:			return STRING_DEFAULT;
+  }
+}
@@ -0,0 +1,171 @@
+/**
+ * @file	program.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Enumeration of instruction opcodes for a compiled regular expression program.
+   */
+  enum class opcode : uint8_t
+  {
+    byte,
+    byte_set,
+    any,
+    split,
+    jump,
+    save,
+    match,
+  };
+
+  /**
+   * Struct representing a single instruction in a compiled program.
+   *
+   * The meaning of the fields depends on the opcode:
+   * - `byte`: consumes one byte equal to `argument`, then continues at `next`.
+   * - `byte_set`: consumes one byte in the set `byte_sets[argument]`, then continues at `next`.
+   * - `any`: consumes any byte, then continues at `next`.
+   * - `split`: continues at both `next` and `alternate`, preferring `next`.
+   * - `jump`: continues at `next`.
+   * - `save`: records the current position in capture slot `argument`, then continues at `next`.
+   * - `match`: reports a match of the pattern numbered `argument`.
+   */
+  struct instruction
+  {
+    regex::opcode op;
+    uint32_t argument;
+    uint32_t next;
+    uint32_t alternate;
+  };
+
+  /**
+   * Class mapping each byte to its equivalence class.
+   *
+   * Two bytes are in the same class if no instruction of a program can tell them apart, so an
+   * automaton built for the program only needs one transition per class rather than one per byte.
+   * Classes are numbered from `0` in order of their smallest member. A default-constructed map
+   * places every byte in its own class.
+   */
+  class byte_class_map
+  {
+  public:
+
+    /** Constructs a map placing every byte in its own class. */
+    byte_class_map()
+      : m_count(256)
+    {
+      for (size_t byte = 0; byte < m_classes.size(); byte++)
+        m_classes[byte] = static_cast<uint8_t>(byte);
+    }
+
+    /** Returns the class of the specified byte. */
+    uint8_t operator[](unsigned char byte) const
+    {
+      return m_classes[byte];
+    }
+
+    /** Returns the number of classes. */
+    uint32_t count() const
+    {
+      return m_count;
+    }
+
+    /** Returns the class of each byte, indexed by byte. */
+    const uint8_t* data() const
+    {
+      return m_classes.data();
+    }
+
+    /** Returns the smallest member of each class, indexed by class. */
+    std::vector<unsigned char> representatives() const;
+
+    /** Places every byte in a single class. */
+    void merge_all()
+    {
+      m_classes.fill(0);
+      m_count = 1;
+    }
+
+    /** Splits every class into the members which are and are not in the specified set. */
+    void split(const std::bitset<256>& bytes);
+
+  private:
+
+    std::array<uint8_t, 256> m_classes;
+    uint32_t m_count;
+
+  };
+
+  /**
+   * Struct representing a compiled regular expression program.
+   *
+   * The program is a flat Thompson NFA. Execution may begin at one of two entry points: the
+   * anchored start, which only matches at the beginning of the input, or the unanchored start,
+   * which is preceded by a non-greedy `.*` loop and so may match anywhere.
+   */
+  struct program
+  {
+    /** The instructions making up this program. */
+    std::vector<regex::instruction> instructions;
+
+    /** The sets of bytes consumed by `byte_set` instructions. */
+    std::vector<std::bitset<256>> byte_sets;
+
+    /** The partition of bytes which the instructions of this program cannot tell apart. */
+    regex::byte_class_map byte_classes;
+
+    /** The entry point for an anchored search. */
+    uint32_t anchored_start = 0;
+
+    /** The entry point for an unanchored search. */
+    uint32_t unanchored_start = 0;
+
+    /** The number of capture slots written by `save` instructions. */
+    size_t slot_count = 0;
+
+    /** The number of patterns compiled into this program, numbered by their `match` instructions. */
+    size_t pattern_count = 1;
+
+    /** `true` if this program matches the reversed language, for scanning input backwards. */
+    bool reverse = false;
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Computes the byte equivalence classes of the specified program from its byte-consuming
+   * instructions.
+   */
+  regex::byte_class_map make_byte_classes(const regex::program& prog);
+
+  /**
+   * Prints a listing of the specified program.
+   */
+  void print_program(const regex::program& prog);
+
+  /**
+   * Returns a string for the specified `regex::opcode` enum.
+   */
+  const std::string& opcode_string(regex::opcode op);
+
+}
@@ -0,0 +1,281 @@
+/**
+ * @file	regex_set.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compiler.hpp"
+#include "dfa_cache.hpp"
+#include "dfa_state_builder.hpp"
+#include "engine_pool.hpp"
+#include "lexical_analyzer.hpp"
+#include "pattern.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+#include "regex_set.hpp"
+#include "simplifier.hpp"
+#include "syntax.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** The estimated bytes of DFA states a scan may build before it is checked for thrashing. */
+  const size_t THRASH_MIN_BUILT = (1 << 20);
+
+  /** The most bytes of DFA states a scan may build per byte of input without thrashing. */
+  const size_t THRASH_BUILT_PER_BYTE = 16;
+
+}
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /**
+   * Class which scans input for every pattern in a set program.
+   *
+   * Threads are never dropped in favor of a higher-priority match, so that every pattern's match
+   * instruction is reachable regardless of which others have matched. The input is scanned by a
+   * lazy DFA, which skips ahead with the set's prefilter whenever no match is in progress.
+   */
+  class set_scanner
+  {
+  public:
+
+    set_scanner(shared_ptr<const program> prog, shared_ptr<const prefilter> pre, size_t cache_size)
+      : m_pre(move(pre)),
+        m_cache(prog, prog->unanchored_start, match_kind::longest, cache_size, m_pre != nullptr),
+        m_seen(prog->pattern_count, false)
+    { }
+
+    /**
+     * Scans the input, adding the indices of matching patterns to `indices`. If `stop_early` is set,
+     * returns as soon as any pattern matches.
+     *
+     * @return `false` if the scan was abandoned because the DFA needs too many states, in which case
+     * `indices` holds the patterns found before it was abandoned.
+     */
+    bool scan(const char* begin, const char* end, bool stop_early, vector<size_t>& indices)
+    {
+      fill(m_seen.begin(), m_seen.end(), false);
+      auto initial_built = m_cache.built_usage();
+      auto state = m_cache.start_state();
+
+      // the start state is only tagged if there is a prefilter, and is then never a match state
+      auto ptr = begin;
+      if (state & dfa_cache::START_FLAG)
+        ptr = m_pre->find(begin, end);
+
+      for (;;)
+      {
+        if (state & dfa_cache::MATCH_FLAG)
+        {
+          record(m_cache.match_ids(state), indices);
+
+          // once every pattern has matched, there is nothing left to find
+          if (stop_early || indices.size() == m_seen.size())
+            return true;
+        }
+
+        if (ptr == end)
+          return true;
+
+        auto built = m_cache.built_usage();
+        state = m_cache.next_state(state, static_cast<unsigned char>(*ptr++));
+        if (m_cache.built_usage() != built &&
+            thrashing(m_cache.built_usage() - initial_built, static_cast<size_t>(ptr - begin)))
+          return false;
+
+        // there is no match in progress, so skip ahead to the next candidate
+        if (state & dfa_cache::START_FLAG)
+          ptr = m_pre->find(ptr, end);
+      }
+    }
+
+  private:
+
+    const shared_ptr<const prefilter> m_pre;
+    dfa_cache m_cache;
+    vector<bool> m_seen;
+
+    /**
+     * Returns `true` if a scan has built `built` bytes of states within its first `scanned` bytes,
+     * so many that building states costs far more than following their transitions.
+     */
+    static bool thrashing(size_t built, size_t scanned)
+    {
+      return (built > THRASH_MIN_BUILT && built > scanned * THRASH_BUILT_PER_BYTE);
+    }
+
+    /** Adds the patterns matched in the specified state which have not been seen yet to `indices`. */
+    void record(const vector<uint32_t>& ids, vector<size_t>& indices)
+    {
+      for (auto id : ids)
+      {
+        if (!m_seen[id])
+        {
+          m_seen[id] = true;
+          indices.push_back(id);
+        }
+      }
+    }
+
+  };
+
+}
+
+/* -- Types -- */
+
+struct regex_set::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const vector<string>& expressions, const regex_set_options& options)
+    : expressions(expressions),
+      options(options),
+      scanners([this] { return make_unique<set_scanner>(prog, pre, this->options.dfa_cache_size); }),
+      thrashing(false)
+  {
+    vector<syntax_tree> trees;
+    for (const auto& expression : expressions)
+    {
+      lexical_analyzer lex(expression);
+      syntax_analyzer parse(lex.all_tokens());
+      trees.push_back(simplify(parse.parse_tree()));
+    }
+
+    prog = compile_set(trees);
+    pre = make_set_prefilter(trees);
+  }
+
+  /* -- Fields -- */
+
+  const vector<string> expressions;
+  const regex_set_options options;
+  shared_ptr<const program> prog;
+  shared_ptr<const prefilter> pre;
+  engine_pool<set_scanner> scanners;
+
+  /** `true` once a scan has found the DFA thrashing, after which patterns are scanned separately. */
+  atomic<bool> thrashing;
+
+  /** The individually compiled patterns, which are only compiled once the DFA has thrashed. */
+  once_flag patterns_compiled;
+  vector<unique_ptr<const pattern>> patterns;
+
+  /* -- Methods -- */
+
+  /**
+   * Scans the input for every pattern, storing the indices of matching patterns in `indices`. If
+   * `stop_early` is set, returns as soon as any pattern matches.
+   */
+  bool scan(const char* begin, const char* end, bool stop_early, vector<size_t>& indices)
+  {
+    indices.clear();
+
+    bool complete = !thrashing && scanners.with_engine([=, &indices] (set_scanner& scanner) {
+        return scanner.scan(begin, end, stop_early, indices);
+      });
+
+    if (!complete)
+    {
+      thrashing = true;
+      scan_patterns(begin, end, stop_early, indices);
+    }
+
+    sort(indices.begin(), indices.end());
+    return !indices.empty();
+  }
+
+  /**
+   * Scans the input for each pattern separately, skipping those already in `indices`. Each scan
+   * stops at its pattern's first match, so patterns are no longer tracked once they have matched.
+   */
+  void scan_patterns(const char* begin, const char* end, bool stop_early, vector<size_t>& indices)
+  {
+    if (stop_early && !indices.empty())
+      return;
+
+    call_once(patterns_compiled, [this] {
+        for (const auto& expression : expressions)
+          patterns.push_back(make_unique<const pattern>(expression));
+      });
+
+    vector<bool> seen(patterns.size(), false);
+    for (auto idx : indices)
+      seen[idx] = true;
+
+    for (size_t idx = 0; idx < patterns.size(); idx++)
+    {
+      if (!seen[idx] && patterns[idx]->is_match(begin, end))
+      {
+        indices.push_back(idx);
+        if (stop_early)
+          return;
+      }
+    }
+  }
+
+};
+
+/* -- Procedures -- */
+
+regex_set::regex_set(const vector<string>& expressions, const regex_set_options& options)
+  : impl(make_unique<implementation>(expressions, options))
+{
+}
+
+regex_set::~regex_set() = default;
+
+size_t regex_set::size() const
+{
+  return impl->expressions.size();
+}
+
+const string& regex_set::expression(size_t index) const
+{
+  return impl->expressions.at(index);
+}
+
+bool regex_set::is_match(const char* begin, const char* end) const
+{
+  vector<size_t> indices;
+  return impl->scan(begin, end, true, indices);
+}
+
+bool regex_set::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool regex_set::matches(const char* begin, const char* end, vector<size_t>& indices) const
+{
+  return impl->scan(begin, end, false, indices);
+}
+
+bool regex_set::matches(const string& input, vector<size_t>& indices) const
+{
+  return matches(input.data(), input.data() + input.size(), indices);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file	regex_set.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Struct containing options for compiling a set of patterns.
+   */
+  struct regex_set_options
+  {
+    /** The maximum number of bytes each search engine may use for its DFA state cache. */
+    size_t dfa_cache_size = (8 << 20);
+  };
+
+  /**
+   * Class representing a set of regular expressions which are searched for together.
+   *
+   * All of the expressions are compiled into a single program, in which each expression ends in a
+   * match instruction numbered by its index in the set, and the program is executed as a lazily
+   * built DFA. A single pass over the input therefore reports every expression matching anywhere in
+   * it, at a cost per byte which does not depend on the number of expressions once the DFA's cache
+   * is warm. If every expression must begin with one of a few literals or bytes, the DFA skips
+   * ahead to the next occurrence of any of them whenever no match is in progress.
+   *
+   * Each DFA state tracks every expression, including those which have already matched, so a large
+   * set may need far more states than its cache can hold. If a search builds states much faster
+   * than it consumes input, the set instead searches for each expression separately, skipping those
+   * already found and stopping each search at its expression's first match, and continues to do so
+   * for all later searches.
+   *
+   * A `regex::regex_set` is immutable once constructed, and may safely be searched by multiple
+   * threads at the same time.
+   */
+  class regex_set
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Compiles a new `regex::regex_set` from the specified expressions.
+     *
+     * @exception regex::lexical_error
+     * Thrown if an expression cannot be tokenized.
+     *
+     * @exception regex::syntax_error
+     * Thrown if an expression cannot be parsed.
+     *
+     * @exception regex::compile_error
+     * Thrown if `expressions` is empty, or if the expressions are too large to compile.
+     */
+    regex_set(const std::vector<std::string>& expressions,
+              const regex::regex_set_options& options = regex::regex_set_options());
+
+    /** Destructor. */
+    ~regex_set();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of expressions in this set. */
+    size_t size() const;
+
+    /** Returns the expression with the specified index. */
+    const std::string& expression(size_t index) const;
+
+    /** Returns `true` if any expression in this set matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if any expression in this set matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds every expression in this set which matches anywhere in the input range.
+     *
+     * @return `true` if any expression matched, in which case the indices of all matching
+     * expressions are stored in `indices` in ascending order.
+     */
+    bool matches(const char* begin, const char* end, std::vector<size_t>& indices) const;
+
+    /**
+     * Finds every expression in this set which matches anywhere in the input string.
+     *
+     * @return `true` if any expression matched, in which case the indices of all matching
+     * expressions are stored in `indices` in ascending order.
+     */
+    bool matches(const std::string& input, std::vector<size_t>& indices) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
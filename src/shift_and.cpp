@@ -0,0 +1,479 @@
+/**
+ * @file	shift_and.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "compiler.hpp"
+#include "engine_pool.hpp"
+#include "lazy_dfa.hpp"
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+#include "shift_and.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Constants -- */
+
+namespace
+{
+
+  /** Length of a subexpression which can match arbitrarily long strings. */
+  const size_t UNBOUNDED_LENGTH = SIZE_MAX;
+
+  /** Number of positions whose followers are combined in each lookup table. */
+  const size_t CHUNK_BITS = 8;
+
+}
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /**
+   * Struct describing the Glushkov automaton of a subexpression.
+   */
+  struct glushkov_fragment
+  {
+    /** The positions which may consume the first byte of a match. */
+    uint64_t first;
+
+    /** The positions which may consume the last byte of a match. */
+    uint64_t last;
+
+    /** `true` if the subexpression matches the empty string. */
+    bool nullable;
+
+    /** The length of the longest match, or `UNBOUNDED_LENGTH`. */
+    size_t max_length;
+  };
+
+  /**
+   * Class building the position masks and follow sets of a syntax tree's Glushkov automaton.
+   */
+  class glushkov_builder
+  {
+  public:
+
+    glushkov_builder(const syntax_tree& tree)
+      : m_tree(tree),
+        m_count(0),
+        m_masks(256, 0),
+        m_follow(shift_and::MAX_POSITIONS, 0)
+    { }
+
+    /** Returns the number of positions in the subtree rooted at `index`, saturating past the maximum. */
+    static size_t count(const syntax_tree& tree, syntax_index index)
+    {
+      static const size_t LIMIT = shift_and::MAX_POSITIONS + 1;
+
+      switch (tree.type(index))
+      {
+      case syntax_node_type::literal:
+      case syntax_node_type::wildcard:
+      case syntax_node_type::character_class:
+        return 1;
+
+      case syntax_node_type::string:
+        return min(tree.text(index).size(), LIMIT);
+
+      case syntax_node_type::concatenation:
+      case syntax_node_type::alternation:
+      {
+        size_t total = 0;
+        for (auto child : tree.children(index))
+          total = min(total + count(tree, child), LIMIT);
+        return total;
+      }
+
+      case syntax_node_type::optional:
+      case syntax_node_type::kleene:
+      case syntax_node_type::repeat:
+      case syntax_node_type::capture:
+        return count(tree, tree.children(index)[0]);
+
+      case syntax_node_type::quantifier:
+      {
+        // {m,} is expanded to m copies followed by a star, and {m,n} to n copies
+        size_t copies = tree.max_count(index);
+        if (tree.max_count(index) == syntax_quantifier_node::UNBOUNDED)
+          copies = static_cast<size_t>(tree.min_count(index)) + 1;
+        return min(min(copies, LIMIT) * count(tree, tree.children(index)[0]), LIMIT);
+      }
+
+      default:
+        assert(false);
+        return LIMIT;
+      }
+    }
+
+    /** Builds the automaton for the subtree rooted at `index`. */
+    glushkov_fragment build(syntax_index index)
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+      {
+        bitset<256> bytes;
+        bytes.set(static_cast<unsigned char>(m_tree.character(index)));
+        return position(bytes);
+      }
+
+      case syntax_node_type::wildcard:
+      {
+        bitset<256> bytes;
+        return position(bytes.set());
+      }
+
+      case syntax_node_type::character_class:
+        return position(m_tree.bitmap(index));
+
+      case syntax_node_type::string:
+      {
+        auto result = empty();
+        for (auto ch : m_tree.text(index))
+        {
+          bitset<256> bytes;
+          bytes.set(static_cast<unsigned char>(ch));
+          concatenate(result, position(bytes));
+        }
+        return result;
+      }
+
+      case syntax_node_type::concatenation:
+      {
+        auto result = empty();
+        for (auto child : m_tree.children(index))
+          concatenate(result, build(child));
+        return result;
+      }
+
+      case syntax_node_type::alternation:
+      {
+        auto children = m_tree.children(index);
+        auto result = build(children[0]);
+        for (size_t idx = 1; idx < children.size(); idx++)
+        {
+          auto alternative = build(children[idx]);
+          result.first |= alternative.first;
+          result.last |= alternative.last;
+          result.nullable = result.nullable || alternative.nullable;
+          result.max_length = max(result.max_length, alternative.max_length);
+        }
+        return result;
+      }
+
+      case syntax_node_type::optional:
+        return optional(build(m_tree.children(index)[0]));
+
+      case syntax_node_type::kleene:
+        return optional(loop(build(m_tree.children(index)[0])));
+
+      case syntax_node_type::repeat:
+        return loop(build(m_tree.children(index)[0]));
+
+      case syntax_node_type::capture:
+        // only the overall bounds are reported, so groups are transparent
+        return build(m_tree.children(index)[0]);
+
+      case syntax_node_type::quantifier:
+      {
+        // each copy of the child gets positions of its own
+        auto child = m_tree.children(index)[0];
+        auto min_count = m_tree.min_count(index);
+        auto max_count = m_tree.max_count(index);
+
+        auto result = empty();
+        for (uint32_t idx = 0; idx < min_count; idx++)
+          concatenate(result, build(child));
+
+        if (max_count == syntax_quantifier_node::UNBOUNDED)
+          concatenate(result, optional(loop(build(child))));
+        else
+          for (uint32_t idx = min_count; idx < max_count; idx++)
+            concatenate(result, optional(build(child)));
+        return result;
+      }
+
+      default:
+        assert(false);
+        return empty();
+      }
+    }
+
+    /** Returns the number of positions added so far. */
+    size_t position_count() const
+    {
+      return m_count;
+    }
+
+    /** Returns the positions accepting each byte. */
+    const vector<uint64_t>& masks() const
+    {
+      return m_masks;
+    }
+
+    /** Returns the positions which may follow each position. */
+    const vector<uint64_t>& follow() const
+    {
+      return m_follow;
+    }
+
+  private:
+
+    const syntax_tree& m_tree;
+    size_t m_count;
+    vector<uint64_t> m_masks;
+    vector<uint64_t> m_follow;
+
+    /** Returns a fragment matching only the empty string. */
+    static glushkov_fragment empty()
+    {
+      return glushkov_fragment { 0, 0, true, 0 };
+    }
+
+    /** Adds a position accepting the specified bytes, and returns a fragment for it. */
+    glushkov_fragment position(const bitset<256>& bytes)
+    {
+      assert(m_count < shift_and::MAX_POSITIONS);
+      auto bit = uint64_t(1) << m_count++;
+      for (size_t byte = 0; byte < bytes.size(); byte++)
+        if (bytes.test(byte))
+          m_masks[byte] |= bit;
+      return glushkov_fragment { bit, bit, false, 1 };
+    }
+
+    /** Adds follow edges from every position in `from` to every position in `to`. */
+    void link(uint64_t from, uint64_t to)
+    {
+      for (; from != 0; from &= from - 1)
+        m_follow[__builtin_ctzll(from)] |= to;
+    }
+
+    /** Appends `next` to `result`. */
+    void concatenate(glushkov_fragment& result, const glushkov_fragment& next)
+    {
+      link(result.last, next.first);
+      if (result.nullable)
+        result.first |= next.first;
+      result.last = (next.nullable ? result.last | next.last : next.last);
+      result.nullable = result.nullable && next.nullable;
+      result.max_length = (result.max_length == UNBOUNDED_LENGTH || next.max_length == UNBOUNDED_LENGTH
+                           ? UNBOUNDED_LENGTH
+                           : result.max_length + next.max_length);
+    }
+
+    /** Makes a fragment also match the empty string. */
+    static glushkov_fragment optional(glushkov_fragment fragment)
+    {
+      fragment.nullable = true;
+      return fragment;
+    }
+
+    /** Makes a fragment match one or more repetitions of itself. */
+    glushkov_fragment loop(glushkov_fragment fragment)
+    {
+      link(fragment.last, fragment.first);
+      if (fragment.max_length != 0)
+        fragment.max_length = UNBOUNDED_LENGTH;
+      return fragment;
+    }
+
+  };
+
+}
+
+/* -- Types -- */
+
+struct shift_and::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(const syntax_tree& tree,
+                 shared_ptr<const program> forward,
+                 shared_ptr<const program> reverse,
+                 shared_ptr<const prefilter> pre,
+                 size_t cache_size)
+    : forward(move(forward)),
+      reverse(move(reverse)),
+      pre(move(pre)),
+      lazy_dfas([this, cache_size] { return make_unique<lazy_dfa>(this->forward, this->reverse, cache_size, this->pre); })
+  {
+    assert(tree.root() != syntax_tree::NO_NODE);
+    if (count_positions(tree) > MAX_POSITIONS)
+    {
+      ostringstream message;
+      message << "Expression exceeds limit of " << MAX_POSITIONS << " positions.";
+      throw compile_error(message.str());
+    }
+
+    glushkov_builder builder(tree);
+    auto root = builder.build(tree.root());
+    first = root.first;
+    last = root.last;
+    nullable = root.nullable;
+    max_length = root.max_length;
+    position_count = builder.position_count();
+    copy(builder.masks().begin(), builder.masks().end(), masks);
+
+    // the followers of each group of eight positions are precomputed for every subset of the group
+    chunk_count = (position_count + CHUNK_BITS - 1) / CHUNK_BITS;
+    follow.assign(chunk_count << CHUNK_BITS, 0);
+    for (size_t chunk = 0; chunk < chunk_count; chunk++)
+    {
+      for (size_t subset = 1; subset < (size_t(1) << CHUNK_BITS); subset++)
+      {
+        auto lowest = __builtin_ctz(static_cast<unsigned>(subset));
+        auto pos = chunk * CHUNK_BITS + lowest;
+        auto followers = (pos < position_count ? builder.follow()[pos] : 0);
+        follow[(chunk << CHUNK_BITS) + subset] = follow[(chunk << CHUNK_BITS) + (subset & (subset - 1))] | followers;
+      }
+    }
+  }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const program> forward;
+  const shared_ptr<const program> reverse;
+  const shared_ptr<const prefilter> pre;
+  engine_pool<lazy_dfa> lazy_dfas;
+
+  uint64_t masks[256];
+  vector<uint64_t> follow;
+  size_t chunk_count;
+  size_t position_count;
+  uint64_t first;
+  uint64_t last;
+  bool nullable;
+  size_t max_length;
+
+  /* -- Methods -- */
+
+  /** Scans forwards for the earliest end of any match, returning `nullptr` if there is none. */
+  const char* scan(const char* begin, const char* end) const
+  {
+    if (nullable)
+      return begin;
+
+    const uint64_t* table = follow.data();
+    uint64_t state = 0;
+
+    auto ptr = begin;
+    if (pre != nullptr)
+      ptr = pre->find(begin, end);
+
+    while (ptr != end)
+    {
+      // a match may begin at any byte, so the first positions are always candidates
+      uint64_t next = first;
+      for (size_t chunk = 0; chunk < chunk_count; chunk++)
+        next |= table[(chunk << CHUNK_BITS) + ((state >> (chunk * CHUNK_BITS)) & 0xFF)];
+      state = next & masks[static_cast<unsigned char>(*ptr++)];
+
+      if (state & last)
+        return ptr;
+
+      // no match is in progress, so skip ahead to the next candidate
+      if (state == 0 && pre != nullptr)
+        ptr = pre->find(ptr, end);
+    }
+
+    return nullptr;
+  }
+
+};
+
+/* -- Procedures -- */
+
+const size_t shift_and::MAX_POSITIONS;
+
+shift_and::shift_and(const syntax_tree& tree,
+                     shared_ptr<const program> forward,
+                     shared_ptr<const program> reverse,
+                     shared_ptr<const prefilter> pre,
+                     size_t cache_size)
+  : impl(make_unique<implementation>(tree, move(forward), move(reverse), move(pre), cache_size))
+{
+}
+
+shift_and::~shift_and() = default;
+
+size_t shift_and::count_positions(const syntax_tree& tree)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  return glushkov_builder::count(tree, tree.root());
+}
+
+size_t shift_and::position_count() const
+{
+  return impl->position_count;
+}
+
+bool shift_and::is_bounded() const
+{
+  return (impl->max_length != UNBOUNDED_LENGTH);
+}
+
+size_t shift_and::memory_usage() const
+{
+  return sizeof(impl->masks) + impl->follow.capacity() * sizeof(uint64_t);
+}
+
+bool shift_and::is_match(const char* begin, const char* end) const
+{
+  return (impl->scan(begin, end) != nullptr);
+}
+
+bool shift_and::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool shift_and::find(const char* begin, const char* end, match& result) const
+{
+  // the leftmost match of an unbounded expression may start arbitrarily far before the earliest end
+  auto from = begin;
+  if (is_bounded())
+  {
+    auto earliest_end = impl->scan(begin, end);
+    if (earliest_end == nullptr)
+      return false;
+
+    // no match ends before the earliest end, so the leftmost one cannot start more than the longest
+    // match length before it
+    if (static_cast<size_t>(earliest_end - begin) > impl->max_length)
+      from = earliest_end - impl->max_length;
+  }
+
+  return impl->lazy_dfas.with_engine([=, &result] (lazy_dfa& dfa) {
+      if (!dfa.find(from, end, result))
+        return false;
+      result.begin += static_cast<size_t>(from - begin);
+      result.end += static_cast<size_t>(from - begin);
+      return true;
+    });
+}
+
+bool shift_and::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
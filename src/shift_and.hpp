@@ -0,0 +1,126 @@
+/**
+ * @file	shift_and.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "match.hpp"
+#include "prefilter.hpp"
+#include "program.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which executes small expressions by simulating their Glushkov automaton bit-parallel.
+   *
+   * Each terminal of the expression (a literal, wildcard, class, or one character of a string) is a
+   * position of the automaton, and the set of active positions is packed into a single 64-bit word.
+   * Each input byte is consumed with a constant number of table lookups, shifts and masks: the
+   * positions following the active ones are looked up eight at a time, the first positions are
+   * added so that a match may begin anywhere, and the result is masked by the positions accepting
+   * the byte. No state tables are built beyond these per-byte and per-position masks.
+   *
+   * The scan finds the earliest position at which any match ends. `find()` then resolves the exact
+   * leftmost-first bounds with a lazy DFA, which finds the end of the match forwards and its start
+   * with the reverse program. If the expression's matches have a bounded length, the lazy DFA is
+   * started no earlier than the longest possible match allows; otherwise the leftmost match could
+   * start anywhere before that end, and the lazy DFA searches the whole input.
+   *
+   * The masks are immutable once built and the lazy DFAs are pooled, so a single instance may be
+   * used by multiple threads.
+   */
+  class shift_and
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The maximum number of positions an expression may have. */
+    static const size_t MAX_POSITIONS = 64;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Builds a new `regex::shift_and`.
+     *
+     * @param tree The expression to match.
+     * @param forward The same expression compiled forwards, used to resolve the end of matches.
+     * @param reverse The same expression compiled in reverse, used to resolve the start of matches.
+     * @param pre An optional prefilter, used to skip input whenever no positions are active.
+     * @param cache_size The maximum size of each lazy DFA's state cache, in bytes.
+     *
+     * @exception regex::compile_error
+     * Thrown if the expression has more than `MAX_POSITIONS` positions.
+     */
+    shift_and(const regex::syntax_tree& tree,
+              std::shared_ptr<const regex::program> forward,
+              std::shared_ptr<const regex::program> reverse,
+              std::shared_ptr<const regex::prefilter> pre = nullptr,
+              size_t cache_size = (2 << 20));
+
+    /** Destructor. */
+    ~shift_and();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Returns the number of positions in the specified expression, or `MAX_POSITIONS + 1` if it has
+     * more than `MAX_POSITIONS`.
+     */
+    static size_t count_positions(const regex::syntax_tree& tree);
+
+    /** Returns the number of positions in the automaton. */
+    size_t position_count() const;
+
+    /** Returns `true` if the length of the expression's matches is bounded. */
+    bool is_bounded() const;
+
+    /** Returns the estimated number of bytes used by the automaton's masks. */
+    size_t memory_usage() const;
+
+    /** Returns `true` if the expression matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if the expression matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,283 @@
+/**
+ * @file	shuffle_dfa.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "compiler.hpp"
+#include "full_dfa.hpp"
+#include "match.hpp"
+#include "shuffle_dfa.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define REGEX_SHUFFLE_DFA_X86 1
+#include <immintrin.h>
+#endif
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+namespace
+{
+
+  /** Struct containing the compact tables scanned by the kernels. */
+  struct shuffle_tables
+  {
+    /** For each byte, the index of the next state, indexed by the index of the current state. */
+    vector<array<uint8_t, 16>> next;
+
+    /** `0xff` for the dead state and each match state, and zero for all others. */
+    array<uint8_t, 16> stop;
+
+    /** The index of the start state. */
+    uint8_t start;
+
+    /** The index of the last match state. */
+    uint8_t last_match;
+  };
+
+}
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /**
+   * Scans `[ptr, end)` one byte at a time from `state`, exactly as `regex::full_dfa` does, updating
+   * `found` and `match_end` for each match state entered. Returns `true` if the scan is over, either
+   * because the dead state was entered or because a match was seen and `stop_early` is set.
+   */
+  bool scan_exact(const shuffle_tables& tables,
+                  const char* begin,
+                  const char*& ptr,
+                  const char* end,
+                  uint8_t& state,
+                  bool stop_early,
+                  bool& found,
+                  size_t& match_end)
+  {
+    const uint8_t last_match = tables.last_match;
+    while (ptr != end)
+    {
+      state = tables.next[static_cast<unsigned char>(*ptr++)][state];
+      if (state <= last_match)
+      {
+        if (state == 0)
+          return true;
+        found = true;
+        match_end = static_cast<size_t>(ptr - begin);
+        if (stop_early)
+          return true;
+      }
+    }
+    return false;
+  }
+
+  /* -- Scalar Implementation -- */
+
+  bool scan_scalar(const shuffle_tables& tables, const char* begin, const char* end, bool stop_early, size_t& match_end)
+  {
+    bool found = false;
+    auto state = tables.start;
+    auto ptr = begin;
+    scan_exact(tables, begin, ptr, end, state, stop_early, found, match_end);
+    return found;
+  }
+
+#if REGEX_SHUFFLE_DFA_X86
+
+  /* -- SSSE3 Implementation -- */
+
+  __attribute__((target("ssse3")))
+  bool scan_ssse3(const shuffle_tables& tables, const char* begin, const char* end, bool stop_early, size_t& match_end)
+  {
+    const __m128i stop = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.stop.data()));
+    const array<uint8_t, 16>* next = tables.next.data();
+    bool found = false;
+    auto state = tables.start;
+    auto ptr = begin;
+
+    while (end - ptr >= 8)
+    {
+      // only lane zero is meaningful, since it is the only lane ever indexed by a real state
+      __m128i current = _mm_cvtsi32_si128(state);
+      __m128i stopped = _mm_setzero_si128();
+      for (size_t idx = 0; idx < 8; idx++)
+      {
+        const __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i*>(next[static_cast<unsigned char>(ptr[idx])].data()));
+        current = _mm_shuffle_epi8(row, current);
+        stopped = _mm_or_si128(stopped, _mm_shuffle_epi8(stop, current));
+      }
+
+      if ((_mm_cvtsi128_si32(stopped) & 0xff) == 0)
+      {
+        state = static_cast<uint8_t>(_mm_cvtsi128_si32(current));
+        ptr += 8;
+        continue;
+      }
+
+      // a match or dead state was entered somewhere in the block, so rescan it to find out where
+      if (scan_exact(tables, begin, ptr, ptr + 8, state, stop_early, found, match_end))
+        return found;
+    }
+
+    scan_exact(tables, begin, ptr, end, state, stop_early, found, match_end);
+    return found;
+  }
+
+#endif
+
+  /* -- Dispatch -- */
+
+  /** Struct containing the implementation selected for the current CPU. */
+  struct implementations
+  {
+    const char* isa;
+    bool (*scan)(const shuffle_tables&, const char*, const char*, bool, size_t&);
+  };
+
+  /** Returns the best implementation supported by the current CPU. */
+  const implementations& selected()
+  {
+    static const implementations IMPLEMENTATIONS = [] {
+#if REGEX_SHUFFLE_DFA_X86
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("ssse3"))
+        return implementations { "ssse3", scan_ssse3 };
+#endif
+      return implementations { "scalar", scan_scalar };
+    }();
+    return IMPLEMENTATIONS;
+  }
+
+}
+
+struct shuffle_dfa::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const full_dfa> dfa)
+    : dfa(move(dfa))
+  {
+    const auto& table = this->dfa->forward_table();
+    if (!fits(*this->dfa))
+    {
+      ostringstream message;
+      message << "DFA has " << table.state_count() << " states, more than the "
+              << MAX_STATES << " which can be executed with shuffles.";
+      throw compile_error(message.str());
+    }
+
+    // state IDs are offsets into the transition table, so each is divided by the stride to index
+    // the vectors, which keeps the dead state at zero and the match states just after it
+    tables.next.resize(256);
+    for (size_t byte = 0; byte < 256; byte++)
+    {
+      auto& row = tables.next[byte];
+      row.fill(0);
+      for (size_t state = 0; state < table.state_count(); state++)
+      {
+        auto next = table.transitions[state * table.stride + table.classes[static_cast<unsigned char>(byte)]];
+        row[state] = static_cast<uint8_t>(next / table.stride);
+      }
+    }
+
+    tables.last_match = static_cast<uint8_t>(table.last_match / table.stride);
+    tables.start = static_cast<uint8_t>(table.start / table.stride);
+    for (size_t state = 0; state < 16; state++)
+      tables.stop[state] = (state <= tables.last_match ? 0xff : 0x00);
+  }
+
+  /* -- Fields -- */
+
+  const shared_ptr<const full_dfa> dfa;
+  shuffle_tables tables;
+
+  /* -- Methods -- */
+
+  /** Scans forwards for the end of the leftmost-first match. */
+  bool scan(const char* begin, const char* end, bool stop_early, size_t& match_end) const
+  {
+    if (tables.start <= tables.last_match)
+    {
+      match_end = 0;
+      if (stop_early)
+        return true;
+    }
+
+    auto found = selected().scan(tables, begin, end, stop_early, match_end);
+    return (found || tables.start <= tables.last_match);
+  }
+
+};
+
+/* -- Procedures -- */
+
+shuffle_dfa::shuffle_dfa(shared_ptr<const full_dfa> dfa)
+  : impl(make_unique<implementation>(move(dfa)))
+{
+}
+
+shuffle_dfa::~shuffle_dfa() = default;
+
+bool shuffle_dfa::fits(const full_dfa& dfa)
+{
+  return (dfa.forward_table().state_count() <= MAX_STATES);
+}
+
+const char* shuffle_dfa::isa()
+{
+  return selected().isa;
+}
+
+size_t shuffle_dfa::memory_usage() const
+{
+  return sizeof(implementation) + impl->tables.next.capacity() * sizeof(array<uint8_t, 16>);
+}
+
+bool shuffle_dfa::is_match(const char* begin, const char* end) const
+{
+  size_t match_end;
+  return impl->scan(begin, end, true, match_end);
+}
+
+bool shuffle_dfa::is_match(const string& input) const
+{
+  return is_match(input.data(), input.data() + input.size());
+}
+
+bool shuffle_dfa::find(const char* begin, const char* end, match& result) const
+{
+  size_t match_end;
+  if (!impl->scan(begin, end, false, match_end))
+    return false;
+
+  result.begin = impl->dfa->match_start(begin, match_end);
+  result.end = match_end;
+  return true;
+}
+
+bool shuffle_dfa::find(const string& input, match& result) const
+{
+  return find(input.data(), input.data() + input.size(), result);
+}
+
+/* -- Constants -- */
+
+const size_t shuffle_dfa::MAX_STATES;
@@ -0,0 +1,111 @@
+/**
+ * @file	shuffle_dfa.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+
+#include "full_dfa.hpp"
+#include "match.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which executes a full DFA of at most 16 states with byte shuffles.
+   *
+   * With so few states, the whole transition function for one byte class fits in a 16-byte vector
+   * indexed by state, and a single shuffle instruction (`pshufb`) advances the state held in a
+   * register. The vector for each byte is loaded independently of the current state, so unlike a
+   * table-driven scan, no memory load sits on the dependency chain from one byte to the next.
+   * Whether a match or dead state has been entered is accumulated with a second shuffle and tested
+   * once per block of 8 bytes, and only blocks in which one was entered are rescanned one byte at a
+   * time to find exactly where.
+   *
+   * The instruction set is selected at runtime, and CPUs without SSSE3 scan the same compact table
+   * without shuffles. The start of each match is found with the reverse table of the full DFA, which
+   * may be larger.
+   *
+   * Since the tables are immutable once built, a single instance may be used by multiple threads.
+   */
+  class shuffle_dfa
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** The maximum number of states in the forward table of the DFA. */
+    static const size_t MAX_STATES = 16;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Builds a new `regex::shuffle_dfa`.
+     *
+     * @param dfa The DFA to execute.
+     *
+     * @exception regex::compile_error
+     * Thrown if the forward table of the DFA has more than `MAX_STATES` states.
+     */
+    shuffle_dfa(std::shared_ptr<const regex::full_dfa> dfa);
+
+    /** Destructor. */
+    ~shuffle_dfa();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the forward table of the DFA is small enough to be executed with shuffles. */
+    static bool fits(const regex::full_dfa& dfa);
+
+    /** Returns the name of the instruction set used to scan on this CPU. */
+    static const char* isa();
+
+    /**
+     * Returns the estimated number of bytes used by the shuffle tables. This does not include the
+     * DFA, which is shared with the caller.
+     */
+    size_t memory_usage() const;
+
+    /** Returns `true` if the DFA matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const;
+
+    /** Returns `true` if the DFA matches anywhere in the input string. */
+    bool is_match(const std::string& input) const;
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const;
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
@@ -0,0 +1,624 @@
+/**
+ * @file	simplifier.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "simplifier.hpp"
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Types -- */
+
+namespace
+{
+
+  /**
+   * Class which builds a simplified copy of a syntax tree.
+   *
+   * Nodes are built bottom-up in a scratch tree, so that each node is simplified after its children.
+   * A structural hash is kept for every scratch node so that identical subtrees can be found
+   * quickly. Rewrites leave unreachable nodes behind in the scratch tree, so the result is copied
+   * into a fresh tree once simplification is complete.
+   */
+  class simplifier
+  {
+  public:
+
+    simplifier(const syntax_tree& input)
+      : m_input(input)
+    { }
+
+    /** Simplifies the input tree. */
+    syntax_tree run()
+    {
+      m_tree.reserve(m_input.size());
+      auto root = simplify_node(m_input.root());
+
+      syntax_tree result;
+      result.reserve(m_tree.size());
+      result.set_root(copy_node(result, root));
+      return result;
+    }
+
+  private:
+
+    /** Hash functor for scratch nodes. */
+    struct node_hash
+    {
+      const simplifier* owner;
+      size_t operator()(syntax_index index) const { return owner->m_hashes[index]; }
+    };
+
+    /** Structural equality functor for scratch nodes. */
+    struct node_equal
+    {
+      const simplifier* owner;
+      bool operator()(syntax_index lhs, syntax_index rhs) const { return owner->equal(lhs, rhs); }
+    };
+
+    const syntax_tree& m_input;
+    syntax_tree m_tree;
+    vector<size_t> m_hashes;
+    vector<bool> m_has_capture;
+
+    /** Returns the simplified scratch node equivalent to the input node at `index`. */
+    syntax_index simplify_node(syntax_index index)
+    {
+      auto children = m_input.children(index);
+      switch (m_input.type(index))
+      {
+      case syntax_node_type::literal:
+        return make_string(string(1, m_input.character(index)));
+
+      case syntax_node_type::wildcard:
+        return hashed(m_tree.add_wildcard());
+
+      case syntax_node_type::character_class:
+        return make_class(m_input.bitmap(index));
+
+      case syntax_node_type::string:
+        return make_string(m_input.text(index));
+
+      case syntax_node_type::concatenation:
+      case syntax_node_type::alternation:
+      {
+        vector<syntax_index> items;
+        items.reserve(children.size());
+        for (auto child : children)
+          items.push_back(simplify_node(child));
+        return (m_input.type(index) == syntax_node_type::concatenation ?
+                make_concatenation(items) :
+                make_alternation(items));
+      }
+
+      case syntax_node_type::optional:
+      case syntax_node_type::kleene:
+      case syntax_node_type::repeat:
+        return make_closure(m_input.type(index), simplify_node(children[0]));
+
+      case syntax_node_type::quantifier:
+        return make_quantifier(simplify_node(children[0]), m_input.min_count(index), m_input.max_count(index));
+
+      case syntax_node_type::capture:
+        // groups are kept intact, since their bounds must be reported exactly as written
+        return hashed(m_tree.add_capture(simplify_node(children[0]), m_input.group(index)));
+      }
+
+      assert(false);
+      return syntax_tree::NO_NODE;
+    }
+
+    /** Returns a literal node for a single character, or a string node otherwise. */
+    syntax_index make_string(const string& text)
+    {
+      assert(!text.empty());
+      if (text.size() == 1)
+        return hashed(m_tree.add_literal(text[0]));
+      return hashed(m_tree.add_string(text));
+    }
+
+    /** Returns a literal node for a class of a single character, or a class node otherwise. */
+    syntax_index make_class(const bitset<256>& bitmap)
+    {
+      if (bitmap.count() == 1)
+      {
+        for (size_t byte = 0; byte < bitmap.size(); byte++)
+          if (bitmap.test(byte))
+            return hashed(m_tree.add_literal(static_cast<char>(byte)));
+      }
+      return hashed(m_tree.add_class(bitmap));
+    }
+
+    /** Returns a node for the concatenation of the specified nodes. */
+    syntax_index make_concatenation(const vector<syntax_index>& items)
+    {
+      vector<syntax_index> result;
+      string pending;
+
+      auto flush = [&] () {
+        if (!pending.empty())
+          result.push_back(make_string(pending));
+        pending.clear();
+      };
+
+      auto append = [&] (syntax_index item) {
+        switch (m_tree.type(item))
+        {
+        case syntax_node_type::literal:
+          pending += m_tree.character(item);
+          return;
+
+        case syntax_node_type::string:
+          pending += m_tree.text(item);
+          return;
+
+        default:
+          flush();
+          if (!result.empty() && redundant_closure(result.back(), item))
+            return;
+          result.push_back(item);
+          return;
+        }
+      };
+
+      for (auto item : items)
+      {
+        if (m_tree.type(item) == syntax_node_type::concatenation)
+        {
+          for (auto child : m_tree.children(item))
+            append(child);
+        }
+        else
+          append(item);
+      }
+      flush();
+
+      assert(!result.empty());
+      if (result.size() == 1)
+        return result.front();
+      return hashed(m_tree.add_internal(syntax_node_type::concatenation, result.data(), result.size()));
+    }
+
+    /** Returns a node for the alternation of the specified nodes, in order of preference. */
+    syntax_index make_alternation(const vector<syntax_index>& items)
+    {
+      // an alternative identical to an earlier one can never be preferred to it
+      unordered_set<syntax_index, node_hash, node_equal> seen(items.size(), node_hash { this }, node_equal { this });
+      vector<syntax_index> alternatives;
+
+      auto append = [&] (syntax_index item) {
+        if (seen.insert(item).second)
+          alternatives.push_back(item);
+      };
+
+      for (auto item : items)
+      {
+        if (m_tree.type(item) == syntax_node_type::alternation)
+        {
+          for (auto child : m_tree.children(item))
+            append(child);
+        }
+        else
+          append(item);
+      }
+
+      alternatives = merge_classes(alternatives);
+      alternatives = factor(alternatives, false);
+      alternatives = factor(alternatives, true);
+
+      assert(!alternatives.empty());
+      if (alternatives.size() == 1)
+        return alternatives.front();
+      return hashed(m_tree.add_internal(syntax_node_type::alternation, alternatives.data(), alternatives.size()));
+    }
+
+    /**
+     * Merges runs of adjacent alternatives which each match a single character from a set into one
+     * character class. Since every such alternative consumes exactly one character, the first one
+     * to match always ends at the same position as the merged class.
+     */
+    vector<syntax_index> merge_classes(const vector<syntax_index>& alternatives)
+    {
+      vector<syntax_index> result;
+      for (size_t first = 0; first < alternatives.size(); )
+      {
+        bitset<256> bitmap;
+        auto last = first;
+        while (last < alternatives.size() && add_to_class(alternatives[last], bitmap))
+          last++;
+
+        if (last - first < 2)
+        {
+          result.push_back(alternatives[first]);
+          first++;
+          continue;
+        }
+
+        result.push_back(make_class(bitmap));
+        first = last;
+      }
+      return result;
+    }
+
+    /** Adds the characters matched by a literal or class node to `bitmap`, returning `false` for other nodes. */
+    bool add_to_class(syntax_index index, bitset<256>& bitmap) const
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+        bitmap.set(static_cast<unsigned char>(m_tree.character(index)));
+        return true;
+
+      case syntax_node_type::character_class:
+        bitmap |= m_tree.bitmap(index);
+        return true;
+
+      default:
+        return false;
+      }
+    }
+
+    /** Returns a node for a closure of the specified type over `body`. */
+    syntax_index make_closure(syntax_node_type type, syntax_index body)
+    {
+      // nested closures over a group are kept, since merging them changes which iteration, if any,
+      // sets the group
+      auto body_type = m_tree.type(body);
+      if (is_closure(body_type) && !m_has_capture[body])
+      {
+        if (body_type == type)
+          return body;
+
+        // any two different closures combine to a Kleene closure
+        return hashed(m_tree.add_internal(syntax_node_type::kleene, { m_tree.children(body)[0] }));
+      }
+
+      return hashed(m_tree.add_internal(type, { body }));
+    }
+
+    /** Returns a node repeating `body` between `min_count` and `max_count` times. */
+    syntax_index make_quantifier(syntax_index body, uint32_t min_count, uint32_t max_count)
+    {
+      // quantifiers equivalent to a closure or to the body itself are replaced by them
+      auto unbounded = (max_count == syntax_quantifier_node::UNBOUNDED);
+      if (min_count == 1 && max_count == 1)
+        return body;
+      if (min_count == 0 && max_count == 1)
+        return make_closure(syntax_node_type::optional, body);
+      if (min_count == 0 && unbounded)
+        return make_closure(syntax_node_type::kleene, body);
+      if (min_count == 1 && unbounded)
+        return make_closure(syntax_node_type::repeat, body);
+
+      return hashed(m_tree.add_quantifier(body, min_count, max_count));
+    }
+
+    /**
+     * Factors the literal prefixes (or suffixes, if `suffix` is set) shared by runs of adjacent
+     * alternatives.
+     *
+     * Only adjacent alternatives are combined, since reordering alternatives would change which
+     * match is preferred. An alternative which is entirely the shared literal can only be included
+     * as the last alternative of its run, in which case the remaining alternatives become optional.
+     */
+    vector<syntax_index> factor(const vector<syntax_index>& alternatives, bool suffix)
+    {
+      vector<syntax_index> result;
+      for (size_t first = 0; first < alternatives.size(); )
+      {
+        auto edge = edge_string(alternatives[first], suffix);
+        auto length = edge.size();
+        auto last = first + 1;
+        for (; length != 0 && last < alternatives.size(); last++)
+        {
+          auto common = common_length(edge, length, edge_string(alternatives[last], suffix), suffix);
+          if (common == 0 || is_whole_string(alternatives[last - 1], common))
+            break;
+          length = common;
+        }
+
+        if (last - first < 2)
+        {
+          result.push_back(alternatives[first]);
+          first++;
+          continue;
+        }
+
+        vector<syntax_index> rests;
+        bool optional = false;
+        for (auto idx = first; idx < last; idx++)
+        {
+          if (is_whole_string(alternatives[idx], length))
+          {
+            assert(idx == last - 1);
+            optional = true;
+          }
+          else
+            rests.push_back(drop_edge(alternatives[idx], length, suffix));
+        }
+
+        auto body = make_alternation(rests);
+        if (optional)
+          body = make_closure(syntax_node_type::optional, body);
+
+        auto shared = make_string(suffix ? edge.substr(edge.size() - length) : edge.substr(0, length));
+        result.push_back(suffix ? make_concatenation({ body, shared }) : make_concatenation({ shared, body }));
+        first = last;
+      }
+      return result;
+    }
+
+    /**
+     * Returns the literal string at the start (or end, if `suffix` is set) of the specified node, or
+     * an empty string if it does not begin (or end) with a literal.
+     */
+    string edge_string(syntax_index index, bool suffix) const
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+        return string(1, m_tree.character(index));
+
+      case syntax_node_type::string:
+        return m_tree.text(index);
+
+      case syntax_node_type::concatenation:
+      {
+        auto children = m_tree.children(index);
+        return edge_string(suffix ? children[children.size() - 1] : children[0], suffix);
+      }
+
+      default:
+        return string();
+      }
+    }
+
+    /**
+     * Returns the number of characters shared by the first `length` characters of `edge` and by
+     * `other`, counting from the start (or end, if `suffix` is set).
+     */
+    static size_t common_length(const string& edge, size_t length, const string& other, bool suffix)
+    {
+      length = min(length, other.size());
+      for (size_t idx = 0; idx < length; idx++)
+      {
+        auto lhs = (suffix ? edge[edge.size() - 1 - idx] : edge[idx]);
+        auto rhs = (suffix ? other[other.size() - 1 - idx] : other[idx]);
+        if (lhs != rhs)
+          return idx;
+      }
+      return length;
+    }
+
+    /** Returns `true` if the specified node is a literal string of exactly `length` characters. */
+    bool is_whole_string(syntax_index index, size_t length) const
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+        return (length == 1);
+
+      case syntax_node_type::string:
+        return (m_tree.text(index).size() == length);
+
+      default:
+        return false;
+      }
+    }
+
+    /** Returns the specified node with `length` literal characters removed from its start (or end). */
+    syntax_index drop_edge(syntax_index index, size_t length, bool suffix)
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+      case syntax_node_type::string:
+      {
+        auto text = edge_string(index, suffix);
+        assert(text.size() > length);
+        return make_string(suffix ? text.substr(0, text.size() - length) : text.substr(length));
+      }
+
+      case syntax_node_type::concatenation:
+      {
+        auto children = m_tree.children(index);
+        vector<syntax_index> items(children.begin(), children.end());
+        auto edge_index = (suffix ? items.size() - 1 : 0);
+        auto text = edge_string(items[edge_index], suffix);
+        if (text.size() == length)
+          items.erase(items.begin() + edge_index);
+        else
+          items[edge_index] = make_string(suffix ? text.substr(0, text.size() - length) : text.substr(length));
+        return make_concatenation(items);
+      }
+
+      default:
+        assert(false);
+        return syntax_tree::NO_NODE;
+      }
+    }
+
+    /** Returns `true` if `next` is redundant when immediately following `previous`. */
+    bool redundant_closure(syntax_index previous, syntax_index next) const
+    {
+      // only single characters are merged, since every path through the closure then ends at the
+      // same set of positions
+      if (m_tree.type(previous) != syntax_node_type::kleene || m_tree.type(next) != syntax_node_type::kleene)
+        return false;
+      auto body = m_tree.children(next)[0];
+      auto body_type = m_tree.type(body);
+      return ((body_type == syntax_node_type::literal || body_type == syntax_node_type::wildcard) &&
+              equal(m_tree.children(previous)[0], body));
+    }
+
+    /** Returns `true` if the specified node type is a closure. */
+    static bool is_closure(syntax_node_type type)
+    {
+      return (type == syntax_node_type::optional ||
+              type == syntax_node_type::kleene ||
+              type == syntax_node_type::repeat);
+    }
+
+    /** Records the structural hash of a newly added scratch node and returns its index. */
+    syntax_index hashed(syntax_index index)
+    {
+      assert(index == m_hashes.size());
+
+      size_t hash = static_cast<size_t>(m_tree.type(index));
+      auto combine = [&hash] (size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+      };
+
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+        combine(static_cast<unsigned char>(m_tree.character(index)));
+        break;
+
+      case syntax_node_type::character_class:
+        combine(std::hash<bitset<256>>()(m_tree.bitmap(index)));
+        break;
+
+      case syntax_node_type::string:
+        combine(std::hash<string>()(m_tree.text(index)));
+        break;
+
+      case syntax_node_type::quantifier:
+        combine(m_hashes[m_tree.children(index)[0]]);
+        combine(m_tree.min_count(index));
+        combine(m_tree.max_count(index));
+        break;
+
+      case syntax_node_type::capture:
+        combine(m_hashes[m_tree.children(index)[0]]);
+        combine(m_tree.group(index));
+        break;
+
+      default:
+        for (auto child : m_tree.children(index))
+          combine(m_hashes[child]);
+        break;
+      }
+
+      auto children = m_tree.children(index);
+      m_hashes.push_back(hash);
+      m_has_capture.push_back(m_tree.type(index) == syntax_node_type::capture ||
+                              any_of(children.begin(), children.end(), [this] (syntax_index child) { return m_has_capture[child]; }));
+      return index;
+    }
+
+    /** Returns `true` if the scratch nodes at `lhs` and `rhs` are structurally identical. */
+    bool equal(syntax_index lhs, syntax_index rhs) const
+    {
+      if (lhs == rhs)
+        return true;
+      if (m_hashes[lhs] != m_hashes[rhs] || m_tree.type(lhs) != m_tree.type(rhs))
+        return false;
+
+      switch (m_tree.type(lhs))
+      {
+      case syntax_node_type::literal:
+        return (m_tree.character(lhs) == m_tree.character(rhs));
+
+      case syntax_node_type::wildcard:
+        return true;
+
+      case syntax_node_type::character_class:
+        return (m_tree.bitmap(lhs) == m_tree.bitmap(rhs));
+
+      case syntax_node_type::string:
+        return (m_tree.text(lhs) == m_tree.text(rhs));
+
+      case syntax_node_type::quantifier:
+        return (m_tree.min_count(lhs) == m_tree.min_count(rhs) &&
+                m_tree.max_count(lhs) == m_tree.max_count(rhs) &&
+                equal(m_tree.children(lhs)[0], m_tree.children(rhs)[0]));
+
+      case syntax_node_type::capture:
+        return (m_tree.group(lhs) == m_tree.group(rhs) &&
+                equal(m_tree.children(lhs)[0], m_tree.children(rhs)[0]));
+
+      default:
+      {
+        auto lhs_children = m_tree.children(lhs);
+        auto rhs_children = m_tree.children(rhs);
+        if (lhs_children.size() != rhs_children.size())
+          return false;
+        for (size_t idx = 0; idx < lhs_children.size(); idx++)
+          if (!equal(lhs_children[idx], rhs_children[idx]))
+            return false;
+        return true;
+      }
+      }
+    }
+
+    /** Copies the scratch subtree at `index` into `result`, returning the index of its root there. */
+    syntax_index copy_node(syntax_tree& result, syntax_index index) const
+    {
+      switch (m_tree.type(index))
+      {
+      case syntax_node_type::literal:
+        return result.add_literal(m_tree.character(index));
+
+      case syntax_node_type::wildcard:
+        return result.add_wildcard();
+
+      case syntax_node_type::character_class:
+        return result.add_class(m_tree.bitmap(index));
+
+      case syntax_node_type::string:
+        return result.add_string(m_tree.text(index));
+
+      case syntax_node_type::quantifier:
+        return result.add_quantifier(copy_node(result, m_tree.children(index)[0]),
+                                     m_tree.min_count(index),
+                                     m_tree.max_count(index));
+
+      case syntax_node_type::capture:
+        return result.add_capture(copy_node(result, m_tree.children(index)[0]), m_tree.group(index));
+
+      default:
+      {
+        vector<syntax_index> children;
+        children.reserve(m_tree.children(index).size());
+        for (auto child : m_tree.children(index))
+          children.push_back(copy_node(result, child));
+        return result.add_internal(m_tree.type(index), children.data(), children.size());
+      }
+      }
+    }
+
+  };
+
+}
+
+/* -- Procedures -- */
+
+unique_ptr<const syntax_node> regex::simplify(const unique_ptr<const syntax_node>& root)
+{
+  assert(root != nullptr);
+  return make_syntax_node(simplify(make_syntax_tree(root)));
+}
+
+syntax_tree regex::simplify(const syntax_tree& tree)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  return simplifier(tree).run();
+}
@@ -0,0 +1,48 @@
+/**
+ * @file	simplifier.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Returns a simplified syntax tree matching the same strings, with the same preference among
+   * matches, as the tree rooted at the specified node.
+   */
+  std::unique_ptr<const regex::syntax_node> simplify(const std::unique_ptr<const regex::syntax_node>& root);
+
+  /**
+   * Returns a simplified arena syntax tree matching the same strings, with the same preference among
+   * matches, as the specified tree.
+   *
+   * The following rewrites are applied, each of which preserves leftmost-first semantics:
+   *
+   * - Nested concatenations and alternations are flattened, and runs of literals are merged into
+   *   string nodes.
+   * - A closure over a closure is collapsed into a single closure (`(a*)*`, `(a+)?` and `a?*` all
+   *   become `a*`, and `(a+)+` and `(a?)?` become `a+` and `a?`).
+   * - Quantifiers equivalent to a closure are replaced by it (`a{0,1}` becomes `a?`, and `a{1,}`
+   *   becomes `a+`).
+   * - Adjacent identical Kleene closures over a single character are merged (`.*.*` becomes `.*`).
+   * - Alternatives identical to an earlier alternative are removed, since they can never be
+   *   preferred over it, and runs of adjacent single-character alternatives are merged into a
+   *   character class (`a|b|[cd]` becomes `[a-d]`).
+   * - Literal prefixes and suffixes shared by adjacent alternatives are factored out
+   *   (`abc|abd` becomes `ab(c|d)`, and `xa|ya` becomes `(x|y)a`).
+   */
+  regex::syntax_tree simplify(const regex::syntax_tree& tree);
+
+}
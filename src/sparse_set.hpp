@@ -0,0 +1,120 @@
+/**
+ * @file	sparse_set.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Set of integers in the range `[0, capacity)` with constant-time insertion, lookup, and clearing.
+   *
+   * Elements are iterated in insertion order. All storage is allocated up front by the constructor,
+   * so no operation after construction allocates memory.
+   */
+  class sparse_set
+  {
+
+    /* -- Types -- */
+
+  public:
+
+    /** Iterator over the elements of the set, in insertion order. */
+    using const_iterator = std::vector<uint32_t>::const_iterator;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new, empty `regex::sparse_set` able to hold values less than `capacity`. */
+    explicit sparse_set(size_t capacity = 0)
+      : m_dense(capacity),
+        m_sparse(capacity),
+        m_size(0)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the set contains `value`. */
+    bool contains(uint32_t value) const
+    {
+      assert(value < m_sparse.size());
+      uint32_t index = m_sparse[value];
+      return (index < m_size && m_dense[index] == value);
+    }
+
+    /** Inserts `value` into the set. The value must not already be present. */
+    void insert(uint32_t value)
+    {
+      assert(!contains(value));
+      m_sparse[value] = static_cast<uint32_t>(m_size);
+      m_dense[m_size++] = value;
+    }
+
+    /** Removes all elements from the set. */
+    void clear()
+    {
+      m_size = 0;
+    }
+
+    /** Returns the number of elements in the set. */
+    size_t size() const
+    {
+      return m_size;
+    }
+
+    /** Returns `true` if the set is empty. */
+    bool empty() const
+    {
+      return (m_size == 0);
+    }
+
+    /** Returns the maximum value (exclusive) which may be stored in this set. */
+    size_t capacity() const
+    {
+      return m_sparse.size();
+    }
+
+    /** Returns the element at `index` in insertion order. */
+    uint32_t operator[](size_t index) const
+    {
+      assert(index < m_size);
+      return m_dense[index];
+    }
+
+    /** Returns an iterator to the first element. */
+    const_iterator begin() const
+    {
+      return m_dense.cbegin();
+    }
+
+    /** Returns an iterator past the last element. */
+    const_iterator end() const
+    {
+      return m_dense.cbegin() + m_size;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    std::vector<uint32_t> m_dense;
+    std::vector<uint32_t> m_sparse;
+    size_t m_size;
+
+  };
+
+}
@@ -0,0 +1,1342 @@
+/**
+ * @file	static_regex.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Macros -- */
+
+/**
+ * Declares a type named `name` holding the expression `literal`, for use as the argument of
+ * `regex::static_regex`.
+ */
+#define REGEX_STATIC_PATTERN(name, literal)                             \
+  struct name                                                           \
+  {                                                                     \
+    static constexpr const char* value() { return literal; }            \
+  }
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Enumeration of the node types of a syntax tree parsed at compile time.
+   */
+  enum class static_node_type : uint8_t
+  {
+    empty,
+    byte_set,
+    concatenation,
+    alternation,
+    repeat,
+  };
+
+  /** Value indicating that a node of a static syntax tree does not exist. */
+  constexpr size_t STATIC_NO_NODE = SIZE_MAX;
+
+  /** Value indicating that a repetition has no upper bound. */
+  constexpr size_t STATIC_UNBOUNDED = SIZE_MAX;
+
+  /**
+   * The maximum number of copies a repetition may be unrolled into, counting the copies made by every
+   * repetition enclosing it. This is the default limit of `regex::compile_options`.
+   */
+  constexpr size_t STATIC_MAX_REPETITIONS = 1000;
+
+  /**
+   * Struct representing a node of a syntax tree parsed at compile time. Children are linked through
+   * `first` and `next`, in order.
+   */
+  struct static_node
+  {
+    static_node_type type = static_node_type::empty;
+    uint64_t bits[4] = { 0, 0, 0, 0 };
+    size_t first = STATIC_NO_NODE;
+    size_t next = STATIC_NO_NODE;
+    size_t min_count = 0;
+    size_t max_count = 0;
+
+    /** Returns `true` if this node is a byte set containing `ch`. */
+    constexpr bool test(unsigned char ch) const
+    {
+      return ((bits[ch >> 6] >> (ch & 63)) & 1) != 0;
+    }
+
+    /** Returns the number of bytes in this node's byte set. */
+    constexpr size_t count() const
+    {
+      size_t count = 0;
+      for (size_t ch = 0; ch < 256; ch++)
+        count += (test(static_cast<unsigned char>(ch)) ? 1 : 0);
+      return count;
+    }
+
+    /** Returns the lowest byte in this node's byte set, which must not be empty. */
+    constexpr unsigned char lowest() const
+    {
+      size_t ch = 0;
+      while (ch < 255 && !test(static_cast<unsigned char>(ch)))
+        ch++;
+      return static_cast<unsigned char>(ch);
+    }
+
+    /** Returns the highest byte in this node's byte set, which must not be empty. */
+    constexpr unsigned char highest() const
+    {
+      size_t ch = 255;
+      while (ch > 0 && !test(static_cast<unsigned char>(ch)))
+        ch--;
+      return static_cast<unsigned char>(ch);
+    }
+
+    /** Adds every byte in `[low, high]` to this node's byte set. */
+    constexpr void set(unsigned char low, unsigned char high)
+    {
+      for (size_t ch = low; ch <= high; ch++)
+        bits[ch >> 6] |= (uint64_t(1) << (ch & 63));
+    }
+  };
+
+  /**
+   * Struct representing a syntax tree parsed at compile time, with room for `N` nodes.
+   */
+  template <size_t N>
+  struct static_tree
+  {
+    static_node nodes[N];
+    size_t count = 0;
+    size_t root = STATIC_NO_NODE;
+
+    /** The bytes which may begin a match, unless the expression matches the empty string. */
+    static_node first_bytes;
+    bool nullable = false;
+
+    /**
+     * Whether some repetition repeats a subexpression which may match in more than one way, so that
+     * backtracking could take exponential time.
+     */
+    bool ambiguous = false;
+
+    /**
+     * Returns `true` if the subtree rooted at `index` contains a repetition or alternation, so that
+     * it may match the same input in more than one way.
+     */
+    constexpr bool branches(size_t index) const
+    {
+      if (nodes[index].type == static_node_type::repeat || nodes[index].type == static_node_type::alternation)
+        return true;
+      for (auto child = nodes[index].first; child != STATIC_NO_NODE; child = nodes[child].next)
+        if (branches(child))
+          return true;
+      return false;
+    }
+
+    /** Returns the number of copies a repetition unrolls its child into. */
+    constexpr size_t copies(size_t index) const
+    {
+      auto count = (nodes[index].max_count == STATIC_UNBOUNDED ? nodes[index].min_count : nodes[index].max_count);
+      return (count > 1 ? count : 1);
+    }
+
+    /**
+     * Returns the largest number of copies of any node in the subtree rooted at `index` once its
+     * repetitions are unrolled.
+     */
+    constexpr size_t repetitions(size_t index) const
+    {
+      size_t result = 1;
+      for (auto child = nodes[index].first; child != STATIC_NO_NODE; child = nodes[child].next)
+      {
+        auto nested = repetitions(child);
+        result = (nested > result ? nested : result);
+      }
+      return (nodes[index].type == static_node_type::repeat ? copies(index) * result : result);
+    }
+
+    /** Returns the number of instructions the subtree rooted at `index` compiles to. */
+    constexpr size_t program_size(size_t index) const
+    {
+      const auto& node = nodes[index];
+      switch (node.type)
+      {
+      case static_node_type::byte_set:
+        return 1;
+
+      case static_node_type::concatenation:
+      case static_node_type::alternation:
+      {
+        // each alternative but the last is preceded by a split and followed by a jump
+        size_t size = 0;
+        for (auto child = node.first; child != STATIC_NO_NODE; child = nodes[child].next)
+          size += program_size(child) + (node.type == static_node_type::alternation && nodes[child].next != STATIC_NO_NODE ? 2 : 0);
+        return size;
+      }
+
+      case static_node_type::repeat:
+      {
+        auto body = program_size(node.first);
+        if (node.max_count != STATIC_UNBOUNDED)
+          return node.min_count * body + (node.max_count - node.min_count) * (body + 1);
+        return (node.min_count == 0 ? body + 2 : node.min_count * body + 1);
+      }
+
+      case static_node_type::empty:
+      default:
+        return 0;
+      }
+    }
+  };
+
+  /**
+   * Class which parses an expression into a `regex::static_tree` in a constant expression,
+   * following the grammar in `grammar.txt`. Errors are thrown as `regex::syntax_error`, which
+   * makes a compile-time parse ill-formed, so that the compiler reports the offending message.
+   */
+  template <size_t N>
+  class static_parser
+  {
+  public:
+
+    /** Constructs a parser for the specified expression. */
+    constexpr static_parser(const char* input)
+      : m_input(input),
+        m_length(static_length(input)),
+        m_position(0),
+        m_tree()
+    { }
+
+    /** Parses the expression and returns its tree. */
+    constexpr static_tree<N> parse()
+    {
+      m_tree.root = parse_alternation();
+      require(m_position == m_length, "Unparseable tokens at end of string.");
+      m_tree.nullable = first_bytes(m_tree.root, m_tree.first_bytes);
+      for (size_t index = 0; index < m_tree.count; index++)
+        if (m_tree.nodes[index].type == static_node_type::repeat && m_tree.branches(m_tree.nodes[index].first))
+          m_tree.ambiguous = true;
+      return m_tree;
+    }
+
+    /** Returns the length of a null-terminated string. */
+    static constexpr size_t static_length(const char* input)
+    {
+      size_t length = 0;
+      while (input[length] != 0)
+        length++;
+      return length;
+    }
+
+  private:
+
+    const char* m_input;
+    size_t m_length;
+    size_t m_position;
+    static_tree<N> m_tree;
+
+    /** Throws a syntax error with the specified message if `condition` does not hold. */
+    constexpr void require(bool condition, const char* message) const
+    {
+      if (!condition)
+        throw regex::syntax_error(message);
+    }
+
+    /** Returns the next character, or zero at the end of the expression. */
+    constexpr char peek() const
+    {
+      return (m_position < m_length ? m_input[m_position] : 0);
+    }
+
+    /** Adds a node of the specified type, and returns its index. */
+    constexpr size_t add_node(static_node_type type)
+    {
+      require(m_tree.count < N, "Expression is too large to parse at compile time.");
+      m_tree.nodes[m_tree.count].type = type;
+      return m_tree.count++;
+    }
+
+    /** Parses alternatives separated by `|`. */
+    constexpr size_t parse_alternation()
+    {
+      auto first = parse_sequence();
+      if (peek() != '|')
+        return first;
+
+      auto node = add_node(static_node_type::alternation);
+      m_tree.nodes[node].first = first;
+      auto last = first;
+      while (peek() == '|')
+      {
+        m_position++;
+        auto next = parse_sequence();
+        m_tree.nodes[last].next = next;
+        last = next;
+      }
+      return node;
+    }
+
+    /** Parses a run of atoms, each with an optional closure operator. */
+    constexpr size_t parse_sequence()
+    {
+      auto first = STATIC_NO_NODE;
+      auto last = STATIC_NO_NODE;
+      size_t count = 0;
+      while (m_position < m_length && peek() != '|' && peek() != ')')
+      {
+        auto next = parse_closure(parse_atom());
+        if (first == STATIC_NO_NODE)
+          first = next;
+        else
+          m_tree.nodes[last].next = next;
+        last = next;
+        count++;
+      }
+
+      require(count != 0, "Expected atom.");
+      if (count == 1)
+        return first;
+
+      auto node = add_node(static_node_type::concatenation);
+      m_tree.nodes[node].first = first;
+      return node;
+    }
+
+    /** Parses a closure operator or quantifier following an atom, if there is one. */
+    constexpr size_t parse_closure(size_t atom)
+    {
+      size_t min_count = 0;
+      size_t max_count = 0;
+      if (!read_closure(min_count, max_count))
+        return atom;
+
+      size_t ignored_min = 0;
+      size_t ignored_max = 0;
+      auto position = m_position;
+      require(!read_closure(ignored_min, ignored_max), "Unexpected closure operator.");
+      m_position = position;
+
+      auto node = add_node(static_node_type::repeat);
+      m_tree.nodes[node].first = atom;
+      m_tree.nodes[node].min_count = min_count;
+      m_tree.nodes[node].max_count = max_count;
+      require(m_tree.repetitions(node) <= STATIC_MAX_REPETITIONS, "Nested repetitions exceed limit of 1000 copies.");
+      return node;
+    }
+
+    /** Reads a closure operator or quantifier, returning `false` if there is none. */
+    constexpr bool read_closure(size_t& min_count, size_t& max_count)
+    {
+      switch (peek())
+      {
+      case '?':
+        m_position++;
+        min_count = 0;
+        max_count = 1;
+        return true;
+
+      case '*':
+        m_position++;
+        min_count = 0;
+        max_count = STATIC_UNBOUNDED;
+        return true;
+
+      case '+':
+        m_position++;
+        min_count = 1;
+        max_count = STATIC_UNBOUNDED;
+        return true;
+
+      case '{':
+      {
+        auto end = read_quantifier(min_count, max_count);
+        if (end == m_position)
+          return false;
+        m_position = end;
+        return true;
+      }
+
+      default:
+        return false;
+      }
+    }
+
+    /**
+     * Reads a quantifier of the form `{n}`, `{m,}` or `{m,n}`, returning the position just past it,
+     * or the current position if there is none.
+     */
+    constexpr size_t read_quantifier(size_t& min_count, size_t& max_count) const
+    {
+      auto ptr = m_position + 1;
+      if (!read_count(ptr, min_count))
+        return m_position;
+
+      if (ptr < m_length && m_input[ptr] == ',')
+      {
+        ptr++;
+        if (!read_count(ptr, max_count))
+          max_count = STATIC_UNBOUNDED;
+      }
+      else
+        max_count = min_count;
+
+      if (ptr >= m_length || m_input[ptr] != '}')
+        return m_position;
+
+      require(max_count >= min_count, "Repetition range is out of order.");
+      return ptr + 1;
+    }
+
+    /** Reads a decimal repetition count, returning `false` if there are no digits. */
+    constexpr bool read_count(size_t& ptr, size_t& count) const
+    {
+      auto begin = ptr;
+      count = 0;
+      for (; ptr < m_length && m_input[ptr] >= '0' && m_input[ptr] <= '9'; ptr++)
+      {
+        count = count * 10 + static_cast<size_t>(m_input[ptr] - '0');
+        require(count <= regex::lexical_analyzer::MAX_REPETITION, "Repetition count exceeds 1000.");
+      }
+      return (ptr != begin);
+    }
+
+    /** Parses a single atom. */
+    constexpr size_t parse_atom()
+    {
+      switch (peek())
+      {
+      case '(':
+      {
+        m_position++;
+        if (m_position + 1 < m_length && m_input[m_position] == '?' && m_input[m_position + 1] == ':')
+          m_position += 2;
+        auto node = parse_alternation();
+        require(peek() == ')', "Expected close bracket.");
+        m_position++;
+        return node;
+      }
+
+      case '?':
+      case '*':
+      case '+':
+        require(false, "Expected atom.");
+        return STATIC_NO_NODE;
+
+      case '{':
+      {
+        size_t min_count = 0;
+        size_t max_count = 0;
+        require(read_quantifier(min_count, max_count) == m_position, "Expected atom.");
+        return add_literal('{');
+      }
+
+      case '.':
+      {
+        m_position++;
+        auto node = add_node(static_node_type::byte_set);
+        m_tree.nodes[node].set(0, 255);
+        return node;
+      }
+
+      case '[':
+        return parse_class();
+
+      case '\\':
+      {
+        auto node = add_node(static_node_type::byte_set);
+        read_member(m_tree.nodes[node]);
+        return node;
+      }
+
+      default:
+        return add_literal(peek());
+      }
+    }
+
+    /** Adds a byte set node for the literal at the current position. */
+    constexpr size_t add_literal(char ch)
+    {
+      m_position++;
+      auto node = add_node(static_node_type::byte_set);
+      m_tree.nodes[node].set(static_cast<unsigned char>(ch), static_cast<unsigned char>(ch));
+      return node;
+    }
+
+    /**
+     * Reads a literal or escape sequence into `set`. Returns `true` and stores the character in
+     * `ch` if it was a single character, or `false` if it was a shorthand class.
+     */
+    constexpr bool read_member(static_node& set, unsigned char* ch = nullptr)
+    {
+      if (peek() != '\\')
+      {
+        auto literal = static_cast<unsigned char>(m_input[m_position++]);
+        set.set(literal, literal);
+        if (ch != nullptr)
+          *ch = literal;
+        return true;
+      }
+
+      m_position++;
+      require(m_position < m_length, "Escape character at end of string.");
+      auto escaped = m_input[m_position++];
+      if (add_shorthand(escaped, set))
+        return false;
+
+      require(is_escapable(escaped), "Unrecognized escape sequence.");
+      auto literal = static_cast<unsigned char>(escaped);
+      set.set(literal, literal);
+      if (ch != nullptr)
+        *ch = literal;
+      return true;
+    }
+
+    /** Returns `true` if the specified character may follow a backslash to stand for itself. */
+    static constexpr bool is_escapable(char ch)
+    {
+      for (auto escapable = ".()|?*+{}[]^-\\"; *escapable != 0; escapable++)
+        if (ch == *escapable)
+          return true;
+      return false;
+    }
+
+    /**
+     * If the specified character follows a backslash to name a shorthand class, adds the class's
+     * characters to `set` and returns `true`.
+     */
+    static constexpr bool add_shorthand(char ch, static_node& set)
+    {
+      static_node members {};
+      switch (ch)
+      {
+      case 'd':
+      case 'D':
+        members.set('0', '9');
+        break;
+
+      case 'w':
+      case 'W':
+        members.set('0', '9');
+        members.set('A', 'Z');
+        members.set('a', 'z');
+        members.set('_', '_');
+        break;
+
+      case 's':
+      case 'S':
+        members.set('\t', '\r');
+        members.set(' ', ' ');
+        break;
+
+      default:
+        return false;
+      }
+
+      for (size_t word = 0; word < 4; word++)
+        set.bits[word] |= (ch >= 'A' && ch <= 'Z' ? ~members.bits[word] : members.bits[word]);
+      return true;
+    }
+
+    /** Parses a bracketed character class. */
+    constexpr size_t parse_class()
+    {
+      m_position++;
+      bool negated = (peek() == '^');
+      if (negated)
+        m_position++;
+
+      auto node = add_node(static_node_type::byte_set);
+      static_node members {};
+      for (bool first = true; ; first = false)
+      {
+        require(m_position < m_length, "Unterminated character class.");
+        if (peek() == ']' && !first)
+        {
+          m_position++;
+          break;
+        }
+
+        // a dash followed by the closing bracket is a literal dash
+        static_node single {};
+        unsigned char low = 0;
+        bool literal = read_member(single, &low);
+        bool range = (peek() == '-' && m_position + 1 < m_length && m_input[m_position + 1] != ']');
+        require(literal || !range, "Shorthand class cannot bound a range.");
+        if (!range)
+        {
+          for (size_t word = 0; word < 4; word++)
+            members.bits[word] |= single.bits[word];
+          continue;
+        }
+
+        m_position++;
+        static_node ignored {};
+        unsigned char high = 0;
+        require(read_member(ignored, &high), "Shorthand class cannot bound a range.");
+        require(high >= low, "Character class range is out of order.");
+        members.set(low, high);
+      }
+
+      for (size_t word = 0; word < 4; word++)
+        m_tree.nodes[node].bits[word] = (negated ? ~members.bits[word] : members.bits[word]);
+      return node;
+    }
+
+    /** Adds the bytes which may begin a match of `index` to `set`, and returns `true` if it is nullable. */
+    constexpr bool first_bytes(size_t index, static_node& set) const
+    {
+      const auto& node = m_tree.nodes[index];
+      switch (node.type)
+      {
+      case static_node_type::byte_set:
+        for (size_t word = 0; word < 4; word++)
+          set.bits[word] |= node.bits[word];
+        return false;
+
+      case static_node_type::concatenation:
+        for (auto child = node.first; child != STATIC_NO_NODE; child = m_tree.nodes[child].next)
+          if (!first_bytes(child, set))
+            return false;
+        return true;
+
+      case static_node_type::alternation:
+      {
+        bool nullable = false;
+        for (auto child = node.first; child != STATIC_NO_NODE; child = m_tree.nodes[child].next)
+          nullable = first_bytes(child, set) || nullable;
+        return nullable;
+      }
+
+      case static_node_type::repeat:
+        return first_bytes(node.first, set) || node.min_count == 0;
+
+      case static_node_type::empty:
+      default:
+        return true;
+      }
+    }
+
+  };
+
+  /**
+   * Parses the specified expression into a `regex::static_tree` with room for `N` nodes. Called in
+   * a constant expression, syntax errors are reported at compile time.
+   */
+  template <size_t N>
+  constexpr static_tree<N> static_parse(const char* input)
+  {
+    return static_parser<N>(input).parse();
+  }
+
+  /**
+   * Struct holding the syntax tree parsed at compile time for the pattern type `TPattern`.
+   */
+  template <typename TPattern>
+  struct static_pattern_traits
+  {
+    /** The number of nodes the tree has room for, which is enough for any expression of its length. */
+    static constexpr size_t capacity = 3 * static_parser<1>::static_length(TPattern::value()) + 2;
+
+    /** The parsed tree. */
+    static constexpr static_tree<capacity> tree = static_parse<capacity>(TPattern::value());
+  };
+
+  template <typename TPattern>
+  constexpr size_t static_pattern_traits<TPattern>::capacity;
+
+  template <typename TPattern>
+  constexpr static_tree<static_pattern_traits<TPattern>::capacity> static_pattern_traits<TPattern>::tree;
+
+  /**
+   * Enumeration of the instructions of a program compiled at compile time.
+   */
+  enum class static_opcode : uint8_t
+  {
+    byte_set,
+    split,
+    jump,
+    match,
+  };
+
+  /**
+   * Struct representing an instruction of a program compiled at compile time. A `byte_set`
+   * instruction consumes a byte in the set of the tree node `node` and continues at `next`; a `split`
+   * continues at both `next` and, with lower priority, `alternate`.
+   */
+  struct static_instruction
+  {
+    static_opcode op = static_opcode::match;
+    size_t node = STATIC_NO_NODE;
+    size_t next = 0;
+    size_t alternate = 0;
+  };
+
+  /**
+   * Struct representing a program of `M` instructions compiled at compile time, beginning at the
+   * first instruction and ending with a `match`.
+   */
+  template <size_t M>
+  struct static_program
+  {
+    static_instruction instructions[M];
+  };
+
+  /**
+   * Class which compiles a `regex::static_tree` into a `regex::static_program` in a constant
+   * expression, by Thompson's construction with counted repetitions unrolled, as `regex::compile`
+   * does at runtime. Each node is laid out in a block of `static_tree::program_size()` instructions
+   * which falls through to the instruction after it.
+   */
+  template <size_t M, size_t N>
+  class static_compiler
+  {
+  public:
+
+    /** Constructs a compiler for the specified tree. */
+    constexpr static_compiler(const static_tree<N>& tree)
+      : m_tree(tree),
+        m_program()
+    { }
+
+    /** Compiles the tree and returns its program. */
+    constexpr static_program<M> compile()
+    {
+      auto end = emit(m_tree.root, 0);
+      m_program.instructions[end].op = static_opcode::match;
+      return m_program;
+    }
+
+  private:
+
+    const static_tree<N>& m_tree;
+    static_program<M> m_program;
+
+    /** Sets the instruction at `pc`. */
+    constexpr void set(size_t pc, static_opcode op, size_t next, size_t alternate = 0, size_t node = STATIC_NO_NODE)
+    {
+      m_program.instructions[pc].op = op;
+      m_program.instructions[pc].node = node;
+      m_program.instructions[pc].next = next;
+      m_program.instructions[pc].alternate = alternate;
+    }
+
+    /** Compiles the subtree rooted at `index` starting at `pc`, and returns the address after it. */
+    constexpr size_t emit(size_t index, size_t pc)
+    {
+      const auto& node = m_tree.nodes[index];
+      auto end = pc + m_tree.program_size(index);
+      switch (node.type)
+      {
+      case static_node_type::byte_set:
+        set(pc, static_opcode::byte_set, pc + 1, 0, index);
+        break;
+
+      case static_node_type::concatenation:
+        for (auto child = node.first; child != STATIC_NO_NODE; child = m_tree.nodes[child].next)
+          pc = emit(child, pc);
+        break;
+
+      case static_node_type::alternation:
+        for (auto child = node.first; child != STATIC_NO_NODE; child = m_tree.nodes[child].next)
+        {
+          if (m_tree.nodes[child].next == STATIC_NO_NODE)
+          {
+            emit(child, pc);
+            break;
+          }
+          auto body_end = emit(child, pc + 1);
+          set(pc, static_opcode::split, pc + 1, body_end + 1);
+          set(body_end, static_opcode::jump, end);
+          pc = body_end + 1;
+        }
+        break;
+
+      case static_node_type::repeat:
+        emit_repeat(node, pc, end);
+        break;
+
+      case static_node_type::empty:
+      default:
+        break;
+      }
+      return end;
+    }
+
+    /**
+     * Compiles a repetition laid out in `[pc, end)`: `x{2,4}` as `xx(x(x)?)?`, `x{2,}` as `xx+` and
+     * `x*` as a loop around a split.
+     */
+    constexpr void emit_repeat(const static_node& node, size_t pc, size_t end)
+    {
+      auto unbounded = (node.max_count == STATIC_UNBOUNDED);
+      for (size_t count = 0; count < node.min_count; count++)
+      {
+        auto start = pc;
+        pc = emit(node.first, pc);
+        if (unbounded && count + 1 == node.min_count)
+          set(pc++, static_opcode::split, start, end);
+      }
+
+      if (unbounded && node.min_count == 0)
+      {
+        auto body_end = emit(node.first, pc + 1);
+        set(pc, static_opcode::split, pc + 1, end);
+        set(body_end, static_opcode::jump, pc);
+      }
+      else if (!unbounded)
+      {
+        // each optional repetition's split may skip all of the remaining repetitions
+        for (auto count = node.min_count; count < node.max_count; count++)
+        {
+          set(pc, static_opcode::split, pc + 1, end);
+          pc = emit(node.first, pc + 1);
+        }
+      }
+    }
+
+  };
+
+  /**
+   * Struct holding the program compiled at compile time for the pattern type `TPattern`. Only
+   * instantiated for expressions which are matched by `regex::static_vm`.
+   */
+  template <typename TPattern>
+  struct static_program_traits
+  {
+    using tree_traits = static_pattern_traits<TPattern>;
+
+    /** The number of instructions in the program, including the final `match`. */
+    static constexpr size_t size = tree_traits::tree.program_size(tree_traits::tree.root) + 1;
+
+    /** The compiled program. */
+    static constexpr static_program<size> program = static_compiler<size, tree_traits::capacity>(tree_traits::tree).compile();
+  };
+
+  template <typename TPattern>
+  constexpr size_t static_program_traits<TPattern>::size;
+
+  template <typename TPattern>
+  constexpr static_program<static_program_traits<TPattern>::size> static_program_traits<TPattern>::program;
+
+  /**
+   * Class which matches the program compiled for `TPattern` by simulating it as an NFA, in the
+   * manner of `regex::pike_vm`, so that a search takes time linear in the length of the input
+   * however ambiguous the expression. The thread lists are sized at compile time and kept on the
+   * stack, so no memory is allocated.
+   */
+  template <typename TPattern>
+  class static_vm
+  {
+    /* -- Types -- */
+
+  private:
+
+    using traits = static_pattern_traits<TPattern>;
+    using program_traits = static_program_traits<TPattern>;
+
+    static constexpr size_t size = program_traits::size;
+
+    /** Set of threads, in priority order, each with the position at which its match began. */
+    struct thread_list
+    {
+      uint32_t count = 0;
+      uint32_t dense[size];
+      uint32_t sparse[size];
+      const char* starts[size];
+
+      /** Returns `true` if the list contains a thread at `pc`. */
+      bool contains(uint32_t pc) const
+      {
+        auto index = sparse[pc];
+        return (index < count && dense[index] == pc);
+      }
+    };
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Finds the leftmost-first match in the input range, or if `earliest` is set, any match, and
+     * returns its beginning, storing its end in `match_end`. Returns `nullptr` if there is none.
+     */
+    static const char* search(const char* begin, const char* end, const char*& match_end, bool earliest)
+    {
+      thread_list lists[2] { };
+      auto current = &lists[0];
+      auto next = &lists[1];
+      const char* match_begin = nullptr;
+
+      for (auto ptr = begin; ; ptr++)
+      {
+        // a new thread starts at each position, with the lowest priority, until a match is found
+        if (match_begin == nullptr)
+        {
+          if (current->count == 0 && !traits::tree.nullable)
+          {
+            while (ptr != end && !traits::tree.first_bytes.test(static_cast<unsigned char>(*ptr)))
+              ptr++;
+            if (ptr == end)
+              return nullptr;
+          }
+          add_thread(*current, 0, ptr);
+        }
+
+        next->count = 0;
+        for (uint32_t index = 0; index < current->count; index++)
+        {
+          auto pc = current->dense[index];
+          const auto& inst = program_traits::program.instructions[pc];
+          if (inst.op == static_opcode::match)
+          {
+            // threads after this one have lower priority, so they are cut
+            match_begin = current->starts[pc];
+            match_end = ptr;
+            if (earliest)
+              return match_begin;
+            break;
+          }
+          if (inst.op == static_opcode::byte_set && ptr != end && test(inst.node, *ptr))
+            add_thread(*next, static_cast<uint32_t>(inst.next), current->starts[pc]);
+        }
+
+        std::swap(current, next);
+        if (ptr == end || (current->count == 0 && match_begin != nullptr))
+          return match_begin;
+      }
+    }
+
+    /** Returns `true` if the program matches the entire input range. */
+    static bool full_match(const char* begin, const char* end)
+    {
+      thread_list lists[2] { };
+      auto current = &lists[0];
+      auto next = &lists[1];
+      add_thread(*current, 0, begin);
+
+      for (auto ptr = begin; ptr != end && current->count != 0; ptr++)
+      {
+        next->count = 0;
+        for (uint32_t index = 0; index < current->count; index++)
+        {
+          const auto& inst = program_traits::program.instructions[current->dense[index]];
+          if (inst.op == static_opcode::byte_set && test(inst.node, *ptr))
+            add_thread(*next, static_cast<uint32_t>(inst.next), begin);
+        }
+        std::swap(current, next);
+      }
+
+      for (uint32_t index = 0; index < current->count; index++)
+        if (program_traits::program.instructions[current->dense[index]].op == static_opcode::match)
+          return true;
+      return false;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    /** Returns `true` if the byte set of tree node `node` contains `ch`. */
+    static bool test(size_t node, char ch)
+    {
+      return traits::tree.nodes[node].test(static_cast<unsigned char>(ch));
+    }
+
+    /**
+     * Adds the thread at `pc`, and every thread reachable from it through splits and jumps, to
+     * `list` in priority order. Every frame pushed is a new insertion into the list, so the stack
+     * never holds more than one frame per instruction.
+     */
+    static void add_thread(thread_list& list, uint32_t pc, const char* start)
+    {
+      uint32_t stack[size];
+      size_t depth = 0;
+      stack[depth++] = pc;
+      while (depth != 0)
+      {
+        pc = stack[--depth];
+        while (!list.contains(pc))
+        {
+          list.sparse[pc] = list.count;
+          list.dense[list.count++] = pc;
+          list.starts[pc] = start;
+
+          const auto& inst = program_traits::program.instructions[pc];
+          if (inst.op == static_opcode::split)
+          {
+            stack[depth++] = static_cast<uint32_t>(inst.alternate);
+            pc = static_cast<uint32_t>(inst.next);
+          }
+          else if (inst.op == static_opcode::jump)
+            pc = static_cast<uint32_t>(inst.next);
+          else
+            break;
+        }
+      }
+    }
+
+  };
+
+  template <typename TPattern>
+  constexpr size_t static_vm<TPattern>::size;
+
+  /**
+   * Matches node `I` of the tree for `TPattern` at `ptr`, calling the continuation `k` with the end
+   * of each way it matches, in priority order, until `k` returns `true`. Specialized for each node
+   * type, so the compiler sees the whole expression as straight-line code.
+   */
+  template <typename TPattern, size_t I, static_node_type T = static_pattern_traits<TPattern>::tree.nodes[I].type>
+  struct static_matcher;
+
+  /** Matches the siblings beginning with node `I` in order, then calls `k`. */
+  template <typename TPattern, size_t I>
+  struct static_sequence
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      auto rest = [end, &k] (const char* next) {
+        return static_sequence<TPattern, static_pattern_traits<TPattern>::tree.nodes[I].next>::run(next, end, k);
+      };
+      return static_matcher<TPattern, I>::run(ptr, end, rest);
+    }
+  };
+
+  template <typename TPattern>
+  struct static_sequence<TPattern, STATIC_NO_NODE>
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char*, TContinuation& k)
+    {
+      return k(ptr);
+    }
+  };
+
+  /** Tries the siblings beginning with node `I` in order, until one leads to a match. */
+  template <typename TPattern, size_t I>
+  struct static_choice
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      if (static_matcher<TPattern, I>::run(ptr, end, k))
+        return true;
+      return static_choice<TPattern, static_pattern_traits<TPattern>::tree.nodes[I].next>::run(ptr, end, k);
+    }
+  };
+
+  template <typename TPattern>
+  struct static_choice<TPattern, STATIC_NO_NODE>
+  {
+    template <typename TContinuation>
+    static bool run(const char*, const char*, TContinuation&)
+    {
+      return false;
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  struct static_matcher<TPattern, I, static_node_type::empty>
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char*, TContinuation& k)
+    {
+      return k(ptr);
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  struct static_matcher<TPattern, I, static_node_type::byte_set>
+  {
+    static constexpr size_t count = static_pattern_traits<TPattern>::tree.nodes[I].count();
+    static constexpr unsigned char lowest = static_pattern_traits<TPattern>::tree.nodes[I].lowest();
+    static constexpr bool contiguous = (static_pattern_traits<TPattern>::tree.nodes[I].highest() + 1u == lowest + count);
+
+    /** Returns `true` if the byte set contains `ch`, testing a single range without a lookup. */
+    static bool test(unsigned char ch)
+    {
+      if (contiguous)
+        return static_cast<unsigned char>(ch - lowest) < count;
+      return static_pattern_traits<TPattern>::tree.nodes[I].test(ch);
+    }
+
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      if (ptr == end || !test(static_cast<unsigned char>(*ptr)))
+        return false;
+      return k(ptr + 1);
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  constexpr size_t static_matcher<TPattern, I, static_node_type::byte_set>::count;
+
+  template <typename TPattern, size_t I>
+  constexpr unsigned char static_matcher<TPattern, I, static_node_type::byte_set>::lowest;
+
+  template <typename TPattern, size_t I>
+  constexpr bool static_matcher<TPattern, I, static_node_type::byte_set>::contiguous;
+
+  template <typename TPattern, size_t I>
+  struct static_matcher<TPattern, I, static_node_type::concatenation>
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      return static_sequence<TPattern, static_pattern_traits<TPattern>::tree.nodes[I].first>::run(ptr, end, k);
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  struct static_matcher<TPattern, I, static_node_type::alternation>
+  {
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      return static_choice<TPattern, static_pattern_traits<TPattern>::tree.nodes[I].first>::run(ptr, end, k);
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  struct static_matcher<TPattern, I, static_node_type::repeat>
+  {
+    static constexpr size_t child = static_pattern_traits<TPattern>::tree.nodes[I].first;
+    static constexpr size_t min_count = static_pattern_traits<TPattern>::tree.nodes[I].min_count;
+    static constexpr size_t max_count = static_pattern_traits<TPattern>::tree.nodes[I].max_count;
+    static constexpr bool single_byte = (static_pattern_traits<TPattern>::tree.nodes[child].type == static_node_type::byte_set);
+
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k)
+    {
+      return run(ptr, end, k, std::integral_constant<bool, single_byte>());
+    }
+
+    /**
+     * Repeats a single byte set by counting the longest run of accepted bytes, then backing off one
+     * byte at a time, which matches exactly as backtracking would but without recursing per byte.
+     */
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k, std::true_type)
+    {
+      auto available = static_cast<size_t>(end - ptr);
+      auto limit = (max_count < available ? max_count : available);
+      size_t count = 0;
+      while (count < limit && static_matcher<TPattern, child>::test(static_cast<unsigned char>(ptr[count])))
+        count++;
+      if (count < min_count)
+        return false;
+
+      for (;; count--)
+      {
+        if (k(ptr + count))
+          return true;
+        if (count == min_count)
+          return false;
+      }
+    }
+
+    /** Repeats any other child by recursing once per iteration. */
+    template <typename TContinuation>
+    static bool run(const char* ptr, const char* end, TContinuation& k, std::false_type)
+    {
+      return iterate(ptr, end, 0, k);
+    }
+
+    /**
+     * Repeats the child greedily, having already matched it `count` times. An iteration which
+     * matches the empty string once the minimum is reached is not continued, as it could loop forever
+     * without consuming input.
+     */
+    template <typename TContinuation>
+    static bool iterate(const char* ptr, const char* end, size_t count, TContinuation& k)
+    {
+      if (count < max_count)
+      {
+        auto again = [ptr, end, count, &k] (const char* next) {
+          if (next == ptr && count >= min_count)
+            return false;
+          return iterate(next, end, count + 1, k);
+        };
+        if (static_matcher<TPattern, child>::run(ptr, end, again))
+          return true;
+      }
+      return (count >= min_count && k(ptr));
+    }
+  };
+
+  template <typename TPattern, size_t I>
+  constexpr size_t static_matcher<TPattern, I, static_node_type::repeat>::child;
+
+  template <typename TPattern, size_t I>
+  constexpr size_t static_matcher<TPattern, I, static_node_type::repeat>::min_count;
+
+  template <typename TPattern, size_t I>
+  constexpr size_t static_matcher<TPattern, I, static_node_type::repeat>::max_count;
+
+  template <typename TPattern, size_t I>
+  constexpr bool static_matcher<TPattern, I, static_node_type::repeat>::single_byte;
+
+  /**
+   * Class which matches an expression parsed entirely at compile time.
+   *
+   * `TPattern` is a type with a `static constexpr const char* value()` function returning the
+   * expression, as declared by `REGEX_STATIC_PATTERN`. The expression is parsed by a constexpr
+   * function, so a syntax error fails compilation with the same message a runtime parse would
+   * throw, and the matcher is a tree of templates specialized for each node of the expression, which
+   * the compiler can inline into straight-line code. There is no runtime compilation at all.
+   *
+   * Matching backtracks in priority order, so results are the same leftmost-first matches as
+   * `regex::pattern` finds. Repetitions of a single byte or class are run as a counted loop rather
+   * than recursively. An expression which repeats a subexpression that can match in more than one
+   * way, such as `(a*)*b`, could make backtracking take exponential time, so it is instead compiled
+   * to a program at compile time and matched by `regex::static_vm` in linear time. Only the bounds
+   * of the overall match are reported; groups are parsed but do not capture.
+   */
+  template <typename TPattern>
+  class static_regex
+  {
+    /* -- Types -- */
+
+  private:
+
+    using traits = static_pattern_traits<TPattern>;
+    using root_matcher = static_matcher<TPattern, traits::tree.root>;
+    using uses_vm = std::integral_constant<bool, traits::tree.ambiguous>;
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns `true` if the expression matches anywhere in the input range. */
+    bool is_match(const char* begin, const char* end) const
+    {
+      normalize(begin, end);
+      const char* match_end = nullptr;
+      return search(begin, end, match_end, true, uses_vm()) != nullptr;
+    }
+
+    /** Returns `true` if the expression matches anywhere in the input string. */
+    bool is_match(const std::string& input) const
+    {
+      return is_match(input.data(), input.data() + input.size());
+    }
+
+    /** Returns `true` if the expression matches the entire input range. */
+    bool full_match(const char* begin, const char* end) const
+    {
+      return matches_all(begin, end, uses_vm());
+    }
+
+    /** Returns `true` if the expression matches the entire input string. */
+    bool full_match(const std::string& input) const
+    {
+      return full_match(input.data(), input.data() + input.size());
+    }
+
+    /**
+     * Finds the leftmost-first match in the input range.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const char* begin, const char* end, regex::match& result) const
+    {
+      normalize(begin, end);
+      const char* match_end = nullptr;
+      auto match_begin = search(begin, end, match_end, false, uses_vm());
+      if (match_begin == nullptr)
+        return false;
+
+      result.begin = static_cast<size_t>(match_begin - begin);
+      result.end = static_cast<size_t>(match_end - begin);
+      return true;
+    }
+
+    /**
+     * Finds the leftmost-first match in the input string.
+     *
+     * @return `true` if a match was found, in which case its location is stored in `result`.
+     */
+    bool find(const std::string& input, regex::match& result) const
+    {
+      return find(input.data(), input.data() + input.size(), result);
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    /** Replaces an empty range, which may be null, with one which is not. */
+    static void normalize(const char*& begin, const char*& end)
+    {
+      static const char EMPTY = 0;
+      if (begin == end)
+        begin = end = &EMPTY;
+    }
+
+    /**
+     * Tries each start position in turn, skipping those at which no match can begin, and returns
+     * the first at which the expression matches, storing the end of the match in `match_end`, or
+     * `nullptr` if there is none. Backtracking finds the leftmost-first match first, so `earliest`
+     * makes no difference.
+     */
+    static const char* search(const char* begin, const char* end, const char*& match_end, bool, std::false_type)
+    {
+      auto k = [&match_end] (const char* next) {
+        match_end = next;
+        return true;
+      };
+
+      for (auto ptr = begin; ; ptr++)
+      {
+        if (!traits::tree.nullable)
+        {
+          while (ptr != end && !traits::tree.first_bytes.test(static_cast<unsigned char>(*ptr)))
+            ptr++;
+          if (ptr == end)
+            return nullptr;
+        }
+
+        if (root_matcher::run(ptr, end, k))
+          return ptr;
+        if (ptr == end)
+          return nullptr;
+      }
+    }
+
+    /** Searches with `regex::static_vm`, for expressions which may be slow to backtrack. */
+    static const char* search(const char* begin, const char* end, const char*& match_end, bool earliest, std::true_type)
+    {
+      return static_vm<TPattern>::search(begin, end, match_end, earliest);
+    }
+
+    /** Returns `true` if some way of matching by backtracking ends at the end of the input. */
+    static bool matches_all(const char* begin, const char* end, std::false_type)
+    {
+      auto k = [end] (const char* next) { return next == end; };
+      return root_matcher::run(begin, end, k);
+    }
+
+    /** Returns `true` if `regex::static_vm` matches the entire input. */
+    static bool matches_all(const char* begin, const char* end, std::true_type)
+    {
+      return static_vm<TPattern>::full_match(begin, end);
+    }
+
+  };
+
+}
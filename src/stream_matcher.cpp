@@ -0,0 +1,272 @@
+/**
+ * @file	stream_matcher.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "match.hpp"
+#include "program.hpp"
+#include "stream_matcher.hpp"
+#include "thread_list.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Types -- */
+
+struct stream_matcher::implementation
+{
+
+  /* -- Constructor -- */
+
+  implementation(shared_ptr<const program> prog)
+    : prog(move(prog)),
+      slot_count(this->prog->slot_count),
+      clist(this->prog->instructions.size(), slot_count),
+      nlist(this->prog->instructions.size(), slot_count),
+      threads(*this->prog, slot_count),
+      matched_slots(slot_count)
+  {
+    assert(!this->prog->reverse);
+    reset();
+  }
+
+  /* -- Fields -- */
+
+  shared_ptr<const program> prog;
+  size_t slot_count;
+  thread_list clist;
+  thread_list nlist;
+  thread_builder threads;
+  vector<size_t> matched_slots;
+
+  /** `true` if a match has been seen which may still be extended by a higher priority thread. */
+  bool matched;
+
+  /** The stream offset of the next byte to run, which moves back when input is replayed. */
+  size_t position;
+
+  /** The number of bytes pushed into the current stream. */
+  size_t consumed;
+
+  /** The first stream offset at which a new match may begin. */
+  size_t next_start;
+
+  /** Input kept for replay, beginning at stream offset `history_start`. */
+  vector<char> history;
+  size_t history_start;
+
+  /* -- Methods -- */
+
+  /** Discards all state, beginning a new stream. */
+  void reset()
+  {
+    clist.set.clear();
+    matched = false;
+    position = 0;
+    consumed = 0;
+    next_start = 0;
+    history.clear();
+    history_start = 0;
+  }
+
+  /**
+   * Runs input until both the replay history and the chunk `[chunk, end)` are exhausted, appending
+   * any final matches to `matches`.
+   */
+  void run(const char* chunk, const char* end, vector<match>& matches)
+  {
+    for (;;)
+    {
+      char ch;
+      bool from_chunk = false;
+      if (position < history_start + history.size())
+        ch = history[position - history_start];
+      else if (chunk != end)
+      {
+        ch = *chunk++;
+        from_chunk = true;
+      }
+      else
+        break;
+
+      step(position, static_cast<unsigned char>(ch), false);
+
+      // once a match has been seen, the input after it may have to be replayed
+      if (matched && from_chunk)
+      {
+        if (history.empty())
+          history_start = position;
+        assert(history_start + history.size() == position);
+        history.push_back(ch);
+      }
+
+      position++;
+      settle(matches);
+    }
+  }
+
+  /** Ends the stream, appending any remaining matches to `matches`. */
+  void finish(vector<match>& matches)
+  {
+    for (;;)
+    {
+      run(nullptr, nullptr, matches);
+      step(position, 0, true);
+      if (!matched)
+        break;
+
+      // no thread survives the end of the input, so the match is final, but it may need replaying
+      settle(matches);
+    }
+    reset();
+  }
+
+  /**
+   * Reports the pending match if no remaining thread can extend it, resuming the search at its end,
+   * and discards any history which can no longer be replayed.
+   */
+  void settle(vector<match>& matches)
+  {
+    if (matched && clist.set.empty())
+    {
+      match result { matched_slots[0], matched_slots[1] };
+      matches.push_back(result);
+      matched = false;
+      next_start = (result.begin == result.end ? result.end + 1 : result.end);
+      position = result.end;
+    }
+
+    if (!matched)
+      discard_history(position);
+    else
+      discard_history(matched_slots[1]);
+  }
+
+  /** Discards history before the specified stream offset, once enough has built up to be worth it. */
+  void discard_history(size_t offset)
+  {
+    if (offset <= history_start)
+      return;
+
+    auto count = min(offset - history_start, history.size());
+    if (count == history.size())
+    {
+      history.clear();
+      history_start = offset;
+    }
+    else if (2 * count >= history.size())
+    {
+      history.erase(history.begin(), history.begin() + count);
+      history_start += count;
+    }
+  }
+
+  /**
+   * Runs the thread list for one position of the stream, starting a new thread there first if a
+   * match may begin at it.
+   */
+  void step(size_t pos, uint32_t ch, bool at_end)
+  {
+    if (!matched && pos >= next_start)
+    {
+      threads.start_thread(clist, prog->anchored_start, pos);
+    }
+
+    nlist.set.clear();
+    for (size_t idx = 0; idx < clist.set.size(); idx++)
+    {
+      auto pc = clist.set[idx];
+      const auto& inst = prog->instructions[pc];
+      const size_t* thread_slots = &clist.slots[pc * slot_count];
+
+      bool cut = false;
+      switch (inst.op)
+      {
+      case opcode::match:
+        matched = true;
+        copy(thread_slots, thread_slots + slot_count, matched_slots.begin());
+        // all remaining threads have lower priority than this one
+        cut = true;
+        break;
+
+      case opcode::byte:
+        if (!at_end && ch == inst.argument)
+          threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+        break;
+
+      case opcode::byte_set:
+        if (!at_end && prog->byte_sets[inst.argument].test(ch))
+          threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+        break;
+
+      case opcode::any:
+        if (!at_end)
+          threads.step_thread(nlist, inst.next, pos + 1, thread_slots);
+        break;
+
+      default:
+        // epsilon instructions are only in the list to mark them as visited
+        break;
+      }
+
+      if (cut)
+        break;
+    }
+
+    swap(clist, nlist);
+  }
+
+};
+
+/* -- Procedures -- */
+
+stream_matcher::stream_matcher(shared_ptr<const program> prog)
+  : impl(make_unique<implementation>(move(prog)))
+{
+}
+
+stream_matcher::~stream_matcher() = default;
+
+void stream_matcher::push(const char* begin, const char* end, vector<match>& matches)
+{
+  impl->consumed += static_cast<size_t>(end - begin);
+  impl->run(begin, end, matches);
+}
+
+void stream_matcher::push(const string& chunk, vector<match>& matches)
+{
+  push(chunk.data(), chunk.data() + chunk.size(), matches);
+}
+
+void stream_matcher::finish(vector<match>& matches)
+{
+  impl->finish(matches);
+}
+
+void stream_matcher::reset()
+{
+  impl->reset();
+}
+
+size_t stream_matcher::offset() const
+{
+  return impl->consumed;
+}
+
+size_t stream_matcher::buffered() const
+{
+  return impl->history.size();
+}
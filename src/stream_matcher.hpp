@@ -0,0 +1,94 @@
+/**
+ * @file	stream_matcher.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "match.hpp"
+#include "program.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Class which finds successive matches in a stream of input delivered in chunks.
+   *
+   * The program is simulated as by a `regex::pike_vm`, with each thread carrying the absolute stream
+   * offset at which its match began, so the thread list is simply carried over from one chunk to the
+   * next and nothing already consumed needs to be kept. The exception is a match which may still be
+   * extended: once the preferred match has been seen, the input following it must be kept until
+   * every thread which could extend it has died, since the search for the next match resumes from
+   * its end. For a pattern such as `abc`, a match is final as soon as it is seen, so no input is
+   * ever buffered.
+   *
+   * Matches are reported in order, do not overlap, and have the same bounds as successive calls to
+   * `find()` on the whole stream would, each resuming at the end of the previous match. An empty
+   * match resumes one byte later instead.
+   *
+   * A single instance must not be used by multiple threads at once.
+   */
+  class stream_matcher
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::stream_matcher` for the specified program.
+     *
+     * @param prog The program to execute, which must not be reversed.
+     */
+    stream_matcher(std::shared_ptr<const regex::program> prog);
+
+    /** Destructor. */
+    ~stream_matcher();
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /**
+     * Consumes the next chunk of the stream. Any matches which are known to be final are appended to
+     * `matches`, with positions relative to the start of the stream.
+     */
+    void push(const char* begin, const char* end, std::vector<regex::match>& matches);
+
+    /** Consumes the next chunk of the stream. */
+    void push(const std::string& chunk, std::vector<regex::match>& matches);
+
+    /**
+     * Ends the stream, appending any remaining matches to `matches`. The matcher is then reset to
+     * begin a new stream.
+     */
+    void finish(std::vector<regex::match>& matches);
+
+    /** Discards all state, beginning a new stream. */
+    void reset();
+
+    /** Returns the number of bytes consumed from the current stream. */
+    size_t offset() const;
+
+    /** Returns the number of bytes currently buffered while a match may still be extended. */
+    size_t buffered() const;
+
+    /* -- Implementation -- */
+
+  private:
+
+    struct implementation;
+    std::unique_ptr<implementation> impl;
+
+  };
+
+}
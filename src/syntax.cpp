@@ -50,6 +50,22 @@ namespace
       cout << "Wildcard" << endl;
       break;
 
+    case syntax_node_type::character_class:
+    {
+      auto class_node = dynamic_cast<const syntax_class_node*>(root.get());
+      assert(class_node != nullptr);
+      cout << "Class: " << class_node->bitmap().count() << " characters" << endl;
+      break;
+    }
+
+    case syntax_node_type::string:
+    {
+      auto string_node = dynamic_cast<const syntax_string_node*>(root.get());
+      assert(string_node != nullptr);
+      cout << "String: " << string_node->text() << endl;
+      break;
+    }
+
     case syntax_node_type::concatenation:
       print_internal(dynamic_cast<const syntax_concatenation_node*>(root.get()));
       break;
@@ -69,6 +85,28 @@ namespace
     case syntax_node_type::repeat:
       print_internal(dynamic_cast<const syntax_repeat_node*>(root.get()));
       break;
+
+    case syntax_node_type::quantifier:
+    {
+      auto quantifier_node = dynamic_cast<const syntax_quantifier_node*>(root.get());
+      assert(quantifier_node != nullptr);
+      cout << "Quantifier: " << quantifier_node->min_count() << ", ";
+      if (quantifier_node->max_count() == syntax_quantifier_node::UNBOUNDED)
+        cout << "unbounded" << endl;
+      else
+        cout << quantifier_node->max_count() << endl;
+      recursive_print_syntax_tree(quantifier_node->children()[0], indentation + 1);
+      break;
+    }
+
+    case syntax_node_type::capture:
+    {
+      auto capture_node = dynamic_cast<const syntax_capture_node*>(root.get());
+      assert(capture_node != nullptr);
+      cout << "Capture: " << capture_node->index() << endl;
+      recursive_print_syntax_tree(capture_node->children()[0], indentation + 1);
+      break;
+    }
     }
   }
 
@@ -76,6 +114,8 @@ namespace
 
 /* -- Procedures -- */
 
+const uint32_t syntax_quantifier_node::UNBOUNDED;
+
 void regex::print_syntax_tree(const unique_ptr<const syntax_node>& root)
 {
   recursive_print_syntax_tree(root, 0);
@@ -85,22 +125,30 @@ const string& regex::syntax_node_type_string(syntax_node_type type)
 {
   static const string STRING_LITERAL 		= "Literal";
   static const string STRING_WILDCARD		= "Wildcard";
+  static const string STRING_CLASS		= "Class";
+  static const string STRING_STRING		= "String";
   static const string STRING_CONCATENATION	= "Concatenation";
   static const string STRING_ALTERNATION	= "Alternation";
   static const string STRING_OPTIONAL		= "Optional";
   static const string STRING_KLEENE		= "Kleene";
   static const string STRING_REPEAT		= "Repeat";
+  static const string STRING_QUANTIFIER		= "Quantifier";
+  static const string STRING_CAPTURE		= "Capture";
   static const string STRING_DEFAULT		= "Unknown";
 
   switch (type)
   {
   case syntax_node_type::literal:		return STRING_LITERAL;
   case syntax_node_type::wildcard:		return STRING_WILDCARD;
+  case syntax_node_type::character_class:	return STRING_CLASS;
+  case syntax_node_type::string:		return STRING_STRING;
   case syntax_node_type::concatenation:		return STRING_CONCATENATION;
   case syntax_node_type::alternation:		return STRING_ALTERNATION;
   case syntax_node_type::optional:		return STRING_OPTIONAL;
   case syntax_node_type::kleene:		return STRING_KLEENE;
   case syntax_node_type::repeat:		return STRING_REPEAT;
+  case syntax_node_type::quantifier:		return STRING_QUANTIFIER;
+  case syntax_node_type::capture:		return STRING_CAPTURE;
   default:					return STRING_DEFAULT;
   }
 }
@@ -9,7 +9,11 @@
 /* -- Includes -- */
 
 #include <array>
+#include <bitset>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
 
 /* -- Types -- */
 
@@ -21,15 +25,19 @@ namespace regex
   /**
    * Enumeration of types of syntax nodes.
    */
-  enum class syntax_node_type
+  enum class syntax_node_type : uint8_t
   {
     literal,
     wildcard,
+    character_class,
+    string,
     concatenation,
     alternation,
     optional,
     kleene,
     repeat,
+    quantifier,
+    capture,
   };
 
   /* -- Base Type -- */
@@ -133,6 +141,89 @@ namespace regex
 
   };
 
+  /**
+   * Class representing a character class node in a syntax tree, matching any one character in a set.
+   */
+  class syntax_class_node : public regex::syntax_terminal_node
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new `regex::syntax_class_node` object matching the bytes set in `bitmap`. */
+    syntax_class_node(const std::bitset<256>& bitmap)
+      : m_bitmap(bitmap)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the type of this syntax node. */
+    virtual regex::syntax_node_type type() const override
+    {
+      return syntax_node_type::character_class;
+    }
+
+    /** Returns `true` if this node matches the specified character. */
+    virtual bool matches_character(char ch) const override
+    {
+      return m_bitmap.test(static_cast<unsigned char>(ch));
+    }
+
+    /** Returns the set of bytes that this class matches. */
+    const std::bitset<256>& bitmap() const
+    {
+      return m_bitmap;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+    std::bitset<256> m_bitmap;
+  };
+
+  /**
+   * Class representing a string of literal characters in a syntax tree.
+   *
+   * The parser never produces string nodes. They are introduced by `regex::simplify()`, which
+   * merges runs of consecutive literals so that they may be handled as a unit.
+   */
+  class syntax_string_node : public regex::syntax_node
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new `regex::syntax_string_node` object for the specified non-empty string. */
+    syntax_string_node(const std::string& text)
+      : m_text(text)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the type of this syntax node. */
+    virtual regex::syntax_node_type type() const override
+    {
+      return syntax_node_type::string;
+    }
+
+    /** Returns the string that this node represents. */
+    const std::string& text() const
+    {
+      return m_text;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+    std::string m_text;
+  };
+
   /* -- Internal Nodes -- */
 
   /**
@@ -206,6 +297,91 @@ namespace regex
   using syntax_repeat_node =
     regex::syntax_internal_node<regex::syntax_node_type::repeat, 1>;
 
+  /**
+   * Class representing a counted repetition of a subexpression, matching it between `min_count()`
+   * and `max_count()` times, inclusive.
+   */
+  class syntax_quantifier_node : public regex::syntax_internal_node<regex::syntax_node_type::quantifier, 1>
+  {
+
+    /* -- Constants -- */
+
+  public:
+
+    /** Value of `max_count()` indicating that there is no maximum. */
+    static const uint32_t UNBOUNDED = 0xFFFFFFFF;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new `regex::syntax_quantifier_node` over the specified child. */
+    syntax_quantifier_node(child_type child, uint32_t min_count, uint32_t max_count)
+      : syntax_internal_node(std::move(child)),
+        m_min_count(min_count),
+        m_max_count(max_count)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the minimum number of repetitions. */
+    uint32_t min_count() const
+    {
+      return m_min_count;
+    }
+
+    /** Returns the maximum number of repetitions, or `UNBOUNDED`. */
+    uint32_t max_count() const
+    {
+      return m_max_count;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    uint32_t m_min_count;
+    uint32_t m_max_count;
+
+  };
+
+  /**
+   * Class representing a capturing group, which records the bounds of the input matched by its
+   * subexpression. Groups are numbered from `1` in the order of their opening brackets.
+   */
+  class syntax_capture_node : public regex::syntax_internal_node<regex::syntax_node_type::capture, 1>
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new `regex::syntax_capture_node` over the specified child. */
+    syntax_capture_node(child_type child, uint32_t index)
+      : syntax_internal_node(std::move(child)),
+        m_index(index)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of this group. */
+    uint32_t index() const
+    {
+      return m_index;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    uint32_t m_index;
+
+  };
+
 }
 
 /* -- Procedure Prototypes -- */
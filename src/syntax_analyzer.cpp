@@ -6,6 +6,7 @@
 
 /* -- Includes -- */
 
+#include <bitset>
 #include <cassert>
 #include <iostream>
 #include <memory>
@@ -16,6 +17,7 @@
 #include "lexical_analyzer.hpp"
 #include "syntax.hpp"
 #include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
 #include "token.hpp"
 
 /* -- Namespaces -- */
@@ -28,111 +30,224 @@ using namespace regex;
 struct syntax_analyzer::implementation
 {
 
+  /* -- Types -- */
+
+  /** Struct describing a bracketed group which is still being parsed. */
+  struct group
+  {
+    size_t alternatives_begin;
+    size_t sequence_begin;
+    uint32_t capture;
+  };
+
+  /** Value of `group::capture` for a group which does not capture. */
+  static const uint32_t NO_CAPTURE = 0;
+
   /* -- Fields -- */
 
-  vector<unique_ptr<const token>> tokens;
-  vector<unique_ptr<const token>>::const_iterator it;
+  vector<token> tokens;
+  vector<token>::const_iterator it;
+  syntax_tree tree;
+
+  vector<group> groups;
+  vector<syntax_index> alternatives;
+  vector<syntax_index> sequence;
+  uint32_t capture_count;
 
   /* -- Methods -- */
 
-  /** Parses a regular expression. */
-  unique_ptr<const syntax_node> parse_regex()
+  /**
+   * Parses a regular expression.
+   *
+   * Rather than recursing for each atom, alternative, and group, the parser keeps the state of each
+   * open group on explicit stacks: `sequence` holds the atoms parsed so far in the current
+   * alternative of every open group, and `alternatives` holds the alternatives completed so far. A
+   * run of atoms becomes a single n-ary concatenation node and a list of alternatives a single n-ary
+   * alternation node, so the native stack depth is constant and each token is handled once,
+   * however long the expression is.
+   */
+  syntax_index parse_regex()
   {
-    auto expr = parse_expr();
-    switch (next_token_type())
-    {
-    case token_type::alternation_operator:
-    {
-      it++;
-      auto regex = parse_regex();
-      return make_unique<const syntax_alternation_node>(move(expr), move(regex));
-    }
+    groups.clear();
+    alternatives.clear();
+    sequence.clear();
+    capture_count = 0;
+    groups.push_back(group { 0, 0, NO_CAPTURE });
 
-    default:
-      return expr;
-    }
-  }
+    // `true` if the last atom in the sequence has already had a closure operator applied
+    bool closed = false;
 
-  /** Parses an expression. */
-  unique_ptr<const syntax_node> parse_expr()
-  {
-    auto subexpr = parse_subexpr();
-    switch (next_token_type())
+    while (true)
     {
-    case token_type::open_bracket:
-    case token_type::literal:
-    case token_type::wildcard:
-    {
-      // we can only start a new concatenation on an open bracket, literal, or wildcard
-      auto expr = parse_expr();
-      return make_unique<const syntax_concatenation_node>(move(subexpr), move(expr));
-    }
-
-    default:
-      return subexpr;
+      switch (next_token_type())
+      {
+      case token_type::literal:
+        sequence.push_back(parse_literal());
+        closed = false;
+        break;
+
+      case token_type::wildcard:
+        sequence.push_back(parse_wildcard());
+        closed = false;
+        break;
+
+      case token_type::open_class_bracket:
+        sequence.push_back(parse_class());
+        closed = false;
+        break;
+
+      case token_type::open_bracket:
+      {
+        // capturing groups are numbered in the order in which they open
+        uint32_t capture = NO_CAPTURE;
+        if (it->capturing())
+          capture = ++capture_count;
+
+        // the root of the expression is the outermost entry on the stack
+        if (groups.size() > MAX_NESTING_DEPTH)
+          throw_syntax_error(next_token_position(),
+                             "Groups nested more than " + to_string(MAX_NESTING_DEPTH) + " deep.");
+        skip_next_token();
+        groups.push_back(group { alternatives.size(), sequence.size(), capture });
+        break;
+      }
+
+      case token_type::optional_operator:
+      case token_type::kleene_operator:
+      case token_type::repeat_operator:
+      case token_type::quantifier:
+      {
+        if (sequence.size() == groups.back().sequence_begin)
+          throw_syntax_error(next_token_position(), "Expected atom.");
+        if (closed)
+          throw_unexpected_token();
+
+        sequence.back() = parse_closure(sequence.back());
+        closed = true;
+        break;
+      }
+
+      case token_type::alternation_operator:
+        end_alternative();
+        skip_next_token();
+        closed = false;
+        break;
+
+      case token_type::close_bracket:
+      {
+        if (groups.size() == 1)
+        {
+          end_alternative();
+          throw_unexpected_token();
+        }
+
+        skip_next_token();
+        auto capture = groups.back().capture;
+        auto subexpr = end_group();
+        if (capture != NO_CAPTURE)
+          subexpr = tree.add_capture(subexpr, capture);
+        sequence.push_back(subexpr);
+        closed = false;
+        break;
+      }
+
+      case token_type::eof:
+      {
+        if (groups.size() != 1)
+        {
+          end_alternative();
+          throw_unexpected_token();
+        }
+        return end_group();
+      }
+
+      default:
+        throw_syntax_error(next_token_position(), "Expected atom.");
+      }
     }
   }
 
-  /** Parses a subexpression. */
-  unique_ptr<const syntax_node> parse_subexpr()
+  /** Parses a closure operator or quantifier applied to the specified atom. */
+  syntax_index parse_closure(syntax_index atom)
   {
-    auto atom = parse_atom();
-    switch (next_token_type())
+    auto tok = *it;
+    skip_next_token();
+    switch (tok.type())
     {
     case token_type::optional_operator:
-      skip_next_token();
-      return make_unique<const syntax_optional_node>(move(atom));
+      return tree.add_internal(syntax_node_type::optional, { atom });
 
     case token_type::kleene_operator:
-      skip_next_token();
-      return make_unique<const syntax_kleene_node>(move(atom));
+      return tree.add_internal(syntax_node_type::kleene, { atom });
 
     case token_type::repeat_operator:
-      skip_next_token();
-      return make_unique<const syntax_repeat_node>(move(atom));
+      return tree.add_internal(syntax_node_type::repeat, { atom });
+
+    case token_type::quantifier:
+    {
+      auto max_count = (tok.max_count() == token::UNBOUNDED ?
+                        syntax_quantifier_node::UNBOUNDED :
+                        static_cast<uint32_t>(tok.max_count()));
+      return tree.add_quantifier(atom, static_cast<uint32_t>(tok.min_count()), max_count);
+    }
 
     default:
-      return atom;
+      throw_syntax_error(tok.position(), "Expected closure operator.");
     }
   }
 
-  /** Parses an atom. */
-  unique_ptr<const syntax_node> parse_atom()
+  /** Completes the current alternative of the innermost open group. */
+  void end_alternative()
   {
-    switch (next_token_type())
-    {
-    case token_type::literal:
-      return parse_literal();
+    auto begin = groups.back().sequence_begin;
+    if (sequence.size() == begin)
+      throw_syntax_error(next_token_position(), "Expected atom.");
 
-    case token_type::wildcard:
-      return parse_wildcard();
+    alternatives.push_back(make_node(syntax_node_type::concatenation, sequence, begin));
+    sequence.resize(begin);
+  }
 
-    case token_type::open_bracket:
-    {
-      skip_next_token();
-      auto subexpr = parse_regex();
-      if (next_token_type() != token_type::close_bracket)
-        throw_syntax_error(next_token_position(), "Expected close bracket.");
-      skip_next_token();
-      return subexpr;
-    }
+  /** Completes the innermost open group and returns its root. */
+  syntax_index end_group()
+  {
+    end_alternative();
+    auto begin = groups.back().alternatives_begin;
+    auto node = make_node(syntax_node_type::alternation, alternatives, begin);
+    alternatives.resize(begin);
+    groups.pop_back();
+    return node;
+  }
 
-    default:
-      throw_syntax_error(next_token_position(), "Expected atom.");
-    }
+  /**
+   * Returns a node of the specified type whose children are the indices in `stack` from `begin`
+   * onwards, or the only index if there is just one.
+   */
+  syntax_index make_node(syntax_node_type type, const vector<syntax_index>& stack, size_t begin)
+  {
+    assert(begin < stack.size());
+    if (stack.size() - begin == 1)
+      return stack[begin];
+    return tree.add_internal(type, stack.data() + begin, stack.size() - begin);
+  }
+
+  /** Throws a syntax error for a token which cannot continue the current group. */
+  [[noreturn]] void throw_unexpected_token() const
+  {
+    if (groups.size() == 1)
+      throw_syntax_error(next_token_position(), "Unparseable tokens at end of string.");
+    throw_syntax_error(next_token_position(), "Expected close bracket.");
   }
 
   /** Parses a literal. */
-  unique_ptr<const syntax_node> parse_literal()
+  syntax_index parse_literal()
   {
     switch (next_token_type())
     {
     case token_type::literal:
     {
-      auto literal_token = next_token<class literal_token>();
-      auto node = make_unique<const syntax_literal_node>(literal_token->character());
+      auto node = tree.add_literal(it->character());
       skip_next_token();
-      return move(node);
+      return node;
     }
 
     default:
@@ -141,15 +256,15 @@ struct syntax_analyzer::implementation
   }
 
   /** Parses a wildcard. */
-  unique_ptr<const syntax_node> parse_wildcard()
+  syntax_index parse_wildcard()
   {
     switch (next_token_type())
     {
     case token_type::wildcard:
     {
-      auto node = make_unique<const syntax_wildcard_node>();
+      auto node = tree.add_wildcard();
       skip_next_token();
-      return move(node);
+      return node;
     }
 
     default:
@@ -157,6 +272,28 @@ struct syntax_analyzer::implementation
     }
   }
 
+  /** Parses a character class. */
+  syntax_index parse_class()
+  {
+    if (next_token_type() != token_type::open_class_bracket)
+      throw_syntax_error(next_token_position(), "Expected character class.");
+    bool negated = it->negated();
+    skip_next_token();
+
+    bitset<256> bitmap;
+    for (; next_token_type() == token_type::class_range; skip_next_token())
+      for (unsigned byte = it->range_first(); byte <= it->range_last(); byte++)
+        bitmap.set(byte);
+
+    if (next_token_type() != token_type::close_class_bracket)
+      throw_syntax_error(next_token_position(), "Expected close class bracket.");
+    skip_next_token();
+
+    if (negated)
+      bitmap.flip();
+    return tree.add_class(bitmap);
+  }
+
   /** Skips the current token. */
   void skip_next_token()
   {
@@ -166,22 +303,13 @@ struct syntax_analyzer::implementation
   /** Returns the type of the next token. */
   token_type next_token_type() const
   {
-    return (*it)->type();
+    return it->type();
   }
 
   /** Returns the position of the next token. */
   size_t next_token_position() const
   {
-    return (*it)->position();
-  }
-
-  /** Gets a reference to the next token as the specified type. */
-  template <typename TToken>
-  const TToken* next_token() const
-  {
-    auto ptr = dynamic_cast<const TToken*>(it->get());
-    assert(ptr != nullptr);
-    return ptr;
+    return it->position();
   }
 
   /** Throws a syntax error. */
@@ -196,7 +324,9 @@ struct syntax_analyzer::implementation
 
 /* -- Procedures -- */
 
-syntax_analyzer::syntax_analyzer(vector<unique_ptr<const token>> tokens)
+const size_t syntax_analyzer::MAX_NESTING_DEPTH;
+
+syntax_analyzer::syntax_analyzer(vector<token> tokens)
   : impl(make_unique<implementation>())
 {
   impl->tokens = move(tokens);
@@ -207,8 +337,15 @@ syntax_analyzer::~syntax_analyzer() = default;
 
 unique_ptr<const syntax_node> syntax_analyzer::parse_regex()
 {
+  return make_syntax_node(parse_tree());
+}
+
+syntax_tree syntax_analyzer::parse_tree()
+{
+  impl->tree.clear();
+  impl->tree.reserve(impl->tokens.size());
+
   auto regex = impl->parse_regex();
-  if (impl->next_token_type() != token_type::eof)
-    implementation::throw_syntax_error(impl->next_token_position(), "Unparseable tokens at end of string.");
-  return regex;
+  impl->tree.set_root(regex);
+  return move(impl->tree);
 }
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "syntax.hpp"
+#include "syntax_tree.hpp"
 #include "token.hpp"
 
 /* -- Procedure Prototypes -- */
@@ -40,12 +41,22 @@ namespace regex
   class syntax_analyzer
   {
 
+    /* -- Constants -- */
+
+  public:
+
+    /**
+     * The deepest that groups may be nested. The passes over a parsed tree recurse once for each
+     * level of nesting, so this bounds the native stack they need.
+     */
+    static const size_t MAX_NESTING_DEPTH = 250;
+
     /* -- Lifecycle -- */
 
   public:
 
     /** Constructs a new `regex::syntax_analyzer` instance using the specified tokens. */
-    syntax_analyzer(std::vector<std::unique_ptr<const regex::token>> tokens);
+    syntax_analyzer(std::vector<regex::token> tokens);
 
     /** Destructor. */
     ~syntax_analyzer();
@@ -58,10 +69,25 @@ namespace regex
      * Parses a regular expression using this syntax analyzer's token list.
      *
      * @exception regex::syntax_error
-     * Thrown if a syntax error is encountered.
+     * Thrown if a syntax error is encountered, or if groups are nested more than
+     * `MAX_NESTING_DEPTH` deep.
      */
     std::unique_ptr<const regex::syntax_node> parse_regex();
 
+    /**
+     * Parses a regular expression using this syntax analyzer's token list, building the tree
+     * directly in a single arena.
+     *
+     * Parsing is iterative, so it takes time linear in the number of tokens and a constant amount
+     * of native stack regardless of the length or nesting depth of the expression. Runs of atoms and
+     * lists of alternatives are produced as single n-ary concatenation and alternation nodes.
+     *
+     * @exception regex::syntax_error
+     * Thrown if a syntax error is encountered, or if groups are nested more than
+     * `MAX_NESTING_DEPTH` deep.
+     */
+    regex::syntax_tree parse_tree();
+
     /* -- Implementation -- */
 
   private:
@@ -0,0 +1,300 @@
+/**
+ * @file	syntax_tree.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/27
+ */
+
+/* -- Includes -- */
+
+#include <bitset>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "syntax.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace regex;
+
+/* -- Private Procedures -- */
+
+namespace
+{
+
+  /** Recursively adds the tree rooted at `node` to `tree`, returning the index of its root. */
+  syntax_index recursive_make_syntax_tree(const syntax_node& node, syntax_tree& tree)
+  {
+    auto add_internal = [&tree] (const auto& internal) {
+      syntax_index children[2];
+      size_t count = 0;
+      for (const auto& child : internal.children())
+        children[count++] = recursive_make_syntax_tree(*child, tree);
+      return tree.add_internal(internal.type(), children, count);
+    };
+
+    switch (node.type())
+    {
+    case syntax_node_type::literal:
+      return tree.add_literal(static_cast<const syntax_literal_node&>(node).character());
+
+    case syntax_node_type::wildcard:
+      return tree.add_wildcard();
+
+    case syntax_node_type::character_class:
+      return tree.add_class(static_cast<const syntax_class_node&>(node).bitmap());
+
+    case syntax_node_type::string:
+      return tree.add_string(static_cast<const syntax_string_node&>(node).text());
+
+    case syntax_node_type::concatenation:
+      return add_internal(static_cast<const syntax_concatenation_node&>(node));
+
+    case syntax_node_type::alternation:
+      return add_internal(static_cast<const syntax_alternation_node&>(node));
+
+    case syntax_node_type::optional:
+      return add_internal(static_cast<const syntax_optional_node&>(node));
+
+    case syntax_node_type::kleene:
+      return add_internal(static_cast<const syntax_kleene_node&>(node));
+
+    case syntax_node_type::repeat:
+      return add_internal(static_cast<const syntax_repeat_node&>(node));
+
+    case syntax_node_type::quantifier:
+    {
+      const auto& quantifier = static_cast<const syntax_quantifier_node&>(node);
+      auto child = recursive_make_syntax_tree(*quantifier.children()[0], tree);
+      return tree.add_quantifier(child, quantifier.min_count(), quantifier.max_count());
+    }
+
+    case syntax_node_type::capture:
+    {
+      const auto& capture = static_cast<const syntax_capture_node&>(node);
+      auto child = recursive_make_syntax_tree(*capture.children()[0], tree);
+      return tree.add_capture(child, capture.index());
+    }
+    }
+
+    assert(false);
+    return syntax_tree::NO_NODE;
+  }
+
+  unique_ptr<const syntax_node> recursive_make_syntax_node(const syntax_tree& tree, syntax_index index);
+
+  /**
+   * Builds a right-nested chain of binary `TNode` nodes from the children of an n-ary concatenation
+   * or alternation, in the shape the recursive descent parser used to produce.
+   */
+  template <typename TNode>
+  unique_ptr<const syntax_node> make_binary_syntax_node(const syntax_tree& tree, syntax_tree::child_range children)
+  {
+    assert(children.size() >= 2);
+    auto node = recursive_make_syntax_node(tree, children[children.size() - 1]);
+    for (auto idx = children.size() - 1; idx-- > 0; )
+      node = make_unique<const TNode>(recursive_make_syntax_node(tree, children[idx]), move(node));
+    return node;
+  }
+
+  /** Recursively builds the `regex::syntax_node` tree equivalent to the subtree at `index`. */
+  unique_ptr<const syntax_node> recursive_make_syntax_node(const syntax_tree& tree, syntax_index index)
+  {
+    auto children = tree.children(index);
+    switch (tree.type(index))
+    {
+    case syntax_node_type::literal:
+      return make_unique<const syntax_literal_node>(tree.character(index));
+
+    case syntax_node_type::wildcard:
+      return make_unique<const syntax_wildcard_node>();
+
+    case syntax_node_type::character_class:
+      return make_unique<const syntax_class_node>(tree.bitmap(index));
+
+    case syntax_node_type::string:
+      return make_unique<const syntax_string_node>(tree.text(index));
+
+    case syntax_node_type::concatenation:
+      return make_binary_syntax_node<syntax_concatenation_node>(tree, children);
+
+    case syntax_node_type::alternation:
+      return make_binary_syntax_node<syntax_alternation_node>(tree, children);
+
+    case syntax_node_type::optional:
+      return make_unique<const syntax_optional_node>(recursive_make_syntax_node(tree, children[0]));
+
+    case syntax_node_type::kleene:
+      return make_unique<const syntax_kleene_node>(recursive_make_syntax_node(tree, children[0]));
+
+    case syntax_node_type::repeat:
+      return make_unique<const syntax_repeat_node>(recursive_make_syntax_node(tree, children[0]));
+
+    case syntax_node_type::quantifier:
+      return make_unique<const syntax_quantifier_node>(recursive_make_syntax_node(tree, children[0]),
+                                                       tree.min_count(index),
+                                                       tree.max_count(index));
+
+    case syntax_node_type::capture:
+      return make_unique<const syntax_capture_node>(recursive_make_syntax_node(tree, children[0]), tree.group(index));
+    }
+
+    assert(false);
+    return nullptr;
+  }
+
+  /** Recursively prints an arena syntax tree. */
+  void recursive_print_syntax_tree(const syntax_tree& tree, syntax_index index, int indentation)
+  {
+    for (int idx = 0; idx < indentation; idx++)
+      cout << "  ";
+
+    switch (tree.type(index))
+    {
+    case syntax_node_type::literal:
+      cout << "Literal: " << tree.character(index) << endl;
+      break;
+
+    case syntax_node_type::wildcard:
+      cout << "Wildcard" << endl;
+      break;
+
+    case syntax_node_type::character_class:
+      cout << "Class: " << tree.bitmap(index).count() << " characters" << endl;
+      break;
+
+    case syntax_node_type::string:
+      cout << "String: " << tree.text(index) << endl;
+      break;
+
+    case syntax_node_type::quantifier:
+      cout << "Quantifier: " << tree.min_count(index) << ", ";
+      if (tree.max_count(index) == syntax_quantifier_node::UNBOUNDED)
+        cout << "unbounded" << endl;
+      else
+        cout << tree.max_count(index) << endl;
+      recursive_print_syntax_tree(tree, tree.children(index)[0], indentation + 1);
+      break;
+
+    case syntax_node_type::capture:
+      cout << "Capture: " << tree.group(index) << endl;
+      recursive_print_syntax_tree(tree, tree.children(index)[0], indentation + 1);
+      break;
+
+    default:
+      cout << syntax_node_type_string(tree.type(index)) << endl;
+      for (auto child : tree.children(index))
+        recursive_print_syntax_tree(tree, child, indentation + 1);
+      break;
+    }
+  }
+
+}
+
+/* -- Procedures -- */
+
+const syntax_index syntax_tree::NO_NODE;
+
+syntax_index syntax_tree::add_internal(syntax_node_type type, const syntax_index* children, size_t count)
+{
+  // the children may be a range of this tree's own child list, which would be invalidated by growing it
+  auto data = m_children.data();
+  if (count != 0 && children >= data && children < data + m_children.size())
+  {
+    vector<syntax_index> copy(children, children + count);
+    return add_internal(type, copy.data(), count);
+  }
+
+  auto offset = static_cast<uint32_t>(m_children.size());
+  for (size_t idx = 0; idx < count; idx++)
+  {
+    assert(children[idx] < m_nodes.size());
+    m_children.push_back(children[idx]);
+  }
+
+  m_nodes.push_back(syntax_tree_node { type, static_cast<uint32_t>(count), offset });
+  return static_cast<syntax_index>(m_nodes.size() - 1);
+}
+
+syntax_index syntax_tree::add_terminal(syntax_node_type type, uint32_t value)
+{
+  m_nodes.push_back(syntax_tree_node { type, 0, value });
+  return static_cast<syntax_index>(m_nodes.size() - 1);
+}
+
+syntax_tree regex::make_syntax_tree(const unique_ptr<const syntax_node>& root)
+{
+  assert(root != nullptr);
+  syntax_tree tree;
+  tree.set_root(recursive_make_syntax_tree(*root, tree));
+  return tree;
+}
+
+unique_ptr<const syntax_node> regex::make_syntax_node(const syntax_tree& tree)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  return recursive_make_syntax_node(tree, tree.root());
+}
+
+syntax_tree regex::restrict_classes(const syntax_tree& tree, const bitset<256>& allowed)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+
+  // children are always added before their parents, so a single pass in index order suffices
+  syntax_tree result;
+  result.reserve(tree.size());
+  vector<syntax_index> mapped(tree.size(), syntax_tree::NO_NODE);
+  vector<syntax_index> children;
+  for (syntax_index index = 0; index < tree.size(); index++)
+  {
+    children.clear();
+    for (auto child : tree.children(index))
+    {
+      assert(child < index);
+      children.push_back(mapped[child]);
+    }
+
+    switch (tree.type(index))
+    {
+    case syntax_node_type::literal:
+      mapped[index] = result.add_literal(tree.character(index));
+      break;
+
+    case syntax_node_type::wildcard:
+      mapped[index] = result.add_class(allowed);
+      break;
+
+    case syntax_node_type::character_class:
+      mapped[index] = result.add_class(tree.bitmap(index) & allowed);
+      break;
+
+    case syntax_node_type::string:
+      mapped[index] = result.add_string(tree.text(index));
+      break;
+
+    case syntax_node_type::quantifier:
+      mapped[index] = result.add_quantifier(children[0], tree.min_count(index), tree.max_count(index));
+      break;
+
+    case syntax_node_type::capture:
+      mapped[index] = result.add_capture(children[0], tree.group(index));
+      break;
+
+    default:
+      mapped[index] = result.add_internal(tree.type(index), children.data(), children.size());
+      break;
+    }
+  }
+
+  result.set_root(mapped[tree.root()]);
+  return result;
+}
+
+void regex::print_syntax_tree(const syntax_tree& tree)
+{
+  assert(tree.root() != syntax_tree::NO_NODE);
+  recursive_print_syntax_tree(tree, tree.root(), 0);
+}
@@ -0,0 +1,323 @@
+/**
+ * @file	syntax_tree.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/27
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "syntax.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /** Type of the index identifying a node in a `regex::syntax_tree`. */
+  using syntax_index = uint32_t;
+
+  /**
+   * Struct representing a single node in a `regex::syntax_tree`.
+   *
+   * For terminal nodes, `value` holds the node's data: the character, for a literal, or the index
+   * of the class's bitmap or the string in the tree's bitmap or string list. For internal nodes,
+   * `value` is the offset of the node's first child in the tree's child list, and the remaining
+   * children follow it contiguously. A quantifier node's single child is followed in the child list
+   * by its minimum and maximum counts.
+   */
+  struct syntax_tree_node
+  {
+    /** The type of this node. */
+    regex::syntax_node_type type;
+
+    /** The number of children of this node. */
+    uint32_t child_count;
+
+    /** Node data, depending on `type`. */
+    uint32_t value;
+  };
+
+  /**
+   * Class representing a syntax tree stored in a single contiguous arena.
+   *
+   * This is an alternative to the tree of individually allocated `regex::syntax_node` objects.
+   * Nodes are referred to by 32-bit indices rather than pointers, have no vtables, and are stored
+   * contiguously in the order they were created, so that a tree with many thousands of nodes is
+   * built with a handful of allocations and destroyed all at once. Children must be added before
+   * their parents, so the root is normally the last node added.
+   *
+   * Unlike their `regex::syntax_node` counterparts, concatenation and alternation nodes may have any
+   * number of children (at least two), so a long sequence or a long list of alternatives is a single
+   * wide node rather than a deep chain of binary nodes.
+   */
+  class syntax_tree
+  {
+
+    /* -- Types -- */
+
+  public:
+
+    /** Range of the indices of a node's children. */
+    struct child_range
+    {
+      const regex::syntax_index* first;
+      const regex::syntax_index* last;
+
+      const regex::syntax_index* begin() const { return first; }
+      const regex::syntax_index* end() const { return last; }
+      size_t size() const { return static_cast<size_t>(last - first); }
+      regex::syntax_index operator[](size_t index) const { return first[index]; }
+    };
+
+    /* -- Constants -- */
+
+  public:
+
+    /** Index indicating that no node is present. */
+    static const regex::syntax_index NO_NODE = 0xFFFFFFFF;
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /** Constructs a new, empty `regex::syntax_tree`. */
+    syntax_tree()
+      : m_root(NO_NODE)
+    { }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Adds a literal node and returns its index. */
+    regex::syntax_index add_literal(char character)
+    {
+      return add_terminal(regex::syntax_node_type::literal, static_cast<unsigned char>(character));
+    }
+
+    /** Adds a wildcard node and returns its index. */
+    regex::syntax_index add_wildcard()
+    {
+      return add_terminal(regex::syntax_node_type::wildcard, 0);
+    }
+
+    /** Adds a character class node matching the bytes set in `bitmap` and returns its index. */
+    regex::syntax_index add_class(const std::bitset<256>& bitmap)
+    {
+      m_bitmaps.push_back(bitmap);
+      return add_terminal(regex::syntax_node_type::character_class, static_cast<uint32_t>(m_bitmaps.size() - 1));
+    }
+
+    /** Adds a string node for the specified non-empty string and returns its index. */
+    regex::syntax_index add_string(const std::string& text)
+    {
+      assert(!text.empty());
+      m_strings.push_back(text);
+      return add_terminal(regex::syntax_node_type::string, static_cast<uint32_t>(m_strings.size() - 1));
+    }
+
+    /**
+     * Adds a quantifier node repeating `child` between `min_count` and `max_count` times, and returns
+     * its index.
+     */
+    regex::syntax_index add_quantifier(regex::syntax_index child, uint32_t min_count, uint32_t max_count)
+    {
+      auto index = add_internal(regex::syntax_node_type::quantifier, { child });
+      m_children.push_back(min_count);
+      m_children.push_back(max_count);
+      return index;
+    }
+
+    /** Adds a capture node recording the bounds of `child` as group `group`, and returns its index. */
+    regex::syntax_index add_capture(regex::syntax_index child, uint32_t group)
+    {
+      auto index = add_internal(regex::syntax_node_type::capture, { child });
+      m_children.push_back(group);
+      return index;
+    }
+
+    /** Adds an internal node with the specified children and returns its index. */
+    regex::syntax_index add_internal(regex::syntax_node_type type, std::initializer_list<regex::syntax_index> children)
+    {
+      return add_internal(type, children.begin(), children.size());
+    }
+
+    /** Adds an internal node with the specified children and returns its index. */
+    regex::syntax_index add_internal(regex::syntax_node_type type, const regex::syntax_index* children, size_t count);
+
+    /** Returns the node with the specified index. */
+    const regex::syntax_tree_node& node(regex::syntax_index index) const
+    {
+      assert(index < m_nodes.size());
+      return m_nodes[index];
+    }
+
+    /** Returns the type of the node with the specified index. */
+    regex::syntax_node_type type(regex::syntax_index index) const
+    {
+      return node(index).type;
+    }
+
+    /** Returns the character of the literal node with the specified index. */
+    char character(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::literal);
+      return static_cast<char>(node(index).value);
+    }
+
+    /** Returns the set of bytes matched by the character class node with the specified index. */
+    const std::bitset<256>& bitmap(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::character_class);
+      return m_bitmaps[node(index).value];
+    }
+
+    /** Returns the string of the string node with the specified index. */
+    const std::string& text(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::string);
+      return m_strings[node(index).value];
+    }
+
+    /** Returns the minimum number of repetitions of the quantifier node with the specified index. */
+    uint32_t min_count(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::quantifier);
+      return m_children[node(index).value + 1];
+    }
+
+    /**
+     * Returns the maximum number of repetitions of the quantifier node with the specified index, or
+     * `regex::syntax_quantifier_node::UNBOUNDED`.
+     */
+    uint32_t max_count(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::quantifier);
+      return m_children[node(index).value + 2];
+    }
+
+    /** Returns the group number of the capture node with the specified index. */
+    uint32_t group(regex::syntax_index index) const
+    {
+      assert(type(index) == regex::syntax_node_type::capture);
+      return m_children[node(index).value + 1];
+    }
+
+    /** Returns the children of the node with the specified index. */
+    child_range children(regex::syntax_index index) const
+    {
+      const auto& n = node(index);
+      if (n.child_count == 0)
+        return child_range { nullptr, nullptr };
+      auto first = m_children.data() + n.value;
+      return child_range { first, first + n.child_count };
+    }
+
+    /** Returns the index of the root node, or `NO_NODE` if the tree is empty. */
+    regex::syntax_index root() const
+    {
+      return m_root;
+    }
+
+    /** Sets the index of the root node. */
+    void set_root(regex::syntax_index index)
+    {
+      assert(index < m_nodes.size());
+      m_root = index;
+    }
+
+    /** Returns the number of nodes in the tree. */
+    size_t size() const
+    {
+      return m_nodes.size();
+    }
+
+    /** Returns `true` if the tree has no nodes. */
+    bool empty() const
+    {
+      return m_nodes.empty();
+    }
+
+    /** Reserves space for the specified number of nodes. */
+    void reserve(size_t node_count)
+    {
+      m_nodes.reserve(node_count);
+      m_children.reserve(node_count);
+    }
+
+    /** Removes all nodes, keeping the allocated storage for reuse. */
+    void clear()
+    {
+      m_nodes.clear();
+      m_children.clear();
+      m_strings.clear();
+      m_bitmaps.clear();
+      m_root = NO_NODE;
+    }
+
+    /** Returns the number of bytes allocated by the tree. */
+    size_t memory_usage() const
+    {
+      size_t usage = (m_nodes.capacity() * sizeof(regex::syntax_tree_node) +
+                      m_children.capacity() * sizeof(regex::syntax_index) +
+                      m_strings.capacity() * sizeof(std::string) +
+                      m_bitmaps.capacity() * sizeof(std::bitset<256>));
+      for (const auto& text : m_strings)
+        usage += text.capacity();
+      return usage;
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    std::vector<regex::syntax_tree_node> m_nodes;
+    std::vector<regex::syntax_index> m_children;
+    std::vector<std::string> m_strings;
+    std::vector<std::bitset<256>> m_bitmaps;
+    regex::syntax_index m_root;
+
+    /** Adds a terminal node and returns its index. */
+    regex::syntax_index add_terminal(regex::syntax_node_type type, uint32_t value);
+
+  };
+
+}
+
+/* -- Procedure Prototypes -- */
+
+namespace regex
+{
+
+  /**
+   * Builds an arena syntax tree equivalent to the tree rooted at the specified node.
+   */
+  regex::syntax_tree make_syntax_tree(const std::unique_ptr<const regex::syntax_node>& root);
+
+  /**
+   * Builds a tree of `regex::syntax_node` objects equivalent to the specified arena syntax tree.
+   */
+  std::unique_ptr<const regex::syntax_node> make_syntax_node(const regex::syntax_tree& tree);
+
+  /**
+   * Returns a copy of the specified tree in which every wildcard and character class matches only
+   * the bytes in `allowed`. Literals and strings are unchanged.
+   */
+  regex::syntax_tree restrict_classes(const regex::syntax_tree& tree, const std::bitset<256>& allowed);
+
+  /**
+   * Prints the specified arena syntax tree.
+   */
+  void print_syntax_tree(const regex::syntax_tree& tree);
+
+}
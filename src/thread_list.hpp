@@ -0,0 +1,178 @@
+/**
+ * @file	thread_list.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/06
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "match.hpp"
+#include "program.hpp"
+#include "sparse_set.hpp"
+
+/* -- Types -- */
+
+namespace regex
+{
+
+  /**
+   * Set of NFA threads, each identified by its instruction address, with their capture slots.
+   *
+   * Threads are iterated in the order they were added, which is their priority order when they are
+   * added by a `regex::thread_builder`.
+   */
+  struct thread_list
+  {
+
+    /* -- Lifecycle -- */
+
+    /** Constructs a new, empty `regex::thread_list` for a program of the specified size. */
+    thread_list(size_t instruction_count, size_t slot_count)
+      : set(instruction_count),
+        slots(instruction_count * slot_count)
+    { }
+
+    /* -- Fields -- */
+
+    /** The instruction addresses of the threads, including visited epsilon instructions. */
+    sparse_set set;
+
+    /** The capture slots of each thread, indexed by instruction address. */
+    std::vector<size_t> slots;
+
+  };
+
+  /**
+   * Class which adds threads to a `regex::thread_list` by following the epsilon transitions of a
+   * program, recording the current position in the capture slots which the threads pass through.
+   *
+   * The closure is computed with an explicit stack rather than by recursion, so that it handles
+   * programs of any size. Every frame pushed corresponds to a new insertion into a thread list, so
+   * the stack is allocated once, up front, and no method allocates memory.
+   */
+  class thread_builder
+  {
+
+    /* -- Lifecycle -- */
+
+  public:
+
+    /**
+     * Constructs a new `regex::thread_builder` for the specified program, which must outlive it.
+     * Only the first `slot_count` capture slots are tracked.
+     */
+    thread_builder(const regex::program& prog, size_t slot_count)
+      : m_prog(prog),
+        m_slot_count(slot_count),
+        m_scratch(slot_count)
+    {
+      m_stack.reserve(prog.instructions.size() + 1);
+    }
+
+    /* -- Public Methods -- */
+
+  public:
+
+    /** Returns the number of capture slots tracked for each thread. */
+    size_t slot_count() const
+    {
+      return m_slot_count;
+    }
+
+    /** Adds a new thread at `pc`, with every capture slot unset, to `list`. */
+    void start_thread(regex::thread_list& list, uint32_t pc, size_t pos)
+    {
+      std::fill(m_scratch.begin(), m_scratch.end(), regex::match::NO_POSITION);
+      add_thread(list, pc, pos, m_scratch.data());
+    }
+
+    /** Advances a thread with the specified slots past a consuming instruction into `list`. */
+    void step_thread(regex::thread_list& list, uint32_t pc, size_t pos, const size_t* thread_slots)
+    {
+      std::copy(thread_slots, thread_slots + m_slot_count, m_scratch.begin());
+      add_thread(list, pc, pos, m_scratch.data());
+    }
+
+    /* -- Implementation -- */
+
+  private:
+
+    /** A thread to explore, or a capture slot to restore once the threads after it are explored. */
+    struct frame
+    {
+      bool restore;
+      uint32_t pc;
+      size_t slot;
+      size_t value;
+    };
+
+    const regex::program& m_prog;
+    const size_t m_slot_count;
+    std::vector<size_t> m_scratch;
+    std::vector<frame> m_stack;
+
+    /**
+     * Adds the thread at `pc`, along with every thread reachable from it through epsilon transitions,
+     * to `list` in priority order. `slots` is used as scratch space and is restored before returning.
+     */
+    void add_thread(regex::thread_list& list, uint32_t pc, size_t pos, size_t* slots)
+    {
+      m_stack.push_back(frame { false, pc, 0, 0 });
+      while (!m_stack.empty())
+      {
+        auto current = m_stack.back();
+        m_stack.pop_back();
+
+        if (current.restore)
+        {
+          slots[current.slot] = current.value;
+          continue;
+        }
+
+        bool done = false;
+        pc = current.pc;
+        while (!done && !list.set.contains(pc))
+        {
+          list.set.insert(pc);
+          const auto& inst = m_prog.instructions[pc];
+          switch (inst.op)
+          {
+          case regex::opcode::split:
+            m_stack.push_back(frame { false, inst.alternate, 0, 0 });
+            pc = inst.next;
+            break;
+
+          case regex::opcode::jump:
+            pc = inst.next;
+            break;
+
+          case regex::opcode::save:
+            if (inst.argument < m_slot_count)
+            {
+              m_stack.push_back(frame { true, 0, inst.argument, slots[inst.argument] });
+              slots[inst.argument] = pos;
+            }
+            pc = inst.next;
+            break;
+
+          case regex::opcode::byte:
+          case regex::opcode::byte_set:
+          case regex::opcode::any:
+          case regex::opcode::match:
+            std::copy(slots, slots + m_slot_count, list.slots.begin() + pc * m_slot_count);
+            done = true;
+            break;
+          }
+        }
+      }
+    }
+
+  };
+
+}
@@ -8,6 +8,7 @@
 
 /* -- Includes -- */
 
+#include <cstdint>
 #include <string>
 
 /* -- Types -- */
@@ -18,7 +19,7 @@ namespace regex
   /**
    * Enumeration of recognized token types.
    */
-  enum class token_type
+  enum class token_type : uint8_t
   {
     eof,
     literal,
@@ -26,6 +27,9 @@ namespace regex
     quantifier,
     open_bracket,
     close_bracket,
+    open_class_bracket,
+    class_range,
+    close_class_bracket,
     alternation_operator,
     optional_operator,
     kleene_operator,
@@ -33,184 +37,144 @@ namespace regex
   };
 
   /**
-   * Abstract base class for tokens.
+   * Class representing a token.
+   *
+   * Tokens are small, trivially copyable values, so that a token stream can be produced into a
+   * reusable buffer without allocating. The payload accessors are only meaningful for the token
+   * types noted in their descriptions.
    */
   class token
   {
 
-    /* -- Public Methods -- */
+    /* -- Constants -- */
 
   public:
 
-    /** Returns the type of this token. */
-    virtual regex::token_type type() const = 0;
-
-    /** The position of this token in the input string. */
-    virtual size_t position() const = 0;
-
-  };
-
-  /**
-   * Template for classes representing a simple token.
-   */
-  template <token_type TokenType>
-  class simple_token : public token
-  {
+    /** Value of `max_count()` for a quantifier token with no maximum. */
+    static const size_t UNBOUNDED = 0xFFFFFFFF;
 
     /* -- Lifecycle -- */
 
   public:
 
-    /** Constructs a new `regex::simple_token` with the specified position. */
-    simple_token(size_t position)
-      : m_position(position)
-    { }
-
-    /* -- Public Methods -- */
+    /** Constructs a new EOF token at position 0. */
+    token() = default;
 
-  public:
+    /** Constructs a new token of the specified type, which has no payload. */
+    token(regex::token_type type, size_t position)
+      : m_type(type),
+        m_position(static_cast<uint32_t>(position))
+    { }
 
-    /** Returns the type of this token. */
-    virtual regex::token_type type() const override
+    /** Constructs a new literal token for the specified character. */
+    static token literal(char character, size_t position)
     {
-      return TokenType;
+      token tok(regex::token_type::literal, position);
+      tok.m_character = character;
+      return tok;
     }
 
-    /** Returns the position of this token in the input string. */
-    virtual size_t position() const override
+    /** Constructs a new token opening a group, which records its bounds if `capturing` is set. */
+    static token open_bracket(bool capturing, size_t position)
     {
-      return m_position;
+      token tok(regex::token_type::open_bracket, position);
+      tok.m_min_count = (capturing ? 0 : 1);
+      return tok;
     }
 
-    /* -- Implementation -- */
-
-  private:
-
-    size_t m_position;
-
-  };
-
-  /** Token class representing an EOF token. */
-  using eof_token = simple_token<regex::token_type::eof>;
-
-  /** Token class representing a wildcard token. */
-  using wildcard_token = simple_token<regex::token_type::wildcard>;
-
-  /** Token class representing an open bracket. */
-  using open_bracket_token = simple_token<regex::token_type::open_bracket>;
-
-  /** Token class representing a close bracket. */
-  using close_bracket_token = simple_token<regex::token_type::close_bracket>;
-
-  /** Token class representing an alternation operator. */
-  using alternation_operator_token = simple_token<regex::token_type::alternation_operator>;
-
-  /** Token class representing an optional closure operator. */
-  using optional_operator_token = simple_token<regex::token_type::optional_operator>;
-
-  /** Token class representing a Kleene closure operator. */
-  using kleene_operator_token = simple_token<regex::token_type::kleene_operator>;
-
-  /** Token class representing a repeat closure operator. */
-  using repeat_operator_token = simple_token<regex::token_type::repeat_operator>;
-
-  /**
-   * Token class representing a literal character.
-   */
-  class literal_token : public regex::token
-  {
-
-    /* -- Lifecycle -- */
+    /** Constructs a new quantifier token matching between `min_count` and `max_count` repetitions, inclusive. */
+    static token quantifier(size_t min_count, size_t max_count, size_t position)
+    {
+      token tok(regex::token_type::quantifier, position);
+      tok.m_min_count = static_cast<uint32_t>(min_count);
+      tok.m_max_count = static_cast<uint32_t>(max_count);
+      return tok;
+    }
 
-  public:
+    /** Constructs a new token opening a character class, which matches its complement if `negated` is set. */
+    static token open_class_bracket(bool negated, size_t position)
+    {
+      token tok(regex::token_type::open_class_bracket, position);
+      tok.m_min_count = (negated ? 1 : 0);
+      return tok;
+    }
 
-    /** Constructs a new `regex::literal_token` instance. */
-    literal_token(char character, size_t position)
-      : m_character(character),
-        m_position(position)
-    { }
+    /** Constructs a new token adding the characters from `first` to `last`, inclusive, to a character class. */
+    static token class_range(unsigned char first, unsigned char last, size_t position)
+    {
+      token tok(regex::token_type::class_range, position);
+      tok.m_min_count = first;
+      tok.m_max_count = last;
+      return tok;
+    }
 
     /* -- Public Methods -- */
 
   public:
 
     /** Returns the type of this token. */
-    regex::token_type type() const override
+    regex::token_type type() const
     {
-      return regex::token_type::literal;
+      return m_type;
     }
 
-    /** Returns the literal character this token represents. */
+    /** Returns the position of this token in the input string. */
+    size_t position() const
+    {
+      return m_position;
+    }
+
+    /** Returns the character of a `literal` token. */
     char character() const
     {
       return m_character;
     }
 
-    /** Returns the position of this token. */
-    size_t position() const override
+    /** Returns the minimum number of repetitions of a `quantifier` token. */
+    size_t min_count() const
     {
-      return m_position;
+      return m_min_count;
     }
 
-    /* -- Implementation -- */
-
-  private:
-
-    char m_character;
-    size_t m_position;
-
-  };
-
-  /**
-   * Token class representing a quantifier.
-   */
-  class quantifier_token : public regex::token
-  {
-
-    /* -- Lifecycle -- */
-
-  public:
-
-    /** Constructs a new instance matching the specified quantity only. */
-    quantifier_token(size_t count)
-      : m_min_count(count),
-        m_max_count(count)
-    { }
-
-    /** Constructs a new instance matching quantities between `min_count` and `max_count`, inclusive. */
-    quantifier_token(size_t min_count, size_t max_count)
-      : m_min_count(min_count),
-        m_max_count(max_count)
-    { }
-
-    /* -- Public Methods -- */
+    /** Returns the maximum number of repetitions of a `quantifier` token, or `UNBOUNDED`. */
+    size_t max_count() const
+    {
+      return m_max_count;
+    }
 
-  public:
+    /** Returns `true` if an `open_class_bracket` token begins a negated class. */
+    bool negated() const
+    {
+      return (m_min_count != 0);
+    }
 
-    /** Returns the type of this token. */
-    regex::token_type type() const
+    /** Returns `true` if an `open_bracket` token begins a capturing group. */
+    bool capturing() const
     {
-      return regex::token_type::quantifier;
+      return (m_min_count == 0);
     }
 
-    /** The minimum number of repetitions for this token. */
-    size_t min_count() const
+    /** Returns the first character of a `class_range` token. */
+    unsigned char range_first() const
     {
-      return m_min_count;
+      return static_cast<unsigned char>(m_min_count);
     }
 
-    /** The maximum number of repetitions for this token. */
-    size_t max_count() const
+    /** Returns the last character of a `class_range` token. */
+    unsigned char range_last() const
     {
-      return m_max_count;
+      return static_cast<unsigned char>(m_max_count);
     }
 
     /* -- Implementation -- */
 
   private:
 
-    size_t m_min_count;
-    size_t m_max_count;
+    regex::token_type m_type = regex::token_type::eof;
+    char m_character = 0;
+    uint32_t m_position = 0;
+    uint32_t m_min_count = 0;
+    uint32_t m_max_count = 0;
 
   };
 
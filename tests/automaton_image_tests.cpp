@@ -0,0 +1,185 @@
+/**
+ * @file	automaton_image_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/03/04
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "automaton_image.hpp"
+#include "compiler.hpp"
+#include "dfa_test_helpers.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "regex_set.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+using namespace regex::test;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::automaton_image` class and its writer.
+ */
+class AutomatonImageTests : public Test
+{
+protected:
+
+  /** Copies the serialized image into suitably aligned storage. */
+  vector<uint64_t> aligned_copy(const string& data)
+  {
+    vector<uint64_t> storage((data.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    copy(data.begin(), data.end(), reinterpret_cast<char*>(storage.data()));
+    return storage;
+  }
+
+};
+
+/** Verify that patterns loaded from an image match exactly as compiled patterns do. */
+TEST_F(AutomatonImageTests, PatternsAgreeWithCompiledPatterns)
+{
+  const vector<string> expressions {
+    "abc",
+    "a(b|c)*d",
+    "x*",
+    "(ab|a)(bc|c)?",
+    "hello|help",
+    "[a-c]+d{2,3}",
+    "q.*z",
+  };
+
+  image_writer writer;
+  for (const auto& expression : expressions)
+    writer.add_pattern(expression);
+  EXPECT_EQ(writer.size(), expressions.size());
+
+  auto storage = aligned_copy(writer.data());
+  automaton_image image(storage.data(), writer.data().size());
+  ASSERT_EQ(image.size(), expressions.size());
+  image.verify();
+
+  mt19937 rng(RANDOM_SEED);
+  for (size_t idx = 0; idx < expressions.size(); idx++)
+  {
+    ASSERT_EQ(image.kind(idx), image_entry_kind::pattern);
+    auto loaded = image.pattern(idx);
+    EXPECT_EQ(loaded.expression(), expressions[idx]);
+
+    pattern expected(expressions[idx]);
+    expect_same_match(expected, loaded, expressions[idx], "");
+    expect_same_matches(expected, loaded, expressions[idx], rng, { "abcdehlpqxz" }, 200, 1, 41);
+  }
+}
+
+/** Verify that sets loaded from an image report the same matches as a `regex::regex_set`. */
+TEST_F(AutomatonImageTests, SetsAgreeWithRegexSet)
+{
+  const vector<string> expressions { "foo", "ba(r|z)", "o+", "xyz", "f.*z" };
+
+  image_writer writer;
+  writer.add_pattern("unused");
+  writer.add_set(expressions);
+
+  auto data = writer.data();
+  auto storage = aligned_copy(data);
+  automaton_image image(storage.data(), data.size());
+  ASSERT_EQ(image.kind(1), image_entry_kind::set);
+  EXPECT_THROW(image.set(0), image_error);
+  EXPECT_THROW(image.pattern(1), image_error);
+
+  auto loaded = image.set(1);
+  ASSERT_EQ(loaded.size(), expressions.size());
+  EXPECT_EQ(loaded.expression(1), "ba(r|z)");
+
+  regex_set expected(expressions);
+  mt19937 rng(RANDOM_SEED);
+  for (int iteration = 0; iteration < 500; iteration++)
+  {
+    auto input = random_input(rng, "abfoorxyz", iteration % 30);
+    vector<size_t> expected_indices;
+    vector<size_t> actual_indices;
+    bool found = expected.matches(input, expected_indices);
+    EXPECT_EQ(loaded.matches(input, actual_indices), found) << input;
+    EXPECT_EQ(actual_indices, expected_indices) << input;
+    EXPECT_EQ(loaded.is_match(input), found) << input;
+  }
+}
+
+/** Verify that an image written to a file can be mapped and searched. */
+TEST_F(AutomatonImageTests, MapsImageFile)
+{
+  char path[] = "/tmp/regex_image_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+
+  image_writer writer;
+  writer.add_pattern("wor(ld|d)");
+  writer.add_set({ "a+", "b+" });
+  writer.write(path);
+
+  {
+    mapped_image mapped(path);
+    const auto& image = mapped.image();
+    ASSERT_EQ(image.size(), 2u);
+
+    match result { 0, 0 };
+    ASSERT_TRUE(image.pattern(0).find("hello world", result));
+    EXPECT_EQ(result.begin, 6u);
+    EXPECT_EQ(result.end, 11u);
+
+    vector<size_t> indices;
+    EXPECT_TRUE(image.set(1).matches("xxbxx", indices));
+    EXPECT_EQ(indices, vector<size_t>({ 1 }));
+  }
+
+  remove(path);
+  EXPECT_THROW(mapped_image mapped(path), image_error);
+}
+
+/** Verify that malformed images are rejected. */
+TEST_F(AutomatonImageTests, RejectsMalformedImages)
+{
+  image_writer writer;
+  writer.add_pattern("abc");
+  auto data = writer.data();
+
+  // truncated
+  auto storage = aligned_copy(data);
+  EXPECT_THROW(automaton_image(storage.data(), data.size() - 8), image_error);
+  EXPECT_THROW(automaton_image(storage.data(), 4), image_error);
+
+  // bad magic number
+  auto corrupt = data;
+  corrupt[0] = 'X';
+  storage = aligned_copy(corrupt);
+  EXPECT_THROW(automaton_image(storage.data(), corrupt.size()), image_error);
+
+  // misaligned
+  vector<uint64_t> shifted(data.size() / sizeof(uint64_t) + 2);
+  auto base = reinterpret_cast<char*>(shifted.data()) + 1;
+  copy(data.begin(), data.end(), base);
+  EXPECT_THROW(automaton_image(base, data.size()), image_error);
+
+  // a transition past the end of the table is only found by verification
+  storage = aligned_copy(data);
+  automaton_image image(storage.data(), data.size());
+  auto words = reinterpret_cast<uint32_t*>(storage.data());
+  words[storage.size() * 2 - 1] = UINT32_MAX;
+  words[storage.size() * 2 - 2] = UINT32_MAX;
+  EXPECT_THROW(image.verify(), image_error);
+}
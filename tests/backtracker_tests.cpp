@@ -0,0 +1,162 @@
+/**
+ * @file	backtracker_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "backtracker.hpp"
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "prefilter.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::backtracker` class.
+ */
+class BacktrackerTests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern. */
+  shared_ptr<const program> compile_pattern(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return compile(parse.parse_regex());
+  }
+
+};
+
+/** Verify that the backtracker agrees with the Pike VM. */
+TEST_F(BacktrackerTests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab*", "ab+c?", "(ab)*c", "a*", "abcd|c", "b+|a", "(a|b)*abb",
+    "x(a*)*b", "(cat|dog)s?", "(a|b)*a(a|b)(a|b)", "ab{2,3}", "(ab){1,}c", "b{0,2}a?b", "[ab]+c",
+    "[^a]b", "\\w+",
+  };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "ab", "abbbc", "ababc", "bbb", "abcd", "xabbb", "aababb", "xaab", "hotdogs",
+    "bbbabaa",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto prog = compile_pattern(pattern);
+    backtracker engine(prog, 1 << 20);
+    pike_vm vm(prog);
+
+    for (const auto& input : INPUTS)
+    {
+      match expected { 0, 0 };
+      match actual { 0, 0 };
+      bool expected_found = vm.find(input, expected);
+
+      ASSERT_TRUE(engine.can_search(input.size()));
+      ASSERT_EQ(engine.find(input, actual), expected_found) << pattern << " / " << input;
+      EXPECT_EQ(engine.is_match(input), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+    }
+  }
+}
+
+/** Verify that pathological expressions are searched in polynomial time. */
+TEST_F(BacktrackerTests, NeverGoesExponential)
+{
+  auto prog = compile_pattern("(a*)*(a|b)*(a*)*c");
+  backtracker engine(prog, 1 << 20);
+
+  // without memoization, each additional byte would double the search time
+  string input(200, 'a');
+  ASSERT_TRUE(engine.can_search(input.size()));
+  EXPECT_FALSE(engine.is_match(input));
+
+  match result { 0, 0 };
+  input += "c";
+  ASSERT_TRUE(engine.find(input, result));
+  EXPECT_EQ(result.begin, 0u);
+  EXPECT_EQ(result.end, input.size());
+}
+
+/** Verify that inputs are only accepted while the visited bitmap fits the budget. */
+TEST_F(BacktrackerTests, EnforcesBudget)
+{
+  auto prog = compile_pattern("abc");
+  auto count = prog->instructions.size();
+  backtracker engine(prog, count * 100);
+
+  EXPECT_TRUE(engine.can_search(0));
+  EXPECT_TRUE(engine.can_search(99));
+  EXPECT_FALSE(engine.can_search(100));
+  EXPECT_FALSE(backtracker::can_search(count, 10, 0));
+  EXPECT_FALSE(backtracker::can_search(count, SIZE_MAX, SIZE_MAX));
+
+  // the pattern only backtracks inputs within the budget, and searches longer ones with another engine
+  static const string LONG_INPUT = string(1000, 'x') + "abc";
+  pattern_options options;
+  options.backtrack_limit = count * 100;
+  pattern pat("abc", options);
+  match result { 0, 0 };
+  ASSERT_TRUE(pat.find("xxabc", result));
+  EXPECT_EQ(result.begin, 2u);
+  ASSERT_TRUE(pat.find(LONG_INPUT, result));
+  EXPECT_EQ(result.begin, 1000u);
+  EXPECT_EQ(result.end, 1003u);
+}
+
+/** Verify that searches starting only at the prefilter's candidates find the same matches. */
+TEST_F(BacktrackerTests, AgreesWithPikeVMUsingPrefilter)
+{
+  static const vector<string> PATTERNS = { "abc", "ab|cd", "x(a|b)*y", "hello\\w*", "(foo|bar)baz" };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "zzcd", "xabbay", "xay xy", "hello world", "foobarbaz barbaz", "ab",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    auto root = parse.parse_regex();
+    auto pre = make_prefilter(root);
+    ASSERT_NE(pre, nullptr) << pattern;
+
+    auto prog = compile(root);
+    backtracker engine(prog, 1 << 20, pre);
+    pike_vm vm(prog);
+    for (const auto& input : INPUTS)
+    {
+      match expected { 0, 0 };
+      match actual { 0, 0 };
+      bool expected_found = vm.find(input, expected);
+
+      ASSERT_EQ(engine.find(input, actual), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+    }
+  }
+}
@@ -0,0 +1,103 @@
+/**
+ * @file	dfa_test_helpers.hpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+#pragma once
+
+/* -- Includes -- */
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "full_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Constants -- */
+
+namespace regex
+{
+  namespace test
+  {
+
+    /** The seed for the random inputs of the engine comparison tests. */
+    const uint32_t RANDOM_SEED = 20170228;
+
+  }
+}
+
+/* -- Procedures -- */
+
+namespace regex
+{
+  namespace test
+  {
+
+    /** Compiles the specified pattern into a full DFA. */
+    inline std::shared_ptr<const regex::full_dfa> compile_dfa(const std::string& pattern, size_t state_limit = 10000)
+    {
+      regex::lexical_analyzer lex(pattern);
+      regex::syntax_analyzer parse(lex.all_tokens());
+      auto root = parse.parse_regex();
+
+      regex::compile_options reverse_options;
+      reverse_options.reverse = true;
+      return std::make_shared<regex::full_dfa>(regex::compile(root), regex::compile(root, reverse_options), state_limit);
+    }
+
+    /** Returns a random string of `length` bytes drawn from `alphabet`. */
+    inline std::string random_input(std::mt19937& rng, const std::string& alphabet, size_t length)
+    {
+      std::uniform_int_distribution<size_t> dist(0, alphabet.size() - 1);
+      std::string input(length, ' ');
+      for (auto& ch : input)
+        ch = alphabet[dist(rng)];
+      return input;
+    }
+
+    /**
+     * Expect the engine `actual` to find exactly the match that `expected` finds in `input`, and to
+     * agree on whether there is one. `label` identifies the expression in failure messages.
+     */
+    template <typename TExpected, typename TActual>
+    void expect_same_match(const TExpected& expected, const TActual& actual, const std::string& label, const std::string& input)
+    {
+      regex::match expected_match { 0, 0 };
+      regex::match actual_match { 0, 0 };
+      bool expected_found = expected.find(input, expected_match);
+
+      ASSERT_EQ(actual.find(input, actual_match), expected_found) << label << " / " << input;
+      EXPECT_EQ(actual.is_match(input), expected_found) << label << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual_match.begin, expected_match.begin) << label << " / " << input;
+        EXPECT_EQ(actual_match.end, expected_match.end) << label << " / " << input;
+      }
+    }
+
+    /**
+     * Runs `expect_same_match()` for `count` random inputs, drawn from each of `alphabets` in turn,
+     * growing evenly in length from `min_length` to just below `max_length`.
+     */
+    template <typename TExpected, typename TActual>
+    void expect_same_matches(const TExpected& expected, const TActual& actual, const std::string& label,
+                             std::mt19937& rng, const std::vector<std::string>& alphabets,
+                             size_t count, size_t min_length, size_t max_length)
+    {
+      for (size_t idx = 0; idx < count && !::testing::Test::HasFatalFailure(); idx++)
+      {
+        auto length = min_length + idx * (max_length - min_length) / count;
+        expect_same_match(expected, actual, label, random_input(rng, alphabets[idx % alphabets.size()], length));
+      }
+    }
+
+  }
+}
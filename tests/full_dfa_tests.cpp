@@ -0,0 +1,152 @@
+/**
+ * @file	full_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/18
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "full_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::full_dfa` class.
+ */
+class FullDFATests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern into a full DFA with the specified state limit. */
+  unique_ptr<full_dfa> compile_dfa(const string& pattern, size_t state_limit = 10000)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    auto root = parse.parse_regex();
+
+    compile_options reverse_options;
+    reverse_options.reverse = true;
+    return make_unique<full_dfa>(compile(root), compile(root, reverse_options), state_limit);
+  }
+
+  /** Compiles the specified pattern into a Pike VM. */
+  unique_ptr<pike_vm> compile_vm(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return make_unique<pike_vm>(compile(parse.parse_regex()));
+  }
+
+  /** Expect the full DFA to agree with the Pike VM for `pattern` on `input`. */
+  void expect_same_as_vm(const full_dfa& dfa, pike_vm& vm, const string& pattern, const string& input)
+  {
+    match expected { 0, 0 };
+    match actual { 0, 0 };
+    bool expected_found = vm.find(input, expected);
+    bool actual_found = dfa.find(input, actual);
+
+    ASSERT_EQ(actual_found, expected_found) << pattern << " / " << input;
+    EXPECT_EQ(dfa.is_match(input), expected_found) << pattern << " / " << input;
+    if (expected_found)
+    {
+      EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+      EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+    }
+  }
+
+};
+
+/** Verify that the full DFA agrees with the Pike VM. */
+TEST_F(FullDFATests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab*", "ab+c?", "(ab)*c", "a*", "abcd|c", "b+|a", "(a|b)*abb",
+    "x(a*)*b", "(cat|dog)s?", "(a|b)*a(a|b)(a|b)", "ab{2,3}", "(ab){1,}c", "b{0,2}a?b",
+    "[ab]+c", "[^a]b", "\\w+",
+  };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "ab", "abbbc", "ababc", "bbb", "abcd", "xabbb", "aababb", "xaab", "hotdogs",
+    "bbbabaa",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto dfa = compile_dfa(pattern);
+    auto vm = compile_vm(pattern);
+    for (const auto& input : INPUTS)
+      expect_same_as_vm(*dfa, *vm, pattern, input);
+  }
+}
+
+/** Verify that equivalent states are merged by minimization. */
+TEST_F(FullDFATests, MinimizesStates)
+{
+  // the minimal reverse DFA for this language has one state per suffix of "abb", plus the dead state
+  auto dfa = compile_dfa("(a|b)*abb");
+  EXPECT_EQ(dfa->reverse_table().state_count(), 5u);
+
+  // redundant alternatives produce the same DFA as a single literal
+  auto redundant = compile_dfa("abc|abc|abc");
+  auto simple = compile_dfa("abc");
+  EXPECT_EQ(redundant->forward_table().state_count(), simple->forward_table().state_count());
+}
+
+/** Verify that construction fails cleanly when the state limit is exceeded. */
+TEST_F(FullDFATests, EnforcesStateLimit)
+{
+  static const string PATTERN = "(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)";
+  EXPECT_THROW(compile_dfa(PATTERN, 100), compile_error);
+
+  pattern_options options;
+  options.engine = engine_type::full_dfa;
+  options.dfa_state_limit = 100;
+  EXPECT_THROW(pattern(PATTERN, options), compile_error);
+}
+
+/** Verify that transitions are stored per byte equivalence class. */
+TEST_F(FullDFATests, UsesByteClasses)
+{
+  static const string PATTERN = "[a-c]x|[b-d]y|.z";
+  lexical_analyzer lex(PATTERN);
+  syntax_analyzer parse(lex.all_tokens());
+  auto prog = compile(parse.parse_regex());
+
+  // {a}, {b, c}, {d}, {x}, {y}, {z}, and everything else
+  const auto& classes = prog->byte_classes;
+  EXPECT_EQ(classes.count(), 7u);
+  EXPECT_EQ(classes['b'], classes['c']);
+  EXPECT_NE(classes['a'], classes['b']);
+  EXPECT_NE(classes['c'], classes['d']);
+  EXPECT_EQ(classes['e'], classes[0]);
+  EXPECT_EQ(classes[0xFF], classes[0]);
+  EXPECT_EQ(classes[0], 0u);
+
+  auto representatives = classes.representatives();
+  ASSERT_EQ(representatives.size(), classes.count());
+  for (size_t cls = 0; cls < representatives.size(); cls++)
+    EXPECT_EQ(classes[representatives[cls]], cls);
+
+  auto dfa = compile_dfa(PATTERN);
+  EXPECT_EQ(dfa->forward_table().stride, 7u);
+  EXPECT_EQ(dfa->forward_table().transitions.size(), dfa->forward_table().state_count() * 7u);
+
+  // a literal distinguishes only itself from everything else
+  EXPECT_EQ(compile_dfa("a+")->forward_table().stride, 2u);
+}
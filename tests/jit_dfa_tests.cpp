@@ -0,0 +1,108 @@
+/**
+ * @file	jit_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dfa_test_helpers.hpp"
+#include "jit_dfa.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+using namespace regex::test;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::jit_dfa` class.
+ */
+class JITDFATests : public Test
+{
+};
+
+/** Verify that the compiler refuses to build code on platforms it does not support. */
+TEST_F(JITDFATests, RejectsUnsupportedPlatforms)
+{
+  if (jit_dfa::is_supported())
+    GTEST_SKIP() << "JIT compilation is supported on this platform.";
+
+  EXPECT_THROW(jit_dfa jitted(compile_dfa("abc")), compile_error);
+}
+
+/** Verify that the compiled code agrees with the interpreted DFA. */
+TEST_F(JITDFATests, AgreesWithFullDFA)
+{
+  if (!jit_dfa::is_supported())
+    GTEST_SKIP() << "JIT compilation is not supported on this platform.";
+
+  // the later patterns have states with enough distinct transitions to need jump tables
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab+c?", "(a|b)*abb", "cab{2,4}", "x*", "a?", "c.*c",
+    "[a-c]x|[0-9]y|z+", "(abc|bca|cab|xyz)+", "a[^b]c|b[^c]a|c[^a]b|1|3|5|7|9",
+    "\\w+@\\w+", "(a|b|c|x|y|z|0|1){2}9", "[02468acegikmoqsuwy]x+",
+  };
+
+  mt19937 rng(RANDOM_SEED);
+  for (const auto& pattern : PATTERNS)
+  {
+    auto dfa = compile_dfa(pattern);
+    jit_dfa jitted(dfa);
+    EXPECT_GT(jitted.code_size(), 0u);
+    expect_same_matches(*dfa, jitted, pattern, rng, { "abc", "abc xyz0123456789@" }, 200, 0, 100);
+  }
+}
+
+/** Verify that empty and null inputs are handled. */
+TEST_F(JITDFATests, EmptyInput)
+{
+  if (!jit_dfa::is_supported())
+    GTEST_SKIP() << "JIT compilation is not supported on this platform.";
+
+  jit_dfa optional(compile_dfa("a*"));
+  match result { 1, 1 };
+  ASSERT_TRUE(optional.find(nullptr, nullptr, result));
+  EXPECT_EQ(result.begin, 0u);
+  EXPECT_EQ(result.end, 0u);
+  EXPECT_TRUE(optional.is_match(nullptr, nullptr));
+
+  jit_dfa required(compile_dfa("a"));
+  EXPECT_FALSE(required.find(nullptr, nullptr, result));
+  EXPECT_FALSE(required.is_match(string()));
+}
+
+/** Verify that patterns use the JIT when asked to, with identical results. */
+TEST_F(JITDFATests, PatternUsesJIT)
+{
+  pattern_options options;
+  options.engine = engine_type::full_dfa;
+  options.use_jit = true;
+  pattern jitted("(GET|POST) /[a-z/]+", options);
+
+  options.use_jit = false;
+  pattern interpreted("(GET|POST) /[a-z/]+", options);
+
+  if (jit_dfa::is_supported())
+  {
+    EXPECT_GT(jitted.memory_usage(), interpreted.memory_usage());
+  }
+
+  static const string INPUT = "10.0.0.1 - - \"POST /api/v1/items HTTP/1.1\" 200";
+  match expected { 0, 0 };
+  match actual { 0, 0 };
+  ASSERT_TRUE(interpreted.find(INPUT, expected));
+  ASSERT_TRUE(jitted.find(INPUT, actual));
+  EXPECT_EQ(actual.begin, expected.begin);
+  EXPECT_EQ(actual.end, expected.end);
+}
@@ -0,0 +1,128 @@
+/**
+ * @file	lazy_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/11
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lazy_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::lazy_dfa` class.
+ */
+class LazyDFATests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern into a lazy DFA with the specified cache size. */
+  unique_ptr<lazy_dfa> compile_dfa(const string& pattern, size_t cache_size = (1 << 20))
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    auto root = parse.parse_regex();
+
+    compile_options reverse_options;
+    reverse_options.reverse = true;
+    return make_unique<lazy_dfa>(compile(root), compile(root, reverse_options), cache_size);
+  }
+
+  /** Compiles the specified pattern into a Pike VM. */
+  unique_ptr<pike_vm> compile_vm(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return make_unique<pike_vm>(compile(parse.parse_regex()));
+  }
+
+  /** Expect the lazy DFA to agree with the Pike VM for `pattern` on `input`. */
+  void expect_same_as_vm(const string& pattern, const string& input, size_t cache_size = (1 << 20))
+  {
+    auto dfa = compile_dfa(pattern, cache_size);
+    auto vm = compile_vm(pattern);
+
+    match expected { 0, 0 };
+    match actual { 0, 0 };
+    bool expected_found = vm->find(input, expected);
+    bool actual_found = dfa->find(input, actual);
+
+    ASSERT_EQ(actual_found, expected_found) << pattern << " / " << input;
+    EXPECT_EQ(dfa->is_match(input), expected_found) << pattern << " / " << input;
+    if (expected_found)
+    {
+      EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+      EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+    }
+  }
+
+};
+
+/** Verify that the lazy DFA agrees with the Pike VM. */
+TEST_F(LazyDFATests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab*", "ab+c?", "(ab)*c", "a*", "abcd|c", "b+|a", "(a|b)*abb",
+    "x(a*)*b", "(cat|dog)s?", "ab{2,3}", "(ab){1,}c", "b{0,2}a?b",
+    "[ab]+c", "[^a]b", "\\w+",
+  };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "ab", "abbbc", "ababc", "bbb", "abcd", "xabbb", "aababb", "xaab", "hotdogs",
+  };
+
+  for (const auto& pattern : PATTERNS)
+    for (const auto& input : INPUTS)
+      expect_same_as_vm(pattern, input);
+}
+
+/** Verify that matching remains correct when the cache is too small to hold every state. */
+TEST_F(LazyDFATests, SurvivesCacheOverflow)
+{
+  static const string PATTERN = "(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)";
+  string input;
+  for (int idx = 0; idx < 2000; idx++)
+    input += (((idx * 2654435761u) >> 13) & 1 ? 'a' : 'b');
+  input += "c";
+
+  auto dfa = compile_dfa(PATTERN, 4096);
+  match result { 0, 0 };
+  EXPECT_TRUE(dfa->find(input, result));
+  EXPECT_GT(dfa->cache_clear_count(), 0u);
+  EXPECT_LE(dfa->cache_memory_usage(), 4096u);
+
+  expect_same_as_vm(PATTERN, input, 4096);
+}
+
+/** Verify that the `regex::pattern` class exposes the cache size as an option. */
+TEST_F(LazyDFATests, PatternUsesCacheSizeOption)
+{
+  pattern_options options;
+  options.engine = engine_type::lazy_dfa;
+  options.dfa_cache_size = 4096;
+
+  pattern pat("(x|y)*z", options);
+  EXPECT_EQ(pat.options().dfa_cache_size, 4096u);
+
+  match result { 0, 0 };
+  ASSERT_TRUE(pat.find("xyxyz", result));
+  EXPECT_EQ(result.begin, 0u);
+  EXPECT_EQ(result.end, 5u);
+}
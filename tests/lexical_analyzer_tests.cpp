@@ -7,6 +7,7 @@
 /* -- Includes -- */
 
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <gtest/gtest.h>
 
@@ -35,8 +36,7 @@ protected:
 
     token tok = lex.next_token();
     EXPECT_EQ(tok.type(), type);
-    EXPECT_EQ(tok.begin(), input.cbegin());
-    EXPECT_EQ(tok.end(), input.cend());
+    EXPECT_EQ(tok.position(), 0u);
 
     expect_eof(lex);
   }
@@ -53,7 +53,8 @@ protected:
 /** Verify that the `regex::lexical_analyzer` class extracts EOF tokens. */
 TEST_F(LexicalAnalyzerTests, ExtractsEOFToken)
 {
-  lexical_analyzer lex("");
+  static const string INPUT = "";
+  lexical_analyzer lex(INPUT);
   expect_eof(lex);
 }
 
@@ -61,6 +62,17 @@ TEST_F(LexicalAnalyzerTests, ExtractsEOFToken)
 TEST_F(LexicalAnalyzerTests, ExtractsOpenBracketToken)
 {
   expect_single_token("(", token_type::open_bracket);
+  expect_single_token("(?:", token_type::open_bracket);
+
+  static const string INPUT = "((?:a)";
+  lexical_analyzer lex(INPUT);
+
+  token tok = lex.next_token();
+  EXPECT_TRUE(tok.capturing());
+  tok = lex.next_token();
+  EXPECT_FALSE(tok.capturing());
+  EXPECT_EQ(tok.position(), 1u);
+  EXPECT_EQ(lex.next_token().type(), token_type::literal);
 }
 
 /** Verify that the `regex::lexical_analyzer` class extracts close bracket tokens. */
@@ -69,10 +81,10 @@ TEST_F(LexicalAnalyzerTests, ExtractsCloseBracketToken)
   expect_single_token(")", token_type::close_bracket);
 }
 
-/** Verify that the `regex::lexical_analyzer` class extracts union operator tokens. */
-TEST_F(LexicalAnalyzerTests, ExtractsUnionOperatorToken)
+/** Verify that the `regex::lexical_analyzer` class extracts alternation operator tokens. */
+TEST_F(LexicalAnalyzerTests, ExtractsAlternationOperatorToken)
 {
-  expect_single_token("|", token_type::union_operator);
+  expect_single_token("|", token_type::alternation_operator);
 }
 
 /** Verify that the `regex::lexical_analyzer` class extracts optional operator tokens. */
@@ -93,6 +105,107 @@ TEST_F(LexicalAnalyzerTests, ExtractsRepeatOperatorToken)
   expect_single_token("+", token_type::repeat_operator);
 }
 
+/** Verify that the `regex::lexical_analyzer` class extracts literal and escaped literal tokens. */
+TEST_F(LexicalAnalyzerTests, ExtractsLiteralTokens)
+{
+  static const string INPUT = "a\\*";
+  lexical_analyzer lex(INPUT);
+
+  token tok = lex.next_token();
+  EXPECT_EQ(tok.type(), token_type::literal);
+  EXPECT_EQ(tok.character(), 'a');
+  EXPECT_EQ(tok.position(), 0u);
+
+  tok = lex.next_token();
+  EXPECT_EQ(tok.type(), token_type::literal);
+  EXPECT_EQ(tok.character(), '*');
+  EXPECT_EQ(tok.position(), 2u);
+
+  expect_eof(lex);
+}
+
+/** Verify that the `regex::lexical_analyzer` class extracts quantifier tokens. */
+TEST_F(LexicalAnalyzerTests, ExtractsQuantifierTokens)
+{
+  static const string INPUT = "{3}{2,}{0,1000}";
+  lexical_analyzer lex(INPUT);
+
+  token tok = lex.next_token();
+  EXPECT_EQ(tok.type(), token_type::quantifier);
+  EXPECT_EQ(tok.min_count(), 3u);
+  EXPECT_EQ(tok.max_count(), 3u);
+
+  tok = lex.next_token();
+  EXPECT_EQ(tok.type(), token_type::quantifier);
+  EXPECT_EQ(tok.position(), 3u);
+  EXPECT_EQ(tok.min_count(), 2u);
+  EXPECT_EQ(tok.max_count(), token::UNBOUNDED);
+
+  tok = lex.next_token();
+  EXPECT_EQ(tok.type(), token_type::quantifier);
+  EXPECT_EQ(tok.min_count(), 0u);
+  EXPECT_EQ(tok.max_count(), 1000u);
+
+  expect_eof(lex);
+}
+
+/** Verify that braces which do not form a quantifier are literals, and that bad counts are rejected. */
+TEST_F(LexicalAnalyzerTests, ExtractsBraceLiterals)
+{
+  static const vector<string> LITERALS = { "{", "{a}", "{,2}", "{1,2", "\\{" };
+  for (const auto& input : LITERALS)
+  {
+    lexical_analyzer lex(input);
+    token tok = lex.next_token();
+    EXPECT_EQ(tok.type(), token_type::literal) << input;
+    EXPECT_EQ(tok.character(), '{') << input;
+  }
+
+  static const vector<string> ERRORS = { "{1001}", "{3,2}" };
+  for (const auto& input : ERRORS)
+  {
+    lexical_analyzer lex(input);
+    EXPECT_THROW(lex.next_token(), lexical_error) << input;
+  }
+}
+
+/** Verify that the `regex::lexical_analyzer` class extracts character class tokens. */
+TEST_F(LexicalAnalyzerTests, ExtractsClassTokens)
+{
+  static const string INPUT = "[^a-c\\]-]\\d";
+  lexical_analyzer lex(INPUT);
+  vector<token> tokens = lex.all_tokens();
+
+  ASSERT_EQ(tokens.size(), 9u);
+  EXPECT_EQ(tokens[0].type(), token_type::open_class_bracket);
+  EXPECT_TRUE(tokens[0].negated());
+
+  EXPECT_EQ(tokens[1].type(), token_type::class_range);
+  EXPECT_EQ(tokens[1].range_first(), 'a');
+  EXPECT_EQ(tokens[1].range_last(), 'c');
+  EXPECT_EQ(tokens[1].position(), 2u);
+
+  EXPECT_EQ(tokens[2].range_first(), ']');
+  EXPECT_EQ(tokens[2].range_last(), ']');
+  EXPECT_EQ(tokens[3].range_first(), '-');
+  EXPECT_EQ(tokens[4].type(), token_type::close_class_bracket);
+  EXPECT_EQ(tokens[4].position(), 8u);
+
+  EXPECT_EQ(tokens[5].type(), token_type::open_class_bracket);
+  EXPECT_FALSE(tokens[5].negated());
+  EXPECT_EQ(tokens[6].range_first(), '0');
+  EXPECT_EQ(tokens[6].range_last(), '9');
+  EXPECT_EQ(tokens[7].type(), token_type::close_class_bracket);
+  EXPECT_EQ(tokens[8].type(), token_type::eof);
+
+  static const vector<string> ERRORS = { "[abc", "[z-a]", "[\\d-z]", "[\\q]", "\\q" };
+  for (const auto& input : ERRORS)
+  {
+    lexical_analyzer bad(input);
+    EXPECT_THROW(bad.all_tokens(), lexical_error) << input;
+  }
+}
+
 /** Verify that the `regex::lexical_analyzer` class extracts a vector of all tokens. */
 TEST_F(LexicalAnalyzerTests, ExtractsAllTokens)
 {
@@ -100,23 +213,47 @@ TEST_F(LexicalAnalyzerTests, ExtractsAllTokens)
   lexical_analyzer lex(INPUT);
   vector<token> tokens = lex.all_tokens();
 
-  ASSERT_EQ(tokens.size(), 5);
+  ASSERT_EQ(tokens.size(), 5u);
 
   EXPECT_EQ(tokens[0].type(), token_type::close_bracket);
-  EXPECT_EQ(tokens[0].begin(), INPUT.cbegin());
-  EXPECT_EQ(tokens[0].end(), INPUT.cbegin() + 1);
+  EXPECT_EQ(tokens[0].position(), 0u);
 
   EXPECT_EQ(tokens[1].type(), token_type::open_bracket);
-  EXPECT_EQ(tokens[1].begin(), INPUT.cbegin() + 1);
-  EXPECT_EQ(tokens[1].end(), INPUT.cbegin() + 2);
+  EXPECT_EQ(tokens[1].position(), 1u);
 
   EXPECT_EQ(tokens[2].type(), token_type::repeat_operator);
-  EXPECT_EQ(tokens[2].begin(), INPUT.cbegin() + 2);
-  EXPECT_EQ(tokens[2].end(), INPUT.cbegin() + 3);
+  EXPECT_EQ(tokens[2].position(), 2u);
 
   EXPECT_EQ(tokens[3].type(), token_type::kleene_operator);
-  EXPECT_EQ(tokens[3].begin(), INPUT.cbegin() + 3);
-  EXPECT_EQ(tokens[3].end(), INPUT.cend());
+  EXPECT_EQ(tokens[3].position(), 3u);
 
   EXPECT_EQ(tokens[4].type(), token_type::eof);
+  EXPECT_EQ(tokens[4].position(), 4u);
+}
+
+/** Verify that tokens can be extracted into a reused buffer. */
+TEST_F(LexicalAnalyzerTests, ReusesTokenBuffer)
+{
+  static const string FIRST = "abc|def";
+  static const string SECOND = "x*";
+
+  vector<token> tokens;
+  lexical_analyzer first(FIRST);
+  first.all_tokens(tokens);
+  ASSERT_EQ(tokens.size(), 8u);
+
+  auto data = tokens.data();
+  lexical_analyzer second(SECOND);
+  second.all_tokens(tokens);
+  ASSERT_EQ(tokens.size(), 3u);
+  EXPECT_EQ(tokens.data(), data);
+  EXPECT_EQ(tokens[0].character(), 'x');
+  EXPECT_EQ(tokens[1].type(), token_type::kleene_operator);
+}
+
+/** Verify that tokens are compact, trivially copyable values. */
+TEST_F(LexicalAnalyzerTests, TokensAreCompact)
+{
+  EXPECT_TRUE(is_trivially_copyable<token>::value);
+  EXPECT_LE(sizeof(token), 16u);
 }
@@ -0,0 +1,148 @@
+/**
+ * @file	multi_literal_search_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "match.hpp"
+#include "multi_literal_search.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::aho_corasick` and `regex::packed_searcher` classes.
+ */
+class MultiLiteralSearchTests : public Test
+{
+protected:
+
+  /** Returns the leftmost occurrence of any literal, found naively. */
+  const char* naive_find(const char* begin, const char* end, const vector<string>& literals)
+  {
+    for (auto ptr = begin; ptr != end; ptr++)
+      for (const auto& literal : literals)
+        if (literal.size() <= static_cast<size_t>(end - ptr) && memcmp(ptr, literal.data(), literal.size()) == 0)
+          return ptr;
+    return end;
+  }
+
+  /** Returns a pseudo-random haystack over a small alphabet, so that literals occur occasionally. */
+  string make_haystack(size_t length, const string& alphabet)
+  {
+    string haystack;
+    uint32_t seed = 12345;
+    for (size_t idx = 0; idx < length; idx++)
+    {
+      seed = seed * 1103515245 + 12345;
+      haystack += alphabet[(seed >> 16) % alphabet.size()];
+    }
+    return haystack;
+  }
+
+  /** Expect both searchers to agree with a naive search from every position of the haystack. */
+  void expect_same_as_naive(const vector<string>& literals, const string& haystack)
+  {
+    aho_corasick automaton(literals);
+    auto end = haystack.data() + haystack.size();
+    for (size_t begin = 0; begin <= haystack.size(); begin++)
+    {
+      auto first = haystack.data() + begin;
+      auto expected = naive_find(first, end, literals);
+      EXPECT_EQ(automaton.find(first, end) - haystack.data(), expected - haystack.data()) << begin;
+    }
+
+    if (!packed_searcher::is_supported() || literals.size() > packed_searcher::MAX_LITERALS)
+      return;
+
+    packed_searcher searcher(literals);
+    for (size_t begin = 0; begin <= haystack.size(); begin++)
+    {
+      auto first = haystack.data() + begin;
+      auto expected = naive_find(first, end, literals);
+      EXPECT_EQ(searcher.find(first, end) - haystack.data(), expected - haystack.data()) << begin;
+    }
+  }
+
+};
+
+/** Verify that a small set of literals is found. */
+TEST_F(MultiLiteralSearchTests, SmallSet)
+{
+  expect_same_as_naive({ "foo", "bar", "bazz" }, "xx ba baz fo bazz foo bar");
+  expect_same_as_naive({ "foo", "bar", "bazz" }, make_haystack(300, "fobarz "));
+}
+
+/** Verify that overlapping literals report the leftmost start, not the first end. */
+TEST_F(MultiLiteralSearchTests, OverlappingLiterals)
+{
+  expect_same_as_naive({ "abcdef", "cd" }, "xxabcdefxx");
+  expect_same_as_naive({ "he", "she", "his", "hers" }, "ushers");
+  expect_same_as_naive({ "a", "aa", "aaa" }, make_haystack(100, "ab"));
+}
+
+/** Verify that a match reports the literal listed first among those at the leftmost start. */
+TEST_F(MultiLiteralSearchTests, LeftmostFirstMatch)
+{
+  static const string INPUT = "xxabcd";
+  match result { 0, 0 };
+
+  ASSERT_TRUE(aho_corasick({ "a", "ab" }).find(INPUT.data(), INPUT.data() + INPUT.size(), result));
+  EXPECT_EQ(result.begin, 2u);
+  EXPECT_EQ(result.end, 3u);
+
+  ASSERT_TRUE(aho_corasick({ "ab", "a" }).find(INPUT.data(), INPUT.data() + INPUT.size(), result));
+  EXPECT_EQ(result.begin, 2u);
+  EXPECT_EQ(result.end, 4u);
+
+  ASSERT_TRUE(aho_corasick({ "bcd", "abc", "ab" }).find(INPUT.data(), INPUT.data() + INPUT.size(), result));
+  EXPECT_EQ(result.begin, 2u);
+  EXPECT_EQ(result.end, 5u);
+
+  aho_corasick missing({ "abd", "xy" });
+  EXPECT_FALSE(missing.find(INPUT.data(), INPUT.data() + INPUT.size(), result));
+  EXPECT_FALSE(missing.is_match(INPUT.data(), INPUT.data() + INPUT.size()));
+}
+
+/** Verify that a large set of literals is found. */
+TEST_F(MultiLiteralSearchTests, LargeSet)
+{
+  vector<string> literals;
+  for (size_t idx = 0; idx < 200; idx++)
+    literals.push_back(make_haystack(3 + idx % 5, "abcd").substr(idx % 3) + string(1, "abcd"[idx % 4]));
+
+  aho_corasick automaton(literals);
+  EXPECT_GT(automaton.state_count(), 1u);
+  expect_same_as_naive(literals, make_haystack(400, "abcde"));
+
+  literals.resize(packed_searcher::MAX_LITERALS - 8);
+  expect_same_as_naive(literals, make_haystack(400, "abcde"));
+}
+
+/** Verify that the reported memory usage covers the tables built for the literals. */
+TEST_F(MultiLiteralSearchTests, MemoryUsage)
+{
+  vector<string> literals;
+  for (size_t idx = 0; idx < 200; idx++)
+    literals.push_back("literal" + to_string(idx));
+
+  aho_corasick small({ "foo", "bar" });
+  aho_corasick large(literals);
+  EXPECT_GE(large.memory_usage(), large.state_count() * 2 * sizeof(uint32_t));
+  EXPECT_GT(large.memory_usage(), small.memory_usage());
+
+  literals.resize(packed_searcher::MAX_LITERALS);
+  EXPECT_GT(packed_searcher(literals).memory_usage(), packed_searcher({ "foo", "bar" }).memory_usage());
+}
@@ -0,0 +1,160 @@
+/**
+ * @file	onepass_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "onepass_dfa.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::onepass_dfa` class.
+ */
+class OnepassDFATests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern. */
+  shared_ptr<const program> compile_pattern(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return compile(parse.parse_tree());
+  }
+
+  /** Expect two sets of groups to be identical. */
+  void expect_same_groups(const vector<match>& actual, const vector<match>& expected, const string& context)
+  {
+    ASSERT_EQ(actual.size(), expected.size()) << context;
+    for (size_t idx = 0; idx < expected.size(); idx++)
+    {
+      EXPECT_EQ(actual[idx].begin, expected[idx].begin) << context << " / group " << idx;
+      EXPECT_EQ(actual[idx].end, expected[idx].end) << context << " / group " << idx;
+    }
+  }
+
+};
+
+/** Verify that groups extracted from a match agree with the Pike VM. */
+TEST_F(OnepassDFATests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "(a)(b)", "(a|b)*c", "x(a*)y(b?)", "(\\w+)@(\\w+)\\.com", "(?:(a)|(b))+", "([0-9]+)-([0-9]+)",
+    "(ab){2}(c)", "([^x]*)x", "(a)|(b)|(c)",
+  };
+  static const vector<string> INPUTS = {
+    "ab", "abac", "c", "xaay", "xyb", "xyb", "me@example.com", "abba", "12-345", "ababc", "zzx", "x",
+    "b", "c",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto prog = compile_pattern(pattern);
+    onepass_dfa dfa(prog);
+    pike_vm vm(prog);
+
+    for (const auto& input : INPUTS)
+    {
+      vector<match> expected;
+      if (!vm.captures(input, expected))
+        continue;
+
+      // the DFA only runs over the exact bounds of the match
+      auto offset = expected[0].begin;
+      const char* begin = input.data() + offset;
+      const char* end = input.data() + expected[0].end;
+      for (auto& group : expected)
+        if (group.begin != match::NO_POSITION)
+        {
+          group.begin -= offset;
+          group.end -= offset;
+        }
+
+      vector<match> actual;
+      ASSERT_TRUE(dfa.captures(begin, end, actual)) << pattern << " / " << input;
+      expect_same_groups(actual, expected, pattern + " / " + input);
+    }
+  }
+}
+
+/** Verify that programs which are not one-pass are rejected. */
+TEST_F(OnepassDFATests, RejectsAmbiguousPrograms)
+{
+  static const vector<string> PATTERNS = { "(a*)a", "(a|ab)", "(a*)*", "(a|a)b", "(.*)x", "a*(a)" };
+
+  for (const auto& pattern : PATTERNS)
+    EXPECT_THROW(onepass_dfa(compile_pattern(pattern)), compile_error) << pattern;
+
+  string many;
+  for (size_t idx = 0; idx < onepass_dfa::MAX_SLOTS / 2; idx++)
+    many += "(a)";
+  EXPECT_THROW(onepass_dfa(compile_pattern(many)), compile_error);
+
+  vector<match> groups;
+  onepass_dfa dfa(compile_pattern("(a)(b)"));
+  EXPECT_FALSE(dfa.captures("a", groups));
+  EXPECT_FALSE(dfa.captures("abc", groups));
+}
+
+/** Verify that patterns report groups relative to the whole input, whichever engine extracts them. */
+TEST_F(OnepassDFATests, PatternCapturesGroups)
+{
+  static const string INPUT = "to: alice@example, bob@example";
+
+  for (const auto& expression : { string("(\\w+)@(\\w+)"), string("(\\w*)@(\\w+|\\w+x)") })
+  {
+    pattern pat(expression);
+    ASSERT_EQ(pat.group_count(), 2u);
+
+    vector<match> groups;
+    ASSERT_TRUE(pat.captures(INPUT, groups)) << expression;
+    ASSERT_EQ(groups.size(), 3u);
+    EXPECT_EQ(groups[0].begin, 4u);
+    EXPECT_EQ(groups[0].end, 17u);
+    EXPECT_EQ(groups[1].begin, 4u);
+    EXPECT_EQ(groups[1].end, 9u);
+    EXPECT_EQ(groups[2].begin, 10u);
+    EXPECT_EQ(groups[2].end, 17u);
+  }
+
+  // a group removed by simplification is still counted, but never participates
+  pattern removed("a(b){0}(c)");
+  vector<match> groups;
+  ASSERT_EQ(removed.group_count(), 2u);
+  ASSERT_TRUE(removed.captures("xac", groups));
+  ASSERT_EQ(groups.size(), 3u);
+  EXPECT_EQ(groups[1].begin, match::NO_POSITION);
+  EXPECT_EQ(groups[2].begin, 2u);
+  EXPECT_EQ(groups[2].end, 3u);
+  EXPECT_FALSE(removed.captures("ab", groups));
+
+  // without the backtracker, groups which cannot be extracted one-pass fall back to the Pike VM
+  pattern_options options;
+  options.backtrack_limit = 0;
+  pattern ambiguous("(a*)(a*)b", options);
+  ASSERT_TRUE(ambiguous.captures("xaab", groups));
+  EXPECT_EQ(groups[1].begin, 1u);
+  EXPECT_EQ(groups[1].end, 3u);
+  EXPECT_EQ(groups[2].begin, 3u);
+  EXPECT_EQ(groups[2].end, 3u);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file	parallel_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dfa_test_helpers.hpp"
+#include "match.hpp"
+#include "parallel_dfa.hpp"
+#include "pattern.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+using namespace regex::test;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::parallel_dfa` class.
+ */
+class ParallelDFATests : public Test
+{
+};
+
+/** Verify that searching in parallel finds exactly the match a sequential search would. */
+TEST_F(ParallelDFATests, AgreesWithSequentialSearch)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab+c?", "(a|b)*abb", "cab{2,4}", "(abc|bca)+", "a[bc]{6}a",
+    "c.*c", "ccc|bbbb", "x*",
+  };
+
+  mt19937 rng(RANDOM_SEED);
+  for (const auto& pattern : PATTERNS)
+  {
+    auto dfa = compile_dfa(pattern);
+    for (size_t thread_count = 2; thread_count <= 5; thread_count++)
+    {
+      parallel_dfa parallel(dfa, thread_count, 16);
+      expect_same_matches(*dfa, parallel, pattern, rng, { "abc", "aab xyz" }, 50, 16, 266);
+    }
+  }
+}
+
+/** Verify that matches which span chunk boundaries, or end near the end of the input, are found. */
+TEST_F(ParallelDFATests, FindsMatchesAcrossChunks)
+{
+  auto dfa = compile_dfa("needle[0-9]*");
+  parallel_dfa parallel(dfa, 4, 64);
+  EXPECT_EQ(parallel.threads_for(256), 4u);
+  EXPECT_EQ(parallel.threads_for(128), 2u);
+  EXPECT_EQ(parallel.threads_for(63), 1u);
+
+  for (size_t pos = 0; pos + 9 <= 256; pos++)
+  {
+    string input(256, '.');
+    input.replace(pos, 9, "needle123");
+    expect_same_match(*dfa, parallel, "needle[0-9]*", input);
+
+    match result { 0, 0 };
+    ASSERT_TRUE(parallel.find(input, result));
+    EXPECT_EQ(result.begin, pos);
+    EXPECT_EQ(result.end, pos + 9);
+  }
+
+  string input(256, '.');
+  EXPECT_FALSE(parallel.is_match(input));
+}
+
+/** Verify that expressions whose paths never merge are still searched correctly. */
+TEST_F(ParallelDFATests, FallsBackWhenPathsDoNotMerge)
+{
+  // each subset of the open alternatives is a distinct state, and none is closed by 'a' or 'b'
+  static const string PATTERN = "p[^q]*1|r[^q]*2|s[^q]*3|t[^q]*4|u[^q]*5";
+  auto dfa = compile_dfa(PATTERN);
+  parallel_dfa parallel(dfa, 4, 8192);
+
+  mt19937 rng(17);
+  auto input = random_input(rng, "ab", 40000);
+  expect_same_match(*dfa, parallel, PATTERN, input);
+  input[20000] = 'r';
+  input[30000] = '2';
+  expect_same_match(*dfa, parallel, PATTERN, input);
+}
+
+/** Verify that matches are found when the chunks after the matching chunk stop early. */
+TEST_F(ParallelDFATests, FindsMatchesWhenLaterChunksStop)
+{
+  auto dfa = compile_dfa("needle[0-9]*");
+  parallel_dfa parallel(dfa, 8, 1 << 16);
+
+  string input(8 << 17, '.');
+  for (auto pos : { size_t(10), size_t(1 << 17), size_t(5 << 17) - 3 })
+  {
+    input.replace(pos, 8, "needle42");
+    expect_same_match(*dfa, parallel, "needle[0-9]*", input);
+  }
+}
+
+/** Verify that many instances searched at once from several threads share the worker threads. */
+TEST_F(ParallelDFATests, InstancesShareWorkers)
+{
+  static const vector<string> PATTERNS = { "needle[0-9]*", "ab+c?", "(a|b)*abb", "c.*c" };
+
+  vector<thread> searchers;
+  for (size_t searcher = 0; searcher < 4; searcher++)
+    searchers.emplace_back([searcher] {
+        mt19937 rng(RANDOM_SEED + static_cast<unsigned>(searcher));
+        for (size_t idx = 0; idx < 25; idx++)
+        {
+          const auto& pattern = PATTERNS[idx % PATTERNS.size()];
+          auto dfa = compile_dfa(pattern);
+          parallel_dfa parallel(dfa, 8, 64);
+          expect_same_match(*dfa, parallel, pattern, random_input(rng, "abc", 2048));
+        }
+      });
+  for (auto& searcher : searchers)
+    searcher.join();
+}
+
+/** Verify that a pattern searches large inputs in parallel when asked to. */
+TEST_F(ParallelDFATests, PatternSearchesInParallel)
+{
+  pattern_options options;
+  options.thread_count = 4;
+  options.use_prefilter = false;
+  pattern p("(error|warning): [a-z]+", options);
+  pattern sequential("(error|warning): [a-z]+");
+
+  string input(4 * parallel_dfa::DEFAULT_MIN_CHUNK_SIZE, 'x');
+  input.replace(3 * parallel_dfa::DEFAULT_MIN_CHUNK_SIZE + 5, 17, "warning: disk 99%");
+
+  match expected { 0, 0 };
+  match actual { 0, 0 };
+  ASSERT_TRUE(sequential.find(input, expected));
+  ASSERT_TRUE(p.find(input, actual));
+  EXPECT_EQ(actual.begin, expected.begin);
+  EXPECT_EQ(actual.end, expected.end);
+  EXPECT_EQ(actual.end - actual.begin, 13u);
+}
@@ -0,0 +1,159 @@
+/**
+ * @file	pattern_cache_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "engine_pool.hpp"
+#include "pattern.hpp"
+#include "pattern_cache.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::pattern_cache` class.
+ */
+class PatternCacheTests : public Test
+{
+};
+
+/** Verify that repeated lookups return the same cached pattern. */
+TEST_F(PatternCacheTests, ReturnsCachedPattern)
+{
+  pattern_cache cache;
+  auto first = cache.get("ab*c");
+  auto second = cache.get("ab*c");
+  EXPECT_EQ(first, second);
+  EXPECT_TRUE(first->is_match("xabbbc"));
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.evictions, 0u);
+  EXPECT_EQ(stats.entries, 1u);
+  EXPECT_GT(stats.memory_usage, 0u);
+}
+
+/** Verify that the same expression with different options is cached separately. */
+TEST_F(PatternCacheTests, KeysIncludeOptions)
+{
+  pattern_cache cache;
+  pattern_options options;
+  options.engine = engine_type::full_dfa;
+
+  auto lazy = cache.get("abc");
+  auto full = cache.get("abc", options);
+  EXPECT_NE(lazy, full);
+  EXPECT_EQ(full->options().engine, engine_type::full_dfa);
+  EXPECT_EQ(cache.get("abc", options), full);
+  EXPECT_EQ(cache.stats().entries, 2u);
+}
+
+/** Verify that the least recently used patterns are evicted to stay within the memory limit. */
+TEST_F(PatternCacheTests, EvictsLeastRecentlyUsed)
+{
+  pattern_cache_options options;
+  options.shard_count = 1;
+  options.memory_limit = 3 * pattern("abcd").memory_usage() + 256;
+  pattern_cache cache(options);
+
+  auto a = cache.get("aaaa");
+  cache.get("bbbb");
+  cache.get("cccc");
+  EXPECT_EQ(cache.get("aaaa"), a);
+  cache.get("dddd");
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 1u);
+  EXPECT_EQ(stats.entries, 3u);
+  EXPECT_LE(stats.memory_usage, options.memory_limit);
+
+  // "bbbb" was least recently used, so it must be compiled again
+  auto misses = cache.stats().misses;
+  EXPECT_EQ(cache.get("aaaa"), a);
+  cache.get("bbbb");
+  EXPECT_EQ(cache.stats().misses, misses + 1);
+
+  // an evicted pattern remains usable
+  EXPECT_TRUE(a->is_match("xaaaax"));
+}
+
+/** Verify that invalid expressions throw and are not cached. */
+TEST_F(PatternCacheTests, InvalidExpression)
+{
+  pattern_cache cache;
+  EXPECT_THROW(cache.get("(ab"), syntax_error);
+  EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+/** Verify that many threads can use the cache at once. */
+TEST_F(PatternCacheTests, ConcurrentLookups)
+{
+  static const size_t THREAD_COUNT = 8;
+  static const size_t LOOKUP_COUNT = 200;
+
+  pattern_cache cache;
+  vector<thread> threads;
+  vector<int> results(THREAD_COUNT, 1);
+  for (size_t idx = 0; idx < THREAD_COUNT; idx++)
+  {
+    threads.emplace_back([&, idx] {
+        for (size_t lookup = 0; lookup < LOOKUP_COUNT; lookup++)
+        {
+          auto expression = "a" + to_string(lookup % 10) + "b*";
+          auto input = "xa" + to_string(lookup % 10) + "bb";
+          if (!cache.get(expression)->is_match(input))
+            results[idx] = 0;
+        }
+      });
+  }
+  for (auto& t : threads)
+    t.join();
+
+  for (size_t idx = 0; idx < THREAD_COUNT; idx++)
+    EXPECT_TRUE(results[idx]);
+
+  auto stats = cache.stats();
+  EXPECT_EQ(stats.hits + stats.misses, THREAD_COUNT * LOOKUP_COUNT);
+  EXPECT_EQ(stats.entries, 10u);
+}
+
+/** Verify that the engine pools of cached patterns keep a bounded number of idle engines. */
+TEST_F(PatternCacheTests, EnginePoolsAreBounded)
+{
+  static const size_t IDLE_LIMIT = 2;
+
+  size_t created = 0;
+  engine_pool<int> pool([&created] { created++; return make_unique<int>(0); }, IDLE_LIMIT);
+
+  // hold several engines at once, as concurrent searches would
+  pool.with_engine([&] (int&) {
+      return pool.with_engine([&] (int&) {
+          return pool.with_engine([&] (int&) {
+              return pool.with_engine([] (int&) { return true; });
+            });
+        });
+    });
+  EXPECT_EQ(created, 4u);
+  EXPECT_EQ(pool.idle_count(), IDLE_LIMIT);
+
+  // idle engines are reused rather than created again
+  pool.with_engine([] (int&) { return true; });
+  EXPECT_EQ(created, 4u);
+  EXPECT_EQ(pool.idle_count(), IDLE_LIMIT);
+}
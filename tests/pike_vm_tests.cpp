@@ -0,0 +1,189 @@
+/**
+ * @file	pike_vm_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/04
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pike_vm.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::pike_vm` class.
+ */
+class PikeVMTests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern into a VM. */
+  unique_ptr<pike_vm> compile_vm(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return make_unique<pike_vm>(compile(parse.parse_regex()));
+  }
+
+  /** Expect `pattern` to match `input` at exactly `[begin, end)`. */
+  void expect_match(const string& pattern, const string& input, size_t begin, size_t end)
+  {
+    auto vm = compile_vm(pattern);
+    match result { 0, 0 };
+    ASSERT_TRUE(vm->find(input, result)) << pattern << " / " << input;
+    EXPECT_EQ(result.begin, begin) << pattern << " / " << input;
+    EXPECT_EQ(result.end, end) << pattern << " / " << input;
+    EXPECT_TRUE(vm->is_match(input));
+  }
+
+  /** Expect `pattern` not to match anywhere in `input`. */
+  void expect_no_match(const string& pattern, const string& input)
+  {
+    auto vm = compile_vm(pattern);
+    match result { 0, 0 };
+    EXPECT_FALSE(vm->find(input, result)) << pattern << " / " << input;
+    EXPECT_FALSE(vm->is_match(input));
+  }
+
+};
+
+/** Verify that literals and concatenations match. */
+TEST_F(PikeVMTests, MatchesLiterals)
+{
+  expect_match("abc", "abc", 0, 3);
+  expect_match("abc", "xxabcxx", 2, 5);
+  expect_no_match("abc", "abx");
+  expect_no_match("abc", "");
+}
+
+/** Verify that wildcards match any character. */
+TEST_F(PikeVMTests, MatchesWildcards)
+{
+  expect_match("a.c", "xabcx", 1, 4);
+  expect_match("a.c", "a\nc", 0, 3);
+  expect_no_match("a.c", "ac");
+}
+
+/** Verify that alternations prefer the leftmost alternative. */
+TEST_F(PikeVMTests, MatchesAlternations)
+{
+  expect_match("a|ab", "ab", 0, 1);
+  expect_match("ab|a", "ab", 0, 2);
+  expect_match("cat|dog", "hotdog", 3, 6);
+  expect_no_match("cat|dog", "cow");
+}
+
+/** Verify that closures are greedy. */
+TEST_F(PikeVMTests, MatchesClosures)
+{
+  expect_match("ab?", "abb", 0, 2);
+  expect_match("ab*", "abbbc", 0, 4);
+  expect_match("ab+", "xabbb", 1, 5);
+  expect_no_match("ab+", "a");
+  expect_match("(ab)*c", "ababc", 0, 5);
+  expect_match("a*", "bbb", 0, 0);
+}
+
+/** Verify that counted repetitions match between their minimum and maximum counts. */
+TEST_F(PikeVMTests, MatchesQuantifiers)
+{
+  expect_match("ab{2}c", "abbbc abbc", 6, 10);
+  expect_match("ab{2,}", "abbbbx", 0, 5);
+  expect_match("ab{0,}c", "xac", 1, 3);
+  expect_match("ab{1,3}", "abbbbb", 0, 4);
+  expect_match("a(bc){0,2}", "abcbcbc", 0, 5);
+  expect_match("x{0}y", "xy", 1, 2);
+  expect_match("a{,2}", "a{,2}", 0, 5);
+  expect_no_match("ab{2,3}c", "abc abbbbc");
+  expect_match(".{1000}", string(1200, 'z'), 0, 1000);
+}
+
+/** Verify that nested counted repetitions are rejected before they are unrolled. */
+TEST_F(PikeVMTests, RejectsNestedRepetitionsOverLimit)
+{
+  EXPECT_THROW(compile_vm("(\\w{1000}){1000}"), compile_error);
+  EXPECT_THROW(compile_vm("((a{10}){10}){11}"), compile_error);
+  EXPECT_THROW(compile_vm("(a{2,}b?){501}"), compile_error);
+  EXPECT_NO_THROW(compile_vm("((a{10}){10}){10}"));
+  EXPECT_NO_THROW(compile_vm("(a*){1000}b{1000}"));
+}
+
+/** Verify that character classes and shorthand classes match any one of their characters. */
+TEST_F(PikeVMTests, MatchesClasses)
+{
+  expect_match("[abc]+", "xxcabx", 2, 5);
+  expect_match("[a-c0-9]+", "-b9c-", 1, 4);
+  expect_match("[^a-c]", "abcd", 3, 4);
+  expect_match("[]a]+", "x]a]", 1, 4);
+  expect_match("[a-]+", "x-a-", 1, 4);
+  expect_match("[\\]\\-]", "a-", 1, 2);
+  expect_match("\\d{3}-\\d{4}", "call 555-1234", 5, 13);
+  expect_match("\\w+", "  foo_1 ", 2, 7);
+  expect_match("\\s+", "a \t\nb", 1, 4);
+  expect_match("[\\D]+", "12ab3", 2, 4);
+  expect_match("\\S\\W", "a b", 0, 2);
+  expect_no_match("[^\\s\\S]", "anything");
+}
+
+/** Verify that the leftmost match is preferred over a longer match further right. */
+TEST_F(PikeVMTests, PrefersLeftmostMatch)
+{
+  expect_match("b+|a", "xabbb", 1, 2);
+  expect_match("abcd|c", "abcd", 0, 4);
+}
+
+/** Verify that nested empty closures do not loop forever. */
+TEST_F(PikeVMTests, HandlesEmptyLoops)
+{
+  expect_match("(a*)*b", "aab", 0, 3);
+  expect_match("(a?)+", "aa", 0, 2);
+}
+
+/** Verify that pathological patterns complete in linear time. */
+TEST_F(PikeVMTests, HandlesPathologicalPatterns)
+{
+  string pattern;
+  for (int idx = 0; idx < 30; idx++)
+    pattern += "a?";
+  for (int idx = 0; idx < 30; idx++)
+    pattern += "a";
+  expect_match(pattern, string(30, 'a'), 0, 30);
+  expect_no_match("(a*)*b", string(10000, 'a'));
+}
+
+/** Verify that capture groups record the bounds of their last iteration on the preferred path. */
+TEST_F(PikeVMTests, ExtractsCaptures)
+{
+  vector<match> groups;
+  ASSERT_TRUE(compile_vm("(a+)(b|c)?(?:x(y))?")->captures("zaaxy", groups));
+  ASSERT_EQ(groups.size(), 4u);
+  EXPECT_EQ(groups[0].begin, 1u);
+  EXPECT_EQ(groups[0].end, 5u);
+  EXPECT_EQ(groups[1].begin, 1u);
+  EXPECT_EQ(groups[1].end, 3u);
+  EXPECT_EQ(groups[2].begin, match::NO_POSITION);
+  EXPECT_EQ(groups[2].end, match::NO_POSITION);
+  EXPECT_EQ(groups[3].begin, 4u);
+  EXPECT_EQ(groups[3].end, 5u);
+
+  ASSERT_TRUE(compile_vm("(?:(a)|b)*")->captures("abb", groups));
+  ASSERT_EQ(groups.size(), 2u);
+  EXPECT_EQ(groups[1].begin, 0u);
+  EXPECT_EQ(groups[1].end, 1u);
+  EXPECT_FALSE(compile_vm("(a)b")->captures("ac", groups));
+}
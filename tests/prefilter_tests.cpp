@@ -0,0 +1,335 @@
+/**
+ * @file	prefilter_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/25
+ */
+
+/* -- Includes -- */
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "byte_search.hpp"
+#include "compiler.hpp"
+#include "dfa_test_helpers.hpp"
+#include "full_dfa.hpp"
+#include "lazy_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "prefilter.hpp"
+#include "prefix_analysis.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+using namespace regex::test;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for prefix analysis, the prefilters, and the byte search procedures.
+ */
+class PrefilterTests : public Test
+{
+protected:
+
+  /** Parses the specified pattern. */
+  unique_ptr<const syntax_node> parse(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return parse.parse_regex();
+  }
+
+  /** Returns the bounds of every match of the pattern in the input, resuming after each one. */
+  vector<pair<size_t, size_t>> find_all(const pattern& pat, const string& input)
+  {
+    vector<pair<size_t, size_t>> matches;
+    match result { 0, 0 };
+    for (size_t offset = 0; offset <= input.size() && pat.find(input.data() + offset, input.data() + input.size(), result); )
+    {
+      matches.emplace_back(result.begin + offset, result.end + offset);
+      offset += max<size_t>(result.end, result.begin + 1);
+    }
+    return matches;
+  }
+
+  /** Returns a naive search result for `needle` in `haystack`. */
+  const char* naive_find(const char* begin, const char* end, const char* needle, size_t length)
+  {
+    for (auto ptr = begin; static_cast<size_t>(end - ptr) >= length; ptr++)
+      if (memcmp(ptr, needle, length) == 0)
+        return ptr;
+    return end;
+  }
+
+};
+
+/** Verify that a required literal prefix is extracted. */
+TEST_F(PrefilterTests, LiteralPrefix)
+{
+  auto info = analyze_prefix(parse("ERROR.*timeout"));
+  EXPECT_EQ(info.prefix, "ERROR");
+  EXPECT_FALSE(info.exact);
+  EXPECT_FALSE(info.nullable);
+
+  info = analyze_prefix(parse("abc|abd"));
+  EXPECT_EQ(info.prefix, "ab");
+  EXPECT_FALSE(info.exact);
+
+  info = analyze_prefix(parse("abc"));
+  EXPECT_EQ(info.prefix, "abc");
+  EXPECT_TRUE(info.exact);
+
+  info = analyze_prefix(parse("a+bc"));
+  EXPECT_EQ(info.prefix, "a");
+}
+
+/** Verify that the set of possible first bytes is computed. */
+TEST_F(PrefilterTests, FirstBytes)
+{
+  auto info = analyze_prefix(parse("(a|b)c"));
+  EXPECT_EQ(info.prefix, "");
+  EXPECT_EQ(info.first_bytes.count(), 2);
+  EXPECT_TRUE(info.first_bytes.test('a'));
+  EXPECT_TRUE(info.first_bytes.test('b'));
+
+  info = analyze_prefix(parse("a?b*c"));
+  EXPECT_EQ(info.first_bytes.count(), 3);
+  EXPECT_FALSE(info.nullable);
+}
+
+/** Verify that the literals beginning each alternative are collected. */
+TEST_F(PrefilterTests, AlternativeLiterals)
+{
+  auto info = analyze_prefix(parse("foo|bar|bazz"));
+  EXPECT_EQ(info.literals, vector<string>({ "foo", "bar", "bazz" }));
+  EXPECT_TRUE(info.literals_exact);
+
+  info = analyze_prefix(parse("(cat|dog)s.*x"));
+  EXPECT_EQ(info.literals, vector<string>({ "cats", "dogs" }));
+  EXPECT_FALSE(info.literals_exact);
+
+  info = analyze_prefix(parse("foo|b*ar"));
+  EXPECT_TRUE(info.literals.empty());
+
+  info = analyze_prefix(parse("[xy]z"));
+  EXPECT_EQ(info.literals, vector<string>({ "xz", "yz" }));
+  EXPECT_TRUE(info.literals_exact);
+
+  info = analyze_prefix(parse("\\w+"));
+  EXPECT_TRUE(info.literals.empty());
+  EXPECT_EQ(info.first_bytes.count(), 63u);
+
+  info = analyze_prefix(parse("x(ab)?(c|d)"));
+  EXPECT_EQ(info.literals, vector<string>({ "xabc", "xabd", "xc", "xd" }));
+  EXPECT_TRUE(info.literals_exact);
+
+  info = analyze_prefix(parse("(ab)?c*"));
+  EXPECT_TRUE(info.literals.empty());
+}
+
+/** Verify that no prefilter is created where it would not help. */
+TEST_F(PrefilterTests, NoPrefilter)
+{
+  EXPECT_EQ(make_prefilter(parse("a*")), nullptr);
+  EXPECT_EQ(make_prefilter(parse(".abc")), nullptr);
+  EXPECT_EQ(make_prefilter(parse("(a|b|c|d)*x")), nullptr);
+  EXPECT_NE(make_prefilter(parse("a|b|c")), nullptr);
+  EXPECT_NE(make_prefilter(parse("abc")), nullptr);
+}
+
+/** Verify that the byte search procedures agree with a naive search. */
+TEST_F(PrefilterTests, ByteSearch)
+{
+  string haystack(300, 'x');
+  for (size_t pos : { 0, 1, 15, 16, 31, 32, 33, 63, 64, 150, 299 })
+  {
+    for (size_t begin = 0; begin <= pos && begin < 40; begin += 13)
+    {
+      auto text = haystack;
+      text[pos] = 'q';
+      auto first = text.data() + begin;
+      auto last = text.data() + text.size();
+      EXPECT_EQ(find_byte(first, last, 'q') - text.data(), pos);
+      EXPECT_EQ(find_byte2(first, last, 'q', 'z') - text.data(), pos);
+      EXPECT_EQ(find_byte3(first, last, 'y', 'z', 'q') - text.data(), pos);
+    }
+  }
+
+  EXPECT_EQ(find_byte(haystack.data(), haystack.data() + haystack.size(), 'q'), haystack.data() + haystack.size());
+  EXPECT_EQ(find_byte3(haystack.data(), haystack.data(), 'x', 'x', 'x'), haystack.data());
+}
+
+/** Verify that substring search agrees with a naive search, including at buffer boundaries. */
+TEST_F(PrefilterTests, SubstringSearch)
+{
+  static const vector<string> NEEDLES = { "ab", "abc", "xxab", "abababab", "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab" };
+
+  string haystack;
+  for (size_t idx = 0; idx < 500; idx++)
+    haystack += "aaabaxab"[(idx * 7 + idx / 13) % 8];
+  haystack += "xxababababab";
+
+  for (const auto& needle : NEEDLES)
+  {
+    for (size_t begin = 0; begin < haystack.size(); begin += 17)
+    {
+      for (size_t end = begin; end <= haystack.size(); end += 61)
+      {
+        auto first = haystack.data() + begin;
+        auto last = haystack.data() + end;
+        EXPECT_EQ(find_substring(first, last, needle.data(), needle.size()),
+                  naive_find(first, last, needle.data(), needle.size()))
+          << needle << " / " << begin << " / " << end;
+      }
+    }
+  }
+}
+
+/** Verify that engines using a prefilter agree with the Pike VM without one. */
+TEST_F(PrefilterTests, EnginesAgreeWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "ERROR.*timeout", "abc|abd", "(a|b)c", "ab+", "a|b|c", "abab", "ba*c",
+    "foo|bar|bazz", "(cat|dog)s?x", "a|b|c|d", "(ab)*c", "(xy|x)(z|yzw)",
+  };
+  static const vector<string> INPUTS = {
+    "", "a", "ab", "abd", "xxabcxx", "ac bc cc", "ERROR: no timeout here", "ERRORERROR timeout",
+    "xyzzy", "aaabbb", "abaabab", "bc", "bac baac bx",
+    "fobarfoo", "ba bazz", "xx dogsx catx", "dcba", "xxababcx", "xyzw xyyzw",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto root = parse(pattern);
+    auto forward = compile(root);
+    compile_options reverse_options;
+    reverse_options.reverse = true;
+    auto reverse = compile(root, reverse_options);
+    auto pre = make_prefilter(root);
+    ASSERT_NE(pre, nullptr) << pattern;
+
+    pike_vm reference(forward);
+    pike_vm vm(forward, pre);
+    lazy_dfa lazy(forward, reverse, 1 << 20, pre);
+    full_dfa full(forward, reverse, 10000, pre);
+
+    for (const auto& input : INPUTS)
+    {
+      match expected { 0, 0 };
+      bool expected_found = reference.find(input, expected);
+
+      match actual { 0, 0 };
+      ASSERT_EQ(vm.find(input, actual), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+
+      ASSERT_EQ(lazy.find(input, actual), expected_found) << pattern << " / " << input;
+      EXPECT_EQ(lazy.is_match(input), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+
+      ASSERT_EQ(full.find(input, actual), expected_found) << pattern << " / " << input;
+      EXPECT_EQ(full.is_match(input), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+    }
+  }
+}
+
+/**
+ * Verify that an alternation of thousands of literals keeps its literal set, and that searching for
+ * it, alone or followed by more of the expression, is not much slower than for a few literals.
+ */
+TEST_F(PrefilterTests, LargeLiteralSet)
+{
+  using clock = chrono::steady_clock;
+
+  mt19937 rng(RANDOM_SEED);
+  vector<string> words;
+  for (size_t idx = 0; idx < 5000; idx++)
+    words.push_back(random_input(rng, "abcdefghijklmnopqrstuvwxyz", 4 + idx % 6));
+
+  string large;
+  string small;
+  for (size_t idx = 0; idx < words.size(); idx++)
+  {
+    large += (idx == 0 ? "" : "|") + words[idx];
+    if (idx < 16)
+      small += (idx == 0 ? "" : "|") + words[idx];
+  }
+
+  auto info = analyze_prefix(parse(large));
+  EXPECT_EQ(info.literals, words);
+  EXPECT_TRUE(info.literals_exact);
+
+  auto input = random_input(rng, "abcdefghijklmnopqrstuvwxyz 0123456789", 256 << 10);
+  auto sample = input.substr(0, 4 << 10);
+
+  // the leftmost-first matches of the expression, found naively: at each position, the first word
+  // which occurs there, followed by as many digits as possible if the expression requires any
+  auto naive_find_all = [&] (bool digits) {
+    vector<pair<size_t, size_t>> matches;
+    for (size_t pos = 0; pos < sample.size(); pos++)
+    {
+      for (const auto& word : words)
+      {
+        auto end = pos + word.size();
+        if (sample.compare(pos, word.size(), word) != 0)
+          continue;
+        if (digits)
+        {
+          while (end < sample.size() && isdigit(static_cast<unsigned char>(sample[end])))
+            end++;
+          if (end == pos + word.size())
+            continue;
+        }
+        matches.emplace_back(pos, end);
+        pos = end - 1;
+        break;
+      }
+    }
+    return matches;
+  };
+
+  static const vector<string> TAILS = { "", "[0-9]+" };
+  for (const auto& tail : TAILS)
+  {
+    pattern large_pattern("(" + large + ")" + tail);
+    pattern small_pattern("(" + small + ")" + tail);
+    EXPECT_EQ(find_all(large_pattern, sample), naive_find_all(!tail.empty())) << tail;
+
+    auto start = clock::now();
+    auto small_count = find_all(small_pattern, input).size();
+    auto small_time = clock::now() - start;
+
+    start = clock::now();
+    auto large_count = find_all(large_pattern, input).size();
+    auto large_time = clock::now() - start;
+
+    EXPECT_GT(large_count, small_count) << tail;
+    EXPECT_LT(large_time, 20 * small_time + chrono::milliseconds(500)) << tail;
+  }
+}
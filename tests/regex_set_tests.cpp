@@ -0,0 +1,165 @@
+/**
+ * @file	regex_set_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/26
+ */
+
+/* -- Includes -- */
+
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "pattern.hpp"
+#include "regex_set.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::regex_set` class.
+ */
+class RegexSetTests : public Test
+{
+protected:
+
+  /** Returns the indices of the patterns matching `input`, using the set. */
+  vector<size_t> set_matches(const regex_set& set, const string& input)
+  {
+    vector<size_t> indices;
+    bool found = set.matches(input, indices);
+    EXPECT_EQ(found, !indices.empty());
+    EXPECT_EQ(set.is_match(input), found);
+    return indices;
+  }
+
+  /** Returns the indices of the patterns matching `input`, searching each pattern separately. */
+  vector<size_t> individual_matches(const vector<string>& expressions, const string& input)
+  {
+    vector<size_t> indices;
+    for (size_t idx = 0; idx < expressions.size(); idx++)
+      if (pattern(expressions[idx]).is_match(input))
+        indices.push_back(idx);
+    return indices;
+  }
+
+  /** Returns a random string of `length` bytes drawn from `alphabet`. */
+  string random_input(mt19937& rng, const string& alphabet, size_t length)
+  {
+    uniform_int_distribution<size_t> dist(0, alphabet.size() - 1);
+    string input(length, ' ');
+    for (auto& ch : input)
+      ch = alphabet[dist(rng)];
+    return input;
+  }
+
+};
+
+/** Verify that every matching pattern is reported. */
+TEST_F(RegexSetTests, ReportsAllMatches)
+{
+  regex_set set({ "foo", "ba(r|z)", "o+", "xyz" });
+  EXPECT_EQ(set.size(), 4u);
+  EXPECT_EQ(set.expression(1), "ba(r|z)");
+
+  EXPECT_EQ(set_matches(set, "foobar"), vector<size_t>({ 0, 1, 2 }));
+  EXPECT_EQ(set_matches(set, "baz"), vector<size_t>({ 1 }));
+  EXPECT_EQ(set_matches(set, "xyzoo"), vector<size_t>({ 2, 3 }));
+  EXPECT_EQ(set_matches(set, "nothing"), vector<size_t>({ 2 }));
+  EXPECT_EQ(set_matches(set, "abc"), vector<size_t>());
+}
+
+/** Verify that patterns with overlapping matches are all reported. */
+TEST_F(RegexSetTests, OverlappingPatterns)
+{
+  regex_set set({ "a", "ab", "abc", "b*c", "a.*d" });
+  EXPECT_EQ(set_matches(set, "abc"), vector<size_t>({ 0, 1, 2, 3 }));
+  EXPECT_EQ(set_matches(set, "xxabd"), vector<size_t>({ 0, 1, 4 }));
+}
+
+/** Verify that a pattern matching the empty string matches any input. */
+TEST_F(RegexSetTests, EmptyMatch)
+{
+  regex_set set({ "q", "z*" });
+  EXPECT_EQ(set_matches(set, ""), vector<size_t>({ 1 }));
+  EXPECT_EQ(set_matches(set, "q"), vector<size_t>({ 0, 1 }));
+}
+
+/** Verify that a large set agrees with searching each pattern separately. */
+TEST_F(RegexSetTests, AgreesWithIndividualPatterns)
+{
+  vector<string> expressions;
+  for (size_t idx = 0; idx < 200; idx++)
+    expressions.push_back(string(1, "abcdefgh"[idx % 8]) + string(1, "abcdefgh"[(idx / 8) % 8]) + (idx % 3 == 0 ? "x+" : "y"));
+
+  static const vector<string> INPUTS = { "", "abx", "hhy gfx dcxxx", "aaaaa", "xxabyxxbaxx", "the quick brown fox" };
+
+  regex_set set(expressions);
+  for (const auto& input : INPUTS)
+    EXPECT_EQ(set_matches(set, input), individual_matches(expressions, input)) << input;
+}
+
+/** Verify that a large set whose expressions all begin with literals is searched correctly. */
+TEST_F(RegexSetTests, ManyPatternsWithLiterals)
+{
+  vector<string> expressions;
+  for (size_t idx = 0; idx < 1000; idx++)
+    expressions.push_back("id" + to_string(idx) + "=[a-j]+\\d");
+
+  mt19937 rng(20170306);
+  regex_set set(expressions);
+  for (size_t length : { 0, 1000, 20000 })
+  {
+    auto input = random_input(rng, "abcdefghij0123456789=id ", length);
+    EXPECT_EQ(set_matches(set, input), individual_matches(expressions, input)) << length;
+  }
+  EXPECT_FALSE(set.is_match(string(10000, 'x')));
+}
+
+/** Verify that a set of a thousand expressions is not much slower than searching each separately. */
+TEST_F(RegexSetTests, ScalesToManyPatterns)
+{
+  using clock = chrono::steady_clock;
+
+  vector<string> expressions;
+  for (size_t idx = 0; idx < 1000; idx++)
+    expressions.push_back("[a-j]*" + to_string(idx) + "[a-j]+");
+
+  mt19937 rng(20170306);
+  auto input = random_input(rng, "abcdefghij0123456789=id ", 64 << 10);
+
+  vector<unique_ptr<pattern>> patterns;
+  for (const auto& expression : expressions)
+    patterns.push_back(make_unique<pattern>(expression));
+
+  vector<size_t> expected;
+  auto start = clock::now();
+  for (size_t idx = 0; idx < patterns.size(); idx++)
+    if (patterns[idx]->is_match(input))
+      expected.push_back(idx);
+  auto individual_time = clock::now() - start;
+
+  // the first search may compile the expressions separately, so only the second one is timed
+  regex_set set(expressions);
+  EXPECT_EQ(set_matches(set, input), expected);
+  start = clock::now();
+  EXPECT_EQ(set_matches(set, input), expected);
+  auto set_time = clock::now() - start;
+
+  EXPECT_LT(set_time, 4 * individual_time + chrono::milliseconds(100));
+}
+
+/** Verify that an empty set cannot be compiled. */
+TEST_F(RegexSetTests, EmptySet)
+{
+  EXPECT_THROW(regex_set(vector<string>()), compile_error);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file	shift_and_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "prefilter.hpp"
+#include "shift_and.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::shift_and` class.
+ */
+class ShiftAndTests : public Test
+{
+protected:
+
+  /** Parses the specified pattern. */
+  syntax_tree parse(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return parse.parse_tree();
+  }
+
+  /** Compiles the specified expression in reverse. */
+  shared_ptr<const program> compile_reverse(const syntax_tree& tree)
+  {
+    compile_options options;
+    options.reverse = true;
+    return compile(tree, options);
+  }
+
+  /** Expect the Shift-And engine to agree with the Pike VM for `pattern` on `input`. */
+  void expect_same_as_vm(const shift_and& engine, pike_vm& vm, const string& pattern, const string& input)
+  {
+    match expected { 0, 0 };
+    match actual { 0, 0 };
+    bool expected_found = vm.find(input, expected);
+    bool actual_found = engine.find(input, actual);
+
+    ASSERT_EQ(actual_found, expected_found) << pattern << " / " << input;
+    EXPECT_EQ(engine.is_match(input), expected_found) << pattern << " / " << input;
+    if (expected_found)
+    {
+      EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+      EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+    }
+  }
+
+};
+
+/** Verify that the Shift-And engine agrees with the Pike VM, with and without a prefilter. */
+TEST_F(ShiftAndTests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab*", "ab+c?", "(ab)*c", "a*", "abcd|c", "b+|a", "(a|b)*abb",
+    "x(a*)*b", "(cat|dog)s?", "(a|b)*a(a|b)(a|b)", "ab{2,3}", "(ab){1,}c", "b{0,2}a?b", "a{0}b",
+    "[ab]+c", "[^a]b", "\\w+", "(a|bc)(d|ef)?g",
+  };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "ab", "abbbc", "ababc", "bbb", "abcd", "xabbb", "aababb", "xaab", "hotdogs",
+    "bbbabaa", "zzbcefg adg", "xxabb xaaab",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto tree = parse(pattern);
+    auto prog = compile(tree);
+    auto pre = make_prefilter(tree);
+    auto reverse = compile_reverse(tree);
+    shift_and engine(tree, prog, reverse);
+    shift_and filtered(tree, prog, reverse, pre);
+    pike_vm vm(prog);
+
+    for (const auto& input : INPUTS)
+    {
+      expect_same_as_vm(engine, vm, pattern, input);
+      expect_same_as_vm(filtered, vm, pattern, input);
+    }
+  }
+}
+
+/** Verify that only expressions without unbounded repetition have a bounded match length. */
+TEST_F(ShiftAndTests, DetectsBoundedLength)
+{
+  for (const auto& expression : { "abc", "a|bcd", "ab?c{2,5}", "(a|[bc])." })
+  {
+    auto tree = parse(expression);
+    EXPECT_TRUE(shift_and(tree, compile(tree), compile_reverse(tree)).is_bounded()) << expression;
+  }
+
+  for (const auto& expression : { "ab*", "(ab)+c", "a{2,}", "x(a|b*)y" })
+  {
+    auto tree = parse(expression);
+    EXPECT_FALSE(shift_and(tree, compile(tree), compile_reverse(tree)).is_bounded()) << expression;
+  }
+}
+
+/** Verify that positions are counted with repetitions expanded, and that large expressions are rejected. */
+TEST_F(ShiftAndTests, CountsPositions)
+{
+  EXPECT_EQ(shift_and::count_positions(parse("abc")), 3u);
+  EXPECT_EQ(shift_and::count_positions(parse("(a|[bc])*.")), 3u);
+  EXPECT_EQ(shift_and::count_positions(parse("(ab){2,3}")), 6u);
+  EXPECT_EQ(shift_and::count_positions(parse("(ab){2,}")), 6u);
+  EXPECT_EQ(shift_and::count_positions(parse("a{1000}")), shift_and::MAX_POSITIONS + 1);
+
+  auto largest = parse(string(shift_and::MAX_POSITIONS, 'a'));
+  EXPECT_EQ(shift_and(largest, compile(largest), compile_reverse(largest)).position_count(), shift_and::MAX_POSITIONS);
+
+  auto large = parse(string(shift_and::MAX_POSITIONS + 1, 'a'));
+  EXPECT_THROW(shift_and(large, compile(large), compile_reverse(large)), compile_error);
+
+  pattern_options options;
+  options.engine = engine_type::shift_and;
+  EXPECT_THROW(pattern("x{65}", options), compile_error);
+}
+
+/** Verify that the automatic engine falls back for expressions which are too large. */
+TEST_F(ShiftAndTests, PatternFallsBack)
+{
+  static const string INPUT = "...." + string(100, 'a') + "b....";
+
+  regex::match result { 0, 0 };
+  pattern small("a+b");
+  ASSERT_TRUE(small.find(INPUT, result));
+  EXPECT_EQ(result.begin, 4u);
+  EXPECT_EQ(result.end, 105u);
+
+  pattern large("a{100}b");
+  ASSERT_TRUE(large.find(INPUT, result));
+  EXPECT_EQ(result.begin, 4u);
+  EXPECT_EQ(result.end, 105u);
+  EXPECT_FALSE(large.is_match(string(99, 'a') + "b"));
+}
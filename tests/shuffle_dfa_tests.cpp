@@ -0,0 +1,76 @@
+/**
+ * @file	shuffle_dfa_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "dfa_test_helpers.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "shuffle_dfa.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+using namespace regex::test;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::shuffle_dfa` class.
+ */
+class ShuffleDFATests : public Test
+{
+};
+
+/** Verify that the shuffle DFA agrees with the table-driven scan of the same DFA. */
+TEST_F(ShuffleDFATests, AgreesWithFullDFA)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a.c", "a|ab", "ab|a", "ab+c?", "(a|b)*abb", "cab{2,4}", "(abc|bca)+", "c.*c", "ccc|bbbb",
+    "x*", "a?", "[ab]c{3}b",
+  };
+
+  mt19937 rng(RANDOM_SEED);
+  for (const auto& pattern : PATTERNS)
+  {
+    auto dfa = compile_dfa(pattern);
+    ASSERT_TRUE(shuffle_dfa::fits(*dfa)) << pattern;
+    shuffle_dfa shuffled(dfa);
+    expect_same_matches(*dfa, shuffled, pattern, rng, { "abc", "aab xyz" }, 200, 0, 100);
+  }
+}
+
+/** Verify that DFAs with more than 16 states are rejected. */
+TEST_F(ShuffleDFATests, RejectsLargeDFAs)
+{
+  auto dfa = compile_dfa("abcdefghijklmnopqrstuvwxyz");
+  EXPECT_FALSE(shuffle_dfa::fits(*dfa));
+  EXPECT_THROW(shuffle_dfa shuffled(dfa), compile_error);
+  EXPECT_NE(string(shuffle_dfa::isa()), "");
+}
+
+/** Verify that patterns use the shuffle DFA when requested. */
+TEST_F(ShuffleDFATests, PatternUsesShuffleDFA)
+{
+  pattern_options options;
+  options.engine = engine_type::shuffle_dfa;
+  pattern p("[0-9]+(px|em)", options);
+
+  match result { 0, 0 };
+  ASSERT_TRUE(p.find("width: 120px;", result));
+  EXPECT_EQ(result.begin, 7u);
+  EXPECT_EQ(result.end, 12u);
+  EXPECT_FALSE(p.is_match("width: 120%;"));
+
+  EXPECT_THROW(pattern("abcdefghijklmnopqrstuvwxyz", options), compile_error);
+}
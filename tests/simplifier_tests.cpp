@@ -0,0 +1,260 @@
+/**
+ * @file	simplifier_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lazy_dfa.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "pike_vm.hpp"
+#include "simplifier.hpp"
+#include "syntax.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::simplify()` procedures.
+ */
+class SimplifierTests : public Test
+{
+protected:
+
+  /** Parses the specified pattern into an arena syntax tree. */
+  syntax_tree parse(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return parse.parse_tree();
+  }
+
+  /** Returns a compact description of the subtree at `index`. */
+  string describe(const syntax_tree& tree, syntax_index index)
+  {
+    switch (tree.type(index))
+    {
+    case syntax_node_type::literal:
+      return string(1, tree.character(index));
+
+    case syntax_node_type::wildcard:
+      return ".";
+
+    case syntax_node_type::character_class:
+    {
+      string result = "[";
+      for (size_t byte = 0; byte < 256; byte++)
+        if (tree.bitmap(index).test(byte))
+          result += static_cast<char>(byte);
+      return result + "]";
+    }
+
+    case syntax_node_type::string:
+      return "\"" + tree.text(index) + "\"";
+
+    case syntax_node_type::optional:
+      return describe(tree, tree.children(index)[0]) + "?";
+
+    case syntax_node_type::kleene:
+      return describe(tree, tree.children(index)[0]) + "*";
+
+    case syntax_node_type::repeat:
+      return describe(tree, tree.children(index)[0]) + "+";
+
+    case syntax_node_type::capture:
+      return "<" + describe(tree, tree.children(index)[0]) + ">";
+
+    case syntax_node_type::quantifier:
+      return (describe(tree, tree.children(index)[0]) + "{" + to_string(tree.min_count(index)) + "," +
+              (tree.max_count(index) == syntax_quantifier_node::UNBOUNDED ? "" : to_string(tree.max_count(index))) + "}");
+
+    default:
+    {
+      string result = "(";
+      for (auto child : tree.children(index))
+      {
+        if (result.size() > 1)
+          result += (tree.type(index) == syntax_node_type::alternation ? "|" : " ");
+        result += describe(tree, child);
+      }
+      return result + ")";
+    }
+    }
+  }
+
+  /** Returns a compact description of the simplified tree for the specified pattern. */
+  string simplified(const string& pattern)
+  {
+    auto tree = simplify(parse(pattern));
+    return describe(tree, tree.root());
+  }
+
+};
+
+/** Verify that runs of literals are merged into strings. */
+TEST_F(SimplifierTests, MergesLiterals)
+{
+  EXPECT_EQ(simplified("a"), "a");
+  EXPECT_EQ(simplified("abc"), "\"abc\"");
+  EXPECT_EQ(simplified("(?:ab)(?:cd)e"), "\"abcde\"");
+  EXPECT_EQ(simplified("(ab)(cd)e"), "(<\"ab\"> <\"cd\"> e)");
+  EXPECT_EQ(simplified("ab*cd"), "(a b* \"cd\")");
+}
+
+/** Verify that redundant closures are collapsed. */
+TEST_F(SimplifierTests, CollapsesClosures)
+{
+  EXPECT_EQ(simplified("(?:a*)*"), "a*");
+  EXPECT_EQ(simplified("(?:a?)*"), "a*");
+  EXPECT_EQ(simplified("(?:a+)?"), "a*");
+  EXPECT_EQ(simplified("(?:a+)+"), "a+");
+  EXPECT_EQ(simplified("(?:(?:a?)?)?"), "a?");
+  EXPECT_EQ(simplified(".*.*"), ".*");
+  EXPECT_EQ(simplified("a*a*b"), "(a* b)");
+  EXPECT_EQ(simplified("(?:ab)*(?:ab)*"), "(\"ab\"* \"ab\"*)");
+  EXPECT_EQ(simplified("a{0,1}b{0,}c{1,}d{1}"), "(a? b* c+ d)");
+  EXPECT_EQ(simplified("(?:ab){2,5}"), "\"ab\"{2,5}");
+}
+
+/** Verify that duplicate alternatives are removed and shared literals are factored out. */
+TEST_F(SimplifierTests, SimplifiesAlternations)
+{
+  EXPECT_EQ(simplified("a|a"), "a");
+  EXPECT_EQ(simplified("a|(?:b|a)|b"), "[ab]");
+  EXPECT_EQ(simplified("abc|abd"), "(\"ab\" [cd])");
+  EXPECT_EQ(simplified("xa|ya"), "([xy] a)");
+  EXPECT_EQ(simplified("a|[b-d]|e|fg|h"), "([abcde]|\"fg\"|h)");
+  EXPECT_EQ(simplified("[x]"), "x");
+  EXPECT_EQ(simplified("ab|a"), "(a b?)");
+  EXPECT_EQ(simplified("a|ab"), "(a|\"ab\")");
+  EXPECT_EQ(simplified("ab|c|ad"), "(\"ab\"|c|\"ad\")");
+  EXPECT_EQ(simplified("foo|foobar|foobaz"), "(\"foo\"|(\"fooba\" [rz]))");
+}
+
+/** Verify that simplified trees match exactly as the original trees do. */
+TEST_F(SimplifierTests, PreservesMatches)
+{
+  static const vector<string> PATTERNS = {
+    "(a*)*b", "(a|ab)(c|bcd)(d*)", "ab|a", "a|ab", "(ab|a)c", "(a|ab)c", "xa|ya|za?", ".*.*x",
+    "a*a*", "(a+)?b", "(a?)+b", "abc|abd|abe|b", "foo|foobar|foobaz|fo", "(ab|ac)*ad", "(x|xy|xyz)z",
+    "a{2,3}b{0,1}", "(ab|a){1,}c", "x{0}a{1}", "a|[ab]b|b", "[a-c]|ab|[^b]",
+  };
+  static const vector<string> INPUTS = {
+    "", "a", "b", "ab", "abc", "abcd", "abcbcdd", "aab", "ac", "abac", "xa ya za z", "aaax",
+    "abd abe", "foobaz foobar", "fo", "abacad", "xyzz", "xyz",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto original = parse(pattern);
+    auto simple = simplify(original);
+
+    pike_vm reference(compile(original));
+    pike_vm vm(compile(simple));
+
+    compile_options reverse_options;
+    reverse_options.reverse = true;
+    lazy_dfa lazy(compile(simple), compile(simple, reverse_options), 1 << 20);
+
+    for (const auto& input : INPUTS)
+    {
+      match expected { 0, 0 };
+      bool expected_found = reference.find(input, expected);
+
+      match actual { 0, 0 };
+      ASSERT_EQ(vm.find(input, actual), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+
+      ASSERT_EQ(lazy.find(input, actual), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+    }
+  }
+}
+
+/** Verify that simplified patterns report exactly the capture groups the original patterns do. */
+TEST_F(SimplifierTests, PreservesCaptures)
+{
+  static const vector<string> PATTERNS = {
+    "(?:(b*)+)?", "((?:((?:c)?)+)?)", "(?:(a)*)*", "(?:(a?)+)?b", "(?:(ab)+)*", "(?:(a)|b)+",
+    "(?:(a*)?)+", "(?:(?:(a)+)?)*x", "(a*)*b", "(a?)+b",
+  };
+  static const vector<string> INPUTS = {
+    "", "a", "ab", "b", "bb", "c", "abab", "aab", "aaxb", "ba",
+  };
+
+  pattern_options unsimplified;
+  unsimplified.simplify = false;
+  for (const auto& expression : PATTERNS)
+  {
+    pattern original(expression, unsimplified);
+    pattern simple(expression);
+    for (const auto& input : INPUTS)
+    {
+      vector<match> expected;
+      vector<match> actual;
+      ASSERT_EQ(simple.captures(input, actual), original.captures(input, expected)) << expression << " / " << input;
+      ASSERT_EQ(actual.size(), expected.size()) << expression << " / " << input;
+      for (size_t idx = 0; idx < expected.size(); idx++)
+      {
+        EXPECT_EQ(actual[idx].begin, expected[idx].begin) << expression << " / " << input << " / " << idx;
+        EXPECT_EQ(actual[idx].end, expected[idx].end) << expression << " / " << input << " / " << idx;
+      }
+    }
+  }
+}
+
+/** Verify that a large generated alternation is factored into a smaller program. */
+TEST_F(SimplifierTests, FactorsLargeAlternation)
+{
+  string pattern;
+  for (size_t idx = 0; idx < 20000; idx++)
+    pattern += (idx == 0 ? "" : "|") + string("word") + to_string(idx);
+
+  auto original = parse(pattern);
+  auto simple = simplify(original);
+  EXPECT_LT(compile(simple)->instructions.size(), compile(original)->instructions.size() / 2);
+
+  // the earliest alternative matching at the leftmost position is preferred
+  pike_vm vm(compile(simple));
+  match result { 0, 0 };
+  ASSERT_TRUE(vm.find("a word19999 b", result));
+  EXPECT_EQ(result.begin, 2u);
+  EXPECT_EQ(result.end, 7u);
+  ASSERT_TRUE(vm.find("a word0 b", result));
+  EXPECT_EQ(result.end, 7u);
+  EXPECT_FALSE(vm.is_match("a word b"));
+}
+
+/** Verify that the `regex::syntax_node` overload produces an equivalent tree. */
+TEST_F(SimplifierTests, SimplifiesSyntaxNodes)
+{
+  auto tree = parse("(?:a*)*(?:bc|bd)");
+  auto node = simplify(make_syntax_node(tree));
+  ASSERT_NE(node, nullptr);
+
+  auto copy = make_syntax_tree(node);
+  EXPECT_EQ(describe(copy, copy.root()), "(a* (b [cd]))");
+}
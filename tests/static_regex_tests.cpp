@@ -0,0 +1,181 @@
+/**
+ * @file	static_regex_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pike_vm.hpp"
+#include "static_regex.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Patterns -- */
+
+namespace
+{
+  REGEX_STATIC_PATTERN(literal_pattern, "abc");
+  REGEX_STATIC_PATTERN(prefix_pattern, "a|ab");
+  REGEX_STATIC_PATTERN(suffix_pattern, "ab|a");
+  REGEX_STATIC_PATTERN(closure_pattern, "ab*c?");
+  REGEX_STATIC_PATTERN(kleene_group_pattern, "(a|b)*abb");
+  REGEX_STATIC_PATTERN(nested_pattern, "x(a*)*b");
+  REGEX_STATIC_PATTERN(quantifier_pattern, "b{0,2}a?b");
+  REGEX_STATIC_PATTERN(bounded_group_pattern, "(?:ab|a){2,3}c");
+  REGEX_STATIC_PATTERN(class_pattern, "[^a-c][ab-]+\\d");
+  REGEX_STATIC_PATTERN(shorthand_pattern, "\\w+\\s\\W?");
+  REGEX_STATIC_PATTERN(wildcard_pattern, "a.{3}b|a");
+  REGEX_STATIC_PATTERN(empty_pattern, "x*");
+  REGEX_STATIC_PATTERN(brace_pattern, "a{,2}\\.");
+  REGEX_STATIC_PATTERN(optional_group_pattern, "(a|b?)+c");
+  REGEX_STATIC_PATTERN(nested_star_pattern, "(a*)*b");
+  REGEX_STATIC_PATTERN(deeply_nested_star_pattern, "((a*)*)*b");
+  REGEX_STATIC_PATTERN(overlapping_pattern, "(a|aa)+b");
+  REGEX_STATIC_PATTERN(nested_plus_pattern, "(a+a+)+b");
+  REGEX_STATIC_PATTERN(nested_count_pattern, "(a*){2,20}b");
+}
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::static_regex` class.
+ */
+class StaticRegexTests : public Test
+{
+protected:
+
+  /** Expect `static_regex<TPattern>` to agree with the Pike VM on random inputs. */
+  template <typename TPattern>
+  void expect_same_as_vm()
+  {
+    string pattern = TPattern::value();
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    pike_vm vm(compile(parse.parse_regex()));
+    static_regex<TPattern> re;
+
+    mt19937 rng(20170228);
+    static const string ALPHABET = "abcx .2{";
+    uniform_int_distribution<size_t> dist(0, ALPHABET.size() - 1);
+    for (size_t idx = 0; idx < 500; idx++)
+    {
+      string input(idx / 25, ' ');
+      for (auto& ch : input)
+        ch = ALPHABET[dist(rng)];
+
+      match expected { 0, 0 };
+      match actual { 0, 0 };
+      bool expected_found = vm.find(input, expected);
+      bool actual_found = re.find(input, actual);
+
+      ASSERT_EQ(actual_found, expected_found) << pattern << " / " << input;
+      EXPECT_EQ(re.is_match(input), expected_found) << pattern << " / " << input;
+      if (expected_found)
+      {
+        EXPECT_EQ(actual.begin, expected.begin) << pattern << " / " << input;
+        EXPECT_EQ(actual.end, expected.end) << pattern << " / " << input;
+      }
+    }
+  }
+
+};
+
+/** Verify that compile-time patterns find the same matches as runtime ones. */
+TEST_F(StaticRegexTests, AgreesWithPikeVM)
+{
+  expect_same_as_vm<literal_pattern>();
+  expect_same_as_vm<prefix_pattern>();
+  expect_same_as_vm<suffix_pattern>();
+  expect_same_as_vm<closure_pattern>();
+  expect_same_as_vm<kleene_group_pattern>();
+  expect_same_as_vm<nested_pattern>();
+  expect_same_as_vm<quantifier_pattern>();
+  expect_same_as_vm<bounded_group_pattern>();
+  expect_same_as_vm<class_pattern>();
+  expect_same_as_vm<shorthand_pattern>();
+  expect_same_as_vm<wildcard_pattern>();
+  expect_same_as_vm<empty_pattern>();
+  expect_same_as_vm<brace_pattern>();
+  expect_same_as_vm<optional_group_pattern>();
+  expect_same_as_vm<nested_star_pattern>();
+  expect_same_as_vm<overlapping_pattern>();
+  expect_same_as_vm<nested_count_pattern>();
+  expect_same_as_vm<nested_plus_pattern>();
+  expect_same_as_vm<deeply_nested_star_pattern>();
+}
+
+/** Verify that nested repetitions take linear time on inputs which almost match. */
+TEST_F(StaticRegexTests, NestedRepetitionsAreNotExponential)
+{
+  const string input(20000, 'a');
+  EXPECT_FALSE(static_regex<nested_star_pattern>().is_match(input));
+  EXPECT_FALSE(static_regex<deeply_nested_star_pattern>().is_match(input));
+  EXPECT_FALSE(static_regex<overlapping_pattern>().is_match(input));
+  EXPECT_FALSE(static_regex<nested_plus_pattern>().is_match(input));
+  EXPECT_FALSE(static_regex<nested_count_pattern>().is_match(input));
+  EXPECT_FALSE(static_regex<nested_plus_pattern>().full_match(input));
+
+  match result { 0, 0 };
+  ASSERT_TRUE(static_regex<deeply_nested_star_pattern>().find(input + "b", result));
+  EXPECT_EQ(result.begin, 0u);
+  EXPECT_EQ(result.end, input.size() + 1);
+  EXPECT_TRUE(static_regex<nested_plus_pattern>().full_match(input + "b"));
+
+  EXPECT_THROW(static_parse<64>("(a{10}){101}"), syntax_error);
+  EXPECT_NO_THROW(static_parse<64>("(a{10}){100}"));
+}
+
+/** Verify matching against an entire input. */
+TEST_F(StaticRegexTests, FullMatch)
+{
+  static_regex<bounded_group_pattern> re;
+  EXPECT_TRUE(re.full_match("ababc"));
+  EXPECT_TRUE(re.full_match("aabac"));
+  EXPECT_FALSE(re.full_match("abc"));
+  EXPECT_FALSE(re.full_match("ababcx"));
+
+  static_regex<empty_pattern> empty;
+  EXPECT_TRUE(empty.full_match(nullptr, nullptr));
+  EXPECT_TRUE(empty.is_match(nullptr, nullptr));
+}
+
+/** Verify that the constexpr parser rejects the same expressions as the runtime parser. */
+TEST_F(StaticRegexTests, RejectsSyntaxErrors)
+{
+  static const vector<string> INVALID = {
+    "", "a|", "()", "(a", "a)", "*a", "a**", "a{2}{3}", "{2}", "[abc", "[z-a]", "[\\d-z]", "a\\",
+    "\\q", "a{1001}", "a{3,2}",
+  };
+
+  for (const auto& pattern : INVALID)
+  {
+    EXPECT_THROW(static_parse<64>(pattern.c_str()), syntax_error) << pattern;
+    EXPECT_THROW({
+        lexical_analyzer lex(pattern);
+        syntax_analyzer parse(lex.all_tokens());
+        parse.parse_regex();
+      }, runtime_error) << pattern;
+  }
+
+  // parsed at compile time, and usable in constant expressions
+  constexpr auto tree = static_parse<16>("[0-9]+(px|em)");
+  static_assert(tree.nodes[tree.root].type == static_node_type::concatenation, "Expected concatenation.");
+  static_assert(!tree.nullable, "Expected a non-nullable expression.");
+  EXPECT_TRUE(tree.first_bytes.test('7'));
+  EXPECT_FALSE(tree.first_bytes.test('p'));
+}
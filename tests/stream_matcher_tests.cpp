@@ -0,0 +1,162 @@
+/**
+ * @file	stream_matcher_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/28
+ */
+
+/* -- Includes -- */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pike_vm.hpp"
+#include "stream_matcher.hpp"
+#include "syntax_analyzer.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::stream_matcher` class.
+ */
+class StreamMatcherTests : public Test
+{
+protected:
+
+  /** Compiles the specified pattern. */
+  shared_ptr<const program> compile_pattern(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return compile(parse.parse_regex());
+  }
+
+  /** Returns every match in `input`, found by successive searches with the Pike VM. */
+  vector<match> find_all(const shared_ptr<const program>& prog, const string& input)
+  {
+    pike_vm vm(prog);
+    vector<match> matches;
+    size_t start = 0;
+    match result { 0, 0 };
+    while (start <= input.size() && vm.find(input.data() + start, input.data() + input.size(), result))
+    {
+      result.begin += start;
+      result.end += start;
+      matches.push_back(result);
+      start = (result.begin == result.end ? result.end + 1 : result.end);
+    }
+    return matches;
+  }
+
+  /** Returns every match in `input`, pushed through a stream matcher in chunks of `chunk_size` bytes. */
+  vector<match> stream_all(stream_matcher& matcher, const string& input, size_t chunk_size)
+  {
+    vector<match> matches;
+    for (size_t pos = 0; pos < input.size(); pos += chunk_size)
+    {
+      auto end = min(pos + chunk_size, input.size());
+      matcher.push(input.data() + pos, input.data() + end, matches);
+    }
+    EXPECT_EQ(matcher.offset(), input.size());
+    matcher.finish(matches);
+    return matches;
+  }
+
+};
+
+/** Verify that streamed matches agree with successive searches, however the input is split. */
+TEST_F(StreamMatcherTests, AgreesWithPikeVM)
+{
+  static const vector<string> PATTERNS = {
+    "abc", "a|ab", "ab|a", "a+", "a*", "ab*c?", "(a|b)*abb", "x(a*)*b", "(cat|dog)s?", "b{0,2}a?b",
+    "[ab]+c", "\\w+", "(a.{5}b)|a",
+  };
+  static const vector<string> INPUTS = {
+    "", "abc", "xxabcxx", "ababc", "aaa bb aabb", "xabbbaabbb", "hotdogs and cats", "abbabbab",
+    "a12345b a1234x a", "xaab xb",
+  };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto prog = compile_pattern(pattern);
+    stream_matcher matcher(prog);
+
+    for (const auto& input : INPUTS)
+    {
+      auto expected = find_all(prog, input);
+      for (size_t chunk_size = 1; chunk_size <= max<size_t>(input.size(), 1); chunk_size++)
+      {
+        auto actual = stream_all(matcher, input, chunk_size);
+        ASSERT_EQ(actual.size(), expected.size()) << pattern << " / " << input << " / " << chunk_size;
+        for (size_t idx = 0; idx < expected.size(); idx++)
+        {
+          EXPECT_EQ(actual[idx].begin, expected[idx].begin) << pattern << " / " << input << " / " << chunk_size;
+          EXPECT_EQ(actual[idx].end, expected[idx].end) << pattern << " / " << input << " / " << chunk_size;
+        }
+      }
+    }
+  }
+}
+
+/** Verify that matches spanning chunks are reported as soon as they are final, without buffering. */
+TEST_F(StreamMatcherTests, ReportsFinalMatchesEagerly)
+{
+  stream_matcher matcher(compile_pattern("needle"));
+  vector<match> matches;
+
+  matcher.push(string("hay hay nee"), matches);
+  EXPECT_TRUE(matches.empty());
+  EXPECT_EQ(matcher.buffered(), 0u);
+
+  matcher.push(string("dle hay"), matches);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0].begin, 8u);
+  EXPECT_EQ(matches[0].end, 14u);
+  EXPECT_EQ(matcher.buffered(), 0u);
+
+  // a long stream with no matches keeps nothing
+  for (size_t idx = 0; idx < 1000; idx++)
+    matcher.push(string("hay hay hay "), matches);
+  EXPECT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matcher.buffered(), 0u);
+  EXPECT_EQ(matcher.offset(), 12018u);
+
+  matcher.finish(matches);
+  EXPECT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matcher.offset(), 0u);
+}
+
+/** Verify that a match which may still be extended is held back until it is final. */
+TEST_F(StreamMatcherTests, HoldsExtensibleMatches)
+{
+  stream_matcher matcher(compile_pattern("a+"));
+  vector<match> matches;
+
+  matcher.push(string("xaa"), matches);
+  EXPECT_TRUE(matches.empty());
+  matcher.push(string(10000, 'a'), matches);
+  EXPECT_TRUE(matches.empty());
+  EXPECT_LE(matcher.buffered(), 2u);
+
+  matcher.push(string("b"), matches);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_EQ(matches[0].begin, 1u);
+  EXPECT_EQ(matches[0].end, 10003u);
+
+  matcher.push(string("a"), matches);
+  matcher.finish(matches);
+  ASSERT_EQ(matches.size(), 2u);
+  EXPECT_EQ(matches[1].begin, 10004u);
+  EXPECT_EQ(matches[1].end, 10005u);
+}
@@ -0,0 +1,279 @@
+/**
+ * @file	syntax_tree_tests.cpp
+ * @author	Chris Vig (chris@invictus.so)
+ * @date	2017/02/27
+ */
+
+/* -- Includes -- */
+
+#include <bitset>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "compiler.hpp"
+#include "lexical_analyzer.hpp"
+#include "match.hpp"
+#include "pattern.hpp"
+#include "program.hpp"
+#include "syntax.hpp"
+#include "syntax_analyzer.hpp"
+#include "syntax_tree.hpp"
+
+/* -- Namespaces -- */
+
+using namespace std;
+using namespace testing;
+using namespace regex;
+
+/* -- Test Cases -- */
+
+/**
+ * Unit test for the `regex::syntax_tree` class.
+ */
+class SyntaxTreeTests : public Test
+{
+protected:
+
+  /** Parses the specified pattern into an arena syntax tree. */
+  syntax_tree parse(const string& pattern)
+  {
+    lexical_analyzer lex(pattern);
+    syntax_analyzer parse(lex.all_tokens());
+    return parse.parse_tree();
+  }
+
+  /** Returns `true` if two programs have identical instructions. */
+  bool same_program(const program& lhs, const program& rhs)
+  {
+    if (lhs.instructions.size() != rhs.instructions.size())
+      return false;
+    for (size_t pc = 0; pc < lhs.instructions.size(); pc++)
+    {
+      const auto& a = lhs.instructions[pc];
+      const auto& b = rhs.instructions[pc];
+      if (a.op != b.op || a.argument != b.argument || a.next != b.next || a.alternate != b.alternate)
+        return false;
+    }
+    return (lhs.anchored_start == rhs.anchored_start && lhs.unanchored_start == rhs.unanchored_start);
+  }
+
+};
+
+/** Verify that the parser builds the expected arena tree. */
+TEST_F(SyntaxTreeTests, ParsesIntoArena)
+{
+  auto tree = parse("ab|c*");
+  ASSERT_EQ(tree.size(), 6u);
+
+  auto root = tree.root();
+  ASSERT_EQ(tree.type(root), syntax_node_type::alternation);
+  auto children = tree.children(root);
+  ASSERT_EQ(children.size(), 2u);
+
+  auto concatenation = children[0];
+  ASSERT_EQ(tree.type(concatenation), syntax_node_type::concatenation);
+  EXPECT_EQ(tree.character(tree.children(concatenation)[0]), 'a');
+  EXPECT_EQ(tree.character(tree.children(concatenation)[1]), 'b');
+
+  auto kleene = children[1];
+  ASSERT_EQ(tree.type(kleene), syntax_node_type::kleene);
+  ASSERT_EQ(tree.children(kleene).size(), 1u);
+  EXPECT_EQ(tree.character(tree.children(kleene)[0]), 'c');
+}
+
+/** Verify that sequences and lists of alternatives are parsed into single n-ary nodes. */
+TEST_F(SyntaxTreeTests, ParsesNaryNodes)
+{
+  auto tree = parse("abc|d|(?:ef)g");
+  auto root = tree.root();
+  ASSERT_EQ(tree.type(root), syntax_node_type::alternation);
+  auto alternatives = tree.children(root);
+  ASSERT_EQ(alternatives.size(), 3u);
+
+  ASSERT_EQ(tree.type(alternatives[0]), syntax_node_type::concatenation);
+  ASSERT_EQ(tree.children(alternatives[0]).size(), 3u);
+  EXPECT_EQ(tree.character(tree.children(alternatives[0])[2]), 'c');
+
+  EXPECT_EQ(tree.type(alternatives[1]), syntax_node_type::literal);
+
+  ASSERT_EQ(tree.type(alternatives[2]), syntax_node_type::concatenation);
+  ASSERT_EQ(tree.children(alternatives[2]).size(), 2u);
+  EXPECT_EQ(tree.type(tree.children(alternatives[2])[0]), syntax_node_type::concatenation);
+
+  // the legacy tree keeps its right-nested binary shape
+  auto node = make_syntax_node(tree);
+  ASSERT_EQ(node->type(), syntax_node_type::alternation);
+  const auto& rest = static_cast<const syntax_alternation_node&>(*node).children()[1];
+  ASSERT_EQ(rest->type(), syntax_node_type::alternation);
+  EXPECT_EQ(static_cast<const syntax_alternation_node&>(*rest).children()[0]->type(), syntax_node_type::literal);
+}
+
+/** Verify that malformed expressions are still rejected. */
+TEST_F(SyntaxTreeTests, RejectsSyntaxErrors)
+{
+  static const vector<string> PATTERNS = { "", "*", "a**", "a|", "|a", "(a", "a)", "()", "(a|)", "a(", "(a*+)" };
+
+  for (const auto& pattern : PATTERNS)
+    EXPECT_THROW(parse(pattern), syntax_error) << pattern;
+}
+
+/** Verify that very long and deeply nested expressions are parsed without exhausting the stack. */
+TEST_F(SyntaxTreeTests, LongAndNestedPatterns)
+{
+  string literal(200000, 'x');
+  auto tree = parse(literal);
+  EXPECT_EQ(tree.size(), literal.size() + 1);
+  EXPECT_EQ(tree.children(tree.root()).size(), literal.size());
+  EXPECT_NE(compile(tree), nullptr);
+
+  string words;
+  for (size_t idx = 0; idx < 50000; idx++)
+    words += (idx == 0 ? "" : "|") + string("w") + to_string(idx);
+  tree = parse(words);
+  EXPECT_EQ(tree.children(tree.root()).size(), 50000u);
+  EXPECT_NE(compile(tree), nullptr);
+
+  // groups nested as deeply as allowed are compiled and searched without exhausting the stack
+  static const size_t DEPTH = syntax_analyzer::MAX_NESTING_DEPTH;
+  string nested = string(DEPTH, '(') + "a" + string(DEPTH, ')');
+  tree = parse(nested);
+  EXPECT_EQ(tree.size(), DEPTH + 1);
+  EXPECT_EQ(tree.group(tree.root()), 1u);
+
+  string starred;
+  string noncapturing;
+  for (size_t idx = 0; idx < DEPTH; idx++)
+  {
+    starred += "(a";
+    noncapturing += "(?:b|";
+  }
+  for (size_t idx = 0; idx < DEPTH; idx++)
+    starred += ")*";
+  noncapturing += "a" + string(DEPTH, ')');
+
+  static const string INPUT = "xxaay";
+  const vector<pair<string, regex::match>> EXPECTED = {
+    { nested, { 2, 3 } },
+    { starred, { 0, 0 } },
+    { noncapturing, { 2, 3 } },
+  };
+
+  for (auto engine : { engine_type::automatic, engine_type::pike_vm, engine_type::lazy_dfa, engine_type::full_dfa })
+  {
+    pattern_options options;
+    options.engine = engine;
+
+    for (const auto& expected : EXPECTED)
+    {
+      pattern deep(expected.first, options);
+      regex::match result { 0, 0 };
+      ASSERT_TRUE(deep.find(INPUT, result));
+      EXPECT_EQ(result.begin, expected.second.begin);
+      EXPECT_EQ(result.end, expected.second.end);
+    }
+  }
+
+  vector<regex::match> groups;
+  ASSERT_TRUE(pattern(nested).captures(INPUT, groups));
+  ASSERT_EQ(groups.size(), DEPTH + 1);
+  EXPECT_EQ(groups[DEPTH].begin, 2u);
+  EXPECT_EQ(groups[DEPTH].end, 3u);
+
+  // deeper nesting is rejected rather than overflowing the stack in a later pass
+  EXPECT_THROW(parse(string(DEPTH + 1, '(') + "a" + string(DEPTH + 1, ')')), syntax_error);
+  EXPECT_THROW(pattern(string(20000, '(') + "a" + string(20000, ')')), syntax_error);
+
+  starred.clear();
+  for (size_t idx = 0; idx < 8000; idx++)
+    starred += "(a";
+  for (size_t idx = 0; idx < 8000; idx++)
+    starred += ")*";
+  EXPECT_THROW(pattern deep(starred), syntax_error);
+
+  noncapturing.clear();
+  for (size_t idx = 0; idx < 100000; idx++)
+    noncapturing += "(?:";
+  EXPECT_THROW(parse(noncapturing + "a" + string(100000, ')')), syntax_error);
+}
+
+/** Verify that nodes are compact. */
+TEST_F(SyntaxTreeTests, CompactNodes)
+{
+  EXPECT_LE(sizeof(syntax_tree_node), 12u);
+}
+
+/** Verify that conversion between the two representations preserves the tree. */
+TEST_F(SyntaxTreeTests, RoundTrip)
+{
+  static const vector<string> PATTERNS = { "a", ".", "ab|c*", "(a|b)+c?", "((ab)*|c.d)e+" };
+
+  for (const auto& pattern : PATTERNS)
+  {
+    auto tree = parse(pattern);
+    auto node = make_syntax_node(tree);
+    auto copy = make_syntax_tree(node);
+
+    EXPECT_TRUE(same_program(*compile(tree), *compile(node))) << pattern;
+    EXPECT_TRUE(same_program(*compile(tree), *compile(copy))) << pattern;
+  }
+}
+
+/** Verify that wildcards and classes can be kept from matching newlines. */
+TEST_F(SyntaxTreeTests, RestrictsClasses)
+{
+  bitset<256> allowed;
+  allowed.set();
+  allowed.reset('\n');
+
+  auto tree = restrict_classes(parse("(a.)[^b]\n{2}"), allowed);
+  auto root = tree.root();
+  ASSERT_EQ(tree.type(root), syntax_node_type::concatenation);
+  auto children = tree.children(root);
+  ASSERT_EQ(children.size(), 3u);
+
+  auto capture = children[0];
+  ASSERT_EQ(tree.type(capture), syntax_node_type::capture);
+  EXPECT_EQ(tree.group(capture), 1u);
+  auto wildcard = tree.children(tree.children(capture)[0])[1];
+  ASSERT_EQ(tree.type(wildcard), syntax_node_type::character_class);
+  EXPECT_EQ(tree.bitmap(wildcard).count(), 255u);
+  EXPECT_FALSE(tree.bitmap(children[1]).test('\n'));
+  EXPECT_FALSE(tree.bitmap(children[1]).test('b'));
+  EXPECT_EQ(tree.min_count(children[2]), 2u);
+  EXPECT_EQ(tree.character(tree.children(children[2])[0]), '\n');
+
+  // every engine then keeps matches within a line
+  static const string INPUT = "ab\ncd";
+  for (auto engine : { engine_type::pike_vm, engine_type::lazy_dfa, engine_type::full_dfa,
+                       engine_type::shift_and, engine_type::shuffle_dfa })
+  {
+    pattern_options options;
+    options.engine = engine;
+    options.match_newline = false;
+
+    regex::match result { 0, 0 };
+    ASSERT_TRUE(pattern("b.*", options).find(INPUT, result));
+    EXPECT_EQ(result.end, 2u);
+    EXPECT_FALSE(pattern("b[^x]c", options).is_match(INPUT));
+    EXPECT_TRUE(pattern("b\nc", options).is_match(INPUT));
+  }
+}
+
+/** Verify that a large generated pattern is parsed into a single arena. */
+TEST_F(SyntaxTreeTests, LargePattern)
+{
+  string pattern;
+  for (size_t idx = 0; idx < 2000; idx++)
+    pattern += (idx == 0 ? "" : "|") + string("ab") + string(1, static_cast<char>('a' + idx % 26)) + "*";
+
+  auto tree = parse(pattern);
+  EXPECT_EQ(tree.size(), 2000u * 5 + 1);
+  EXPECT_GE(tree.memory_usage(), tree.size() * sizeof(syntax_tree_node));
+  EXPECT_NE(compile(tree), nullptr);
+
+  tree.clear();
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.root(), syntax_tree::NO_NODE);
+}